@@ -1,35 +1,24 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "RawStateReader.h"
 #include "../inputs/buttons/MatrixInput.h"
-#include "../inputs/ShiftRegisterManager.h"
+#include "../inputs/InputManager.h"
 #include "../Config.h"
-#include <hardware/gpio.h>
 
 // Static member definitions
 bool RawStateReader::s_rawMonitoringEnabled = false;
 uint32_t RawStateReader::s_lastMonitorUpdate = 0;
 
-// External references to input subsystems
-extern ShiftRegisterManager g_shiftRegisterManager;
-
 uint64_t RawStateReader::getCurrentTimestamp() {
     return to_us_since_boot(get_absolute_time());
 }
 
 void RawStateReader::readGpioStates() {
-    uint32_t gpio_mask = 0;
-    
-    // Read all 30 GPIO pins (GPIO 0-29)
-    for (int i = 0; i < 30; i++) {
-        bool pin_state = gpio_get(i);
-        if (pin_state) {
-            gpio_mask |= (1UL << i);
-        }
-    }
+    // Levels captured by the scan core at the end of its last cycle (GPIO 0-29)
+    const ScanSnapshot& snap = g_inputManager.snapshot();
     
     uint64_t timestamp = getCurrentTimestamp();
     Serial.print("GPIO_STATES:0x");
-    Serial.print(gpio_mask, HEX);
+    Serial.print(snap.gpio, HEX);
     Serial.print(":");
     Serial.println((unsigned long)timestamp);
 }
@@ -46,30 +35,18 @@ void RawStateReader::readMatrixState() {
         return;
     }
     
-    // Access matrix pin configuration through accessor functions
-    uint8_t* rowPins = MatrixRawAccess::getRowPins();
-    uint8_t* colPins = MatrixRawAccess::getColPins();
-    
-    if (!rowPins || !colPins) {
+    // The matrix is driven by the scan core; report its last undebounced scan instead
+    // of driving the rows from here
+    const ScanSnapshot& snap = g_inputManager.snapshot();
+    if (snap.matrixRows == 0 || snap.matrixCols == 0) {
         Serial.println("MATRIX_STATE:NO_MATRIX_PINS_CONFIGURED");
         return;
     }
     
-    // Scan matrix
-    for (uint8_t row = 0; row < rows; row++) {
-        
-        // Drive this row LOW (active)
-        gpio_set_dir(rowPins[row], GPIO_OUT);
-        gpio_put(rowPins[row], 0);
-        
-        // Small delay for signal to settle
-        delayMicroseconds(10);
-        
-        // Read all columns
-        for (uint8_t col = 0; col < cols; col++) {
-            
-            // Read column state (with pull-up, LOW means pressed)
-            bool is_connected = !gpio_get(colPins[col]);
+    for (uint8_t row = 0; row < snap.matrixRows; row++) {
+        for (uint8_t col = 0; col < snap.matrixCols; col++) {
+            const uint16_t key = (uint16_t)row * snap.matrixCols + col;
+            bool is_connected = (snap.matrixRawBits[key >> 5] >> (key & 31)) & 1u;
             
             // Send state for this intersection
             Serial.print("MATRIX_STATE:");
@@ -81,29 +58,25 @@ void RawStateReader::readMatrixState() {
             Serial.print(":");
             Serial.println((unsigned long)timestamp);
         }
-        
-        // Return row to high-impedance state
-        gpio_set_dir(rowPins[row], GPIO_IN);
     }
 }
 
 void RawStateReader::readShiftRegState() {
     uint64_t timestamp = getCurrentTimestamp();
     
-    // Access shift register buffer
-    uint8_t* buffer = g_shiftRegisterManager.getBuffer();
-    if (!buffer) {
+    // Shift register bytes as read by the scan core
+    const ScanSnapshot& snap = g_inputManager.snapshot();
+    if (snap.shiftRegCount == 0) {
         Serial.println("SHIFT_REG:NO_SHIFT_REG_CONFIGURED");
         return;
     }
     
-    // Read from current buffer (non-intrusive)
-    for (uint8_t reg = 0; reg < SHIFTREG_COUNT; reg++) {
+    for (uint8_t reg = 0; reg < snap.shiftRegCount; reg++) {
         Serial.print("SHIFT_REG:");
         Serial.print(reg);
         Serial.print(":0x");
-        if (buffer[reg] < 0x10) Serial.print('0');
-        Serial.print(buffer[reg], HEX);
+        if (snap.shiftRegs[reg] < 0x10) Serial.print('0');
+        Serial.print(snap.shiftRegs[reg], HEX);
         Serial.print(":");
         Serial.println((unsigned long)timestamp);
     }
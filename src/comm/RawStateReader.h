@@ -7,6 +7,8 @@
  * 
  * Provides non-intrusive access to raw pin states, matrix scanning results,
  * and shift register data without interfering with normal input processing.
+ * Runs on core0 and reports the raw state the scan core (core1) published with
+ * its last cycle (InputManager::snapshot()), so it never touches input hardware.
  */
 class RawStateReader {
 public:
@@ -18,8 +20,8 @@ public:
     static void readGpioStates();
     
     /**
-     * @brief Read matrix button states by scanning
-     * Temporarily scans matrix without affecting normal operation
+     * @brief Read matrix button states
+     * Reports the undebounced result of the scan core's last matrix scan
      * Format: MATRIX_STATE:[row]:[col]:[0/1]:[timestamp]
      */
     static void readMatrixState();
@@ -1,71 +1,92 @@
 #include "SerialCommands.h"
+#include <string.h>
+#include <strings.h>
 #include "../config/core/ConfigManager.h"
 #include "../config/core/DeviceIdentifier.h"
 #include "../utils/Debug.h"
 #include "../Config.h"
 #include "../rp2040/hid/HIDMapping.h"
 #include "RawStateReader.h"
+#include "../inputs/buttons/ButtonInput.h"
+#include "../inputs/encoders/EncoderBuffer.h"
+#include "../inputs/encoders/EncoderInput.h"
+#include "../utils/LoopProfiler.h"
 #if CONFIG_FEATURE_STORAGE_ENABLED
-#include "../rp2040/storage/RP2040EEPROMStorage.h"
+#include "../rp2040/storage/RP2040FlashLogStorage.h"
 #endif
 
-// Command handler signature
-using CommandHandler = void (*)(const String&);
+// Command handler signature: args points at the trimmed text after the command name ("" if none)
+using CommandHandler = void (*)(const char* args);
 struct SerialCommand { const char* name; CommandHandler handler; };
 
-static void cmdIdentify(const String&) {
+static void cmdIdentify(const char*) {
     char response[128];
     JoyCore::formatIdentifyResponse(response, sizeof(response));
     Serial.println(response);
 }
-static void cmdStatus(const String&) {
+static void cmdStatus(const char*) {
     ConfigStatus status = g_configManager.getStatus();
     Serial.print("Config Status - Storage: "); Serial.print(status.storageInitialized ? "OK" : "FAIL");
     Serial.print(", Loaded: "); Serial.print(status.configLoaded ? "YES" : "NO");
     Serial.print(", Version: "); Serial.println(status.configVersion);
 }
-static void cmdForceDefaults(const String&) {
-    Serial.println("Forcing default configuration creation...");
-    g_configManager.resetToDefaults();
-    Serial.println("Default configuration created and saved");
+#if CONFIG_FEATURE_STORAGE_ENABLED
+// Storage writes run in the background (ConfigManager::serviceStorageJob); these commands answer
+// with the job ID at once, and STORAGE_JOB reports how it went
+static void printJobQueued(const char* command, uint16_t id) {
+    if (id == 0) { Serial.print("ERROR:STORAGE_BUSY:"); Serial.println(command); return; }
+    Serial.print("OK:"); Serial.print(command); Serial.print(",job="); Serial.println(id);
+}
+static void cmdForceDefaults(const char*) {
+    printJobQueued("FORCE_DEFAULT_CONFIG", g_configManager.queueResetToDefaults());
 }
-static void cmdSaveConfig(const String&) {
-    Serial.println("Saving current configuration to storage...");
-    bool result = g_configManager.saveConfiguration();
-    Serial.println(result?"Configuration saved successfully":"Configuration save failed");
+static void cmdSaveConfig(const char*) {
+    printJobQueued("SAVE_CONFIG", g_configManager.queueSaveConfiguration());
 }
-static void cmdTestWrite(const String&) {
+static void cmdTestWrite(const char*) {
     const char* testData = "Hello World!";
-    g_configManager.writeFile("/test.txt", (const uint8_t*)testData, strlen(testData));
-    Serial.println("Test write completed");
+    printJobQueued("TEST_WRITE", g_configManager.queueWriteFile("/test.txt", (const uint8_t*)testData, strlen(testData)));
 }
-static void cmdCreateTestFiles(const String&) {
-#if CONFIG_FEATURE_STORAGE_ENABLED
-    Serial.println("Creating test files...");
+static void cmdCreateTestFiles(const char*) {
     const char* versionData = "13";
-    StorageResult result = g_configManager.writeFile("/fw_version.txt", (const uint8_t*)versionData, strlen(versionData));
-    Serial.print("Writing /fw_version.txt: "); Serial.println(result == StorageResult::SUCCESS ? "SUCCESS" : "FAILED");
-    bool saveResult = g_configManager.saveConfiguration();
-    Serial.print("Save configuration result: "); Serial.println(saveResult?"SUCCESS":"FAILED");
-    g_configManager.debugStorage();
-#else
-    Serial.println("ERROR:STORAGE_NOT_ENABLED");
-#endif
+    printJobQueued("CREATE_TEST_FILES", g_configManager.queueWriteFile("/fw_version.txt", (const uint8_t*)versionData, strlen(versionData)));
+    printJobQueued("CREATE_TEST_FILES", g_configManager.queueSaveConfiguration());
 }
+static const char* storageJobStateName(StorageJobState state) {
+    switch (state) {
+        case StorageJobState::QUEUED: return "QUEUED";
+        case StorageJobState::RUNNING: return "RUNNING";
+        case StorageJobState::DONE: return "DONE";
+        case StorageJobState::FAILED: return "FAILED";
+        default: return "NONE";
+    }
+}
+// STORAGE_JOB [id]: progress of a queued write (the last one without an ID)
+static void cmdStorageJob(const char* arg) {
+    StorageJobStatus st;
+    if (!g_configManager.getStorageJobStatus((uint16_t)atoi(arg), st)) { Serial.println("ERROR:UNKNOWN_JOB"); return; }
+    Serial.print("STORAGE_JOB:id="); Serial.print(st.id);
+    Serial.print(",state="); Serial.print(storageJobStateName(st.state));
+    Serial.print(",steps="); Serial.print(st.steps);
+    Serial.print(",bytes="); Serial.print(st.bytes);
+    Serial.print(",elapsed_ms="); Serial.print(st.elapsedMs);
+    Serial.print(",result="); Serial.println((int)st.result);
+}
+#endif
 #if CONFIG_FEATURE_STORAGE_ENABLED
-static void cmdListFiles(const String&) {
+static void cmdListFiles(const char*) {
     char fileNames[8][32];
     uint8_t fileCount = g_configManager.listStorageFiles(fileNames, 8);
     Serial.println("FILES:");
     for (uint8_t i = 0; i < fileCount; i++) Serial.println(fileNames[i]);
     Serial.println("END_FILES");
 }
-static void cmdStorageInfo(const String&) {
+static void cmdStorageInfo(const char*) {
     Serial.print("STORAGE_USED:"); Serial.println(g_configManager.getStorageUsed());
     Serial.print("STORAGE_AVAILABLE:"); Serial.println(g_configManager.getStorageAvailable());
     Serial.print("STORAGE_INITIALIZED:"); Serial.println(g_configManager.isStorageInitialized()?"YES":"NO");
 }
-static void cmdDebugStorage(const String&) {
+static void cmdDebugStorage(const char*) {
     // Provide a concise storage debug dump; mirrors old inline debug previously in main.cpp
     Serial.println("DEBUG_STORAGE:BEGIN");
     Serial.print("STORAGE_INITIALIZED:"); Serial.println(g_configManager.isStorageInitialized()?"YES":"NO");
@@ -75,23 +96,23 @@ static void cmdDebugStorage(const String&) {
     g_configManager.debugStorage();
     Serial.println("DEBUG_STORAGE:END");
 }
-static void cmdReadFile(const String& args) {
-    String f = String(args); f.trim();
-    if(f.length()==0){ Serial.println("ERROR:NO_FILENAME"); return; }
-    uint8_t buffer[1024]; size_t bytesRead=0; auto res = g_configManager.readFile(f.c_str(), buffer, sizeof(buffer), &bytesRead);
-    if(res==StorageResult::SUCCESS) {
-        Serial.print("FILE_DATA:"); Serial.print(f); Serial.print(":"); Serial.print(bytesRead); Serial.print(":");
-        for(size_t i=0;i<bytesRead;i++){ if(buffer[i]<0x10) Serial.print('0'); Serial.print(buffer[i], HEX);} Serial.println();
-    } else if(res==StorageResult::ERROR_FILE_NOT_FOUND) {
-        Serial.print("ERROR:FILE_NOT_FOUND:"); Serial.println(f);
-    } else {
+static void cmdReadFile(const char* f) {
+    if(*f=='\0'){ Serial.println("ERROR:NO_FILENAME"); return; }
+    // Printed straight from mapped flash; nothing writes storage while this runs
+    size_t size=0; const uint8_t* data = g_configManager.mapFile(f, &size);
+    if(data) {
+        Serial.print("FILE_DATA:"); Serial.print(f); Serial.print(":"); Serial.print(size); Serial.print(":");
+        for(size_t i=0;i<size;i++){ if(data[i]<0x10) Serial.print('0'); Serial.print(data[i], HEX);} Serial.println();
+    } else if(!g_configManager.isStorageInitialized()) {
         Serial.print("ERROR:READ_FAILED:"); Serial.println(f);
+    } else {
+        Serial.print("ERROR:FILE_NOT_FOUND:"); Serial.println(f);
     }
 }
 #endif
 
 // HID Mapping test commands
-static void cmdHIDMappingInfo(const String&) {
+static void cmdHIDMappingInfo(const char*) {
     const HIDMappingInfo* info = HIDMappingManager::getMappingInfo();
     Serial.print("HID_MAPPING_INFO:");
     Serial.print("ver="); Serial.print(info->protocol_version);
@@ -101,10 +122,11 @@ static void cmdHIDMappingInfo(const String&) {
     Serial.print(",btn_offset="); Serial.print(info->button_byte_offset);
     Serial.print(",bit_order="); Serial.print(info->button_bit_order);
     Serial.print(",crc=0x"); Serial.print(info->mapping_crc, HEX);
-    Serial.print(",fc_offset="); Serial.println(info->frame_counter_offset);
+    Serial.print(",fc_offset="); Serial.print(info->frame_counter_offset);
+    Serial.print(",enc_axes=0x"); Serial.println(info->encoder_axis_mask, HEX);
 }
 
-static void cmdHIDButtonMap(const String&) {
+static void cmdHIDButtonMap(const char*) {
     const HIDMappingInfo* info = HIDMappingManager::getMappingInfo();
     if (info->mapping_crc == 0x0000) {
         Serial.println("HID_BUTTON_MAP:SEQUENTIAL");
@@ -120,20 +142,19 @@ static void cmdHIDButtonMap(const String&) {
     }
 }
 
-static void cmdHIDSelfTest(const String& args) {
-    String arg = String(args); arg.trim();
-    if (arg == "start") {
+static void cmdHIDSelfTest(const char* arg) {
+    if (strcmp(arg, "start") == 0) {
         SelfTestControl cmd = {0};
         cmd.command = SELFTEST_CMD_START_WALK;
         cmd.interval_ms = SELFTEST_DEFAULT_INTERVAL_MS;
         HIDMappingManager::handleSetSelfTest((const uint8_t*)&cmd, sizeof(cmd));
         Serial.println("HID_SELFTEST:STARTED");
-    } else if (arg == "stop") {
+    } else if (strcmp(arg, "stop") == 0) {
         SelfTestControl cmd = {0};
         cmd.command = SELFTEST_CMD_STOP;
         HIDMappingManager::handleSetSelfTest((const uint8_t*)&cmd, sizeof(cmd));
         Serial.println("HID_SELFTEST:STOPPED");
-    } else if (arg == "status") {
+    } else if (strcmp(arg, "status") == 0) {
         SelfTestControl status = {0};
         HIDMappingManager::handleGetSelfTest((uint8_t*)&status, sizeof(status));
         Serial.print("HID_SELFTEST:status=");
@@ -151,47 +172,93 @@ static void cmdHIDSelfTest(const String& args) {
 }
 
 // Raw state reading commands
-static void cmdReadGpioStates(const String&) {
+static void cmdReadGpioStates(const char*) {
     RawStateReader::readGpioStates();
 }
 
-static void cmdReadMatrixState(const String&) {
+static void cmdReadMatrixState(const char*) {
     RawStateReader::readMatrixState();
 }
 
-static void cmdReadShiftReg(const String&) {
+static void cmdReadShiftReg(const char*) {
     RawStateReader::readShiftRegState();
 }
 
-static void cmdStartRawMonitor(const String&) {
+static void cmdStartRawMonitor(const char*) {
     RawStateReader::startRawMonitor();
 }
 
-static void cmdStopRawMonitor(const String&) {
+static void cmdStopRawMonitor(const char*) {
     RawStateReader::stopRawMonitor();
 }
 
+// Direct-pin edge capture counters (BUTTON_PIN_MODE_IRQ); latencies in microseconds
+static void cmdPinEdgeStats(const char*) {
+    PinEdgeStats st = getPinEdgeStats();
+    Serial.print("PIN_EDGE_STATS:mode="); Serial.print(st.irqMode ? "IRQ" : "POLL");
+    Serial.print(",events="); Serial.print(st.events);
+    Serial.print(",dropped="); Serial.print(st.dropped);
+    Serial.print(",last_us="); Serial.print(st.lastLatencyUs);
+    Serial.print(",avg_us="); Serial.print(st.avgLatencyUs);
+    Serial.print(",max_us="); Serial.println(st.maxLatencyUs);
+}
+
+// Encoder pulse scheduler counters, one line per encoder; overflow counts steps that did not fit
+static void cmdEncoderStats(const char*) {
+    const uint8_t n = getEncoderBufferCount();
+    Serial.print("ENCODER_STATS:count="); Serial.println(n);
+    for (uint8_t i = 0; i < n; i++) {
+        EncoderBufferStats st;
+        if (!getEncoderBufferStats(i, st)) break;
+        Serial.print("ENC:"); Serial.print(i);
+        Serial.print(",press_ms="); Serial.print(st.pressUs / 1000);
+        Serial.print(",release_ms="); Serial.print(st.releaseUs / 1000);
+        Serial.print(",burst="); Serial.print(st.burst ? 1 : 0);
+        Serial.print(",steps="); Serial.print(st.steps);
+        Serial.print(",overflow="); Serial.print(st.overflow);
+        Serial.print(",max_backlog="); Serial.print(st.maxBacklog);
+        EncoderDecodeStats ds = {};
+        getEncoderDecodeStats(i, ds);
+        Serial.print(",pio="); Serial.print(ds.pio ? 1 : 0);
+        Serial.print(",valid="); Serial.print(ds.valid);
+        Serial.print(",recovered="); Serial.print(ds.recovered);
+        Serial.print(",rejected="); Serial.println(ds.rejected);
+    }
+}
+
+#if CONFIG_FEATURE_PERF_STATS_ENABLED
+// Loop profiler commands (durations in CPU cycles)
+static void cmdPerfStats(const char*) {
+    LoopProfiler::printStats();
+}
+
+static void cmdPerfReset(const char*) {
+    LoopProfiler::reset();
+    Serial.println("OK:PERF_RESET");
+}
+#endif
+
 static const SerialCommand kCommands[] = {
     {"IDENTIFY", cmdIdentify},
     {JoyCore::IDENTIFY_COMMAND, cmdIdentify},
     {"STATUS", cmdStatus},
+#if CONFIG_FEATURE_STORAGE_ENABLED
     {"FORCE_DEFAULT_CONFIG", cmdForceDefaults},
     {"SAVE_CONFIG", cmdSaveConfig},
     {"TEST_WRITE", cmdTestWrite},
     {"CREATE_TEST_FILES", cmdCreateTestFiles},
-#if CONFIG_FEATURE_STORAGE_ENABLED
+    {"STORAGE_JOB", cmdStorageJob},
     {"LIST_FILES", cmdListFiles},
     {"STORAGE_INFO", cmdStorageInfo},
     {"DEBUG_STORAGE", cmdDebugStorage},
     {"READ_FILE", cmdReadFile},
-    {"INIT_STORAGE", [](const String&){ Serial.println("INIT_STORAGE not needed (storage auto-initialized at boot)"); }},
-    {"FORMAT_STORAGE", [](const String&){
+    {"INIT_STORAGE", [](const char*){ Serial.println("INIT_STORAGE not needed (storage auto-initialized at boot)"); }},
+    {"FORMAT_STORAGE", [](const char*){
         Serial.println("Formatting storage (erasing all files)...");
         bool res = g_configManager.formatStorage();
         Serial.print("Format result: "); Serial.println(res?"SUCCESS":"FAILED");
         if(res){
-            RP2040EEPROMStorage probe; probe.initialize();
-            Serial.print("Available space: "); Serial.println(probe.getAvailableSpace());
+            Serial.print("Available space: "); Serial.println(g_configManager.getStorageAvailable());
         }
     }},
 #endif
@@ -205,16 +272,59 @@ static const SerialCommand kCommands[] = {
     {"READ_SHIFT_REG", cmdReadShiftReg},
     {"START_RAW_MONITOR", cmdStartRawMonitor},
     {"STOP_RAW_MONITOR", cmdStopRawMonitor},
+    {"PIN_EDGE_STATS", cmdPinEdgeStats},
+    {"ENCODER_STATS", cmdEncoderStats},
+#if CONFIG_FEATURE_PERF_STATS_ENABLED
+    // Loop profiler commands
+    {"PERF_STATS", cmdPerfStats},
+    {"PERF_RESET", cmdPerfReset},
+#endif
 };
 static constexpr size_t kCommandCount = sizeof(kCommands)/sizeof(kCommands[0]);
 
-void processSerialLine(String line) {
-    line.trim();
-    int spaceIdx = line.indexOf(' ');
-    String cmd = (spaceIdx>=0)? line.substring(0, spaceIdx): line;
-    String args = (spaceIdx>=0)? line.substring(spaceIdx+1): String();
+// Trim leading/trailing whitespace in place; returns the new start of the string
+static char* trimInPlace(char* s) {
+    while (*s == ' ' || *s == '\t' || *s == '\r') s++;
+    char* end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+    return s;
+}
+
+void processSerialLine(char* line) {
+    char* cmd = trimInPlace(line);
+    char* args = cmd;
+    while (*args && *args != ' ') args++;
+    if (*args) { *args++ = '\0'; args = trimInPlace(args); }
     for(size_t i=0;i<kCommandCount;i++) {
-        if(cmd.equalsIgnoreCase(kCommands[i].name)) { kCommands[i].handler(args); return; }
+        if(strcasecmp(cmd, kCommands[i].name) == 0) { kCommands[i].handler(args); return; }
     }
     Serial.println("ERROR:UNKNOWN_COMMAND");
 }
+
+// Incremental line assembler: takes whatever bytes are available and dispatches complete lines.
+// A partial line simply stays in the buffer until the rest arrives, so the input loop never waits on the host.
+static char s_lineBuffer[SERIAL_LINE_MAX];
+static uint8_t s_lineLength = 0;
+static bool s_lineOverflow = false;
+
+void pollSerialCommands() {
+    int budget = SERIAL_POLL_MAX_BYTES;
+    while (budget-- > 0 && Serial.available() > 0) {
+        int c = Serial.read();
+        if (c < 0) break;
+        if (c == '\n') {
+            if (s_lineOverflow) {
+                Serial.println("ERROR:LINE_TOO_LONG");
+            } else {
+                s_lineBuffer[s_lineLength] = '\0';
+                processSerialLine(s_lineBuffer);
+            }
+            s_lineLength = 0;
+            s_lineOverflow = false;
+        } else if (s_lineLength < SERIAL_LINE_MAX - 1) {
+            s_lineBuffer[s_lineLength++] = (char)c;
+        } else {
+            s_lineOverflow = true; // drop the rest of this line
+        }
+    }
+}
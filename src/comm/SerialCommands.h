@@ -1,5 +1,13 @@
 #pragma once
 #include <Arduino.h>
 
-// Process a single line from Serial (newline stripped)
-void processSerialLine(String line);
+// Longest accepted command line (including terminator); longer lines are rejected with ERROR:LINE_TOO_LONG
+static constexpr uint8_t SERIAL_LINE_MAX = 128;
+// Upper bound on bytes consumed per pollSerialCommands() call, to cap time spent per loop iteration
+static constexpr int SERIAL_POLL_MAX_BYTES = 64;
+
+// Non-blocking: consume available Serial bytes and dispatch any complete lines (call from main loop)
+void pollSerialCommands();
+
+// Process a single line from Serial (newline stripped); the line is tokenized in place
+void processSerialLine(char* line);
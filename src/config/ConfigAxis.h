@@ -2,8 +2,10 @@
 #define USER_CONFIG_H
 
 #include "../inputs/analog/AnalogAxis.h"
+#include "../inputs/analog/AdcSampler.h"
 #include "../inputs/analog/AxisProcessing.h"
 #include "../rp2040/JoystickWrapper.h"
+#include "core/ConfigManager.h"
 
 /*
  * HOTAS Axis Configuration (runtime behavior reflects the whole codebase)
@@ -13,8 +15,8 @@
  *   -> Filter (adaptive smoothing or EWMA) -> Response Curve -> HID mapping
  *
  * Hardware ranges:
- *   - Built-in analog pins: 10-bit (0..1023)
- *   - ADS1115 channels (ADS1115_CH0..CH3): cached 16-bit (0..16383), read in round-robin
+ *   - Built-in analog pins: 14-bit (0..16383) with AXIS_ADC_BACKGROUND, else 10-bit (0..1023)
+ *   - ADS1115 channels (ADS1115_CH0..CH3): cached 16-bit (0..16383), converted back-to-back
  *
  * HID mapping:
  *   - Processed user range (e.g., 0..32767) is mapped to -32767..32767 for rp2040-HID.
@@ -22,20 +24,61 @@
  * FILTER_LEVEL options (AxisProcessing.cpp):
  *   AXIS_FILTER_OFF    - Pass-through (no smoothing)
  *   AXIS_FILTER_EWMA   - EWMA filter; uses AXIS_*_EWMA_ALPHA (0..1000), higher alpha = more responsive
+ *   AXIS_FILTER_ADAPTIVE - 1-Euro filter: heavy smoothing at rest (AXIS_ADAPTIVE_MIN_CUTOFF),
+ *                        cutoff rises with stick speed (AXIS_ADAPTIVE_BETA) so fast moves
+ *                        have little lag. Uses the measured interval between samples.
+ *                        Parameters are stored per axis (StoredAxisConfig) for tuning.
  *
  * Deadband:
  *   - Dynamic around current position; activates when average movement is low to hold value steady.
  *   - Applied BEFORE filtering/curves; good for eliminating jitter at rest.
  *
+ * Response curves:
+ *   - Linear unless config.bin holds a curve entry for the axis: 2..16 control points over
+ *     0..32767, straight segments or monotone cubic (CURVE_FLAG_SMOOTH, no overshoot).
+ *   - Compiled at setup into a 257..4097 entry lookup table (StoredCurveHeader lutLog2);
+ *     only the table is kept in RAM (2 KB per axis at the default 1025 entries).
+ *
+ * Built-in ADC (AXIS_ADC_BACKGROUND = 1, AdcSampler.cpp):
+ *   - The ADC free-runs in round-robin over the used pins and DMA fills a ring buffer;
+ *     nothing in the loop waits for a conversion.
+ *   - AXIS_*_ADC_RATE_HZ: output rate of that axis (multiple of 100 Hz). Each output runs
+ *     the deadband/filter/curve pipeline once, so EWMA alpha applies per output sample.
+ *   - AXIS_*_ADC_OVERSAMPLE: 1, 4, 16 or 64 raw samples averaged per output
+ *     (12, 13, 14, 14+ effective bits). All used pins are converted at the highest
+ *     rate x oversample of any axis, up to 500 kS/s in total.
+ *   - Both are stored per axis (StoredAxisConfig adcRate / adcOversample).
+ *   - Set AXIS_ADC_BACKGROUND to 0 to fall back to analogRead() at 200 Hz.
+ *
  * ADS1115 behavior:
  *   - Automatically initialized if any axis pin is ADS1115_CH0..CH3.
- *   - Channels registered once and read in a non-blocking round-robin (20 ms per channel),
- *     with latest values cached to avoid blocking and prevent encoder lag.
+ *   - Used channels are converted back-to-back at ADS1115_DATA_RATE_SPS (860 SPS: ~4.7 ms
+ *     for all four). I2C transactions run in the controller FIFO and are only polled, so
+ *     the loop never waits on the ADC; each axis is processed once per new conversion.
+ *   - Wire ALERT/RDY to ADS1115_ALERT_RDY_PIN to read each result as soon as it is ready;
+ *     with -1 results are fetched after the worst-case conversion time instead.
+ *   - The ADS1115 owns the default I2C bus (Wire, SDA GP4 / SCL GP5).
  *
  * Enabling axes:
  *   - Uncomment USE_AXIS_* and set AXIS_*_* values. AxisManager is configured once on first read.
  */
 
+// =============================================================================
+// BUILT-IN ADC / ADS1115 CONFIGURATION
+// =============================================================================
+
+#define AXIS_ADC_BACKGROUND     1       // DMA free-running ADC for A0..A3 (0 = analogRead)
+
+#define ADS1115_I2C_ADDRESS     0x48
+#define ADS1115_I2C_HZ          400000
+#define ADS1115_DATA_RATE_SPS   860     // 8, 16, 32, 64, 128, 250, 475 or 860
+#define ADS1115_ALERT_RDY_PIN   -1      // GPIO wired to ALERT/RDY, or -1
+
+// Adaptive filter defaults for new configurations (per axis in StoredAxisConfig)
+#define AXIS_ADAPTIVE_MIN_CUTOFF  100   // 0.01 Hz units: 1.00 Hz at rest
+#define AXIS_ADAPTIVE_BETA        2000  // 0.01 Hz per full-scale/s: +20 Hz at one sweep per second
+#define AXIS_ADAPTIVE_D_CUTOFF    10    // 0.1 Hz units: 1.0 Hz velocity smoothing
+
 // =============================================================================
 // AXIS CONFIGURATION
 // =============================================================================
@@ -50,6 +93,8 @@
     #define AXIS_X_EWMA_ALPHA       200
     #define AXIS_X_DEADBAND         250
     #define AXIS_X_CURVE            CURVE_CUSTOM
+    #define AXIS_X_ADC_RATE_HZ      200
+    #define AXIS_X_ADC_OVERSAMPLE   64
 #endif
 
 //Y-Axis (Main stick yaw)
@@ -62,6 +107,8 @@
     #define AXIS_Y_EWMA_ALPHA       200
     #define AXIS_Y_DEADBAND         250
     #define AXIS_Y_CURVE            CURVE_CUSTOM
+    #define AXIS_Y_ADC_RATE_HZ      200
+    #define AXIS_Y_ADC_OVERSAMPLE   64
 #endif
 
 // Z-Axis - uncomment to enable
@@ -74,6 +121,8 @@
     #define AXIS_Z_EWMA_ALPHA       30
     #define AXIS_Z_DEADBAND         0
     #define AXIS_Z_CURVE            CURVE_CUSTOM
+    #define AXIS_Z_ADC_RATE_HZ      200
+    #define AXIS_Z_ADC_OVERSAMPLE   64
 #endif
 
 // RX-Axis - uncomment to enable
@@ -86,6 +135,8 @@
     #define AXIS_RX_EWMA_ALPHA      30
     #define AXIS_RX_DEADBAND        0
     #define AXIS_RX_CURVE           CURVE_CUSTOM
+    #define AXIS_RX_ADC_RATE_HZ     200
+    #define AXIS_RX_ADC_OVERSAMPLE  64
 #endif
 
 // RY-Axis - uncomment to enable
@@ -98,6 +149,8 @@
     #define AXIS_RY_EWMA_ALPHA      30
     #define AXIS_RY_DEADBAND        0
     #define AXIS_RY_CURVE           CURVE_CUSTOM
+    #define AXIS_RY_ADC_RATE_HZ     200
+    #define AXIS_RY_ADC_OVERSAMPLE  64
 #endif
 
 // RZ-Axis (Rudder/twist) - uncomment to enable
@@ -110,6 +163,8 @@
     #define AXIS_RZ_EWMA_ALPHA      30
     #define AXIS_RZ_DEADBAND        0
     #define AXIS_RZ_CURVE           CURVE_CUSTOM
+    #define AXIS_RZ_ADC_RATE_HZ     200
+    #define AXIS_RZ_ADC_OVERSAMPLE  64
 #endif
 
 // S1-Axis (Throttle) - uncomment to enable
@@ -122,6 +177,8 @@
     #define AXIS_S1_EWMA_ALPHA      30
     #define AXIS_S1_DEADBAND        0
     #define AXIS_S1_CURVE           CURVE_CUSTOM
+    #define AXIS_S1_ADC_RATE_HZ     200
+    #define AXIS_S1_ADC_OVERSAMPLE  64
 #endif
 
 // S2-Axis (Second throttle/slider) - uncomment to enable
@@ -134,6 +191,8 @@
     #define AXIS_S2_EWMA_ALPHA      30
     #define AXIS_S2_DEADBAND        0
     #define AXIS_S2_CURVE           CURVE_CUSTOM
+    #define AXIS_S2_ADC_RATE_HZ     200
+    #define AXIS_S2_ADC_OVERSAMPLE  64
 #endif
 
 // =============================================================================
@@ -150,32 +209,47 @@ struct AxisDescriptor {
     uint32_t alpha;
     int deadband;
     ResponseCurveType curve;
+    uint16_t adcRateHz;
+    uint8_t adcOversampleLog2;
 };
 
+// Oversampling ratio (1, 4, 16, 64) to its log2
+constexpr uint8_t axisOversampleLog2(uint32_t ratio) {
+    return (ratio <= 1) ? 0 : (uint8_t)(1 + axisOversampleLog2(ratio >> 1));
+}
+
 static const AxisDescriptor axisDescriptors[] = {
 #ifdef USE_AXIS_X
-    { AnalogAxisManager::AXIS_X, AXIS_X_PIN, AXIS_X_MIN, AXIS_X_MAX, AXIS_X_FILTER_LEVEL, AXIS_X_EWMA_ALPHA, AXIS_X_DEADBAND, AXIS_X_CURVE },
+    { AnalogAxisManager::AXIS_X, AXIS_X_PIN, AXIS_X_MIN, AXIS_X_MAX, AXIS_X_FILTER_LEVEL, AXIS_X_EWMA_ALPHA, AXIS_X_DEADBAND, AXIS_X_CURVE,
+      AXIS_X_ADC_RATE_HZ, axisOversampleLog2(AXIS_X_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_Y
-    { AnalogAxisManager::AXIS_Y, AXIS_Y_PIN, AXIS_Y_MIN, AXIS_Y_MAX, AXIS_Y_FILTER_LEVEL, AXIS_Y_EWMA_ALPHA, AXIS_Y_DEADBAND, AXIS_Y_CURVE },
+    { AnalogAxisManager::AXIS_Y, AXIS_Y_PIN, AXIS_Y_MIN, AXIS_Y_MAX, AXIS_Y_FILTER_LEVEL, AXIS_Y_EWMA_ALPHA, AXIS_Y_DEADBAND, AXIS_Y_CURVE,
+      AXIS_Y_ADC_RATE_HZ, axisOversampleLog2(AXIS_Y_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_Z
-    { AnalogAxisManager::AXIS_Z, AXIS_Z_PIN, AXIS_Z_MIN, AXIS_Z_MAX, AXIS_Z_FILTER_LEVEL, AXIS_Z_EWMA_ALPHA, AXIS_Z_DEADBAND, AXIS_Z_CURVE },
+    { AnalogAxisManager::AXIS_Z, AXIS_Z_PIN, AXIS_Z_MIN, AXIS_Z_MAX, AXIS_Z_FILTER_LEVEL, AXIS_Z_EWMA_ALPHA, AXIS_Z_DEADBAND, AXIS_Z_CURVE,
+      AXIS_Z_ADC_RATE_HZ, axisOversampleLog2(AXIS_Z_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_RX
-    { AnalogAxisManager::AXIS_RX, AXIS_RX_PIN, AXIS_RX_MIN, AXIS_RX_MAX, AXIS_RX_FILTER_LEVEL, AXIS_RX_EWMA_ALPHA, AXIS_RX_DEADBAND, AXIS_RX_CURVE },
+    { AnalogAxisManager::AXIS_RX, AXIS_RX_PIN, AXIS_RX_MIN, AXIS_RX_MAX, AXIS_RX_FILTER_LEVEL, AXIS_RX_EWMA_ALPHA, AXIS_RX_DEADBAND, AXIS_RX_CURVE,
+      AXIS_RX_ADC_RATE_HZ, axisOversampleLog2(AXIS_RX_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_RY
-    { AnalogAxisManager::AXIS_RY, AXIS_RY_PIN, AXIS_RY_MIN, AXIS_RY_MAX, AXIS_RY_FILTER_LEVEL, AXIS_RY_EWMA_ALPHA, AXIS_RY_DEADBAND, AXIS_RY_CURVE },
+    { AnalogAxisManager::AXIS_RY, AXIS_RY_PIN, AXIS_RY_MIN, AXIS_RY_MAX, AXIS_RY_FILTER_LEVEL, AXIS_RY_EWMA_ALPHA, AXIS_RY_DEADBAND, AXIS_RY_CURVE,
+      AXIS_RY_ADC_RATE_HZ, axisOversampleLog2(AXIS_RY_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_RZ
-    { AnalogAxisManager::AXIS_RZ, AXIS_RZ_PIN, AXIS_RZ_MIN, AXIS_RZ_MAX, AXIS_RZ_FILTER_LEVEL, AXIS_RZ_EWMA_ALPHA, AXIS_RZ_DEADBAND, AXIS_RZ_CURVE },
+    { AnalogAxisManager::AXIS_RZ, AXIS_RZ_PIN, AXIS_RZ_MIN, AXIS_RZ_MAX, AXIS_RZ_FILTER_LEVEL, AXIS_RZ_EWMA_ALPHA, AXIS_RZ_DEADBAND, AXIS_RZ_CURVE,
+      AXIS_RZ_ADC_RATE_HZ, axisOversampleLog2(AXIS_RZ_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_S1
-    { AnalogAxisManager::AXIS_S1, AXIS_S1_PIN, AXIS_S1_MIN, AXIS_S1_MAX, AXIS_S1_FILTER_LEVEL, AXIS_S1_EWMA_ALPHA, AXIS_S1_DEADBAND, AXIS_S1_CURVE },
+    { AnalogAxisManager::AXIS_S1, AXIS_S1_PIN, AXIS_S1_MIN, AXIS_S1_MAX, AXIS_S1_FILTER_LEVEL, AXIS_S1_EWMA_ALPHA, AXIS_S1_DEADBAND, AXIS_S1_CURVE,
+      AXIS_S1_ADC_RATE_HZ, axisOversampleLog2(AXIS_S1_ADC_OVERSAMPLE) },
 #endif
 #ifdef USE_AXIS_S2
-    { AnalogAxisManager::AXIS_S2, AXIS_S2_PIN, AXIS_S2_MIN, AXIS_S2_MAX, AXIS_S2_FILTER_LEVEL, AXIS_S2_EWMA_ALPHA, AXIS_S2_DEADBAND, AXIS_S2_CURVE },
+    { AnalogAxisManager::AXIS_S2, AXIS_S2_PIN, AXIS_S2_MIN, AXIS_S2_MAX, AXIS_S2_FILTER_LEVEL, AXIS_S2_EWMA_ALPHA, AXIS_S2_DEADBAND, AXIS_S2_CURVE,
+      AXIS_S2_ADC_RATE_HZ, axisOversampleLog2(AXIS_S2_ADC_OVERSAMPLE) },
 #endif
 };
 
@@ -195,7 +269,9 @@ inline void setupUserAxes(Joystick_& joystick) {
     for (auto &d : axisDescriptors) {
         if (isAdsPin(d.pin)) { needsADS1115 = true; break; }
     }
-    if (needsADS1115) initializeADS1115IfNeeded();
+    if (needsADS1115) {
+        initializeADS1115IfNeeded(ADS1115_I2C_ADDRESS, ADS1115_I2C_HZ, ADS1115_DATA_RATE_SPS, ADS1115_ALERT_RDY_PIN);
+    }
 }
 
 inline void readUserAxes(Joystick_& joystick) {
@@ -207,10 +283,32 @@ inline void readUserAxes(Joystick_& joystick) {
             axisManager.setAxisRange(d.idx, d.minv, d.maxv);
             axisManager.setAxisFilterLevel(d.idx, d.filter);
             axisManager.setAxisEwmaAlpha(d.idx, d.alpha);
+            if (const StoredAxisConfig* stored = g_configManager.getAxisConfig(d.idx)) {
+                axisManager.setAxisAdaptiveParams(d.idx, stored->minCutoff, stored->beta, stored->dCutoff);
+            } else {
+                axisManager.setAxisAdaptiveParams(d.idx, AXIS_ADAPTIVE_MIN_CUTOFF, AXIS_ADAPTIVE_BETA, AXIS_ADAPTIVE_D_CUTOFF);
+            }
             axisManager.setAxisDeadbandSize(d.idx, d.deadband);
             axisManager.setAxisResponseCurve(d.idx, d.curve);
+            const StoredCurvePoint* curvePoints = nullptr;
+            if (const StoredCurveHeader* curve = g_configManager.getAxisCurve(d.idx, &curvePoints)) {
+                AxisCurvePoint points[AxisPipeline::MAX_CURVE_POINTS];
+                uint8_t count = (curve->pointCount < AxisPipeline::MAX_CURVE_POINTS) ? curve->pointCount : AxisPipeline::MAX_CURVE_POINTS;
+                for (uint8_t i = 0; i < count; i++) points[i] = { curvePoints[i].x, curvePoints[i].y };
+                axisManager.setAxisCurve(d.idx, points, count, (curve->flags & CURVE_FLAG_SMOOTH) != 0, curve->lutLog2);
+            }
             axisManager.enableAxis(d.idx, true);
+#if AXIS_ADC_BACKGROUND
+            // Sampling comes from the stored config so it can be tuned without reflashing
+            const StoredAxisConfig* stored = g_configManager.getAxisConfig(d.idx);
+            uint16_t rateHz = (stored && stored->adcRate) ? (uint16_t)(stored->adcRate * 100) : d.adcRateHz;
+            uint8_t oversampleLog2 = stored ? stored->adcOversample : d.adcOversampleLog2;
+            axisManager.setAxisAdcSampling(d.idx, rateHz, oversampleLog2);
+#endif
         }
+#if AXIS_ADC_BACKGROUND
+        g_adcSampler.begin();
+#endif
         configured = true;
     }
     axisManager.readAllAxes();
@@ -4,7 +4,8 @@
 // This file is included by Config.h and uses the following types from it:
 // - PinMapEntry, PinType, BTN, BTN_ROW, BTN_COL, SHIFTREG_PL, SHIFTREG_CLK, SHIFTREG_QH
 // - LogicalInput, InputType, ButtonBehavior, LatchMode
-// - INPUT_PIN, INPUT_MATRIX, INPUT_SHIFTREG, NORMAL, MOMENTARY, ENC_A, ENC_B, FOUR0, FOUR3
+// - INPUT_PIN, INPUT_MATRIX, INPUT_SHIFTREG, NORMAL, MOMENTARY, ENC_A, ENC_B, ENC_AXIS_A, FOUR0, FOUR3
+// - ENCODER_FLAG_BURST, ENCODER_FLAG_AXIS_CLAMP, ENCODER_FLAG_AXIS_RELATIVE, ENCODER_FLAG_ACCEL
 //
 // Electrical semantics used by the runtime:
 // - Direct pins are configured with INPUT_PULLUP; a physical press reads LOW.
@@ -47,6 +48,65 @@ static const PinMapEntry hardwarePinMap[] = {
   // ...add more as needed...
 };
 
+// ===========================
+// USER EDITABLE DIRECT PIN CONFIG
+// ===========================
+
+ // Direct-pin button acquisition:
+ // - BUTTON_PIN_MODE_POLL: all pins sampled with one GPIO read per scan cycle.
+ // - BUTTON_PIN_MODE_IRQ: GPIO edge interrupts queue (pins, levels, time_us_64) events that the scan
+ //   drains in order. A tap shorter than a scan cycle still reaches one report, and every edge keeps
+ //   its hardware timestamp for latency accounting (PIN_EDGE_STATS serial command).
+ #define BUTTON_PIN_MODE   BUTTON_PIN_MODE_POLL
+
+ // Direct-pin rotary encoders:
+ // - ENCODER_BACKEND_PIO: a PIO state machine per encoder counts every phase transition in
+ //   hardware (up to 4 per PIO block), so no step is lost however long a scan cycle takes. Needs
+ //   ENC_B on the GPIO right after ENC_A; other encoders fall back to polling automatically.
+ // - ENCODER_BACKEND_POLL: phases sampled once per scan cycle.
+ // Shift-register and matrix encoders are always polled.
+ #define ENCODER_BACKEND   ENCODER_BACKEND_PIO
+
+ // Encoder USB pulses: each detent presses the CW/CCW button for ENCODER_PRESS_MS, then keeps it
+ // released for ENCODER_RELEASE_MS. Faster turns are queued, never dropped (ENCODER_STATS serial
+ // command). Per-encoder overrides go in the ENC_A entry after the latch mode:
+ //   { ..., FOUR3, pressMs, releaseMs, ENCODER_FLAG_BURST }
+ // ENCODER_FLAG_BURST plays a backlog back at the 2 ms minimum the host's 1 ms poll can resolve.
+ // Values are clamped to 2..255 ms.
+ #define ENCODER_PRESS_MS    40
+ #define ENCODER_RELEASE_MS  40
+
+ // Encoder axes: ENC_AXIS_A instead of ENC_A puts the encoder on HID axis 9-16 (the joyButtonID of
+ // the ENC_AXIS_A entry; axes 1-8 belong to the analog inputs) and every detent shows up in the
+ // next report. The mode comes from the flags after the latch mode:
+ // - default: absolute position, ENCODER_AXIS_STEP per detent, wrapping from one end to the other.
+ // - ENCODER_FLAG_AXIS_CLAMP: absolute position that stops at the ends.
+ // - ENCODER_FLAG_AXIS_RELATIVE: turn rate; detents add ENCODER_AXIS_STEP and the value decays to
+ //   center with an ENCODER_AXIS_DECAY_MS time constant.
+ #define ENCODER_AXIS_STEP      512
+ #define ENCODER_AXIS_DECAY_MS  250
+
+ // Encoder acceleration (ENCODER_FLAG_ACCEL in the flags): up to ENCODER_ACCEL_SLOW_RATE detents/s
+ // each detent is one step; above that the steps per detent rise linearly to ENCODER_ACCEL_MAX at
+ // ENCODER_ACCEL_FAST_RATE detents/s. Applies to button pulses and encoder axes alike.
+ #define ENCODER_ACCEL_SLOW_RATE  20
+ #define ENCODER_ACCEL_FAST_RATE  200
+ #define ENCODER_ACCEL_MAX        8
+
+// ===========================
+// USER EDITABLE MATRIX CONFIG
+// ===========================
+
+ // Matrix scan backend:
+ // - MATRIX_BACKEND_SIO: the CPU drives each column and busy-waits MATRIX_SETTLE_US, once per scan cycle.
+ // - MATRIX_BACKEND_PIO: a PIO state machine walks the columns continuously and DMA streams each
+ //   column's row sample into RAM, so scanning costs no CPU time and every key is sampled once per
+ //   (columns rounded up to a power of two) x MATRIX_SETTLE_US, e.g. 12.5 kHz for 8 columns at 10 us.
+ //   Needs one free PIO state machine and two DMA channels, otherwise falls back to SIO. No other
+ //   PIO output may be wired between the lowest and highest BTN_COL GPIO.
+ #define MATRIX_BACKEND    MATRIX_BACKEND_SIO
+ #define MATRIX_SETTLE_US  10
+
 // ===========================
 // USER EDITABLE SHIFT REGISTER CONFIG
 // ===========================
@@ -57,6 +117,19 @@ static const PinMapEntry hardwarePinMap[] = {
  // consecutive bits (ENC_A followed by ENC_B) and can specify FOUR0/FOUR3 latch modes per pair.
  #define SHIFTREG_COUNT    2
 
+ // Chain readout backend:
+ // - SHIFTREG_BACKEND_BITBANG: GPIO bit-bang on any pins, read every 1-5 ms. Devices up to the
+ //   last one holding an encoder phase are also re-latched and read alone at
+ //   SHIFTREG_ENCODER_RATE_HZ (0 = off), so fast detents keep their intermediate states.
+ //   With an encoder on the last device the whole chain is read at that rate.
+ // - SHIFTREG_BACKEND_SPI_DMA: hardware SPI + DMA, read every loop in a few microseconds.
+ //   SHIFTREG_CLK must be an SPI SCK pin and SHIFTREG_QH an SPI RX pin of the same block
+ //   (SPI0: CLK 2/6/18/22, QH 0/4/16/20; SPI1: CLK 10/14/26, QH 8/12/24/28). Other pin
+ //   choices fall back to bit-bang automatically. PL can be any GPIO.
+ #define SHIFTREG_BACKEND  SHIFTREG_BACKEND_BITBANG
+ #define SHIFTREG_SPI_BAUD 8000000
+ #define SHIFTREG_ENCODER_RATE_HZ 2000
+
 // ===========================
 // USER EDITABLE LOGICAL INPUTS
 // ===========================
@@ -66,6 +139,9 @@ constexpr LogicalInput logicalInputs[] = {
   // Latch mode can be specified per pair (default FOUR3 if omitted).
   //{ INPUT_PIN, { .pin = {6, 1, ENC_A, 0} }, FOUR3 },
   //{ INPUT_PIN, { .pin = {7, 2, ENC_B, 0} }, FOUR3 },
+  // Same encoder on HID axis 9 (Wheel), clamped at the ends:
+  //{ INPUT_PIN, { .pin = {6, 9, ENC_AXIS_A, 0} }, FOUR3, 0, 0, ENCODER_FLAG_AXIS_CLAMP },
+  //{ INPUT_PIN, { .pin = {7, 0, ENC_B, 0} }, FOUR3 },
 
   // Direct pin buttons (LOW = pressed due to INPUT_PULLUP). Joystick IDs are 1-based.
   //{ INPUT_PIN, { .pin = {6, 1, ENC_A, 0} }, FOUR3 },
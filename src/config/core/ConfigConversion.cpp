@@ -26,63 +26,6 @@ bool packPinMap(const PinMapEntry* runtimeMap, uint8_t count, StoredPinMapEntry*
     return true;
 }
 
-bool unpackPinMap(const StoredPinMapEntry* storedMap, uint8_t count, PinMapEntry* runtimeMap) {
-    if (!storedMap || !runtimeMap || count == 0) {
-        return false;
-    }
-    
-    for (uint8_t i = 0; i < count; i++) {
-        // Note: This creates a potential issue as runtimeMap expects const char* 
-        // but we're copying from stored format. In practice, you'd need a static
-        // string pool or dynamic allocation here.
-        runtimeMap[i].name = storedMap[i].name; // This is problematic - needs better solution
-        runtimeMap[i].type = (PinType)storedMap[i].type;
-    }
-    
-    return true;
-}
-
-bool packLogicalInputs(const LogicalInput* runtimeInputs, uint8_t count, StoredLogicalInput* storedInputs) {
-    if (!runtimeInputs || !storedInputs || count == 0) {
-        return false;
-    }
-    
-    for (uint8_t i = 0; i < count; i++) {
-        storedInputs[i].type = (uint8_t)runtimeInputs[i].type;
-        storedInputs[i].encoderLatchMode = (uint8_t)runtimeInputs[i].encoderLatchMode;
-        
-        switch (runtimeInputs[i].type) {
-            case INPUT_PIN:
-                storedInputs[i].behavior = (uint8_t)runtimeInputs[i].u.pin.behavior;
-                storedInputs[i].joyButtonID = runtimeInputs[i].u.pin.joyButtonID;
-                storedInputs[i].reverse = runtimeInputs[i].u.pin.reverse;
-                storedInputs[i].data.pin.pin = runtimeInputs[i].u.pin.pin;
-                break;
-                
-            case INPUT_MATRIX:
-                storedInputs[i].behavior = (uint8_t)runtimeInputs[i].u.matrix.behavior;
-                storedInputs[i].joyButtonID = runtimeInputs[i].u.matrix.joyButtonID;
-                storedInputs[i].reverse = runtimeInputs[i].u.matrix.reverse;
-                storedInputs[i].data.matrix.row = runtimeInputs[i].u.matrix.row;
-                storedInputs[i].data.matrix.col = runtimeInputs[i].u.matrix.col;
-                break;
-                
-            case INPUT_SHIFTREG:
-                storedInputs[i].behavior = (uint8_t)runtimeInputs[i].u.shiftreg.behavior;
-                storedInputs[i].joyButtonID = runtimeInputs[i].u.shiftreg.joyButtonID;
-                storedInputs[i].reverse = runtimeInputs[i].u.shiftreg.reverse;
-                storedInputs[i].data.shiftreg.regIndex = runtimeInputs[i].u.shiftreg.regIndex;
-                storedInputs[i].data.shiftreg.bitIndex = runtimeInputs[i].u.shiftreg.bitIndex;
-                break;
-        }
-        
-        // Clear reserved fields
-        memset(storedInputs[i].reserved, 0, sizeof(storedInputs[i].reserved));
-    }
-    
-    return true;
-}
-
 bool unpackLogicalInputs(const StoredLogicalInput* storedInputs, uint8_t count, LogicalInput* runtimeInputs) {
     if (!storedInputs || !runtimeInputs || count == 0) {
         return false;
@@ -91,6 +34,9 @@ bool unpackLogicalInputs(const StoredLogicalInput* storedInputs, uint8_t count,
     for (uint8_t i = 0; i < count; i++) {
         runtimeInputs[i].type = (InputType)storedInputs[i].type;
         runtimeInputs[i].encoderLatchMode = (LatchMode)storedInputs[i].encoderLatchMode;
+        runtimeInputs[i].encoderPressMs = storedInputs[i].encoderPressMs;
+        runtimeInputs[i].encoderReleaseMs = storedInputs[i].encoderReleaseMs;
+        runtimeInputs[i].encoderFlags = storedInputs[i].encoderFlags;
         
         switch (runtimeInputs[i].type) {
             case INPUT_PIN:
@@ -121,14 +67,11 @@ bool unpackLogicalInputs(const StoredLogicalInput* storedInputs, uint8_t count,
     return true;
 }
 
-uint32_t calculateChecksum(const StoredConfig* config, const uint8_t* variableData, size_t variableSize) {
-    if (!config) {
-        return 0;
-    }
-    
+// CRC32 over the header without its checksum field, the rest of the fixed part (fixedSize bytes
+// in the image's layout) and the variable data
+static uint32_t imageChecksum(const uint8_t* data, size_t fixedSize, const uint8_t* variableData, size_t variableSize) {
     // Simple CRC32-like checksum (not cryptographically secure)
     uint32_t checksum = 0xFFFFFFFF;
-    const uint8_t* data = reinterpret_cast<const uint8_t*>(config);
     
     // Skip the checksum field itself
     size_t headerSize = offsetof(ConfigHeader, checksum);
@@ -142,8 +85,8 @@ uint32_t calculateChecksum(const StoredConfig* config, const uint8_t* variableDa
     }
     
     // Skip checksum field and continue with rest of header
-    size_t remainingHeaderSize = sizeof(ConfigHeader) - headerSize - sizeof(config->header.checksum);
-    const uint8_t* afterChecksum = data + headerSize + sizeof(config->header.checksum);
+    size_t remainingHeaderSize = sizeof(ConfigHeader) - headerSize - sizeof(uint32_t);
+    const uint8_t* afterChecksum = data + headerSize + sizeof(uint32_t);
     
     for (size_t i = 0; i < remainingHeaderSize; i++) {
         checksum ^= afterChecksum[i];
@@ -154,7 +97,7 @@ uint32_t calculateChecksum(const StoredConfig* config, const uint8_t* variableDa
     
     // Checksum the rest of the config structure
     const uint8_t* configData = data + sizeof(ConfigHeader);
-    size_t configDataSize = sizeof(StoredConfig) - sizeof(ConfigHeader);
+    size_t configDataSize = fixedSize - sizeof(ConfigHeader);
     
     for (size_t i = 0; i < configDataSize; i++) {
         checksum ^= configData[i];
@@ -176,7 +119,26 @@ uint32_t calculateChecksum(const StoredConfig* config, const uint8_t* variableDa
     return ~checksum;
 }
 
-bool validateStoredConfig(const StoredConfig* config, size_t totalSize) {
+uint32_t calculateChecksum(const StoredConfig* config, const uint8_t* variableData, size_t variableSize) {
+    if (!config) {
+        return 0;
+    }
+    return imageChecksum(reinterpret_cast<const uint8_t*>(config), sizeof(StoredConfig), variableData, variableSize);
+}
+
+size_t curveSectionSize(const uint8_t* curveData, uint8_t curveCount, size_t maxSize) {
+    size_t offset = 0;
+    for (uint8_t i = 0; i < curveCount; i++) {
+        if (offset + sizeof(StoredCurveHeader) > maxSize) return 0;
+        const StoredCurveHeader* header = reinterpret_cast<const StoredCurveHeader*>(curveData + offset);
+        if (header->axis >= 8 || header->pointCount < 2 || header->pointCount > MAX_CURVE_POINTS) return 0;
+        offset += sizeof(StoredCurveHeader) + header->pointCount * sizeof(StoredCurvePoint);
+        if (offset > maxSize) return 0;
+    }
+    return offset;
+}
+
+bool validateStoredConfig(const StoredConfig* config, size_t totalSize, bool verifyChecksum) {
     if (!config || totalSize < sizeof(StoredConfig)) {
         return false;
     }
@@ -186,9 +148,9 @@ bool validateStoredConfig(const StoredConfig* config, size_t totalSize) {
         return false;
     }
     
-    // Check version compatibility
-    if (config->header.version > CONFIG_VERSION) {
-        return false; // Future version, can't handle
+    // Check version: versions 7-9 are converted by upgradeStoredConfig at load, others are unknown
+    if (config->header.version != CONFIG_VERSION) {
+        return false;
     }
     
     // Check size consistency
@@ -199,26 +161,113 @@ bool validateStoredConfig(const StoredConfig* config, size_t totalSize) {
     // Check bounds
     if (config->pinMapCount > MAX_PIN_MAP_ENTRIES ||
         config->logicalInputCount > MAX_LOGICAL_INPUTS ||
-        config->shiftRegCount > MAX_SHIFT_REGISTERS) {
+        config->shiftRegCount > MAX_SHIFT_REGISTERS ||
+        config->curveCount > 8) {
         return false;
     }
     
-    // Calculate expected variable data size
-    size_t expectedVariableSize = config->pinMapCount * sizeof(StoredPinMapEntry) +
-                                  config->logicalInputCount * sizeof(StoredLogicalInput);
-    
-    if (totalSize != sizeof(StoredConfig) + expectedVariableSize) {
+    // Tables end where the curve section starts; curves run to the end of the image
+    size_t curvesOffset = configImageCurvesOffset(*config);
+    if (totalSize < curvesOffset) {
+        return false;
+    }
+    size_t curveSize = 0;
+    if (config->curveCount) {
+        const uint8_t* curveData = reinterpret_cast<const uint8_t*>(config) + curvesOffset;
+        curveSize = curveSectionSize(curveData, config->curveCount, totalSize - curvesOffset);
+        if (curveSize == 0) {
+            return false;
+        }
+    }
+    if (totalSize != curvesOffset + curveSize) {
         return false;
     }
     
     // Verify checksum
-    const uint8_t* variableData = reinterpret_cast<const uint8_t*>(config) + sizeof(StoredConfig);
-    uint32_t calculatedChecksum = calculateChecksum(config, variableData, expectedVariableSize);
+    if (verifyChecksum) {
+        const uint8_t* variableData = reinterpret_cast<const uint8_t*>(config) + sizeof(StoredConfig);
+        if (calculateChecksum(config, variableData, totalSize - sizeof(StoredConfig)) != config->header.checksum) {
+            return false;
+        }
+    }
     
-    if (calculatedChecksum != config->header.checksum) {
+    return true;
+}
+
+// Axis entries before version 9 are 15 bytes: the fields up to adcOversample and one padding
+// byte (adcRate/adcOversample were padding in version 7 too, written as 0). The adaptive filter
+// parameters did not exist yet.
+static constexpr size_t STORED_AXIS_CONFIG_SIZE_V8 = 15;
+static constexpr size_t STORED_AXIS_SHARED_FIELDS = offsetof(StoredAxisConfig, minCutoff);
+static_assert(STORED_AXIS_SHARED_FIELDS == STORED_AXIS_CONFIG_SIZE_V8 - 1, "version 8 axis entries end with one padding byte");
+
+bool upgradeStoredConfig(const uint8_t* image, size_t size, uint8_t* out, size_t outSize, size_t* outLength) {
+    const StoredConfig* config = reinterpret_cast<const StoredConfig*>(image);
+    if (!image || !out || size < sizeof(ConfigHeader) || config->header.magic != CONFIG_MAGIC ||
+        config->header.version < 7 || config->header.version >= CONFIG_VERSION || config->header.size != size) {
         return false;
     }
     
+    // Versions 7-9: the fixed part holds 8 axis entries (15 bytes up to version 8, 20 from
+    // version 9), then the tables packed back to back with StoredLogicalInput entries. Version 7
+    // has no curve section; curveCount was a padding byte that was never initialized.
+    const size_t axisSize = config->header.version >= 9 ? sizeof(StoredAxisConfig) : STORED_AXIS_CONFIG_SIZE_V8;
+    const size_t fixedSize = offsetof(StoredConfig, axes) + 8 * axisSize;
+    if (size < fixedSize) {
+        return false;
+    }
+    const uint8_t curveCount = config->header.version >= 8 ? config->curveCount : 0;
+    if (config->pinMapCount > MAX_PIN_MAP_ENTRIES ||
+        config->logicalInputCount > MAX_LOGICAL_INPUTS ||
+        config->shiftRegCount > MAX_SHIFT_REGISTERS ||
+        curveCount > 8) {
+        return false;
+    }
+    
+    const uint8_t* variableData = image + fixedSize;
+    size_t pinMapSize = config->pinMapCount * sizeof(StoredPinMapEntry);
+    size_t inputsSize = config->logicalInputCount * sizeof(StoredLogicalInput);
+    if (size < fixedSize + pinMapSize + inputsSize) {
+        return false;
+    }
+    size_t curveSize = 0;
+    if (curveCount) {
+        curveSize = curveSectionSize(variableData + pinMapSize + inputsSize, curveCount,
+                                     size - fixedSize - pinMapSize - inputsSize);
+        if (curveSize == 0) {
+            return false;
+        }
+    }
+    if (size != fixedSize + pinMapSize + inputsSize + curveSize ||
+        imageChecksum(image, fixedSize, variableData, size - fixedSize) != config->header.checksum) {
+        return false;
+    }
+    
+    // The counts sit at the same offsets in every layout, so the new table offsets follow from them
+    size_t curvesOffset = configImageCurvesOffset(*config);
+    if (curvesOffset + curveSize > outSize) {
+        return false;
+    }
+    memset(out, 0, curvesOffset);
+    memcpy(out, image, offsetof(StoredConfig, axes));
+    StoredConfig* upgraded = reinterpret_cast<StoredConfig*>(out);
+    upgraded->curveCount = curveCount;
+    for (uint8_t i = 0; i < 8; i++) {
+        // Fields an older entry lacks stay 0 (firmware default)
+        memcpy(out + offsetof(StoredConfig, axes) + i * sizeof(StoredAxisConfig),
+               image + offsetof(StoredConfig, axes) + i * axisSize,
+               axisSize == sizeof(StoredAxisConfig) ? axisSize : STORED_AXIS_SHARED_FIELDS);
+    }
+    memcpy(out + configImagePinMapOffset(*config), variableData, pinMapSize);
+    unpackLogicalInputs(reinterpret_cast<const StoredLogicalInput*>(variableData + pinMapSize),
+                        config->logicalInputCount,
+                        reinterpret_cast<LogicalInput*>(out + configImageLogicalInputsOffset(*config)));
+    memcpy(out + curvesOffset, variableData + pinMapSize + inputsSize, curveSize);
+    
+    upgraded->header.version = CONFIG_VERSION;
+    upgraded->header.size = (uint16_t)(curvesOffset + curveSize);
+    upgraded->header.checksum = calculateChecksum(upgraded, out + sizeof(StoredConfig), curvesOffset + curveSize - sizeof(StoredConfig));
+    *outLength = curvesOffset + curveSize;
     return true;
 }
 
@@ -10,18 +10,22 @@
 ConfigManager g_configManager;
 
 ConfigManager::ConfigManager() 
-    : m_currentPinMapCount(0)
-    , m_currentLogicalInputCount(0) 
-    , m_currentShiftRegCount(0)
+    : m_image(m_imageBuffer)
+    , m_imageSize(sizeof(StoredConfig))
+    , m_imageInFlash(false)
     , m_initialized(false)
     , m_configLoaded(false)
     , m_usingDefaults(false)
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    , m_lastJobId(0)
+    , m_runJobId(1)
+#endif
 {
-    memset(m_currentPinMap, 0, sizeof(m_currentPinMap));
-    memset(m_pinNamePool, 0, sizeof(m_pinNamePool));
-    memset(m_currentLogicalInputs, 0, sizeof(m_currentLogicalInputs));
-    memset(m_currentAxisConfigs, 0, sizeof(m_currentAxisConfigs));
-    memset(&m_currentUSBDescriptor, 0, sizeof(m_currentUSBDescriptor));
+    // Empty image (no tables, all axes off) until a configuration is loaded
+    memset(m_imageBuffer, 0, sizeof(m_imageBuffer));
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    memset(m_jobs, 0, sizeof(m_jobs));
+#endif
 }
 
 ConfigManager::~ConfigManager() {
@@ -68,10 +72,7 @@ bool ConfigManager::loadConfiguration() {
         if (loadFromStorage()) return true;
     }
     Serial.println("WARN: No valid config found, generating defaults");
-    generateDefaultPinMap();
-    generateDefaultLogicalInputs();
-    generateDefaultAxisConfigs();
-    generateDefaultUSBDescriptor();
+    generateDefaultImage(false);
     m_configLoaded = true;
     m_usingDefaults = true;
     saveToStorage();
@@ -84,21 +85,18 @@ bool ConfigManager::loadConfiguration() {
 #if CONFIG_FEATURE_STORAGE_ENABLED
 
 bool ConfigManager::loadFromStorage() {
-    uint8_t buffer[2048]; // Buffer for configuration data
-    size_t bytesRead;
+    size_t size = 0;
     
     DEBUG_PRINTLN("DEBUG: loadFromStorage() called");
     
-    StorageResult result = m_storage.read(CONFIG_STORAGE_FILENAME, buffer, sizeof(buffer), &bytesRead);
-    DEBUG_PRINT("DEBUG: Read result for "); DEBUG_PRINT(CONFIG_STORAGE_FILENAME); DEBUG_PRINT(": "); DEBUG_PRINTLN((int)result);
+    // The image is used where it is stored; nothing is copied out of flash
+    const uint8_t* stored = m_storage.mapFile(CONFIG_STORAGE_FILENAME, &size);
+    DEBUG_PRINT("DEBUG: Mapped "); DEBUG_PRINT(CONFIG_STORAGE_FILENAME); DEBUG_PRINT(": "); DEBUG_PRINTLN(size);
     
-    if (result == StorageResult::ERROR_FILE_NOT_FOUND) {
+    if (!stored) {
     DEBUG_PRINTLN("DEBUG: Config file not found, generating defaults and saving...");
         // No configuration file exists, generate defaults
-        generateDefaultPinMap();
-        generateDefaultLogicalInputs();
-        generateDefaultAxisConfigs();
-        generateDefaultUSBDescriptor();
+        generateDefaultImage(false);
         m_configLoaded = true;
         m_usingDefaults = true;
         
@@ -114,33 +112,35 @@ bool ConfigManager::loadFromStorage() {
         return true;
     }
     
-    if (result != StorageResult::SUCCESS) {
-    DEBUG_PRINT("DEBUG: Failed to read config, error: "); DEBUG_PRINTLN((int)result);
-        return false; // Higher-level will attempt fallback chain
-    }
-    
-    // Validate and parse stored configuration
-    if (bytesRead < sizeof(StoredConfig)) {
-        return false;
+    const StoredConfig* storedConfig = reinterpret_cast<const StoredConfig*>(stored);
+    if (size >= sizeof(ConfigHeader) && storedConfig->header.version < CONFIG_VERSION) {
+        // Older layout: converted once in RAM, then stored in the current one
+    DEBUG_PRINT("DEBUG: Upgrading stored config from version "); DEBUG_PRINTLN(storedConfig->header.version);
+        size_t upgradedSize = 0;
+        if (!ConfigConversion::upgradeStoredConfig(stored, size, m_imageBuffer, sizeof(m_imageBuffer), &upgradedSize)) {
+            return false; // Trigger fallback chain
+        }
+        bindImage(m_imageBuffer, upgradedSize, false);
+        m_configLoaded = true;
+        m_usingDefaults = false;
+        saveToStorage();
+        notifyConfigurationChanged();
+        return true;
     }
     
-    const StoredConfig* storedConfig = reinterpret_cast<const StoredConfig*>(buffer);
-    const uint8_t* variableData = buffer + sizeof(StoredConfig);
-    size_t variableSize = bytesRead - sizeof(StoredConfig);
-    
-    if (!ConfigConversion::validateStoredConfig(storedConfig, bytesRead)) {
+    // The storage log checked the record CRC when it mounted, so only the structure is checked:
+    // load time does not depend on the config size
+    if (!ConfigConversion::validateStoredConfig(storedConfig, size, false)) {
     DEBUG_PRINTLN("DEBUG: Stored config failed validation (possibly corrupt)");
         return false; // Trigger fallback chain
     }
 
-    bool ok = convertStoredToRuntime(storedConfig, variableData, variableSize);
-    if(!ok) {
-    DEBUG_PRINTLN("DEBUG: convertStoredToRuntime failed");
-    } else {
-        // Configuration successfully loaded from storage
-        notifyConfigurationChanged();
-    }
-    return ok;
+    bindImage(stored, size, true);
+    m_configLoaded = true;
+    m_usingDefaults = false;
+    // Configuration successfully loaded from storage
+    notifyConfigurationChanged();
+    return true;
 }
 
 bool ConfigManager::saveToStorage() {
@@ -149,50 +149,185 @@ bool ConfigManager::saveToStorage() {
         return false;
     }
     
-    uint8_t buffer[2048];
-    size_t totalSize = 0;
-    
-    if (!getSerializedConfig(buffer, sizeof(buffer), &totalSize)) {
-        Serial.println("DEBUG: saveToStorage - getSerializedConfig failed");
-        return false;
-    }
-    
-    DEBUG_PRINT("DEBUG: saveToStorage - about to write "); DEBUG_PRINT(totalSize); DEBUG_PRINTLN(" bytes");
+    DEBUG_PRINT("DEBUG: saveToStorage - about to write "); DEBUG_PRINT(m_imageSize); DEBUG_PRINTLN(" bytes");
     
-    // Create backup before saving
-    createBackup();
-    
-    StorageResult result = m_storage.write(CONFIG_STORAGE_FILENAME, buffer, totalSize);
+    // The active image is already in stored form; saving one that was read from the log finds it
+    // unchanged and costs no flash operation. The storage log keeps the previous version as the backup.
+    StorageResult result = m_storage.write(CONFIG_STORAGE_FILENAME, m_image, m_imageSize);
     DEBUG_PRINT("DEBUG: saveToStorage - write result: "); DEBUG_PRINTLN((int)result);
+    rebindStoredImage();
     
     return result == StorageResult::SUCCESS;
 }
 
-bool ConfigManager::createBackup() {
-    // Copy current config file to backup
-    uint8_t buffer[2048];
-    size_t bytesRead;
-    
-    StorageResult result = m_storage.read(CONFIG_STORAGE_FILENAME, buffer, sizeof(buffer), &bytesRead);
-    if (result != StorageResult::SUCCESS) {
-        return false; // No existing config to backup
+bool ConfigManager::restoreFromBackup() {
+    size_t size = 0;
+    const uint8_t* backup = m_storage.mapFile(CONFIG_STORAGE_BACKUP_FILENAME, &size);
+    if (!backup || size > sizeof(m_imageBuffer)) {
+        return false;
     }
     
-    result = m_storage.write(CONFIG_STORAGE_BACKUP_FILENAME, buffer, bytesRead);
+    // Staged in RAM: writing may relocate the backup record it would be read from
+    memcpy(m_imageBuffer, backup, size);
+    bindImage(m_imageBuffer, size, false);
+    StorageResult result = m_storage.write(CONFIG_STORAGE_FILENAME, m_imageBuffer, size);
     return result == StorageResult::SUCCESS;
 }
 
-bool ConfigManager::restoreFromBackup() {
-    uint8_t buffer[2048];
-    size_t bytesRead;
-    
-    StorageResult result = m_storage.read(CONFIG_STORAGE_BACKUP_FILENAME, buffer, sizeof(buffer), &bytesRead);
-    if (result != StorageResult::SUCCESS) {
+void ConfigManager::bindImage(const uint8_t* image, size_t size, bool inFlash) {
+    m_image = image;
+    m_imageSize = size;
+    m_imageInFlash = inFlash;
+}
+
+void ConfigManager::rebindStoredImage() {
+    size_t size = 0;
+    const uint8_t* stored = m_storage.mapFile(CONFIG_STORAGE_FILENAME, &size);
+    if (m_imageInFlash) {
+        // Same content, possibly relocated by the log; the file is only written from the image
+        if (stored && size == m_imageSize) {
+            m_image = stored;
+        }
+    } else if (stored && size == m_imageSize && memcmp(stored, m_imageBuffer, size) == 0) {
+        // The buffer was saved: use the stored copy and free the buffer
+        bindImage(stored, size, true);
+    }
+}
+
+bool ConfigManager::formatStorage() {
+    if (m_imageInFlash) {
+        // Keep running on the active configuration; the next save stores it again
+        memcpy(m_imageBuffer, m_image, m_imageSize);
+        bindImage(m_imageBuffer, m_imageSize, false);
+    }
+    return m_storage.format() == StorageResult::SUCCESS;
+}
+
+StorageResult ConfigManager::writeFile(const char* filename, const uint8_t* data, size_t dataSize) {
+    if (filename && strcmp(filename, CONFIG_STORAGE_FILENAME) == 0) {
+        return StorageResult::ERROR_INVALID_PARAMETER;
+    }
+    StorageResult result = m_storage.write(filename, data, dataSize);
+    rebindStoredImage();
+    return result;
+}
+
+static uint16_t nextStorageJobId(uint16_t id) {
+    return (id == 0xFFFF) ? 1 : (uint16_t)(id + 1);  // 0 means "none"
+}
+
+ConfigManager::StorageJob* ConfigManager::newStorageJob() {
+    const uint16_t id = nextStorageJobId(m_lastJobId);
+    StorageJob& job = m_jobs[id % STORAGE_JOB_SLOTS];
+    if (job.status.state == StorageJobState::QUEUED || job.status.state == StorageJobState::RUNNING) {
+        return nullptr;
+    }
+    memset(&job, 0, sizeof(job));
+    job.status.id = id;
+    job.status.state = StorageJobState::QUEUED;
+    job.queuedMs = millis();
+    m_lastJobId = id;
+    return &job;
+}
+
+uint16_t ConfigManager::queueSaveConfiguration() {
+    if (!m_initialized || !m_configLoaded) {
+        return 0;
+    }
+    // Serialized when the job starts, so a save still waiting covers this one too
+    if (m_lastJobId != 0) {
+        const StorageJob& last = m_jobs[m_lastJobId % STORAGE_JOB_SLOTS];
+        if (last.saveConfig && last.status.state == StorageJobState::QUEUED) {
+            return m_lastJobId;
+        }
+    }
+    StorageJob* job = newStorageJob();
+    if (!job) {
+        return 0;
+    }
+    job->saveConfig = true;
+    return job->status.id;
+}
+
+uint16_t ConfigManager::queueResetToDefaults() {
+    if (!m_initialized) {
+        return 0;
+    }
+    // Check for room first: the defaults replace the running config right away
+    const uint16_t id = nextStorageJobId(m_lastJobId);
+    const StorageJobState slot = m_jobs[id % STORAGE_JOB_SLOTS].status.state;
+    if (slot == StorageJobState::QUEUED || slot == StorageJobState::RUNNING || imageBufferBusy()) {
+        return 0;
+    }
+    generateDefaultImage(true);
+    m_configLoaded = true;
+    m_usingDefaults = true;
+    notifyConfigurationChanged();
+    return queueSaveConfiguration();
+}
+
+uint16_t ConfigManager::queueWriteFile(const char* filename, const uint8_t* data, size_t dataSize) {
+    if (!filename || strlen(filename) >= sizeof(StorageJob::filename) || !data || dataSize == 0 ||
+        dataSize > STORAGE_JOB_INLINE_DATA || strcmp(filename, CONFIG_STORAGE_FILENAME) == 0) {
+        return 0;
+    }
+    StorageJob* job = newStorageJob();
+    if (!job) {
+        return 0;
+    }
+    strcpy(job->filename, filename);
+    memcpy(job->data, data, dataSize);
+    job->status.bytes = (uint16_t)dataSize;
+    return job->status.id;
+}
+
+void ConfigManager::serviceStorageJob() {
+    if (m_lastJobId == 0 || m_runJobId == nextStorageJobId(m_lastJobId)) {
+        return; // nothing queued
+    }
+    StorageJob& job = m_jobs[m_runJobId % STORAGE_JOB_SLOTS];
+    StorageResult result = StorageResult::SUCCESS;
+    if (job.status.state == StorageJobState::QUEUED && job.saveConfig) {
+        // The image as it is when the save starts, so a save still waiting covers later changes
+        job.status.bytes = (uint16_t)m_imageSize;
+    }
+    job.status.state = StorageJobState::RUNNING;
+    job.status.steps++;
+    // A save writes the active image straight from where it is: unchanged if it is in flash
+    // already, otherwise m_imageBuffer, which stays untouched until the save finishes
+    bool finished = job.saveConfig
+        ? m_storage.writeStep(CONFIG_STORAGE_FILENAME, m_image, m_imageSize, &result)
+        : m_storage.writeStep(job.filename, job.data, job.status.bytes, &result);
+    rebindStoredImage();
+    if (finished) {
+        job.status.result = result;
+        job.status.state = (result == StorageResult::SUCCESS) ? StorageJobState::DONE : StorageJobState::FAILED;
+        job.status.elapsedMs = millis() - job.queuedMs;
+        m_runJobId = nextStorageJobId(m_runJobId);
+    }
+}
+
+bool ConfigManager::imageBufferBusy() const {
+    if (m_imageInFlash || m_lastJobId == 0 || m_runJobId == nextStorageJobId(m_lastJobId)) {
         return false;
     }
-    
-    result = m_storage.write(CONFIG_STORAGE_FILENAME, buffer, bytesRead);
-    return result == StorageResult::SUCCESS;
+    const StorageJob& job = m_jobs[m_runJobId % STORAGE_JOB_SLOTS];
+    return job.saveConfig && job.status.state == StorageJobState::RUNNING;
+}
+
+bool ConfigManager::getStorageJobStatus(uint16_t id, StorageJobStatus& status) const {
+    if (id == 0) {
+        id = m_lastJobId;
+    }
+    const StorageJob& job = m_jobs[id % STORAGE_JOB_SLOTS];
+    if (id == 0 || job.status.id != id) {
+        return false;
+    }
+    status = job.status;
+    if (status.state == StorageJobState::QUEUED || status.state == StorageJobState::RUNNING) {
+        status.elapsedMs = millis() - job.queuedMs;
+    }
+    return true;
 }
 
 #endif // CONFIG_FEATURE_STORAGE_ENABLED
@@ -206,9 +341,12 @@ bool ConfigManager::saveConfiguration() {
 }
 
 bool ConfigManager::resetToDefaults() {
-    generateDefaultPinMap();
-    generateDefaultLogicalInputs();
-    generateDefaultAxisConfigs();
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    if (imageBufferBusy()) {
+        return false;
+    }
+#endif
+    generateDefaultImage(true);
     
     m_configLoaded = true;
     m_usingDefaults = true;
@@ -263,201 +401,134 @@ ConfigValidationResult ConfigManager::validateConfiguration(const StoredConfig*
 }
 
 const StoredAxisConfig* ConfigManager::getAxisConfig(uint8_t axisIndex) const {
-    if (axisIndex >= 8 || !m_currentAxisConfigs[axisIndex].enabled) {
+    if (axisIndex >= 8 || !image()->axes[axisIndex].enabled) {
         return nullptr;
     }
-    return &m_currentAxisConfigs[axisIndex];
+    return &image()->axes[axisIndex];
+}
+
+const StoredCurveHeader* ConfigManager::getAxisCurve(uint8_t axisIndex, const StoredCurvePoint** points) const {
+    const uint8_t* curveData = m_image + configImageCurvesOffset(*image());
+    size_t offset = 0;
+    for (uint8_t i = 0; i < image()->curveCount; i++) {
+        const StoredCurveHeader* header = reinterpret_cast<const StoredCurveHeader*>(curveData + offset);
+        offset += sizeof(StoredCurveHeader);
+        if (header->axis == axisIndex) {
+            if (points) *points = reinterpret_cast<const StoredCurvePoint*>(curveData + offset);
+            return header;
+        }
+        offset += header->pointCount * sizeof(StoredCurvePoint);
+    }
+    return nullptr;
 }
 
 bool ConfigManager::isAxisEnabled(uint8_t axisIndex) const {
-    return axisIndex < 8 && m_currentAxisConfigs[axisIndex].enabled;
+    return axisIndex < 8 && image()->axes[axisIndex].enabled;
 }
 
 bool ConfigManager::applyConfiguration(const StoredConfig* config, const uint8_t* variableData, size_t variableSize) {
-    if (!ConfigConversion::validateStoredConfig(config, sizeof(StoredConfig) + variableSize)) {
+    size_t totalSize = sizeof(StoredConfig) + variableSize;
+    if (!ConfigConversion::validateStoredConfig(config, totalSize) || totalSize > sizeof(m_imageBuffer)) {
+        return false;
+    }
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    if (imageBufferBusy()) {
         return false;
     }
+#endif
     
-    return convertStoredToRuntime(config, variableData, variableSize);
+    // Becomes the active image as is; saveConfiguration stores it
+    memmove(m_imageBuffer, config, sizeof(StoredConfig));
+    memmove(m_imageBuffer + sizeof(StoredConfig), variableData, variableSize);
+    bindImage(m_imageBuffer, totalSize, false);
+    m_configLoaded = true;
+    m_usingDefaults = false;
+    return true;
 }
 
 bool ConfigManager::getSerializedConfig(uint8_t* buffer, size_t bufferSize, size_t* actualSize) const {
-    if (!buffer || bufferSize < sizeof(StoredConfig)) {
+    // The active image is the serialized form
+    if (!buffer || bufferSize < m_imageSize) {
         DEBUG_PRINTLN("DEBUG: getSerializedConfig - buffer too small");
         return false;
     }
-    
-    DEBUG_PRINT("DEBUG: getSerializedConfig - buffer size: "); DEBUG_PRINTLN(bufferSize);
-    DEBUG_PRINT("DEBUG: StoredConfig size: "); DEBUG_PRINTLN(sizeof(StoredConfig));
-    
-    StoredConfig* config = reinterpret_cast<StoredConfig*>(buffer);
-    uint8_t* variableData = buffer + sizeof(StoredConfig);
-    size_t maxVariableSize = bufferSize - sizeof(StoredConfig);
-    size_t variableSize;
-    
-    DEBUG_PRINT("DEBUG: Max variable size: "); DEBUG_PRINTLN(maxVariableSize);
-    
-    if (!convertRuntimeToStored(config, variableData, &variableSize, maxVariableSize)) {
-    DEBUG_PRINTLN("DEBUG: convertRuntimeToStored failed");
-        return false;
-    }
-    
-    DEBUG_PRINT("DEBUG: Variable size: "); DEBUG_PRINTLN(variableSize);
-    DEBUG_PRINT("DEBUG: Total size: "); DEBUG_PRINTLN(sizeof(StoredConfig) + variableSize);
-    
+    memcpy(buffer, m_image, m_imageSize);
     if (actualSize) {
-        *actualSize = sizeof(StoredConfig) + variableSize;
+        *actualSize = m_imageSize;
     }
-    
     return true;
 }
 
-bool ConfigManager::convertStoredToRuntime(const StoredConfig* config, const uint8_t* variableData, size_t variableSize) {
-    // Extract pin map
-    const StoredPinMapEntry* storedPinMap = reinterpret_cast<const StoredPinMapEntry*>(variableData);
-    m_currentPinMapCount = min(config->pinMapCount, (uint8_t)MAX_PIN_MAP_ENTRIES);
-    for(uint8_t i=0;i<m_currentPinMapCount;i++) {
-        // Copy name into stable pool then point runtime entry to it
-        strncpy(m_pinNamePool[i], storedPinMap[i].name, sizeof(m_pinNamePool[i]) - 1);
-        m_pinNamePool[i][sizeof(m_pinNamePool[i]) - 1] = '\0';
-        m_currentPinMap[i].name = m_pinNamePool[i];
-        m_currentPinMap[i].type = (PinType)storedPinMap[i].type;
-    }
-    
-    // Extract logical inputs
-    const StoredLogicalInput* storedInputs = reinterpret_cast<const StoredLogicalInput*>(
-        variableData + config->pinMapCount * sizeof(StoredPinMapEntry));
-    if (!ConfigConversion::unpackLogicalInputs(storedInputs, config->logicalInputCount, m_currentLogicalInputs)) {
-        return false;
-    }
-    m_currentLogicalInputCount = config->logicalInputCount;
-    
-    // Copy axis configurations
-    memcpy(m_currentAxisConfigs, config->axes, sizeof(config->axes));
-    
-    // Copy USB descriptor
-    memcpy(&m_currentUSBDescriptor, &config->usbDescriptor, sizeof(config->usbDescriptor));
-    
-    m_currentShiftRegCount = config->shiftRegCount;
-    m_configLoaded = true;
-    m_usingDefaults = false;
-    
-    return true;
-}
-
-bool ConfigManager::convertRuntimeToStored(StoredConfig* config, uint8_t* variableData, size_t* variableSize, size_t maxVariableSize) const {
-    if (!config || !variableData || !variableSize) {
-        return false;
+void ConfigManager::generateDefaultImage(bool keepUSBDescriptor) {
+    // Read before the buffer is cleared: the current image may be in it
+    StoredUSBDescriptor usbDescriptor;
+    if (keepUSBDescriptor) {
+        memcpy(&usbDescriptor, &image()->usbDescriptor, sizeof(usbDescriptor));
+    } else {
+        generateDefaultUSBDescriptor(&usbDescriptor);
     }
     
-    // Initialize header
+    memset(m_imageBuffer, 0, sizeof(m_imageBuffer));
+    StoredConfig* config = reinterpret_cast<StoredConfig*>(m_imageBuffer);
     config->header.magic = CONFIG_MAGIC;
     config->header.version = CONFIG_VERSION;
-    config->header.size = sizeof(StoredConfig);
-    
-    // Set counts
-    config->pinMapCount = m_currentPinMapCount;
-    config->logicalInputCount = m_currentLogicalInputCount;
-    config->shiftRegCount = m_currentShiftRegCount;
-    
-    // Copy axis configurations
-    memcpy(config->axes, m_currentAxisConfigs, sizeof(config->axes));
-    
-    // Copy USB descriptor
-    memcpy(&config->usbDescriptor, &m_currentUSBDescriptor, sizeof(config->usbDescriptor));
-    
-    // Pack variable data
-    size_t offset = 0;
-    
-    // Pack pin map
-    StoredPinMapEntry* storedPinMap = reinterpret_cast<StoredPinMapEntry*>(variableData + offset);
-    if (!ConfigConversion::packPinMap(m_currentPinMap, m_currentPinMapCount, storedPinMap)) {
-        return false;
+    memcpy(&config->usbDescriptor, &usbDescriptor, sizeof(usbDescriptor));
+    generateDefaultAxisConfigs(config->axes);
+    
+    // Static hardwarePinMap / logicalInputs from ConfigDigital.h, up to the limits
+    config->pinMapCount = min((uint8_t)hardwarePinMapCount, (uint8_t)MAX_PIN_MAP_ENTRIES);
+    config->logicalInputCount = min((uint8_t)logicalInputCount, (uint8_t)MAX_LOGICAL_INPUTS);
+    if (config->pinMapCount) {
+        ConfigConversion::packPinMap(hardwarePinMap, config->pinMapCount,
+            reinterpret_cast<StoredPinMapEntry*>(m_imageBuffer + configImagePinMapOffset(*config)));
     }
-    offset += m_currentPinMapCount * sizeof(StoredPinMapEntry);
-    
-    // Pack logical inputs
-    StoredLogicalInput* storedInputs = reinterpret_cast<StoredLogicalInput*>(variableData + offset);
-    if (!ConfigConversion::packLogicalInputs(m_currentLogicalInputs, m_currentLogicalInputCount, storedInputs)) {
-        return false;
-    }
-    offset += m_currentLogicalInputCount * sizeof(StoredLogicalInput);
-    
-    *variableSize = offset;
-    config->header.size += offset;
-    
-    // Calculate checksum
-    config->header.checksum = ConfigConversion::calculateChecksum(config, variableData, *variableSize);
-    
-    return true;
+    memcpy(m_imageBuffer + configImageLogicalInputsOffset(*config), logicalInputs,
+           config->logicalInputCount * sizeof(LogicalInput));
+    // Linear response curves (no curve entries)
+    
+    size_t size = configImageCurvesOffset(*config);
+    config->header.size = (uint16_t)size;
+    config->header.checksum = ConfigConversion::calculateChecksum(config, m_imageBuffer + sizeof(StoredConfig),
+                                                                  size - sizeof(StoredConfig));
+    bindImage(m_imageBuffer, size, false);
 }
 
-void ConfigManager::generateDefaultPinMap() {
-    // Generate basic default pin map - this would typically match ConfigDigital.h defaults
-    m_currentPinMapCount = 0;
-    // Minimal sane defaults: copy any static hardwarePinMap entries up to limits
-    uint8_t copyCount = min((uint8_t)hardwarePinMapCount, (uint8_t)MAX_PIN_MAP_ENTRIES);
-    for(uint8_t i=0;i<copyCount;i++) {
-        strncpy(m_pinNamePool[i], hardwarePinMap[i].name, sizeof(m_pinNamePool[i]) - 1);
-        m_pinNamePool[i][sizeof(m_pinNamePool[i]) - 1] = '\0';
-        m_currentPinMap[i].name = m_pinNamePool[i];
-        m_currentPinMap[i].type = hardwarePinMap[i].type;
-        m_currentPinMapCount++;
-    }
-}
-
-void ConfigManager::generateDefaultLogicalInputs() {
-    // Mirror static logicalInputs[] from ConfigDigital.h exactly
-    m_currentLogicalInputCount = min((uint8_t)logicalInputCount, (uint8_t)MAX_LOGICAL_INPUTS);
-    for(uint8_t i=0;i<m_currentLogicalInputCount;i++) {
-        m_currentLogicalInputs[i] = logicalInputs[i]; // struct copy (includes union + encoderLatchMode)
-    }
-}
-
-void ConfigManager::generateDefaultAxisConfigs() {
+void ConfigManager::generateDefaultAxisConfigs(StoredAxisConfig* axes) const {
     // Start with all axes disabled
     for(uint8_t i=0;i<8;i++) {
-        m_currentAxisConfigs[i].enabled = 0;
-        m_currentAxisConfigs[i].pin = 0;
-        m_currentAxisConfigs[i].minValue = 0;
-        m_currentAxisConfigs[i].maxValue = 0;
-        m_currentAxisConfigs[i].filterLevel = 0;
-        m_currentAxisConfigs[i].ewmaAlpha = 0;
-        m_currentAxisConfigs[i].deadband = 0;
-        m_currentAxisConfigs[i].curve = 0;
-        memset(m_currentAxisConfigs[i].reserved, 0, sizeof(m_currentAxisConfigs[i].reserved));
+        memset(&axes[i], 0, sizeof(axes[i]));
+        axes[i].minCutoff = AXIS_ADAPTIVE_MIN_CUTOFF;
+        axes[i].beta = AXIS_ADAPTIVE_BETA;
+        axes[i].dCutoff = AXIS_ADAPTIVE_D_CUTOFF;
     }
 
     // Populate from axisDescriptors[] defined in ConfigAxis.h (reflecting user/static config)
     for (auto &d : axisDescriptors) {
         if (d.idx >= 8) continue; // safety
-        m_currentAxisConfigs[d.idx].enabled = 1;
-        m_currentAxisConfigs[d.idx].pin = (uint8_t)d.pin; // assumes pin fits in uint8_t for built-in / ADS proxy values
-        m_currentAxisConfigs[d.idx].minValue = (uint16_t)d.minv;
-        m_currentAxisConfigs[d.idx].maxValue = (uint16_t)d.maxv;
-        m_currentAxisConfigs[d.idx].filterLevel = (uint8_t)d.filter;
-        m_currentAxisConfigs[d.idx].ewmaAlpha = (uint16_t)d.alpha;
-        m_currentAxisConfigs[d.idx].deadband = (uint16_t)d.deadband;
-        m_currentAxisConfigs[d.idx].curve = (uint8_t)d.curve;
+        axes[d.idx].enabled = 1;
+        axes[d.idx].pin = (uint8_t)d.pin; // assumes pin fits in uint8_t for built-in / ADS proxy values
+        axes[d.idx].minValue = (uint16_t)d.minv;
+        axes[d.idx].maxValue = (uint16_t)d.maxv;
+        axes[d.idx].filterLevel = (uint8_t)d.filter;
+        axes[d.idx].ewmaAlpha = (uint16_t)d.alpha;
+        axes[d.idx].deadband = (uint16_t)d.deadband;
+        axes[d.idx].curve = (uint8_t)d.curve;
+        axes[d.idx].adcRate = (uint8_t)(d.adcRateHz / 100);
+        axes[d.idx].adcOversample = d.adcOversampleLog2;
     }
 }
 
-void ConfigManager::generateDefaultUSBDescriptor() {
+void ConfigManager::generateDefaultUSBDescriptor(StoredUSBDescriptor* descriptor) const {
     // Use the USB descriptor from static configuration (ConfigDigital.h)
     // This ensures consistent USB identity regardless of config mode
-    m_currentUSBDescriptor.vendorID = staticUSBDescriptor.vendorID;
-    m_currentUSBDescriptor.productID = staticUSBDescriptor.productID;
-    
-    strncpy(m_currentUSBDescriptor.manufacturer, staticUSBDescriptor.manufacturer, 
-            sizeof(m_currentUSBDescriptor.manufacturer) - 1);
-    m_currentUSBDescriptor.manufacturer[sizeof(m_currentUSBDescriptor.manufacturer) - 1] = '\0';
-    
-    strncpy(m_currentUSBDescriptor.product, staticUSBDescriptor.product,
-            sizeof(m_currentUSBDescriptor.product) - 1);
-    m_currentUSBDescriptor.product[sizeof(m_currentUSBDescriptor.product) - 1] = '\0';
-    
-    // Clear reserved bytes
-    memset(m_currentUSBDescriptor.reserved, 0, sizeof(m_currentUSBDescriptor.reserved));
+    memset(descriptor, 0, sizeof(*descriptor));
+    descriptor->vendorID = staticUSBDescriptor.vendorID;
+    descriptor->productID = staticUSBDescriptor.productID;
+    
+    strncpy(descriptor->manufacturer, staticUSBDescriptor.manufacturer, 
+            sizeof(descriptor->manufacturer) - 1);
+    strncpy(descriptor->product, staticUSBDescriptor.product,
+            sizeof(descriptor->product) - 1);
 }
 
 // Storage-enabled firmware version management and semantic version helpers
@@ -5,11 +5,32 @@
 
 #if CONFIG_FEATURE_STORAGE_ENABLED
     #include "../../StorageInterface.h"
-    #include "../../rp2040/storage/RP2040EEPROMStorage.h"
+    #include "../../rp2040/storage/RP2040FlashLogStorage.h"
 #endif
 
 #include <stdint.h>
 
+#if CONFIG_FEATURE_STORAGE_ENABLED
+// Background storage write, queued by the serial commands and run from loop() one flash operation
+// at a time (serviceStorageJob), so a save stalls the loop for one sector erase at most
+enum class StorageJobState : uint8_t {
+    NONE = 0,
+    QUEUED,
+    RUNNING,
+    DONE,
+    FAILED
+};
+
+struct StorageJobStatus {
+    uint16_t id;
+    StorageJobState state;
+    StorageResult result;   // set once DONE or FAILED
+    uint16_t steps;         // serviceStorageJob calls that worked on it
+    uint16_t bytes;         // size written (a config save is serialized when it starts)
+    uint32_t elapsedMs;     // since queued; final once DONE or FAILED
+};
+#endif
+
 // Configuration Manager - Handles loading, saving, and switching between configuration modes
 // Provides a unified interface for configuration regardless of source (compile-time vs storage)
 class ConfigManager {
@@ -31,7 +52,19 @@ public:
 
 #if CONFIG_FEATURE_STORAGE_ENABLED
     // Format storage (ERASE ALL FILES). Use with caution. Returns true on success.
-    bool formatStorage() { return m_storage.format() == StorageResult::SUCCESS; }
+    // The active configuration stays in effect (moved to RAM) until the next save.
+    bool formatStorage();
+
+    // Background variants of saveConfiguration / resetToDefaults / writeFile for use after boot.
+    // Return the job ID, or 0 if the queue is full (or the file is too big to queue by value).
+    // A save queued behind another save that has not started yet joins it and gets its ID.
+    uint16_t queueSaveConfiguration();
+    uint16_t queueResetToDefaults();
+    uint16_t queueWriteFile(const char* filename, const uint8_t* data, size_t dataSize);
+    // Runs at most one flash operation of the oldest unfinished job; call once per loop()
+    void serviceStorageJob();
+    // Status of a recent job (id 0 = the last one queued); false if unknown or too old
+    bool getStorageJobStatus(uint16_t id, StorageJobStatus& status) const;
 #endif
     
     // Get current configuration status
@@ -40,21 +73,29 @@ public:
     // Validate a configuration without applying it
     ConfigValidationResult validateConfiguration(const StoredConfig* config) const;
     
-    // Configuration access methods
-    const PinMapEntry* getPinMap() const { return m_currentPinMap; }
-    uint8_t getPinMapCount() const { return m_currentPinMapCount; }
+    // Configuration access methods. Tables are read in place from the active config image (mapped
+    // flash once stored); pointers stay valid until the next storage write or configuration change.
+    const StoredPinMapEntry* getPinMap() const {
+        return reinterpret_cast<const StoredPinMapEntry*>(m_image + configImagePinMapOffset(*image()));
+    }
+    uint8_t getPinMapCount() const { return image()->pinMapCount; }
     
-    const LogicalInput* getLogicalInputs() const { return m_currentLogicalInputs; }
-    uint8_t getLogicalInputCount() const { return m_currentLogicalInputCount; }
+    const LogicalInput* getLogicalInputs() const {
+        return reinterpret_cast<const LogicalInput*>(m_image + configImageLogicalInputsOffset(*image()));
+    }
+    uint8_t getLogicalInputCount() const { return image()->logicalInputCount; }
     
-    uint8_t getShiftRegisterCount() const { return m_currentShiftRegCount; }
+    uint8_t getShiftRegisterCount() const { return image()->shiftRegCount; }
     
     // Axis configuration access (returns nullptr if axis not enabled)
     const StoredAxisConfig* getAxisConfig(uint8_t axisIndex) const;
     bool isAxisEnabled(uint8_t axisIndex) const;
     
+    // Response curve definition for an axis (returns nullptr if the axis uses the linear curve)
+    const StoredCurveHeader* getAxisCurve(uint8_t axisIndex, const StoredCurvePoint** points) const;
+    
     // USB descriptor configuration access
-    const StoredUSBDescriptor* getUSBDescriptor() const { return &m_currentUSBDescriptor; }
+    const StoredUSBDescriptor* getUSBDescriptor() const { return &image()->usbDescriptor; }
     
     // Hot-reload configuration (for runtime updates via USB)
     bool applyConfiguration(const StoredConfig* config, const uint8_t* variableData, size_t variableSize);
@@ -71,8 +112,11 @@ public:
     StorageResult readFile(const char* filename, uint8_t* buffer, size_t bufferSize, size_t* bytesRead) {
         return m_storage.read(filename, buffer, bufferSize, bytesRead);
     }
-    StorageResult writeFile(const char* filename, const uint8_t* data, size_t dataSize) {
-        return m_storage.write(filename, data, dataSize);
+    // The config file itself is written by the save path only (the active image is read from it)
+    StorageResult writeFile(const char* filename, const uint8_t* data, size_t dataSize);
+    // Contents of a file in mapped flash, no copy; valid until the next storage write
+    const uint8_t* mapFile(const char* filename, size_t* size) const {
+        return m_storage.mapFile(filename, size);
     }
     bool fileExists(const char* filename) {
         return m_storage.exists(filename);
@@ -99,49 +143,60 @@ public:
     #endif
     
 private:
-    // Current active configuration
-    PinMapEntry m_currentPinMap[MAX_PIN_MAP_ENTRIES];
-    // Stable storage for pin names to avoid dangling pointers when loading from storage
-    char m_pinNamePool[MAX_PIN_MAP_ENTRIES][8];
-    LogicalInput m_currentLogicalInputs[MAX_LOGICAL_INPUTS];
-    StoredAxisConfig m_currentAxisConfigs[8];
-    StoredUSBDescriptor m_currentUSBDescriptor;
-    
-    uint8_t m_currentPinMapCount;
-    uint8_t m_currentLogicalInputCount;
-    uint8_t m_currentShiftRegCount;
+    // Active configuration image (StoredConfig and its tables), used in place: the stored config
+    // file in mapped flash, or m_imageBuffer while that is not stored yet (defaults, an upgraded
+    // older image, applyConfiguration). The buffer is also what a save job writes from.
+    const uint8_t* m_image;
+    size_t m_imageSize;
+    bool m_imageInFlash;
+    uint8_t m_imageBuffer[MAX_STORED_CONFIG_SIZE];
+    const StoredConfig* image() const { return reinterpret_cast<const StoredConfig*>(m_image); }
+    void bindImage(const uint8_t* image, size_t size, bool inFlash);
     
     bool m_initialized;
     bool m_configLoaded;
     bool m_usingDefaults;
 
 #if CONFIG_FEATURE_STORAGE_ENABLED
-    RP2040EEPROMStorage m_storage;
+    RP2040FlashLogStorage m_storage;
+
+    // Storage job ring, slot = id % STORAGE_JOB_SLOTS; finished jobs stay for status queries
+    static constexpr uint8_t STORAGE_JOB_SLOTS = 4;
+    static constexpr uint8_t STORAGE_JOB_INLINE_DATA = 32;  // file jobs carry their data by value
+    struct StorageJob {
+        StorageJobStatus status;
+        uint32_t queuedMs;
+        bool saveConfig;
+        char filename[32];
+        uint8_t data[STORAGE_JOB_INLINE_DATA];
+    };
+    StorageJob m_jobs[STORAGE_JOB_SLOTS];
+    uint16_t m_lastJobId;   // 0 = none queued yet
+    uint16_t m_runJobId;    // oldest unfinished job, or the next ID to be queued
+
+    StorageJob* newStorageJob();
+    bool imageBufferBusy() const;  // a save is writing from m_imageBuffer
+    // Re-finds the active image after a storage write moved it (or stored m_imageBuffer)
+    void rebindStoredImage();
     
     // Storage-based configuration methods
     bool loadFromStorage();
     bool saveToStorage();
-    bool createBackup();
     bool restoreFromBackup();
 #endif
     
     // Static configuration method removed (always uses storage). Defaults generated dynamically.
     
-    // Conversion helpers
-    bool convertStaticToRuntime();
-    bool convertStoredToRuntime(const StoredConfig* config, const uint8_t* variableData, size_t variableSize);
-    bool convertRuntimeToStored(StoredConfig* config, uint8_t* variableData, size_t* variableSize, size_t maxVariableSize) const;
-    
     // Validation helpers
     bool validatePinMap(const PinMapEntry* pinMap, uint8_t count) const;
     bool validateLogicalInputs(const LogicalInput* inputs, uint8_t count) const;
     bool validateAxisConfig(const StoredAxisConfig* config) const;
     
-    // Default configuration generators
-    void generateDefaultPinMap();
-    void generateDefaultLogicalInputs();
-    void generateDefaultAxisConfigs();
-    void generateDefaultUSBDescriptor();
+    // Default configuration: built in m_imageBuffer and made active. keepUSBDescriptor keeps the
+    // USB identity of the current image.
+    void generateDefaultImage(bool keepUSBDescriptor);
+    void generateDefaultAxisConfigs(StoredAxisConfig* axes) const;
+    void generateDefaultUSBDescriptor(StoredUSBDescriptor* descriptor) const;
     
     // Firmware version management
     bool checkAndUpdateFirmwareVersion();
@@ -9,6 +9,7 @@
 #define CONFIG_FEATURE_USB_PROTOCOL_ENABLED 0  // USB HID protocol disabled (using serial instead)
 #define CONFIG_FEATURE_STORAGE_ENABLED      1  // Storage system always enabled
 #define CONFIG_FEATURE_VALIDATION_ENABLED   1  // Enable configuration validation
+#define CONFIG_FEATURE_PERF_STATS_ENABLED   1  // Per-stage loop profiler (PERF_STATS / PERF_RESET serial commands)
 
 // Default generation policy: Defaults are ONLY generated when no config file exists.
 // Firmware version changes NEVER auto-reset stored configuration anymore.
@@ -18,7 +19,8 @@
 #define CONFIG_STORAGE_FILENAME            "/config.bin"
 #define CONFIG_STORAGE_BACKUP_FILENAME     "/config_backup.bin"
 #define CONFIG_STORAGE_FIRMWARE_VERSION    "/fw_version.txt"  // Firmware version tracking file
-#define CONFIG_VERSION                     7   // Configuration format version
+#define CONFIG_STORAGE_LOG_SECTORS         16  // 4 KB flash sectors in the config log ring (3..32)
+#define CONFIG_VERSION                     10  // Configuration format version
 
 // Firmware version tracking (semantic versioning MAJOR.MINOR.PATCH[-PRERELEASE])
 // Bump according to semantic versioning rules: MAJOR (breaking), MINOR (features), PATCH (bug fixes)
@@ -2,7 +2,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
-#include "../../Config.h"
+#include "ConfigTypes.h"
 #include "ConfigMode.h"
 
 // Serializable configuration structures for storage and USB communication
@@ -25,14 +25,17 @@ struct StoredPinMapEntry {
     uint8_t reserved;        // Padding for alignment
 } __attribute__((packed));
 
-// Logical input definition for storage
+// Logical input layout of config versions up to 9. Version 10 stores LogicalInput (ConfigTypes.h)
+// as is; older images are converted once at load (ConfigConversion::upgradeStoredConfig).
 struct StoredLogicalInput {
     uint8_t type;            // InputType enum value
     uint8_t behavior;        // ButtonBehavior enum value  
     uint8_t joyButtonID;     // Joystick button ID
     uint8_t reverse;         // Reverse flag
     uint8_t encoderLatchMode; // LatchMode enum value
-    uint8_t reserved[3];     // Padding for alignment
+    uint8_t encoderPressMs;   // Encoder press duration in ms (0 = firmware default)
+    uint8_t encoderReleaseMs; // Encoder release duration in ms (0 = firmware default)
+    uint8_t encoderFlags;     // ENCODER_FLAG_* bits
     
     // Union for different input types
     union {
@@ -53,8 +56,6 @@ struct StoredLogicalInput {
 } __attribute__((packed));
 
 // Analog axis configuration for storage
-// WARNING: Despite __attribute__((packed)), this struct is 16 bytes in practice
-// due to compiler alignment. The actual size must be verified.
 struct StoredAxisConfig {
     uint8_t enabled;         // Axis enabled flag
     uint8_t pin;             // Analog pin number (or ADS1115 channel)
@@ -64,11 +65,33 @@ struct StoredAxisConfig {
     uint16_t ewmaAlpha;      // EWMA alpha value (0-1000)
     uint16_t deadband;       // Deadband size
     uint8_t curve;           // Response curve type
-    uint8_t reserved[3];     // Padding for alignment
+    uint8_t adcRate;         // Built-in ADC output rate in 100 Hz units (0 = AdcSampler default)
+    uint8_t adcOversample;   // log2 of built-in ADC oversampling ratio (0 = single sample)
+    uint16_t minCutoff;      // Adaptive filter cutoff at rest, 0.01 Hz (0 = firmware default)
+    uint16_t beta;           // Adaptive filter cutoff gain, 0.01 Hz per full-scale/s
+    uint8_t dCutoff;         // Adaptive filter velocity cutoff, 0.1 Hz (0 = firmware default)
+    uint8_t reserved[1];     // Padding for alignment
 } __attribute__((packed));
 
-// Verify size at compile time - should be exactly 15 bytes with packed attribute
-static_assert(sizeof(StoredAxisConfig) == 15, "StoredAxisConfig must be exactly 15 bytes");
+// Verify size at compile time - should be exactly 20 bytes with packed attribute
+static_assert(sizeof(StoredAxisConfig) == 20, "StoredAxisConfig must be exactly 20 bytes");
+
+// Response curve definition for storage: a header followed by pointCount points.
+// Only axes with a non-linear curve have an entry; the firmware compiles the points
+// into a lookup table at load time and keeps only the table in RAM.
+struct StoredCurveHeader {
+    uint8_t axis;            // Axis index (0-7)
+    uint8_t flags;           // CURVE_FLAG_*
+    uint8_t pointCount;      // Control points that follow (2-16)
+    uint8_t lutLog2;         // Lookup table size 2^n + 1, n = 8..12 (0 = firmware default)
+} __attribute__((packed));
+
+struct StoredCurvePoint {
+    uint16_t x;              // Curve input (0-32767), strictly increasing
+    uint16_t y;              // Curve output (0-32767)
+} __attribute__((packed));
+
+static constexpr uint8_t CURVE_FLAG_SMOOTH = 0x01;      // Monotone cubic instead of straight segments
 
 // USB descriptor configuration for storage
 struct StoredUSBDescriptor {
@@ -90,16 +113,24 @@ struct StoredConfig {
     uint8_t pinMapCount;
     uint8_t logicalInputCount;
     uint8_t shiftRegCount;
-    uint8_t reserved1;       // Padding
+    uint8_t curveCount;      // Response curve entries (was padding before version 8)
     
     // Analog configuration - 8 axes (X, Y, Z, RX, RY, RZ, S1, S2)
     StoredAxisConfig axes[8];
     
-    // Variable-length arrays (stored after this structure)
+    // Variable-length tables (stored after this structure, each at a 4-byte aligned offset
+    // from the start of the image; configImage*Offset below)
     // StoredPinMapEntry pinMap[pinMapCount];
-    // StoredLogicalInput logicalInputs[logicalInputCount];
+    // LogicalInput logicalInputs[logicalInputCount];   (StoredLogicalInput up to version 9)
+    // curveCount x { StoredCurveHeader; StoredCurvePoint points[pointCount]; }
 } __attribute__((packed));
 
+// The runtime uses a config image in place, in mapped flash or in RAM: every table entry must be
+// usable through a const pointer at the offset it is stored at
+static_assert(sizeof(StoredConfig) % 4 == 0, "tables after StoredConfig start aligned");
+static_assert(sizeof(LogicalInput) == 10 && alignof(LogicalInput) == 1, "LogicalInput layout is stored in the config image");
+static_assert(alignof(StoredPinMapEntry) == 1 && alignof(StoredCurveHeader) == 1, "config tables are byte-aligned");
+
 // USB protocol message types (deprecated - using serial protocol instead)
 // enum class ConfigMessageType : uint8_t {
 //     GET_CONFIG = 0x01,       // Request current configuration
@@ -147,26 +178,42 @@ struct ConfigStatus {
 static constexpr uint8_t MAX_PIN_MAP_ENTRIES = 32;
 static constexpr uint8_t MAX_LOGICAL_INPUTS = 64;
 static constexpr uint8_t MAX_SHIFT_REGISTERS = 8;
+static constexpr uint8_t MAX_CURVE_POINTS = 16;
+static constexpr size_t MAX_CURVE_DATA_SIZE = 8 * (sizeof(StoredCurveHeader) + MAX_CURVE_POINTS * sizeof(StoredCurvePoint));
+static constexpr size_t MAX_STORED_CONFIG_SIZE = 2048;  // serialized config (StoredConfig + variable data)
 static constexpr uint32_t CONFIG_MAGIC = 0x4A4F5943; // "JOYC"
 
+// Offsets of the tables in a config image (version 10)
+inline size_t configImageAlign(size_t offset) { return (offset + 3) & ~(size_t)3; }
+inline size_t configImagePinMapOffset(const StoredConfig&) { return sizeof(StoredConfig); }
+inline size_t configImageLogicalInputsOffset(const StoredConfig& config) {
+    return configImageAlign(configImagePinMapOffset(config) + config.pinMapCount * sizeof(StoredPinMapEntry));
+}
+inline size_t configImageCurvesOffset(const StoredConfig& config) {
+    return configImageAlign(configImageLogicalInputsOffset(config) + config.logicalInputCount * sizeof(LogicalInput));
+}
+
 // Helper functions for conversion between runtime and stored formats
 namespace ConfigConversion {
     
     // Convert runtime pin map to stored format
     bool packPinMap(const PinMapEntry* runtimeMap, uint8_t count, StoredPinMapEntry* storedMap);
     
-    // Convert stored pin map to runtime format  
-    bool unpackPinMap(const StoredPinMapEntry* storedMap, uint8_t count, PinMapEntry* runtimeMap);
-    
-    // Convert runtime logical inputs to stored format
-    bool packLogicalInputs(const LogicalInput* runtimeInputs, uint8_t count, StoredLogicalInput* storedInputs);
-    
-    // Convert stored logical inputs to runtime format
+    // Convert stored logical inputs (version 9 and older) to runtime format
     bool unpackLogicalInputs(const StoredLogicalInput* storedInputs, uint8_t count, LogicalInput* runtimeInputs);
     
     // Calculate configuration checksum
     uint32_t calculateChecksum(const StoredConfig* config, const uint8_t* variableData, size_t variableSize);
     
-    // Validate configuration structure
-    bool validateStoredConfig(const StoredConfig* config, size_t totalSize);
+    // Size of the curve section at curveData (0 if malformed or longer than maxSize)
+    size_t curveSectionSize(const uint8_t* curveData, uint8_t curveCount, size_t maxSize);
+    
+    // Validate configuration structure. The checksum pass can be skipped for an image whose
+    // integrity was already checked (a storage record with its own CRC).
+    bool validateStoredConfig(const StoredConfig* config, size_t totalSize, bool verifyChecksum = true);
+    
+    // Convert a valid version 7, 8 or 9 image to the current layout in out. Axis entries are
+    // widened to 20 bytes with the adaptive filter parameters left 0 (firmware default); a version
+    // 7 image has no curves. Returns false if it is not valid or does not fit.
+    bool upgradeStoredConfig(const uint8_t* image, size_t size, uint8_t* out, size_t outSize, size_t* outLength);
 }
\ No newline at end of file
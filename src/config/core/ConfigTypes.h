@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Pin and logical input definitions shared by the static configuration (Config.h) and the
+// stored config image (ConfigStructs.h). Kept free of Arduino headers so the config image code
+// also builds for the native tests.
+
+// ===========================
+// 🛠️ Hardware Pin Definitions
+// ===========================
+
+// Pin types
+enum PinType : uint8_t {
+    PIN_UNUSED = 0,
+    BTN,
+    BTN_ROW,
+    BTN_COL,
+    SHIFTREG_PL,   // Parallel load (SH/LD)
+    SHIFTREG_CLK,  // Clock
+    SHIFTREG_QH    // Serial data out
+};
+
+// Helper: Pin name type (string) - renamed to avoid conflict with RP2040 framework PinName
+using HardwarePinName = const char*;
+
+// Pin mapping entry
+struct PinMapEntry {
+    HardwarePinName name;
+    PinType type;
+};
+
+// ===========================
+// 🎮 Logical Input Definitions
+// ===========================
+
+enum InputType : uint8_t {
+    INPUT_PIN,
+    INPUT_MATRIX,
+    INPUT_SHIFTREG
+};
+
+enum ButtonBehavior : uint8_t {
+    NORMAL,
+    MOMENTARY,
+    ENC_A,  // Encoder channel A (clockwise)
+    ENC_B,  // Encoder channel B (counter-clockwise)
+    ENC_AXIS_A  // Encoder channel A with the position on a HID axis (joyButtonID = axis 9-16)
+};
+
+// Encoder phases are decoded by EncoderInput, never bound as buttons
+inline bool isEncoderBehavior(ButtonBehavior b) {
+    return b == ENC_A || b == ENC_B || b == ENC_AXIS_A;
+}
+
+// LogicalInput::encoderFlags
+static constexpr uint8_t ENCODER_FLAG_BURST         = 0x01; // drain a pulse backlog at the 2 ms minimum
+static constexpr uint8_t ENCODER_FLAG_AXIS_CLAMP    = 0x02; // ENC_AXIS_A: stop at the ends instead of wrapping
+static constexpr uint8_t ENCODER_FLAG_AXIS_RELATIVE = 0x04; // ENC_AXIS_A: report turn rate, decaying to center
+static constexpr uint8_t ENCODER_FLAG_ACCEL         = 0x08; // multiply steps when spun fast (ENCODER_ACCEL_*)
+
+// Simplified latch mode enum for configuration
+enum LatchMode : uint8_t {
+    FOUR3 = 1,  // Maps to RotaryEncoder::LatchMode::FOUR3
+    FOUR0 = 2,  // Maps to RotaryEncoder::LatchMode::FOUR0
+    TWO03 = 3   // Maps to RotaryEncoder::LatchMode::TWO03
+};
+
+struct LogicalInput {
+    InputType type;
+    union {
+        struct { uint8_t pin; uint8_t joyButtonID; ButtonBehavior behavior; uint8_t reverse; } pin;
+        struct { uint8_t row; uint8_t col; uint8_t joyButtonID; ButtonBehavior behavior; uint8_t reverse; } matrix;
+        struct { uint8_t regIndex; uint8_t bitIndex; uint8_t joyButtonID; ButtonBehavior behavior; uint8_t reverse; } shiftreg;
+    } u;
+    // Optional latch mode for encoders (only used when behavior is ENC_A or ENC_B)
+    LatchMode encoderLatchMode = FOUR3;
+    // Optional USB pulse timing for encoders (read from the ENC_A entry): press and release
+    // durations in ms (0 = ENCODER_PRESS_MS / ENCODER_RELEASE_MS) and ENCODER_FLAG_* bits
+    uint8_t encoderPressMs = 0;
+    uint8_t encoderReleaseMs = 0;
+    uint8_t encoderFlags = 0;
+};
+
+inline ButtonBehavior logicalBehavior(const LogicalInput& in) {
+    switch (in.type) {
+        case INPUT_MATRIX: return in.u.matrix.behavior;
+        case INPUT_SHIFTREG: return in.u.shiftreg.behavior;
+        default: return in.u.pin.behavior;
+    }
+}
+
+inline uint8_t logicalJoyButtonID(const LogicalInput& in) {
+    switch (in.type) {
+        case INPUT_MATRIX: return in.u.matrix.joyButtonID;
+        case INPUT_SHIFTREG: return in.u.shiftreg.joyButtonID;
+        default: return in.u.pin.joyButtonID;
+    }
+}
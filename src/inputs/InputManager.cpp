@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "InputManager.h"
 #include "../config/ConfigAxis.h" // brings in readUserAxes definition
+#include "../utils/LoopProfiler.h"
+#include <hardware/gpio.h>
+#include <hardware/timer.h>
 
 // Forward declare in case inclusion order changes
 inline void readUserAxes(Joystick_& joystick);
@@ -11,24 +14,71 @@ InputManager g_inputManager;
 extern ShiftRegister165* shiftReg;
 extern uint8_t* shiftRegBuffer;
 
+static_assert(SHIFTREG_COUNT <= SCAN_SNAPSHOT_SHIFTREG_MAX, "ScanSnapshot cannot hold all shift registers");
+
 void InputManager::begin(const LogicalInput* inputs, uint8_t count) {
     if (_begun) return;
     initButtonsFromLogical(inputs, count);
+    initMatrixFromLogical(inputs, count);   // encoders may sample matrix cells
     initEncodersFromLogical(inputs, count);
-    initMatrixFromLogical(inputs, count);
     if (shiftReg && shiftRegBuffer) {
-        g_shiftRegisterManager.begin(shiftReg, shiftRegBuffer, SHIFTREG_COUNT);
+        g_shiftRegisterManager.begin(shiftReg, shiftRegBuffer, SHIFTREG_COUNT,
+                                     getEncoderShiftRegPrefix(), SHIFTREG_ENCODER_RATE_HZ);
     }
     _begun = true;
 }
 
 void InputManager::update(Joystick_ &js) {
     if (!_begun) return;
-    uint32_t now = millis();
+    uint32_t now = time_us_32();
+    // All setters below only edit the pending report; it is diffed and sent once at commit
+    js.beginReport();
+    PERF_BEGIN(tShift);
     g_shiftRegisterManager.update(now);
+    PERF_END(PERF_SHIFT_REG, tShift);
+    PERF_BEGIN(tButtons);
     updateButtons();
+    PERF_END(PERF_BUTTONS, tButtons);
+    PERF_BEGIN(tMatrix);
     updateMatrix();
+    PERF_END(PERF_MATRIX, tMatrix);
+    PERF_BEGIN(tEncoders);
     updateEncoders();
+    PERF_END(PERF_ENCODERS, tEncoders);
+    PERF_BEGIN(tAxes);
     readUserAxes(js);
-    js.sendState();
+    PERF_END(PERF_AXES, tAxes);
+    PERF_BEGIN(tHandoff);
+    flushButtonPinEdges();
+    js.endReport();
+    _pressLatch.apply(js.getReport(), _handoff.published() + 1,
+                      _ackedSeq.load(std::memory_order_acquire), _scan.report);
+    fillRawState();
+    _handoff.publish(_scan);
+    PERF_END(PERF_HANDOFF, tHandoff);
+}
+
+// Raw hardware state as this cycle saw it (read by RawStateReader on core0)
+void InputManager::fillRawState() {
+    _scan.gpio = gpio_get_all() & 0x3FFFFFFFu;
+    _scan.scanUs = time_us_32();
+
+    const uint32_t* keys = MatrixRawAccess::getRawKeyBits();
+    const uint16_t cells = (uint16_t)getMatrixRows() * getMatrixCols();
+    if (keys && cells <= SCAN_SNAPSHOT_MATRIX_WORDS * 32) {
+        _scan.matrixRows = getMatrixRows();
+        _scan.matrixCols = getMatrixCols();
+        memcpy(_scan.matrixRawBits, keys, ((cells + 31) / 32) * sizeof(uint32_t));
+    } else {
+        _scan.matrixRows = 0;
+        _scan.matrixCols = 0;
+    }
+
+    const uint8_t* regs = g_shiftRegisterManager.getBuffer();
+    if (regs) {
+        _scan.shiftRegCount = SHIFTREG_COUNT;
+        memcpy(_scan.shiftRegs, regs, SHIFTREG_COUNT);
+    } else {
+        _scan.shiftRegCount = 0;
+    }
 }
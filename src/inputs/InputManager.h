@@ -6,13 +6,37 @@
 #include "encoders/EncoderInput.h"
 #include "ShiftRegisterManager.h"
 #include "../rp2040/JoystickWrapper.h"
+#include "../utils/SeqlockDoubleBuffer.h"
+#include "ScanSnapshot.h"
+#include "ReportPressLatch.h"
+#include <atomic>
 
+// Input acquisition runs on core1 (begin/update); core0 only picks up the published
+// ScanSnapshot (pollSnapshot/snapshot) for USB and RawStateReader.
 class InputManager {
 public:
     void begin(const LogicalInput* inputs, uint8_t count);
+    // One scan cycle on core1: every input stage edits the pending report, which is then
+    // published together with the raw hardware state. Nothing is sent from here.
     void update(Joystick_ &js);
+
+    // Core0: copies the newest published scan; returns true if it is newer than the last one
+    bool pollSnapshot() { return _handoff.readNewer(_latest, _latestSeq); }
+    const ScanSnapshot& snapshot() const { return _latest; }
+    uint32_t snapshotNumber() const { return _latestSeq; }
+    // Core0: the host has the report of the snapshot taken last (sent, or equal to the last
+    // one sent); presses latched up to it are released from the published reports
+    void acknowledgeSnapshot() { _ackedSeq.store(_latestSeq, std::memory_order_release); }
 private:
+    void fillRawState();
+
     bool _begun = false;
+    ScanSnapshot _scan = {};    // core1: built each cycle
+    SeqlockDoubleBuffer<ScanSnapshot> _handoff;
+    ReportPressLatch _pressLatch;              // core1
+    std::atomic<uint32_t> _ackedSeq{0};        // written by core0
+    ScanSnapshot _latest = {};  // core0: last snapshot taken
+    uint32_t _latestSeq = 0;
 };
 
 extern InputManager g_inputManager;
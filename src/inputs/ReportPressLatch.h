@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "../rp2040/hid/GamepadReport.h"
+
+// Keeps button presses in the published reports until core0 has sent one of them.
+//
+// core1 builds a report every scan cycle, but core0 only sends the newest snapshot and at most
+// once per TinyUSBGamepad::MIN_SEND_INTERVAL_US, so a press released again within about 1 ms
+// (a short tap replayed from pin edges) can be overwritten before any report carries it.
+// Every button that turns on in a built report is latched with the number of the snapshot it
+// appears in, and stays set in the published reports until core0 acknowledges that snapshot
+// or a later one. A short tap is therefore sent as pressed for one report and its release
+// follows in the next; two taps of one button between sends still merge into one press.
+// core1 owns the latch; the acknowledged number is the only thing core0 writes.
+class ReportPressLatch {
+public:
+    // core1, once per cycle: out = built with the unacknowledged presses set. number is the
+    // snapshot number out will be published as, acked the newest one core0 has sent.
+    void apply(const joycore_gamepad_report_t& built, uint32_t number, uint32_t acked,
+               joycore_gamepad_report_t& out) {
+        memcpy(&out, &built, sizeof(out));
+        for (uint8_t w = 0; w < GAMEPAD_BUTTON_WORDS; w++) {
+            uint32_t cur;
+            memcpy(&cur, built.buttons + w * 4, sizeof(cur));
+            uint32_t latched = _latched[w];
+            for (uint32_t m = latched; m; m &= m - 1) {
+                const uint8_t b = (uint8_t)__builtin_ctz(m);
+                if ((int32_t)(acked - _since[w * 32 + b]) >= 0) latched &= ~(1u << b);
+            }
+            const uint32_t rose = cur & ~_prev[w];
+            for (uint32_t m = rose; m; m &= m - 1) _since[w * 32 + __builtin_ctz(m)] = number;
+            latched |= rose;
+            _prev[w] = cur;
+            _latched[w] = latched;
+            if (!latched) continue;
+            cur |= latched;
+            memcpy(out.buttons + w * 4, &cur, sizeof(cur));
+        }
+    }
+
+private:
+    uint32_t _prev[GAMEPAD_BUTTON_WORDS] = {};      // buttons of the previous built report
+    uint32_t _latched[GAMEPAD_BUTTON_WORDS] = {};   // pressed since the last acknowledged snapshot
+    uint32_t _since[GAMEPAD_BUTTON_WORDS * 32] = {}; // snapshot number of each latched press
+};
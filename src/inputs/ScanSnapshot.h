@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include "../rp2040/hid/GamepadReport.h"
+
+// Result of one input scan cycle, published by the scan core (core1) and consumed by core0:
+// the finished gamepad report plus the raw hardware state RawStateReader reports, so core0
+// never touches input hardware that core1 is driving.
+static constexpr uint8_t SCAN_SNAPSHOT_SHIFTREG_MAX = 16;  // bytes of 74HC165 data
+static constexpr uint8_t SCAN_SNAPSHOT_MATRIX_WORDS = 8;   // 256 keys; 30 GPIOs allow at most 15 x 15
+
+struct ScanSnapshot {
+    uint32_t gpio;                                    // GPIO 0-29 levels at the end of the scan
+    uint32_t scanUs;                                  // time_us_32() when the scan finished
+    uint32_t matrixRawBits[SCAN_SNAPSHOT_MATRIX_WORDS]; // undebounced, bit r * cols + c, 1 = pressed
+    joycore_gamepad_report_t report;                  // presses not yet sent are held (ReportPressLatch)
+    uint8_t matrixRows;                               // 0 = no matrix
+    uint8_t matrixCols;
+    uint8_t shiftRegCount;                            // 0 = no shift registers
+    uint8_t reserved;
+    uint8_t shiftRegs[SCAN_SNAPSHOT_SHIFTREG_MAX];    // raw bytes as read (active-low inputs)
+};
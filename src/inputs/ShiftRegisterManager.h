@@ -2,23 +2,32 @@
 #pragma once
 #include <Arduino.h>
 #include "shift_register/ShiftRegister165.h"
+#include "shift_register/ShiftRegisterCadence.h"
 
 class ShiftRegisterManager {
 public:
-    void begin(ShiftRegister165* reg, uint8_t* buffer, uint8_t count) {
-        _reg = reg; _buffer = buffer; _count = count; _lastRead = 0;
+    // prefixBytes: devices up to the last one holding an encoder phase (0 = none), read at
+    // prefixRateHz between full-chain reads
+    void begin(ShiftRegister165* reg, uint8_t* buffer, uint8_t count,
+               uint8_t prefixBytes = 0, uint32_t prefixRateHz = 0) {
+        _reg = reg; _buffer = buffer; _count = count;
+        // Hardware-clocked chains cost a few us per read and run every loop
+        const uint32_t fullUs = (reg && reg->isHardwareClocked()) ? 0 : ((count > 1) ? 5000 : 1000);
+        shiftRegisterCadenceInit(_cadence, count, prefixBytes, fullUs,
+                                 prefixRateHz ? 1000000u / prefixRateHz : 0);
     }
-    void update(uint32_t now) {
+    void update(uint32_t nowUs) {
         if (!_reg || !_buffer) return;
-        uint32_t interval = (_count > 1) ? 5 : 1; // ms cadence
-        if (now - _lastRead >= interval) { _reg->read(_buffer); _lastRead = now; }
+        const uint8_t bytes = shiftRegisterCadenceNext(_cadence, nowUs);
+        if (bytes == _count) _reg->read(_buffer);
+        else if (bytes) _reg->readPrefix(_buffer, bytes);
     }
     uint8_t* getBuffer() const { return _buffer; }
 private:
     ShiftRegister165* _reg = nullptr;
     uint8_t* _buffer = nullptr;
     uint8_t _count = 0;
-    uint32_t _lastRead = 0;
+    ShiftRegisterCadence _cadence;
 };
 
 extern ShiftRegisterManager g_shiftRegisterManager;
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "AdcSampler.h"
+#include <Arduino.h>
+#include <hardware/adc.h>
+#include <hardware/dma.h>
+
+AdcSampler g_adcSampler;
+
+uint8_t AdcSampler::addSlot(uint8_t pin, uint16_t rateHz, uint8_t oversampleLog2) {
+    if (_running || _slotCount >= MAX_SLOTS || !isAdcPin(pin)) return NO_SLOT;
+    Slot& s = _slots[_slotCount];
+    s.lane = (uint8_t)(pin - 26); // resolved to a lane in begin()
+    s.rateHz = rateHz ? rateHz : DEFAULT_RATE_HZ;
+    s.oversampleLog2 = (oversampleLog2 > MAX_OVERSAMPLE_LOG2) ? MAX_OVERSAMPLE_LOG2 : oversampleLog2;
+    s.value = OUTPUT_MAX / 2;
+    s.fresh = false;
+    _inputMask |= (uint8_t)(1u << s.lane);
+    return _slotCount++;
+}
+
+bool AdcSampler::begin() {
+    if (_running || !_slotCount) return false;
+
+    // Round-robin converts the enabled inputs in ascending order
+    uint8_t laneOf[MAX_INPUTS] = {};
+    _laneCount = 0;
+    for (uint8_t in = 0; in < MAX_INPUTS; in++) {
+        if (_inputMask & (1u << in)) {
+            laneOf[in] = _laneCount;
+            _laneInput[_laneCount++] = in;
+        }
+    }
+
+    // Every input is converted at the rate the most demanding slot needs
+    uint32_t perInput = 0;
+    for (uint8_t i = 0; i < _slotCount; i++) {
+        uint32_t need = (uint32_t)_slots[i].rateHz << _slots[i].oversampleLog2;
+        if (need > perInput) perInput = need;
+    }
+    _totalSps = perInput * _laneCount;
+    if (_totalSps > MAX_TOTAL_SPS) _totalSps = MAX_TOTAL_SPS;
+    if (_totalSps < 1000) _totalSps = 1000; // clock divider range
+    perInput = _totalSps / _laneCount;
+
+    for (uint8_t i = 0; i < _slotCount; i++) {
+        Slot& s = _slots[i];
+        s.lane = laneOf[s.lane];
+        const uint32_t window = 1u << s.oversampleLog2;
+        s.interval = (perInput + s.rateHz / 2) / s.rateHz;
+        if (s.interval < window) s.interval = window; // rate capped by MAX_TOTAL_SPS
+        s.nextDue = window;
+    }
+
+    _ringLen = (uint32_t)_laneCount * SAMPLES_PER_INPUT;
+    _ring = new uint16_t[_ringLen];
+    memset(_ring, 0, _ringLen * sizeof(uint16_t));
+    _ringStart = (uint32_t)(uintptr_t)_ring;
+    _lastIndex = 0;
+    memset(_laneSamples, 0, sizeof(_laneSamples));
+
+    adc_init();
+    for (uint8_t l = 0; l < _laneCount; l++) adc_gpio_init(26 + _laneInput[l]);
+    adc_select_input(_laneInput[0]);
+    adc_set_round_robin(_inputMask);
+    adc_fifo_setup(true, true, 1, false, false); // DREQ per sample, 12-bit results
+    adc_set_clkdiv(48000000.0f / (float)_totalSps - 1.0f);
+    adc_fifo_drain();
+
+    _dataChan = dma_claim_unused_channel(true);
+    _ctrlChan = dma_claim_unused_channel(true);
+
+    dma_channel_config dc = dma_channel_get_default_config(_dataChan);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_16);
+    channel_config_set_read_increment(&dc, false);
+    channel_config_set_write_increment(&dc, true);
+    channel_config_set_dreq(&dc, DREQ_ADC);
+    channel_config_set_chain_to(&dc, _ctrlChan);
+    dma_channel_configure(_dataChan, &dc, _ring, &adc_hw->fifo, _ringLen, false);
+
+    // Re-arms the data channel at the ring start; its transfer count reloads on trigger
+    dma_channel_config cc = dma_channel_get_default_config(_ctrlChan);
+    channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+    channel_config_set_read_increment(&cc, false);
+    channel_config_set_write_increment(&cc, false);
+    dma_channel_configure(_ctrlChan, &cc, &dma_hw->ch[_dataChan].al2_write_addr_trig, &_ringStart, 1, false);
+
+    dma_channel_start(_dataChan);
+    adc_run(true);
+    _running = true;
+    return true;
+}
+
+uint32_t AdcSampler::writeIndex() const {
+    uint32_t idx = (dma_channel_hw_addr(_dataChan)->write_addr - _ringStart) >> 1;
+    return (idx < _ringLen) ? idx : 0; // end of ring, re-arm pending
+}
+
+void AdcSampler::poll() {
+    if (!_running) return;
+    const uint32_t idx = writeIndex();
+    const uint32_t delta = (idx + _ringLen - _lastIndex) % _ringLen;
+    if (!delta) return;
+
+    // The ring holds whole round-robin rounds, so ring position % lanes == lane
+    const uint32_t full = delta / _laneCount;
+    const uint32_t rem = delta % _laneCount;
+    const uint32_t firstLane = _lastIndex % _laneCount;
+    for (uint8_t l = 0; l < _laneCount; l++) {
+        _laneSamples[l] += full + (((l + _laneCount - firstLane) % _laneCount) < rem ? 1 : 0);
+    }
+    _lastIndex = idx;
+
+    const uint32_t newest = (idx + _ringLen - 1) % _ringLen;
+    for (uint8_t i = 0; i < _slotCount; i++) {
+        Slot& s = _slots[i];
+        const uint32_t count = _laneSamples[s.lane];
+        if ((int32_t)(count - s.nextDue) < 0) continue;
+
+        // Sum the lane's latest 2^k samples, walking back one round-robin round at a time
+        uint32_t p = (newest + _ringLen - ((newest % _laneCount) + _laneCount - s.lane) % _laneCount) % _ringLen;
+        uint32_t sum = 0;
+        for (uint32_t n = 1u << s.oversampleLog2; n; n--) {
+            sum += _ring[p] & 0x0FFF;
+            if (p < _laneCount) p += _ringLen;
+            p -= _laneCount;
+        }
+        s.value = (s.oversampleLog2 >= 2) ? (int32_t)(sum >> (s.oversampleLog2 - 2))
+                                          : (int32_t)(sum << (2 - s.oversampleLog2));
+        s.fresh = true;
+
+        s.nextDue += s.interval;
+        if ((int32_t)(count - s.nextDue) >= 0) s.nextDue = count + s.interval; // fell behind
+    }
+}
+
+bool AdcSampler::takeValue(uint8_t slot, int32_t& value) {
+    if (slot >= _slotCount || !_slots[slot].fresh) return false;
+    _slots[slot].fresh = false;
+    value = _slots[slot].value;
+    return true;
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Free-running RP2040 ADC acquisition for the built-in analog pins (GPIO26-29).
+//
+// The ADC converts the used inputs in hardware round-robin and a DMA channel streams the
+// FIFO into a ring of SAMPLES_PER_INPUT samples per input. A second DMA channel rewrites
+// the data channel's write address when it reaches the end, so capture never stops and
+// the CPU is not involved. poll() only looks at the DMA write pointer: each registered
+// slot (one per axis) emits a decimated value at its own rate by summing its latest
+// 2^oversampleLog2 samples from the ring. Values are scaled to 14 bits (0..16383);
+// effective resolution is 12 bits without oversampling and 14 bits from 16x.
+// poll() must run at least once per ring lap (SAMPLES_PER_INPUT rounds, >= 4 ms).
+class AdcSampler {
+public:
+    static constexpr uint8_t MAX_SLOTS = 8;
+    static constexpr uint8_t NO_SLOT = 0xFF;
+    static constexpr uint8_t MAX_INPUTS = 4;               // GPIO26..29
+    static constexpr uint8_t MAX_OVERSAMPLE_LOG2 = 6;      // 64x
+    static constexpr uint16_t SAMPLES_PER_INPUT = 512;
+    static constexpr uint32_t MAX_TOTAL_SPS = 500000;      // 96 ADC clocks at 48 MHz
+    static constexpr uint16_t DEFAULT_RATE_HZ = 1000;
+    static constexpr int32_t OUTPUT_MAX = 16383;
+
+    static bool isAdcPin(int pin) { return pin >= 26 && pin <= 29; }
+
+    // Registers a consumer of pin (GPIO26..29) producing rateHz values, each the average of
+    // 2^oversampleLog2 raw samples. Must be called before begin(); returns the slot handle.
+    uint8_t addSlot(uint8_t pin, uint16_t rateHz, uint8_t oversampleLog2);
+
+    // Plans the conversion rate, allocates the ring and starts ADC + DMA
+    bool begin();
+    bool isRunning() const { return _running; }
+
+    // Consumes newly captured samples and updates due slots; never waits
+    void poll();
+
+    // Latest value of a slot; true only once per new value
+    bool takeValue(uint8_t slot, int32_t& value);
+    int32_t getValue(uint8_t slot) const { return (slot < _slotCount) ? _slots[slot].value : 0; }
+
+    uint32_t getTotalSampleRate() const { return _totalSps; }
+
+private:
+    struct Slot {
+        uint8_t lane;            // position of the input in the round-robin sequence
+        uint8_t oversampleLog2;
+        uint16_t rateHz;
+        uint32_t interval;       // input samples between outputs
+        uint32_t nextDue;        // lane sample count of the next output
+        int32_t value;
+        bool fresh;
+    };
+
+    uint32_t writeIndex() const;
+
+    Slot _slots[MAX_SLOTS] = {};
+    uint8_t _slotCount = 0;
+    uint8_t _inputMask = 0;
+    uint8_t _laneCount = 0;
+    uint8_t _laneInput[MAX_INPUTS] = {};
+    uint32_t _laneSamples[MAX_INPUTS] = {};  // samples captured per lane since begin()
+    uint16_t* _ring = nullptr;
+    uint32_t _ringStart = 0;                 // read by the control DMA channel
+    uint32_t _ringLen = 0;                   // _laneCount * SAMPLES_PER_INPUT
+    uint32_t _lastIndex = 0;
+    uint32_t _totalSps = 0;
+    int _dataChan = -1;
+    int _ctrlChan = -1;
+    bool _running = false;
+};
+
+extern AdcSampler g_adcSampler;
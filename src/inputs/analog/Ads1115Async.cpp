@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "Ads1115Async.h"
+
+static const uint16_t kDataRates[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+
+uint8_t Ads1115Sequencer::dataRateCode(uint16_t sps) {
+    uint8_t code = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        if (kDataRates[i] <= sps) code = i;
+    }
+    return code;
+}
+
+uint32_t Ads1115Sequencer::conversionTimeUs(uint8_t rateCode) {
+    return (1000000UL + kDataRates[rateCode & 7] - 1) / kDataRates[rateCode & 7];
+}
+
+uint16_t Ads1115Sequencer::getDataRateSps() const {
+    return kDataRates[_rateCode];
+}
+
+void Ads1115Sequencer::begin(Ads1115Bus* bus, uint16_t dataRateSps, bool useReadyPin) {
+    _bus = bus;
+    _rateCode = dataRateCode(dataRateSps);
+    _useReady = useReadyPin;
+    _state = useReadyPin ? ST_INIT_HI : ST_START;
+    _thresholdsWritten = false;
+    _retryPending = false;
+}
+
+void Ads1115Sequencer::enableChannel(uint8_t channel) {
+    if (channel >= CHANNELS) return;
+    if (!_channelMask) _current = channel;
+    _channelMask |= (uint8_t)(1u << channel);
+}
+
+uint16_t Ads1115Sequencer::configWord(uint8_t channel) const {
+    return ADS1115_CFG_OS_START
+         | (uint16_t)(ADS1115_CFG_MUX_SINGLE_0 + ((uint16_t)channel << 12))
+         | ADS1115_CFG_PGA_6_144V
+         | ADS1115_CFG_MODE_SINGLE
+         | (uint16_t)(_rateCode << ADS1115_CFG_DR_SHIFT)
+         | (_useReady ? ADS1115_CFG_CQUE_1CONV : ADS1115_CFG_CQUE_NONE);
+}
+
+void Ads1115Sequencer::advanceChannel() {
+    for (uint8_t i = 1; i <= CHANNELS; i++) {
+        uint8_t next = (uint8_t)((_current + i) % CHANNELS);
+        if (_channelMask & (1u << next)) { _current = next; return; }
+    }
+}
+
+// Common bookkeeping for a queued transaction; a refused or failed transaction backs off
+// and restarts the current step (thresholds first if they were never written).
+bool Ads1115Sequencer::issue(bool ok, uint32_t nowUs) {
+    if (ok) return true;
+    _busErrors++;
+    _retryPending = true;
+    _retryAtUs = nowUs + ERROR_RETRY_US;
+    _state = (_useReady && !_thresholdsWritten) ? ST_INIT_HI : ST_START;
+    return false;
+}
+
+bool Ads1115Sequencer::update(uint32_t nowUs) {
+    if (!_bus || !_channelMask) return false;
+    if (_retryPending) {
+        if ((int32_t)(nowUs - _retryAtUs) < 0) return false;
+        _retryPending = false;
+    }
+
+    bool stored = false;
+    uint16_t value = 0;
+    // Run consecutive steps until one has to wait, so a finished read immediately
+    // queues the next channel's conversion.
+    for (uint8_t step = 0; step < 6; step++) {
+        switch (_state) {
+            case ST_IDLE:
+                return stored;
+
+            case ST_INIT_HI:
+                if (!issue(_bus->startWrite(ADS1115_REG_HI_THRESH, 0x8000), nowUs)) return stored;
+                _afterWrite = ST_INIT_LO;
+                _state = ST_WAIT_WRITE;
+                break;
+
+            case ST_INIT_LO:
+                if (!issue(_bus->startWrite(ADS1115_REG_LO_THRESH, 0x0000), nowUs)) return stored;
+                _afterWrite = ST_START;
+                _state = ST_WAIT_WRITE;
+                break;
+
+            case ST_START:
+                if (_useReady) (void)_bus->takeReady(); // drop any edge from before this conversion
+                if (!issue(_bus->startWrite(ADS1115_REG_CONFIG, configWord(_current)), nowUs)) return stored;
+                _afterWrite = ST_CONVERTING;
+                _state = ST_WAIT_WRITE;
+                break;
+
+            case ST_WAIT_WRITE: {
+                Ads1115Bus::Status st = _bus->poll(value);
+                if (st == Ads1115Bus::BUS_BUSY) return stored;
+                if (st == Ads1115Bus::BUS_ERROR) { issue(false, nowUs); return stored; }
+                _state = _afterWrite;
+                if (_state == ST_START) _thresholdsWritten = true;
+                if (_state == ST_CONVERTING) {
+                    // The conversion started no later than now. With ALERT/RDY the deadline is
+                    // only a safety net; without it, allow for the +/-10% internal oscillator.
+                    uint32_t conv = conversionTimeUs(_rateCode);
+                    _deadlineUs = nowUs + (_useReady ? conv + conv / 2 + 500 : conv + conv / 8 + 50);
+                    return stored;
+                }
+                break;
+            }
+
+            case ST_CONVERTING: {
+                bool ready = _useReady && _bus->takeReady();
+                if (!ready && (int32_t)(nowUs - _deadlineUs) < 0) return stored;
+                if (_useReady && !ready) _timeouts++;
+                if (!issue(_bus->startRead(ADS1115_REG_CONVERSION), nowUs)) return stored;
+                _state = ST_READING;
+                break;
+            }
+
+            case ST_READING: {
+                Ads1115Bus::Status st = _bus->poll(value);
+                if (st == Ads1115Bus::BUS_BUSY) return stored;
+                if (st == Ads1115Bus::BUS_ERROR) { issue(false, nowUs); return stored; }
+                int16_t v = (int16_t)value;
+                if (v >= 0) _values[_current] = v; // single-ended: negative only from offset noise
+                _samples[_current]++;
+                stored = true;
+                advanceChannel();
+                _state = ST_START;
+                break;
+            }
+        }
+    }
+    return stored;
+}
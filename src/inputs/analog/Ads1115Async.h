@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Non-blocking ADS1115 acquisition (no Arduino dependency, host-testable).
+//
+// Ads1115Sequencer converts the enabled single-ended channels back-to-back: it queues a
+// single-shot conversion, returns to the loop, and on a later update() collects the result
+// once ALERT/RDY has fired (or the conversion deadline has passed), then immediately starts
+// the next channel. All I2C traffic goes through Ads1115Bus, whose transactions are queued
+// and completed by hardware; update() only ever polls.
+
+// ADS1115 register map
+static constexpr uint8_t ADS1115_REG_CONVERSION = 0x00;
+static constexpr uint8_t ADS1115_REG_CONFIG     = 0x01;
+static constexpr uint8_t ADS1115_REG_LO_THRESH  = 0x02;
+static constexpr uint8_t ADS1115_REG_HI_THRESH  = 0x03;
+
+// Config register fields
+static constexpr uint16_t ADS1115_CFG_OS_START     = 0x8000; // write: start single conversion
+static constexpr uint16_t ADS1115_CFG_MUX_SINGLE_0 = 0x4000; // AIN0 vs GND; +0x1000 per channel
+static constexpr uint16_t ADS1115_CFG_PGA_6_144V   = 0x0000; // +/-6.144 V (Adafruit GAIN_TWOTHIRDS)
+static constexpr uint16_t ADS1115_CFG_MODE_SINGLE  = 0x0100;
+static constexpr uint8_t  ADS1115_CFG_DR_SHIFT     = 5;
+static constexpr uint16_t ADS1115_CFG_CQUE_1CONV   = 0x0000; // ALERT/RDY asserts after each conversion
+static constexpr uint16_t ADS1115_CFG_CQUE_NONE    = 0x0003; // comparator and ALERT/RDY disabled
+
+// Non-blocking register access. start*() queue one transaction and return immediately;
+// poll() reports its completion. Only one transaction is in flight at a time; after poll()
+// returns BUS_DONE or BUS_ERROR the bus is idle and accepts the next one.
+class Ads1115Bus {
+public:
+    enum Status : uint8_t { BUS_BUSY, BUS_DONE, BUS_ERROR };
+
+    virtual ~Ads1115Bus() = default;
+    virtual bool startWrite(uint8_t reg, uint16_t value) = 0;
+    virtual bool startRead(uint8_t reg) = 0;
+    virtual Status poll(uint16_t& value) = 0;
+    // True once per ALERT/RDY assertion since the previous call (false if not wired)
+    virtual bool takeReady() = 0;
+};
+
+class Ads1115Sequencer {
+public:
+    static constexpr uint8_t CHANNELS = 4;
+    static constexpr uint32_t ERROR_RETRY_US = 1000;
+
+    // dataRateSps is rounded down to a supported rate (8..860 SPS)
+    void begin(Ads1115Bus* bus, uint16_t dataRateSps, bool useReadyPin);
+    void enableChannel(uint8_t channel);
+
+    // Advances the state machine; never waits. Returns true when a new sample was stored.
+    bool update(uint32_t nowUs);
+
+    int16_t getValue(uint8_t channel) const { return (channel < CHANNELS) ? _values[channel] : 0; }
+    uint32_t getSampleCount(uint8_t channel) const { return (channel < CHANNELS) ? _samples[channel] : 0; }
+    uint32_t getTimeouts() const { return _timeouts; }
+    uint32_t getBusErrors() const { return _busErrors; }
+    uint16_t getDataRateSps() const;
+
+    static uint8_t dataRateCode(uint16_t sps);
+    static uint32_t conversionTimeUs(uint8_t rateCode);
+
+private:
+    enum State : uint8_t {
+        ST_IDLE,
+        ST_INIT_HI,        // Hi_thresh MSB = 1 and Lo_thresh MSB = 0 select conversion-ready mode
+        ST_INIT_LO,
+        ST_START,          // queue config write for the current channel
+        ST_WAIT_WRITE,
+        ST_CONVERTING,
+        ST_READING
+    };
+
+    bool issue(bool ok, uint32_t nowUs);
+    void advanceChannel();
+    uint16_t configWord(uint8_t channel) const;
+
+    Ads1115Bus* _bus = nullptr;
+    State _state = ST_IDLE;
+    State _afterWrite = ST_IDLE;   // next state once the queued write completes
+    uint8_t _rateCode = 7;
+    bool _useReady = false;
+    uint8_t _channelMask = 0;
+    uint8_t _current = 0;
+    bool _thresholdsWritten = false;
+    uint32_t _deadlineUs = 0;
+    uint32_t _retryAtUs = 0;
+    bool _retryPending = false;
+    int16_t _values[CHANNELS] = {};
+    uint32_t _samples[CHANNELS] = {};
+    uint32_t _timeouts = 0;
+    uint32_t _busErrors = 0;
+};
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "Ads1115I2CBus.h"
+#include <Wire.h>
+
+static volatile bool s_adsReady = false;
+
+static void onAdsReady() {
+    s_adsReady = true;
+}
+
+void RP2040Ads1115Bus::begin(uint8_t address, uint32_t clockHz, int8_t readyPin) {
+    Wire.setClock(clockHz);
+    Wire.begin();
+
+    _hw = i2c_get_hw(i2c0); // Wire is bound to i2c0
+    _hw->enable = 0;
+    _hw->tar = address;
+    _hw->enable = 1;
+    _pending = PEND_NONE;
+
+    _hasReadyPin = readyPin >= 0;
+    if (_hasReadyPin) {
+        // ALERT/RDY is open-drain and pulses low at the end of each conversion
+        pinMode(readyPin, INPUT_PULLUP);
+        s_adsReady = false;
+        attachInterrupt(digitalPinToInterrupt(readyPin), onAdsReady, FALLING);
+    }
+}
+
+// Clears leftovers of the previous transaction; false if one is still running
+bool RP2040Ads1115Bus::prepare() {
+    if (!_hw || _pending != PEND_NONE) return false;
+    if (_hw->txflr != 0) return false;
+    while (_hw->rxflr) (void)_hw->data_cmd;
+    (void)_hw->clr_tx_abrt;
+    (void)_hw->clr_stop_det;
+    return true;
+}
+
+bool RP2040Ads1115Bus::startWrite(uint8_t reg, uint16_t value) {
+    if (!prepare()) return false;
+    _hw->data_cmd = reg;
+    _hw->data_cmd = (uint32_t)(value >> 8);
+    _hw->data_cmd = (uint32_t)(value & 0xFF) | I2C_IC_DATA_CMD_STOP_BITS;
+    _pending = PEND_WRITE;
+    return true;
+}
+
+bool RP2040Ads1115Bus::startRead(uint8_t reg) {
+    if (!prepare()) return false;
+    _hw->data_cmd = reg;
+    _hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS | I2C_IC_DATA_CMD_RESTART_BITS;
+    _hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS | I2C_IC_DATA_CMD_STOP_BITS;
+    _pending = PEND_READ;
+    return true;
+}
+
+Ads1115Bus::Status RP2040Ads1115Bus::poll(uint16_t& value) {
+    if (_pending == PEND_NONE) return BUS_ERROR;
+    if (_hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        // NACK or arbitration loss: the controller flushed the FIFO and issued STOP
+        (void)_hw->clr_tx_abrt;
+        _pending = PEND_NONE;
+        return BUS_ERROR;
+    }
+    // Both kinds finish with STOP; waiting for it keeps a late STOP_DET from being
+    // mistaken for completion of the next transaction.
+    if (!(_hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS)) return BUS_BUSY;
+    if (_pending == PEND_READ) {
+        if (_hw->rxflr < 2) {
+            // Short read: drop what arrived so the next transaction starts clean
+            while (_hw->rxflr) (void)_hw->data_cmd;
+            _pending = PEND_NONE;
+            return BUS_ERROR;
+        }
+        uint16_t hi = (uint16_t)(_hw->data_cmd & 0xFF);
+        uint16_t lo = (uint16_t)(_hw->data_cmd & 0xFF);
+        value = (uint16_t)((hi << 8) | lo);
+    }
+    _pending = PEND_NONE;
+    return BUS_DONE;
+}
+
+bool RP2040Ads1115Bus::takeReady() {
+    if (!_hasReadyPin || !s_adsReady) return false;
+    s_adsReady = false;
+    return true;
+}
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <Arduino.h>
+#include <hardware/i2c.h>
+#include "Ads1115Async.h"
+
+// Ads1115Bus on the RP2040 I2C block. Each register transaction (at most 3 writes, or a
+// pointer write plus 2 reads) fits in the 16-entry command FIFO, so it is queued in one go
+// with the STOP/RESTART flags set and the controller runs it without CPU involvement.
+// Completion is detected by polling the raw interrupt status, never by waiting.
+//
+// Wire.begin() is used once to claim the default I2C pins and program the bus timing;
+// afterwards the ADS1115 owns the bus and nothing else may use Wire.
+class RP2040Ads1115Bus : public Ads1115Bus {
+public:
+    // readyPin < 0: ALERT/RDY not wired
+    void begin(uint8_t address, uint32_t clockHz, int8_t readyPin);
+
+    bool startWrite(uint8_t reg, uint16_t value) override;
+    bool startRead(uint8_t reg) override;
+    Status poll(uint16_t& value) override;
+    bool takeReady() override;
+
+private:
+    enum Pending : uint8_t { PEND_NONE, PEND_WRITE, PEND_READ };
+
+    bool prepare();
+
+    i2c_hw_t* _hw = nullptr;
+    Pending _pending = PEND_NONE;
+    bool _hasReadyPin = false;
+};
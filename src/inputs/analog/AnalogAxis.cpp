@@ -1,20 +1,18 @@
 #include "AnalogAxis.h"
+#include "Ads1115I2CBus.h"
+#include "AdcSampler.h"
 
-// ADS1115 instance and initialization flag
-Adafruit_ADS1115 ads;
+// ADS1115 sequencer, its I2C bus and initialization flag
+static RP2040Ads1115Bus adsBus;
+static Ads1115Sequencer adsSequencer;
 bool adsInitialized = false;
 
-// ADS1115 rate limiting variables (moved outside function to avoid static variable issues)
+// Latest completed conversion per channel (mid-range until the first sample arrives)
 static int32_t adsLastValues[4] = {0, 0, 0, 0};
-static unsigned long adsLastReadTimes[4] = {0, 0, 0, 0};
+// Per axis: sequencer sample count already passed to the pipeline
+static uint32_t adsTakenSamples[ANALOG_AXIS_COUNT] = {};
 
-// Round-robin ADS1115 reading to prevent encoder lag
-static uint8_t adsRoundRobinIndex = 0;
-static uint8_t adsChannelsInUse[4] = {255, 255, 255, 255}; // 255 = not in use
-static uint8_t adsChannelCount = 0;
-static unsigned long adsRoundRobinInterval = 20; // Read one channel every 20ms
-
-// Note: AxisFilter and AxisCurve implementations have been moved to AxisProcessing.cpp
+// Note: the processing chain is AxisPipeline (AxisProcessing.cpp)
 // This file now focuses on AnalogAxisManager and hardware interface
 
 // AnalogAxisManager implementation
@@ -26,6 +24,7 @@ AnalogAxisManager::AnalogAxisManager() {
         _axisCalibMax[i] = 1023;
         _axisValues[i] = 0;
         _axisPins[i] = -1;  // No pin assigned by default
+        _adcSlots[i] = AdcSampler::NO_SLOT;
     }
     _enabledAxes = 0;
 }
@@ -44,6 +43,7 @@ void AnalogAxisManager::setAxisRange(uint8_t axis, int32_t minimum, int32_t maxi
     if (axis < ANALOG_AXIS_COUNT) {
         _axisMinimum[axis] = minimum;
         _axisMaximum[axis] = maximum;
+        _pipeline.setRange(axis, minimum, maximum);
     }
 }
 
@@ -55,58 +55,55 @@ void AnalogAxisManager::setAxisCalibration(uint8_t axis, int32_t calibMin, int32
 }
 
 void AnalogAxisManager::setAxisFilterLevel(uint8_t axis, AxisFilterLevel level) {
-    if (axis < ANALOG_AXIS_COUNT) _filters[axis].setLevel(level);
+    if (axis < ANALOG_AXIS_COUNT) _pipeline.setFilterLevel(axis, level);
 }
 
 void AnalogAxisManager::setAxisEwmaAlpha(uint8_t axis, uint32_t alphaValue) {
-    if (axis < ANALOG_AXIS_COUNT) _filters[axis].setEwmaAlpha(alphaValue);
+    if (axis < ANALOG_AXIS_COUNT) _pipeline.setEwmaAlpha(axis, alphaValue);
 }
 
 void AnalogAxisManager::setAxisResponseCurve(uint8_t axis, ResponseCurveType type) {
-    if (axis < ANALOG_AXIS_COUNT) _curves[axis].setType(type);
+    (void)axis; // CURVE_CUSTOM is the only curve type
+    (void)type;
 }
 
 void AnalogAxisManager::setAxisCustomCurve(uint8_t axis, const int32_t* table, uint8_t points) {
-    if (axis < ANALOG_AXIS_COUNT) _curves[axis].setCustomCurve(table, points);
+    if (axis < ANALOG_AXIS_COUNT) _pipeline.setCustomCurve(axis, table, points);
+}
+
+bool AnalogAxisManager::setAxisCurve(uint8_t axis, const AxisCurvePoint* points, uint8_t count, bool smooth, uint8_t lutLog2) {
+    return (axis < ANALOG_AXIS_COUNT) && _pipeline.setCurve(axis, points, count, smooth, lutLog2);
+}
+
+void AnalogAxisManager::setAxisAdaptiveParams(uint8_t axis, uint16_t minCutoff, uint16_t beta, uint8_t dCutoff) {
+    if (axis < ANALOG_AXIS_COUNT) _pipeline.setAdaptiveParams(axis, minCutoff, beta, dCutoff);
 }
 
 void AnalogAxisManager::setAxisDeadbandSize(uint8_t axis, int32_t size) {
     if (axis < ANALOG_AXIS_COUNT) {
-        _deadbands[axis].setSize(size);
+        _pipeline.setDeadbandSize(axis, size);
     }
 }
 
 int32_t AnalogAxisManager::processAxisValue(uint8_t axis, int32_t rawValue) {
     if (axis >= ANALOG_AXIS_COUNT) return rawValue;
     
-    // First map raw hardware value to user-defined range
-    int32_t sourceMin, sourceMax;
+    int32_t raw[ANALOG_AXIS_COUNT];
+    raw[axis] = rawValue;
+    _pipeline.process((uint8_t)(1u << axis), raw, _axisValues, micros());
+    return _axisValues[axis];
+}
+
+// Hardware range of the raw values an axis delivers
+void AnalogAxisManager::updateSourceRange(uint8_t axis) {
     int8_t pin = _axisPins[axis];
-    
-    if (pin >= 100 && pin <= 103) {
-        // ADS1115 channels: 16-bit range (0-16383)
-        sourceMin = 0;
-        sourceMax = 16383;
+    if ((pin >= 100 && pin <= 103) || _adcSlots[axis] != AdcSampler::NO_SLOT) {
+        // ADS1115 channels and oversampled background ADC: 0-16383
+        _pipeline.setSourceMax(axis, 16383);
     } else {
         // Analog pins: 10-bit range (0-1023) on RP2040
-        sourceMin = 0;
-        sourceMax = 1023;
+        _pipeline.setSourceMax(axis, 1023);
     }
-    
-    // Map from hardware range to user-defined range
-    int32_t mappedValue = map(rawValue, sourceMin, sourceMax, _axisMinimum[axis], _axisMaximum[axis]);
-    mappedValue = constrain(mappedValue, _axisMinimum[axis], _axisMaximum[axis]);
-    
-    // Apply deadband FIRST on the raw mapped signal, then filtering and curves
-    int32_t deadbanded = _deadbands[axis].apply(mappedValue);
-    int32_t filtered = _filters[axis].filter(deadbanded);
-    int32_t curved = _curves[axis].apply(filtered);
-    
-    // Map to joystick range (-32767 to 32767)
-    int32_t finalValue = map(curved, _axisMinimum[axis], _axisMaximum[axis], -32767, 32767);
-    
-    _axisValues[axis] = finalValue;
-    return finalValue;
 }
 
 int32_t AnalogAxisManager::getAxisValue(uint8_t axis) {
@@ -137,6 +134,7 @@ int32_t AnalogAxisManager::getAxisMaximum(uint8_t axis) {
 void AnalogAxisManager::setAxisPin(uint8_t axis, int8_t pin) {
     if (axis < ANALOG_AXIS_COUNT) {
         _axisPins[axis] = pin;
+        updateSourceRange(axis);
         
         // Auto-register ADS1115 channels for round-robin reading
         if (pin >= 100 && pin <= 103) {
@@ -145,6 +143,13 @@ void AnalogAxisManager::setAxisPin(uint8_t axis, int8_t pin) {
     }
 }
 
+void AnalogAxisManager::setAxisAdcSampling(uint8_t axis, uint16_t rateHz, uint8_t oversampleLog2) {
+    if (axis < ANALOG_AXIS_COUNT && AdcSampler::isAdcPin(_axisPins[axis])) {
+        _adcSlots[axis] = g_adcSampler.addSlot((uint8_t)_axisPins[axis], rateHz, oversampleLog2);
+        updateSourceRange(axis);
+    }
+}
+
 int8_t AnalogAxisManager::getAxisPin(uint8_t axis) {
     if (axis < ANALOG_AXIS_COUNT) {
         return _axisPins[axis];
@@ -163,6 +168,8 @@ int32_t AnalogAxisManager::readAxisRaw(uint8_t axis) {
                 return adsLastValues[channel];
             }
             return 0;
+        } else if (_adcSlots[axis] != AdcSampler::NO_SLOT) {
+            return g_adcSampler.getValue(_adcSlots[axis]);
         } else {
             return analogRead(pin);
         }
@@ -173,69 +180,73 @@ int32_t AnalogAxisManager::readAxisRaw(uint8_t axis) {
 void AnalogAxisManager::readAllAxes() {
     static unsigned long lastReadTime = 0;
     unsigned long currentTime = millis();
+    int32_t raw[ANALOG_AXIS_COUNT];
+    uint8_t due = 0;
     
-    // Enforce consistent timing regardless of input source
-    // This ensures EWMA filtering behaves consistently
-    if (currentTime - lastReadTime < 5) {
-        return; // Skip this read cycle to maintain consistent timing
+    // Background ADC axes run the pipeline once per decimated sample, at their own rate
+    g_adcSampler.poll();
+    for (uint8_t i = 0; i < ANALOG_AXIS_COUNT; i++) {
+        if (isAxisEnabled(i) && _adcSlots[i] != AdcSampler::NO_SLOT &&
+            g_adcSampler.takeValue(_adcSlots[i], raw[i])) {
+            due |= (uint8_t)(1u << i);
+        }
     }
-    lastReadTime = currentTime;
     
-    // Perform round-robin ADS1115 reading to prevent encoder lag
+    // Keep the ADS1115 conversion pipeline moving every loop; this never blocks.
+    // ADS1115 axes run once per completed conversion, so their sample interval is real.
     performRoundRobinADS1115Read();
+    if (adsInitialized) {
+        for (uint8_t i = 0; i < ANALOG_AXIS_COUNT; i++) {
+            const int8_t pin = _axisPins[i];
+            if (!isAxisEnabled(i) || pin < 100 || pin > 103) continue;
+            const uint32_t count = adsSequencer.getSampleCount((uint8_t)(pin - 100));
+            if (count != adsTakenSamples[i]) {
+                adsTakenSamples[i] = count;
+                raw[i] = adsLastValues[pin - 100];
+                due |= (uint8_t)(1u << i);
+            }
+        }
+    }
     
-    // Read all axes (ADS1115 channels return cached values, analog pins read directly)
-    for (uint8_t i = 0; i < ANALOG_AXIS_COUNT; i++) {
-        if (isAxisEnabled(i) && _axisPins[i] >= 0) {
-            int32_t rawValue = readAxisRaw(i);
-            processAxisValue(i, rawValue);
+    // Enforce consistent timing for analogRead() pins
+    // This ensures EWMA filtering behaves consistently
+    if (currentTime - lastReadTime >= 5) {
+        lastReadTime = currentTime;
+        for (uint8_t i = 0; i < ANALOG_AXIS_COUNT; i++) {
+            const int8_t pin = _axisPins[i];
+            if (isAxisEnabled(i) && pin >= 0 && pin < 100 && _adcSlots[i] == AdcSampler::NO_SLOT) {
+                raw[i] = readAxisRaw(i);
+                due |= (uint8_t)(1u << i);
+            }
         }
     }
+    
+    if (due) _pipeline.process(due, raw, _axisValues, micros());
 }
 
-void initializeADS1115IfNeeded() {
+void initializeADS1115IfNeeded(uint8_t address, uint32_t i2cHz, uint16_t dataRateSps, int8_t readyPin) {
     if (!adsInitialized) {
-        ads.begin();
+        adsBus.begin(address, i2cHz, readyPin);
+        adsSequencer.begin(&adsBus, dataRateSps, readyPin >= 0);
         adsInitialized = true;
     }
 }
 
 void registerADS1115Channel(uint8_t channel) {
     if (channel > 3) return;
-    
-    // Check if channel is already registered
-    for (uint8_t i = 0; i < adsChannelCount; i++) {
-        if (adsChannelsInUse[i] == channel) return;
-    }
-    
-    // Add channel to the list if there's space
-    if (adsChannelCount < 4) {
-        adsChannelsInUse[adsChannelCount] = channel;
-        adsChannelCount++;
-        // Initialize with a reasonable center value
-        adsLastValues[channel] = 8192; // Mid-range for 16-bit ADC
+    if (adsSequencer.getSampleCount(channel) == 0) {
+        adsLastValues[channel] = 8192; // Mid-range until the first conversion completes
     }
+    adsSequencer.enableChannel(channel);
 }
 
 void performRoundRobinADS1115Read() {
-    if (!adsInitialized || adsChannelCount == 0) return;
-    
-    static unsigned long lastRoundRobinTime = 0;
-    unsigned long currentTime = millis();
+    if (!adsInitialized) return;
     
-    // Only read one channel per interval to prevent blocking
-    if (currentTime - lastRoundRobinTime >= adsRoundRobinInterval) {
-        uint8_t channel = adsChannelsInUse[adsRoundRobinIndex];
-        
-        // Read the current channel
-        int16_t val = ads.readADC_SingleEnded(channel);
-        if (val >= 0) { // Valid reading
-            adsLastValues[channel] = val;
-            adsLastReadTimes[channel] = currentTime;
+    // Queues/collects conversions as the hardware finishes them; never waits on the bus
+    if (adsSequencer.update(micros())) {
+        for (uint8_t ch = 0; ch < 4; ch++) {
+            if (adsSequencer.getSampleCount(ch)) adsLastValues[ch] = adsSequencer.getValue(ch);
         }
-        
-        // Move to next channel for next iteration
-        adsRoundRobinIndex = (adsRoundRobinIndex + 1) % adsChannelCount;
-        lastRoundRobinTime = currentTime;
     }
-}
\ No newline at end of file
+}
@@ -3,7 +3,6 @@
 
 #include <stdint.h>
 #include <Arduino.h>
-#include <Adafruit_ADS1X15.h>
 #include "AxisProcessing.h"
 
 // ADS1115 channel definitions
@@ -14,8 +13,8 @@
 
 #define ANALOG_AXIS_COUNT 8 // X, Y, Z, Rx, Ry, Rz, S1, S2
 
-// Forward declarations - actual implementations are in AxisProcessing.h
-// This keeps the interface clean while the processing logic is modularized
+// Signal processing lives in AxisProcessing.h (AxisPipeline); this class owns the
+// hardware sources and feeds all due axes through the pipeline in one pass
 
 class AnalogAxisManager {
 private:
@@ -28,16 +27,17 @@ private:
     // Current axis values
     int32_t _axisValues[ANALOG_AXIS_COUNT];
     
-    // Per-axis processing
-    AxisFilter _filters[ANALOG_AXIS_COUNT];
-    AxisCurve _curves[ANALOG_AXIS_COUNT];
-    AxisDeadband _deadbands[ANALOG_AXIS_COUNT];
+    // Processing chain for all axes (struct-of-arrays, fixed-point)
+    AxisPipeline _pipeline;
     
     // Axis enable flags
     uint8_t _enabledAxes = 0;
 
+    void updateSourceRange(uint8_t axis);
+
     // Pin assignments
     int8_t _axisPins[ANALOG_AXIS_COUNT];  // -1 = not assigned
+    uint8_t _adcSlots[ANALOG_AXIS_COUNT]; // AdcSampler slot, AdcSampler::NO_SLOT = analogRead
 
 public:
     enum AxisIndex { 
@@ -57,6 +57,8 @@ public:
     void setAxisEwmaAlpha(uint8_t axis, uint32_t alphaValue);
     void setAxisResponseCurve(uint8_t axis, ResponseCurveType type);
     void setAxisCustomCurve(uint8_t axis, const int32_t* table, uint8_t points);
+    void setAxisAdaptiveParams(uint8_t axis, uint16_t minCutoff, uint16_t beta, uint8_t dCutoff);
+    bool setAxisCurve(uint8_t axis, const AxisCurvePoint* points, uint8_t count, bool smooth, uint8_t lutLog2);
     
     // Deadband configuration
     void setAxisDeadbandSize(uint8_t axis, int32_t size);
@@ -65,6 +67,9 @@ public:
     void setAxisPin(uint8_t axis, int8_t pin);
     int8_t getAxisPin(uint8_t axis);
     
+    // Background ADC sampling for built-in pins (call after setAxisPin, before g_adcSampler.begin())
+    void setAxisAdcSampling(uint8_t axis, uint16_t rateHz, uint8_t oversampleLog2);
+    
     // Value processing
     int32_t processAxisValue(uint8_t axis, int32_t rawValue);
     int32_t getAxisValue(uint8_t axis);
@@ -85,10 +90,10 @@ public:
     }
 };
 
-// Function to initialize ADS1115 if needed
-void initializeADS1115IfNeeded();
+// Function to initialize ADS1115 if needed (readyPin < 0: ALERT/RDY not wired)
+void initializeADS1115IfNeeded(uint8_t address, uint32_t i2cHz, uint16_t dataRateSps, int8_t readyPin);
 
-// Functions for round-robin ADS1115 reading to prevent encoder lag
+// Non-blocking ADS1115 acquisition (see Ads1115Async.h); call every loop
 void registerADS1115Channel(uint8_t channel);
 void performRoundRobinADS1115Read();
 
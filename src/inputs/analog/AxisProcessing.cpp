@@ -1,246 +1,363 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "AxisProcessing.h"
+#include <string.h>
+#include <math.h>
+#include <new>
+
+static inline int32_t absDiff(int32_t a, int32_t b) { return (a > b) ? a - b : b - a; }
+
+// 1 - a for a first-order low-pass, a = r / (1 + r), r = 2 pi fc dt; Q15
+static inline uint32_t lowPassRetainQ15(uint32_t cutoffCHz, uint32_t dtUs) {
+    // r in Q16: cutoff (0.01 Hz) * dt (us) * 2 pi * 1e-8 * 2^16, constant scaled by 2^24
+    uint64_t r = ((uint64_t)cutoffCHz * dtUs * 69080u + (1u << 23)) >> 24;
+    if (r > 0x7FFF0000u) r = 0x7FFF0000u;
+    return 0x80000000u / (uint32_t)(r + 65536u);
+}
 
 // =============================================================================
-// AXIS FILTER IMPLEMENTATION
+// CONFIGURATION
 // =============================================================================
 
-void AxisFilter::reset() {
-    initialized = false;
-    ewmaFilter.reset();
+AxisPipeline::AxisPipeline() {
+    for (uint8_t a = 0; a < AXES; a++) {
+        _min[a] = 0;
+        _max[a] = 1023;
+        _sourceMax[a] = 1023;
+        _adMinCutoff[a] = ADAPTIVE_DEFAULT_MIN_CUTOFF;
+        _adBeta[a] = ADAPTIVE_DEFAULT_BETA;
+        _adDCutoff[a] = ADAPTIVE_DEFAULT_D_CUTOFF;
+        updateScales(a);
+
+        _dbSize[a] = 0;
+        _dbSumLimit[a] = DEADBAND_HISTORY;
+        _dbSettleMs[a] = 150;
+        _dbIntervalUs[a] = (150 / DEADBAND_HISTORY) * 1000u;
+
+        _filterLevel[a] = AXIS_FILTER_EWMA;
+        setEwmaAlpha(a, 30);
+
+        _lut[a] = nullptr;
+        _lutLog2[a] = 0;
+        _lutShift[a] = 0;
+
+        reset(a);
+    }
+}
+
+AxisPipeline::~AxisPipeline() {
+    for (uint8_t a = 0; a < AXES; a++) delete[] _lut[a];
+}
+
+void AxisPipeline::updateScales(uint8_t axis) {
+    const int32_t span = _max[axis] - _min[axis];
+    const uint32_t spanAbs = (uint32_t)((span < 0) ? -span : span);
+    _spanSign[axis] = (span < 0) ? -1 : 1;
+    _inScale[axis].set(spanAbs, (uint32_t)((_sourceMax[axis] > 0) ? _sourceMax[axis] : 0));
+    _outScale[axis].set(2 * OUTPUT_MAX, spanAbs);
+    updateAdaptive(axis);
+}
+
+void AxisPipeline::updateAdaptive(uint8_t axis) {
+    const int32_t span = _max[axis] - _min[axis];
+    const uint32_t spanAbs = (uint32_t)((span < 0) ? -span : ((span == 0) ? 1 : span));
+    const uint64_t betaK = ((uint64_t)_adBeta[axis] << 16) / spanAbs;
+    _adBetaK[axis] = (betaK > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)betaK;
+    _adDCutoffCHz[axis] = _adDCutoff[axis] * 10u;
+    _adDGain[axis] = (_adDCutoff[axis] * 411775u + 5u) / 10u; // 2 pi * 2^16 / 10 per step
+}
+
+void AxisPipeline::setSourceMax(uint8_t axis, int32_t sourceMax) {
+    if (axis >= AXES) return;
+    _sourceMax[axis] = sourceMax;
+    updateScales(axis);
+}
+
+void AxisPipeline::setRange(uint8_t axis, int32_t minimum, int32_t maximum) {
+    if (axis >= AXES) return;
+    _min[axis] = minimum;
+    _max[axis] = maximum;
+    updateScales(axis);
 }
 
-int32_t AxisFilter::filter(int32_t rawValue) {
-    // If filtering is disabled, pass through raw value
-    if (filterLevel == AXIS_FILTER_OFF) return rawValue;
-    
-    // Handle EWMA filtering
-    if (filterLevel == AXIS_FILTER_EWMA) {
-        return ewmaFilter.filter(rawValue);
+void AxisPipeline::setDeadbandSize(uint8_t axis, int32_t size) {
+    if (axis >= AXES) return;
+    _dbSize[axis] = (size > 0) ? size : 0;
+    // floor(sum / HISTORY) <= size / 8  <=>  sum < (size / 8 + 1) * HISTORY
+    _dbSumLimit[axis] = (_dbSize[axis] / 8 + 1) * DEADBAND_HISTORY;
+}
+
+void AxisPipeline::setSettleDuration(uint8_t axis, uint32_t durationMs) {
+    if (axis >= AXES) return;
+    _dbSettleMs[axis] = durationMs;
+    _dbIntervalUs[axis] = (durationMs / DEADBAND_HISTORY) * 1000u;
+}
+
+void AxisPipeline::setFilterLevel(uint8_t axis, AxisFilterLevel level) {
+    if (axis >= AXES) return;
+    _filterLevel[axis] = (uint8_t)level;
+    if (level == AXIS_FILTER_EWMA) setEwmaAlpha(axis, 30); // Default alpha = 0.03 (30/1000)
+    _ewmaInit[axis] = false;
+}
+
+void AxisPipeline::setEwmaAlpha(uint8_t axis, uint32_t alphaValue) {
+    if (axis >= AXES) return;
+    if (alphaValue <= EWMA_ALPHA_SCALE) {
+        _ewmaAlpha[axis] = alphaValue;
+        _ewmaCoeff[axis] = (((int64_t)alphaValue << 32) + EWMA_ALPHA_SCALE / 2) / EWMA_ALPHA_SCALE;
     }
-    
-    // Default fallback (should not be reached)
-    return rawValue;
-}
-
-void AxisFilter::setLevel(AxisFilterLevel level) {
-    filterLevel = level;
-    
-    // Set parameters based on filter level
-    switch (level) {
-        case AXIS_FILTER_OFF:
-            // No filtering - pass through
-            break;
-            
-        case AXIS_FILTER_EWMA:
-            ewmaFilter.setAlpha(30); // Default alpha = 0.03 (30/1000)
-            break;
+    _ewmaInit[axis] = false; // clean transition
+}
+
+void AxisPipeline::setAdaptiveParams(uint8_t axis, uint16_t minCutoff, uint16_t beta, uint8_t dCutoff) {
+    if (axis >= AXES) return;
+    _adMinCutoff[axis] = minCutoff ? minCutoff : ADAPTIVE_DEFAULT_MIN_CUTOFF;
+    _adBeta[axis] = beta;
+    _adDCutoff[axis] = dCutoff ? dCutoff : ADAPTIVE_DEFAULT_D_CUTOFF;
+    updateAdaptive(axis);
+    _ewmaInit[axis] = false;
+}
+
+void AxisPipeline::setCustomCurve(uint8_t axis, const int32_t* table, uint8_t points) {
+    if (axis >= AXES || table == nullptr || points < 2 || points > MAX_CURVE_POINTS) return;
+    AxisCurvePoint pts[MAX_CURVE_POINTS];
+    for (uint8_t i = 0; i < points; i++) {
+        const int32_t y = table[i];
+        pts[i].x = (uint16_t)((i * CURVE_INPUT_MAX) / (points - 1));
+        pts[i].y = (uint16_t)((y < 0) ? 0 : ((y > CURVE_INPUT_MAX) ? CURVE_INPUT_MAX : y));
     }
-    
-    // Reset filter state when level changes
-    reset();
+    setCurve(axis, pts, points, false, 0);
 }
 
+bool AxisPipeline::setCurve(uint8_t axis, const AxisCurvePoint* points, uint8_t count, bool smooth, uint8_t lutLog2) {
+    if (axis >= AXES) return false;
+    if (lutLog2 == 0) lutLog2 = CURVE_LUT_LOG2_DEFAULT;
+    if (lutLog2 < CURVE_LUT_LOG2_MIN || lutLog2 > CURVE_LUT_LOG2_MAX) return false;
 
-void AxisFilter::setEwmaAlpha(uint32_t alphaValue) {
-    ewmaFilter.setAlpha(alphaValue);
+    // Reallocate only when the resolution changes (configuration time)
+    if (_lut[axis] == nullptr || _lutLog2[axis] != lutLog2) {
+        delete[] _lut[axis];
+        _lut[axis] = new (std::nothrow) uint16_t[(1u << lutLog2) + 1];
+        _lutLog2[axis] = lutLog2;
+        _lutShift[axis] = (uint8_t)(CURVE_INPUT_BITS - lutLog2);
+    }
+    if (_lut[axis] == nullptr || !compileCurve(points, count, smooth, lutLog2, _lut[axis])) {
+        clearCurve(axis);
+        return false;
+    }
+    return true;
 }
 
-// =============================================================================
-// AXIS CURVE IMPLEMENTATION
-// =============================================================================
+void AxisPipeline::clearCurve(uint8_t axis) {
+    if (axis >= AXES) return;
+    delete[] _lut[axis];
+    _lut[axis] = nullptr;
+    _lutLog2[axis] = 0;
+    _lutShift[axis] = 0;
+}
+
+bool AxisPipeline::compileCurve(const AxisCurvePoint* points, uint8_t count, bool smooth,
+                                uint8_t lutLog2, uint16_t* lut) {
+    if (points == nullptr || lut == nullptr || count < 2 || count > MAX_CURVE_POINTS) return false;
+    if (lutLog2 < CURVE_LUT_LOG2_MIN || lutLog2 > CURVE_LUT_LOG2_MAX) return false;
+    for (uint8_t i = 0; i < count; i++) {
+        if (points[i].x > CURVE_INPUT_MAX || points[i].y > CURVE_INPUT_MAX) return false;
+        if (i && points[i].x <= points[i - 1].x) return false;
+    }
 
-int32_t AxisCurve::apply(int32_t input) {
-    // All curves now use custom table (EEPROM-stored configuration)
-    const int32_t* table = customTable;
-    
-    // Perform linear interpolation between curve points
-    // Use the actual input range from the user configuration (0-32767)
-    int32_t maxInput = 32767; // User-defined range
-    int32_t idx = (input * (points - 1)) / maxInput;
-    
-    // Clamp to valid index range
-    if (idx >= points - 1) return table[points - 1];
-    if (idx < 0) return table[0];
-    
-    // Calculate interpolation points
-    int32_t x0 = (idx * maxInput) / (points - 1);
-    int32_t x1 = ((idx + 1) * maxInput) / (points - 1);
-    int32_t y0 = table[idx];
-    int32_t y1 = table[idx + 1];
-    
-    // Handle edge case where x0 == x1
-    if (x1 == x0) return y0;
-    
-    // Linear interpolation: y = y0 + (input - x0) * (y1 - y0) / (x1 - x0)
-    return y0 + (input - x0) * (y1 - y0) / (x1 - x0);
-}
-
-void AxisCurve::setType(ResponseCurveType newType) {
-    // Only CURVE_CUSTOM is supported now
-    type = CURVE_CUSTOM;
-}
-
-void AxisCurve::setCustomCurve(const int32_t* newTable, uint8_t newPoints) {
-    // Validate input parameters
-    if (newPoints > 1 && newPoints <= 11 && newTable != nullptr) {
-        // Copy the new curve points
-        for (uint8_t i = 0; i < newPoints; ++i) {
-            customTable[i] = newTable[i];
+    // Segment slopes, and tangents at the points for the smooth variant. Interior tangents
+    // are the weighted harmonic mean of the neighbouring slopes (zero at a local extremum),
+    // which keeps every segment monotone so the curve cannot overshoot its control points.
+    float slope[MAX_CURVE_POINTS - 1];
+    float tangent[MAX_CURVE_POINTS];
+    for (uint8_t k = 0; k + 1 < count; k++) {
+        slope[k] = (float)(points[k + 1].y - points[k].y) / (float)(points[k + 1].x - points[k].x);
+    }
+    tangent[0] = slope[0];
+    tangent[count - 1] = slope[count - 2];
+    for (uint8_t k = 1; k + 1 < count; k++) {
+        const float d0 = slope[k - 1], d1 = slope[k];
+        if (d0 * d1 <= 0.0f) { tangent[k] = 0.0f; continue; }
+        const float h0 = (float)(points[k].x - points[k - 1].x);
+        const float h1 = (float)(points[k + 1].x - points[k].x);
+        const float w0 = 2.0f * h1 + h0, w1 = h1 + 2.0f * h0;
+        tangent[k] = (w0 + w1) / (w0 / d0 + w1 / d1);
+    }
+
+    const uint32_t entries = (1u << lutLog2) + 1;
+    const uint8_t shift = (uint8_t)(CURVE_INPUT_BITS - lutLog2);
+    uint8_t k = 0;
+    for (uint32_t i = 0; i < entries; i++) {
+        uint32_t x = i << shift;
+        if (x > (uint32_t)CURVE_INPUT_MAX) x = CURVE_INPUT_MAX;
+
+        float y;
+        if (x <= points[0].x) {
+            y = points[0].y;
+        } else if (x >= points[count - 1].x) {
+            y = points[count - 1].y;
+        } else {
+            while (x > points[k + 1].x) k++;
+            const float h = (float)(points[k + 1].x - points[k].x);
+            const float t = (float)(x - points[k].x) / h;
+            const float y0 = points[k].y, y1 = points[k + 1].y;
+            if (smooth) {
+                const float t2 = t * t, t3 = t2 * t;
+                y = (2.0f * t3 - 3.0f * t2 + 1.0f) * y0 + (t3 - 2.0f * t2 + t) * h * tangent[k] +
+                    (3.0f * t2 - 2.0f * t3) * y1 + (t3 - t2) * h * tangent[k + 1];
+            } else {
+                y = y0 + t * (y1 - y0);
+            }
         }
-        points = newPoints;
-        type = CURVE_CUSTOM;
+        const int32_t r = (int32_t)lroundf(y);
+        lut[i] = (uint16_t)((r < 0) ? 0 : ((r > CURVE_INPUT_MAX) ? CURVE_INPUT_MAX : r));
     }
+    return true;
+}
+
+void AxisPipeline::reset(uint8_t axis) {
+    if (axis >= AXES) return;
+    _dbFlags[axis] = 0;
+    _dbLastInput[axis] = 0;
+    _dbStable[axis] = 0;
+    _dbLastUs[axis] = 0;
+    memset(_dbHistory[axis], 0, sizeof(_dbHistory[axis]));
+    _dbSum[axis] = 0;
+    _dbIndex[axis] = 0;
+    _dbSamples[axis] = 0;
+    _ewmaAcc[axis] = 0;
+    _ewmaInit[axis] = false;
+    _adVelocity[axis] = 0;
+    _adLastUs[axis] = 0;
 }
 
 // =============================================================================
-// AXIS DEADBAND IMPLEMENTATION
+// PROCESSING
 // =============================================================================
 
-int32_t AxisDeadband::apply(int32_t input) {
-    // If deadband is disabled, pass through unchanged
-    if (deadbandSize <= 0) {
-        return input;
-    }
-    
-    uint32_t currentTime = millis();
-    
-    // Initialize with first input value
-    if (!initialized) {
-        lastInput = input;
-        stableValue = input;
-        lastSampleTime = currentTime;
-        deadbandActive = false;
-        capturedStableValue = false;
-        initialized = true;
-        return input;
+void AxisPipeline::process(uint8_t mask, const int32_t* raw, int32_t* out, uint32_t nowUs) {
+    int32_t v[AXES];
+
+    // Raw hardware range -> user range, clamped
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint8_t a = (uint8_t)__builtin_ctz(m);
+        int32_t u = _min[a] + _spanSign[a] * _inScale[a].applySigned(raw[a]);
+        const int32_t lo = _min[a], hi = _max[a];
+        v[a] = (u < lo) ? lo : ((u > hi) ? hi : u);
     }
-    
-    // Sample movement at regular intervals for statistical analysis
-    if (currentTime - lastSampleTime >= (settleDuration / HISTORY_SIZE)) {
-        // Calculate movement since last reading
-        int32_t movement = abs(input - lastInput);
-        
-        // Add to movement history (ring buffer)
-        movementHistory[historyIndex] = movement;
-        historyIndex = (historyIndex + 1) % HISTORY_SIZE;
-        if (historySamples < HISTORY_SIZE) {
-            historySamples++;
+
+    // Deadband on the mapped signal, before filtering and curves
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint8_t a = (uint8_t)__builtin_ctz(m);
+        if (_dbSize[a] <= 0) continue;
+        const int32_t input = v[a];
+
+        if (!(_dbFlags[a] & DB_INIT)) {
+            _dbLastInput[a] = input;
+            _dbStable[a] = input;
+            _dbLastUs[a] = nowUs;
+            _dbFlags[a] = DB_INIT;
+            continue;
         }
-        
-        lastSampleTime = currentTime;
-        lastInput = input;
-        
-        // Only evaluate deadband state when we have sufficient samples
-        if (historySamples >= HISTORY_SIZE) {
-            int32_t avgMovement = getAverageMovement();
-            int32_t movementThreshold = deadbandSize / 8; // More sensitive threshold
-            
-            if (avgMovement <= movementThreshold) {
-                // Low average movement detected
-                if (!capturedStableValue) {
-                    // First time detecting minimal movement - capture the stable value now
-                    stableValue = input;
-                    capturedStableValue = true;
-                }
-                
-                // Activate deadband if not already active
-                if (!deadbandActive) {
-                    deadbandActive = true;
+
+        // Sample movement at regular intervals for the settled-state decision
+        if (nowUs - _dbLastUs[a] >= _dbIntervalUs[a]) {
+            const int32_t movement = absDiff(input, _dbLastInput[a]);
+            uint8_t idx = _dbIndex[a];
+            _dbSum[a] += movement - _dbHistory[a][idx];
+            _dbHistory[a][idx] = movement;
+            _dbIndex[a] = (uint8_t)((idx + 1 == DEADBAND_HISTORY) ? 0 : idx + 1);
+            if (_dbSamples[a] < DEADBAND_HISTORY) _dbSamples[a]++;
+            _dbLastUs[a] = nowUs;
+            _dbLastInput[a] = input;
+
+            if (_dbSamples[a] >= DEADBAND_HISTORY) {
+                if (_dbSum[a] < _dbSumLimit[a]) {
+                    // Capture the hold value once per settle period
+                    if (!(_dbFlags[a] & DB_CAPTURED)) _dbStable[a] = input;
+                    _dbFlags[a] |= DB_CAPTURED | DB_ACTIVE;
+                } else {
+                    _dbFlags[a] &= (uint8_t)~(DB_CAPTURED | DB_ACTIVE);
                 }
+            }
+        }
+
+        if (_dbFlags[a] & DB_ACTIVE) {
+            if (absDiff(input, _dbStable[a]) > _dbSize[a]) {
+                // Large movement: release immediately and restart the movement history
+                _dbFlags[a] &= (uint8_t)~(DB_CAPTURED | DB_ACTIVE);
+                _dbStable[a] = input;
+                _dbSamples[a] = 0;
+                _dbIndex[a] = 0;
             } else {
-                // High average movement - deactivate deadband and reset capture flag
-                deadbandActive = false;
-                capturedStableValue = false;
+                v[a] = _dbStable[a];
             }
         }
     }
-    
-    // Return appropriate value based on deadband state
-    if (deadbandActive) {
-        // Deadband is active - check if movement exceeds threshold
-        if (abs(input - stableValue) > deadbandSize) {
-            // Large movement - deactivate deadband immediately
-            deadbandActive = false;
-            capturedStableValue = false;
-            stableValue = input;
-            // Clear movement history to avoid lag in reactivation
-            historySamples = 0;
-            historyIndex = 0;
-            return input;
-        } else {
-            // Small movement - maintain stable value
-            return stableValue;
+
+    // EWMA: acc += alpha * (input - acc), Q12 state with a rounded Q32 step
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint8_t a = (uint8_t)__builtin_ctz(m);
+        if (_filterLevel[a] != AXIS_FILTER_EWMA) continue;
+        const int32_t in = v[a] * (1 << EWMA_FRACTION_BITS);
+        if (!_ewmaInit[a]) {
+            _ewmaAcc[a] = in;
+            _ewmaInit[a] = true;
+            continue;
         }
-    } else {
-        // Deadband not active - pass through input
-        return input;
+        const int64_t step = ((int64_t)(in - _ewmaAcc[a]) * _ewmaCoeff[a] + (1LL << 31)) >> 32;
+        _ewmaAcc[a] += (int32_t)step;
+        v[a] = (_ewmaAcc[a] + (1 << (EWMA_FRACTION_BITS - 1))) >> EWMA_FRACTION_BITS;
     }
-}
 
-void AxisDeadband::setSize(int32_t size) {
-    deadbandSize = max(0, size); // Ensure non-negative
-}
+    // Adaptive (1-Euro): velocity-driven cutoff, coefficients from the measured interval
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint8_t a = (uint8_t)__builtin_ctz(m);
+        if (_filterLevel[a] != AXIS_FILTER_ADAPTIVE) continue;
+        const int32_t in = v[a] * (1 << EWMA_FRACTION_BITS);
+        if (!_ewmaInit[a]) {
+            _ewmaAcc[a] = in;
+            _adVelocity[a] = 0;
+            _adLastUs[a] = nowUs;
+            _ewmaInit[a] = true;
+            continue;
+        }
+        uint32_t dt = nowUs - _adLastUs[a];
+        _adLastUs[a] = nowUs;
+        if (dt == 0) dt = 1;
+        if (dt > ADAPTIVE_MAX_DT_US) dt = ADAPTIVE_MAX_DT_US;
 
-void AxisDeadband::setSettleDuration(uint32_t duration) {
-    settleDuration = duration;
-}
+        // v' += ad * ((x - x')/dt - v')  ==  v' = (1 - ad) * (v' + 2 pi fd * (x - x'))
+        const int32_t delta = in - _ewmaAcc[a];
+        const int32_t drive = (int32_t)(((int64_t)delta * _adDGain[a]) >> (16 + EWMA_FRACTION_BITS));
+        const uint32_t retainD = lowPassRetainQ15(_adDCutoffCHz[a], dt);
+        const int32_t vel = (int32_t)(((int64_t)(_adVelocity[a] + drive) * retainD) >> 15);
+        _adVelocity[a] = vel;
 
-void AxisDeadband::reset() {
-    initialized = false;
-    lastInput = 0;
-    stableValue = 0;
-    lastSampleTime = 0;
-    deadbandActive = false;
-    capturedStableValue = false;
-    historyIndex = 0;
-    historySamples = 0;
-    for (uint8_t i = 0; i < HISTORY_SIZE; i++) {
-        movementHistory[i] = 0;
+        uint64_t cutoff = _adMinCutoff[a] + (((uint64_t)(uint32_t)((vel < 0) ? -vel : vel) * _adBetaK[a]) >> 16);
+        if (cutoff > 0xFFFFFu) cutoff = 0xFFFFFu; // 10 kHz: a -> 1 for any realistic dt
+        const int32_t alpha = 32768 - (int32_t)lowPassRetainQ15((uint32_t)cutoff, dt);
+        _ewmaAcc[a] += (int32_t)(((int64_t)delta * alpha + (1 << 14)) >> 15);
+        v[a] = (_ewmaAcc[a] + (1 << (EWMA_FRACTION_BITS - 1))) >> EWMA_FRACTION_BITS;
     }
-}
 
-int32_t AxisDeadband::getAverageMovement() const {
-    if (historySamples == 0) return 0;
-    
-    int32_t sum = 0;
-    for (uint8_t i = 0; i < historySamples; i++) {
-        sum += movementHistory[i];
+    // Response curve: one table read and a linear interpolation between adjacent entries
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint8_t a = (uint8_t)__builtin_ctz(m);
+        const uint16_t* lut = _lut[a];
+        int32_t x = v[a];
+        if (x < 0) x = 0;
+        if (!lut) { v[a] = (x > CURVE_INPUT_MAX) ? CURVE_INPUT_MAX : x; continue; }
+        if (x >= CURVE_INPUT_MAX) { v[a] = lut[1u << _lutLog2[a]]; continue; }
+        const uint8_t shift = _lutShift[a];
+        const uint32_t idx = (uint32_t)x >> shift;
+        const int32_t y0 = lut[idx];
+        const int32_t frac = x & ((1 << shift) - 1);
+        v[a] = y0 + (((lut[idx + 1] - y0) * frac) >> shift);
     }
-    return sum / historySamples;
-}
-
-// =============================================================================
-// EWMA FILTER IMPLEMENTATION
-// =============================================================================
 
-void EwmaFilter::reset() {
-    lastOutput = 0;
-    initialized = false;
-}
-
-int32_t EwmaFilter::filter(int32_t input) {
-    // Initialize filter on first run
-    if (!initialized) {
-        lastOutput = input;
-        initialized = true;
-        return input;
+    // User range -> -32767..32767
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint8_t a = (uint8_t)__builtin_ctz(m);
+        out[a] = -OUTPUT_MAX + _spanSign[a] * _outScale[a].applySigned(v[a] - _min[a]);
     }
-    
-    // Apply EWMA formula: output = alpha * input + (1 - alpha) * lastOutput
-    // Using integer arithmetic: output = (alpha * input + (alphaScale - alpha) * lastOutput) / alphaScale
-    int32_t output = (alpha * input + (alphaScale - alpha) * lastOutput) / alphaScale;
-    
-    lastOutput = output;
-    return output;
-}
-
-void EwmaFilter::setAlpha(uint32_t alphaValue) {
-    // Clamp alpha to valid range [0, alphaScale]
-    if (alphaValue <= alphaScale) {
-        alpha = alphaValue;
-    }
-    
-    // Reset filter when alpha changes for clean transition
-    reset();
-}
\ No newline at end of file
+}
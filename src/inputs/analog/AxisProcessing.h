@@ -3,21 +3,29 @@
 #define AXIS_PROCESSING_H
 
 #include <stdint.h>
-#include <Arduino.h>
 
 /**
  * @file AxisProcessing.h
- * @brief Analog axis signal processing library for joystick controllers
+ * @brief Analog axis signal processing for joystick controllers
  *
- * This library provides signal processing capabilities for analog axes including:
- * - EWMA (Exponentially Weighted Moving Average) filtering
- * - Deadband filtering to eliminate jitter at rest
- * - Custom response curve shaping
+ * AxisPipeline runs the per-sample chain for all axes:
+ *   raw -> user range -> deadband -> filter (EWMA / adaptive) -> response curve -> HID range
  *
- * The processing components can be used independently:
- * - EwmaFilter: Smooth filtering with configurable responsiveness
- * - AxisDeadband: Eliminates small fluctuations when control is at rest
- * - AxisCurve: Applies custom response curves to axis values
+ * Everything that depends only on configuration (range scale factors, EWMA coefficient,
+ * deadband thresholds, the response curve) is precomputed when a setter is called, so
+ * processing uses multiplies, shifts and compares only. The exception is the adaptive filter,
+ * whose coefficients depend on the measured sample interval: it needs two 32-bit divisions
+ * per sample (the RP2040 hardware divider). Response curves are
+ * compiled from their control points into a dense lookup table (2^n + 1 entries, n = 8..12)
+ * and cost one table read plus a linear interpolation per sample.
+ * State is kept as struct-of-arrays and process() walks one stage at a time over every
+ * axis with a new sample. The range, deadband and output stages keep the truncation of the
+ * previous map() code (within 1 LSB at the HID output). A custom curve goes through the
+ * compiled table, so it differs from the old point-to-point interpolation by up to the
+ * table's interpolation error near breakpoints (tens of LSB with the default table). The
+ * EWMA keeps a fractional accumulator instead of truncating its state.
+ *
+ * No Arduino dependency: the caller supplies the time base (host-testable).
  */
 
 // =============================================================================
@@ -36,271 +44,194 @@ enum ResponseCurveType {
  */
 enum AxisFilterLevel {
     AXIS_FILTER_OFF,    ///< No filtering (raw values pass through)
-    AXIS_FILTER_EWMA    ///< EWMA (Exponentially Weighted Moving Average) filtering
+    AXIS_FILTER_EWMA,   ///< EWMA (Exponentially Weighted Moving Average) filtering
+    AXIS_FILTER_ADAPTIVE ///< 1-Euro filter: cutoff rises with the measured signal velocity
 };
 
 // =============================================================================
-// EWMA FILTER CLASS
+// FIXED-POINT RATIO
 // =============================================================================
 
 /**
- * @brief Exponentially Weighted Moving Average filter
- * 
- * EWMA filter provides smooth, responsive filtering with significantly less memory
- * usage compared to traditional moving average filters. Based on jonnieZG/EWMA.
- * 
- * Formula: output = alpha * input + (1 - alpha) * lastOutput
- * 
- * Features:
- * - Memory efficient (no history buffer required)
- * - Configurable alpha parameter for smoothing control
- * - Integer-only arithmetic to avoid floating point operations
- * - Automatic initialization on first reading
+ * @brief Precomputed floor(x * num / den) as a multiply and a shift
+ *
+ * k = floor(num * 2^32 / den) + 1 gives the exact quotient whenever x * den < 2^32,
+ * which holds for all axis values (x, den <= 65535). Negative x truncates toward zero
+ * like C integer division.
  */
-class EwmaFilter {
-private:
-    int32_t lastOutput = 0;        ///< Previous filtered output value
-    uint32_t alpha = 30;           ///< Smoothing factor scaled by 1000 (0-1000 range)
-    uint32_t alphaScale = 1000;    ///< Scale factor for integer arithmetic
-    bool initialized = false;      ///< Whether filter has received first value
-    
-public:
-    /**
-     * @brief Constructor with alpha parameter
-     * @param alphaValue Alpha value scaled by 1000 (e.g., 100 = 0.1 alpha)
-     */
-    EwmaFilter(uint32_t alphaValue = 30) : alpha(alphaValue) {}
-    
-    /**
-     * @brief Reset filter to initial state
-     */
-    void reset();
-    
-    /**
-     * @brief Filter input value using EWMA algorithm
-     * @param input Raw input value
-     * @return Filtered output value
-     */
-    int32_t filter(int32_t input);
-    
-    /**
-     * @brief Set alpha smoothing factor
-     * @param alphaValue Alpha value scaled by 1000 (0-1000 range)
-     * 
-     * Higher values = less smoothing (more responsive)
-     * Lower values = more smoothing (less responsive)
-     * 
-     * Common values:
-     * - 100 (0.1) = Heavy smoothing, approximately averages last 10 readings
-     * - 200 (0.2) = Moderate smoothing, approximately averages last 5 readings  
-     * - 500 (0.5) = Light smoothing, approximately averages last 2 readings
-     */
-    void setAlpha(uint32_t alphaValue);
-    
-    /**
-     * @brief Get current alpha value
-     * @return Alpha value scaled by 1000
-     */
-    uint32_t getAlpha() const { return alpha; }
-    
-    /**
-     * @brief Get last filtered output
-     * @return Last output value
-     */
-    int32_t getOutput() const { return lastOutput; }
-};
+struct AxisRatio {
+    uint64_t k = 0;
 
-// =============================================================================
-// AXIS FILTER CLASS
-// =============================================================================
+    void set(uint32_t num, uint32_t den) {
+        k = den ? (((uint64_t)num << 32) / den) + 1 : 0;
+    }
+    uint32_t apply(uint32_t x) const {
+        return (uint32_t)(((uint64_t)x * k) >> 32);
+    }
+    int32_t applySigned(int32_t x) const {
+        return (x < 0) ? -(int32_t)apply((uint32_t)-x) : (int32_t)apply((uint32_t)x);
+    }
+};
 
 /**
- * @brief Filtering for analog axis values
- *
- * This class provides simple filtering for analog axis values:
- * - No filtering (raw values pass through)
- * - EWMA (Exponentially Weighted Moving Average) filtering
- *
- * The filter can be configured to use EWMA filtering for smoothing
- * or bypass filtering entirely for maximum responsiveness.
+ * @brief Response curve control point, both coordinates in 0..32767
  */
-class AxisFilter {
-private:
-    bool initialized = false;         ///< Whether filter has been initialized
-    
-    // Filter parameters
-    AxisFilterLevel filterLevel = AXIS_FILTER_EWMA; ///< Current filter level
-    
-    // EWMA filter instance
-    EwmaFilter ewmaFilter;            ///< EWMA filter for when AXIS_FILTER_EWMA is selected
-
-public:
-    /**
-     * @brief Reset filter to initial state
-     */
-    void reset();
-    
-    /**
-     * @brief Process a raw axis value through the filter
-     * @param rawValue Raw input value from ADC
-     * @return Filtered and smoothed output value
-     */
-    int32_t filter(int32_t rawValue);
-    
-    /**
-     * @brief Set filter level
-     * @param level Filter level (OFF or EWMA)
-     */
-    void setLevel(AxisFilterLevel level);
-    
-    
-    /**
-     * @brief Set EWMA alpha parameter
-     * @param alphaValue Alpha value scaled by 1000 (0-1000 range)
-     * 
-     * Only applies when filter level is set to AXIS_FILTER_EWMA
-     */
-    void setEwmaAlpha(uint32_t alphaValue);
-    
-    // Getters for current settings
-    AxisFilterLevel getFilterLevel() const { return filterLevel; }
-    uint32_t getEwmaAlpha() const { return ewmaFilter.getAlpha(); }
+struct AxisCurvePoint {
+    uint16_t x;
+    uint16_t y;
 };
 
 // =============================================================================
-// AXIS DEADBAND CLASS
+// AXIS PIPELINE
 // =============================================================================
 
 /**
- * @brief Deadband filter for analog axes
- * 
- * Prevents small fluctuations around the current axis position when the user
- * stops moving the control. This eliminates jitter and provides stability:
- * - Uses rolling average of movement to detect settled state
- * - Activates deadband only when average movement is consistently low
- * - Maintains smooth movement during active control
- * - Stabilizes position when control is at rest
- * - Compatible with EWMA and other filtering
- * 
- * The deadband uses statistical analysis to avoid interfering with slow movements.
+ * @brief Struct-of-arrays processing chain for up to AXES analog axes
+ *
+ * Stages per axis (same order and integer semantics as the former per-axis classes):
+ * - Range: raw 0..sourceMax mapped to the user range and clamped
+ * - Deadband: holds the value when average movement over the settle window is low
+ * - Filter: EWMA with alpha in 1/1000, as a Q32 coefficient on a Q12 accumulator, or the
+ *   adaptive 1-Euro filter (below)
+ * - Curve: lookup table over 0..32767 (identity when no curve is set)
+ * - Output: user range mapped to -32767..32767
+ *
+ * Adaptive filter (1-Euro, Casiez et al. 2012), per sample with the real interval dt:
+ *   dx'  = low-pass(dx/dt) at dCutoff           (velocity in user-range units per second)
+ *   fc   = minCutoff + beta * |dx'| / span      (span = |maximum - minimum|, i.e. full scale)
+ *   x'   = x' + a(fc, dt) * (x - x'),  a = r / (1 + r),  r = 2 pi fc dt
+ * At rest fc stays at minCutoff (heavy smoothing); fast moves raise it (little lag).
  */
-class AxisDeadband {
-private:
-    static constexpr uint8_t HISTORY_SIZE = 10;  ///< Number of samples for movement analysis
-    
-    int32_t deadbandSize = 0;         ///< Size of deadband (0 = disabled)
-    int32_t lastInput = 0;            ///< Previous input value
-    int32_t stableValue = 0;          ///< Value to hold when deadband is active
-    uint32_t settleDuration = 150;    ///< Time to wait before activating deadband (ms)
-    bool deadbandActive = false;      ///< Whether deadband is currently active
-    bool initialized = false;         ///< Whether filter has been initialized
-    
-    // Movement history for statistical analysis
-    int32_t movementHistory[HISTORY_SIZE] = {0}; ///< Ring buffer of recent movements
-    uint8_t historyIndex = 0;         ///< Current position in ring buffer
-    uint8_t historySamples = 0;       ///< Number of samples collected
-    uint32_t lastSampleTime = 0;      ///< Time of last sample
-    
-    // Stable value capture
-    bool capturedStableValue = false; ///< Whether we've captured the stable value for this settle period
-    
+class AxisPipeline {
 public:
+    static constexpr uint8_t AXES = 8;
+    static constexpr uint8_t MAX_CURVE_POINTS = 16;
+    static constexpr int32_t CURVE_INPUT_MAX = 32767;
+    static constexpr uint8_t CURVE_INPUT_BITS = 15;
+    static constexpr uint8_t CURVE_LUT_LOG2_MIN = 8;       ///< 257 entries
+    static constexpr uint8_t CURVE_LUT_LOG2_MAX = 12;      ///< 4097 entries
+    static constexpr uint8_t CURVE_LUT_LOG2_DEFAULT = 10;  ///< 1025 entries
+    static constexpr int32_t OUTPUT_MAX = 32767;
+    static constexpr uint8_t DEADBAND_HISTORY = 10;   ///< Movement samples per settle window
+    static constexpr uint8_t EWMA_FRACTION_BITS = 12;
+    static constexpr uint32_t EWMA_ALPHA_SCALE = 1000;
+    static constexpr uint32_t ADAPTIVE_MAX_DT_US = 100000;        ///< longer gaps count as 100 ms
+    static constexpr uint16_t ADAPTIVE_DEFAULT_MIN_CUTOFF = 100;  ///< 1.00 Hz (0.01 Hz units)
+    static constexpr uint16_t ADAPTIVE_DEFAULT_BETA = 2000;       ///< 20.00 Hz per full scale/s
+    static constexpr uint8_t ADAPTIVE_DEFAULT_D_CUTOFF = 10;      ///< 1.0 Hz (0.1 Hz units)
+
+    AxisPipeline();
+    ~AxisPipeline();
+    AxisPipeline(const AxisPipeline&) = delete;
+    AxisPipeline& operator=(const AxisPipeline&) = delete;
+
+    // Configuration (precomputes the fixed-point form; resets that stage's state)
+    void setSourceMax(uint8_t axis, int32_t sourceMax);
+    void setRange(uint8_t axis, int32_t minimum, int32_t maximum);
+    void setDeadbandSize(uint8_t axis, int32_t size);
+    void setSettleDuration(uint8_t axis, uint32_t durationMs);
+    void setFilterLevel(uint8_t axis, AxisFilterLevel level);
+    void setEwmaAlpha(uint8_t axis, uint32_t alphaValue);
     /**
-     * @brief Constructor with deadband size
-     * @param size Size of deadband zone (0 = disabled)
-     */
-    AxisDeadband(int32_t size = 0) : deadbandSize(size) {}
-    
-    /**
-     * @brief Apply deadband to input value
-     * @param input Input value
-     * @return Output value with deadband applied
-     */
-    int32_t apply(int32_t input);
-    
-    /**
-     * @brief Set deadband size
-     * @param size Size of deadband zone (0 = disabled)
-     * 
-     * Typical values:
-     * - 0: No deadband
-     * - 500-1000: Light deadband for precision controls
-     * - 1000-2000: Medium deadband for joysticks
-     * - 2000-5000: Heavy deadband for worn controls
+     * @brief Adaptive (1-Euro) filter parameters
+     * @param minCutoff Cutoff at rest in 0.01 Hz (> 0)
+     * @param beta Cutoff increase in 0.01 Hz per full-scale-per-second of velocity
+     * @param dCutoff Velocity smoothing cutoff in 0.1 Hz (> 0)
      */
-    void setSize(int32_t size);
-    
+    void setAdaptiveParams(uint8_t axis, uint16_t minCutoff, uint16_t beta, uint8_t dCutoff);
+    void setCustomCurve(uint8_t axis, const int32_t* table, uint8_t points);   ///< equally spaced, linear
     /**
-     * @brief Set settle duration - time to wait before activating deadband
-     * @param duration Time in milliseconds (default: 150ms)
+     * @brief Compiles control points into the axis lookup table
+     * @param points 2..MAX_CURVE_POINTS points with strictly increasing x
+     * @param smooth Monotone cubic (Fritsch-Carlson) through the points instead of straight segments
+     * @param lutLog2 Table resolution, CURVE_LUT_LOG2_MIN..MAX (0 = default)
+     * @return false if the definition is invalid or the table could not be allocated
      */
-    void setSettleDuration(uint32_t duration);
-    
+    bool setCurve(uint8_t axis, const AxisCurvePoint* points, uint8_t count, bool smooth, uint8_t lutLog2);
+    void clearCurve(uint8_t axis);   ///< identity, no table
+    void reset(uint8_t axis);
+
     /**
-     * @brief Reset deadband state
+     * @brief Fills lut[0..2^lutLog2] with the curve sampled every 2^(15 - lutLog2) inputs
+     *
+     * The last entry holds the value at 32767. Inputs below the first / above the last
+     * control point take that point's value. Runs at configuration time only (float math).
      */
-    void reset();
-    
-    // Getters
-    int32_t getSize() const { return deadbandSize; }
-    uint32_t getSettleDuration() const { return settleDuration; }
-    bool isActive() const { return deadbandActive; }
+    static bool compileCurve(const AxisCurvePoint* points, uint8_t count, bool smooth,
+                             uint8_t lutLog2, uint16_t* lut);
 
-private:
     /**
-     * @brief Calculate average movement over recent samples
-     * @return Average movement magnitude
+     * @brief Processes every axis whose bit is set in mask
+     * @param mask Axes with a new raw sample (bit n = axis n)
+     * @param raw Raw samples, indexed by axis
+     * @param out Receives -32767..32767 outputs for the processed axes
+     * @param nowUs Microsecond time of the samples (deadband timing, adaptive filter dt)
      */
-    int32_t getAverageMovement() const;
-};
+    void process(uint8_t mask, const int32_t* raw, int32_t* out, uint32_t nowUs);
 
-// =============================================================================
-// AXIS CURVE CLASS
-// =============================================================================
+    // Getters for current settings
+    AxisFilterLevel getFilterLevel(uint8_t axis) const { return (AxisFilterLevel)_filterLevel[axis]; }
+    uint32_t getEwmaAlpha(uint8_t axis) const { return _ewmaAlpha[axis]; }
+    uint16_t getAdaptiveMinCutoff(uint8_t axis) const { return _adMinCutoff[axis]; }
+    uint16_t getAdaptiveBeta(uint8_t axis) const { return _adBeta[axis]; }
+    uint8_t getAdaptiveDCutoff(uint8_t axis) const { return _adDCutoff[axis]; }
+    int32_t getDeadbandSize(uint8_t axis) const { return _dbSize[axis]; }
+    bool isDeadbandActive(uint8_t axis) const { return (_dbFlags[axis] & DB_ACTIVE) != 0; }
+    uint16_t getCurveLutSize(uint8_t axis) const { return _lut[axis] ? (uint16_t)((1u << _lutLog2[axis]) + 1) : 0; }
+    const uint16_t* getCurveLut(uint8_t axis) const { return _lut[axis]; }
 
-/**
- * @brief Response curve shaping for analog axis values
- *
- * This class applies custom response curves to modify the relationship between
- * input and output values. The curve is defined by a lookup table with
- * linear interpolation between points.
- */
-class AxisCurve {
 private:
-    ResponseCurveType type = CURVE_CUSTOM; ///< Current curve type
-    int32_t customTable[11] = {0, 3277, 6554, 9830, 13107, 16384, 19661, 22938, 26214, 29491, 32767}; ///< Custom curve points (linear by default, 0-32767 range)
-    uint8_t points = 11; ///< Number of points in custom curve
+    enum : uint8_t {
+        DB_INIT     = 0x01,
+        DB_ACTIVE   = 0x02,
+        DB_CAPTURED = 0x04
+    };
 
-public:
-    /**
-     * @brief Apply response curve to input value
-     * @param input Input value (0-32767 range)
-     * @return Curve-shaped output value
-     */
-    int32_t apply(int32_t input);
-    
-    /**
-     * @brief Set response curve type
-     * @param newType Curve type (only CUSTOM is currently supported)
-     */
-    void setType(ResponseCurveType newType);
-    
-    /**
-     * @brief Define custom response curve
-     * @param newTable Array of curve points (must be in ascending order)
-     * @param newPoints Number of points in the curve (2-11)
-     * 
-     * The curve points should span the expected input range.
-     * Linear interpolation is used between points.
-     */
-    void setCustomCurve(const int32_t* newTable, uint8_t newPoints);
-    
-    // Getters for current settings
-    ResponseCurveType getType() const { return type; }
-    uint8_t getPointCount() const { return points; }
-    const int32_t* getCustomTable() const { return customTable; }
-};
+    void updateScales(uint8_t axis);
+    void updateAdaptive(uint8_t axis);
 
+    // Range mapping
+    int32_t _min[AXES];
+    int32_t _max[AXES];
+    int32_t _sourceMax[AXES];
+    int32_t _spanSign[AXES];          ///< -1 when maximum < minimum
+    AxisRatio _inScale[AXES];         ///< raw * span / sourceMax
+    AxisRatio _outScale[AXES];        ///< x * 65534 / span
+
+    // Deadband
+    int32_t _dbSize[AXES];
+    int32_t _dbSumLimit[AXES];        ///< average <= size / 8  <=>  sum < limit
+    uint32_t _dbSettleMs[AXES];
+    uint32_t _dbIntervalUs[AXES];     ///< (settle duration / DEADBAND_HISTORY) in us
+    int32_t _dbLastInput[AXES];
+    int32_t _dbStable[AXES];
+    uint32_t _dbLastUs[AXES];
+    int32_t _dbHistory[AXES][DEADBAND_HISTORY];
+    int32_t _dbSum[AXES];             ///< running sum of _dbHistory
+    uint8_t _dbIndex[AXES];
+    uint8_t _dbSamples[AXES];
+    uint8_t _dbFlags[AXES];
+
+    // Filter
+    uint8_t _filterLevel[AXES];
+    uint32_t _ewmaAlpha[AXES];
+    int64_t _ewmaCoeff[AXES];         ///< alpha / 1000 in Q32
+    int32_t _ewmaAcc[AXES];           ///< Q12 state (shared by EWMA and adaptive)
+    bool _ewmaInit[AXES];
+    uint16_t _adMinCutoff[AXES];
+    uint16_t _adBeta[AXES];
+    uint8_t _adDCutoff[AXES];
+    uint32_t _adBetaK[AXES];          ///< beta * 2^16 / span: |velocity| -> 0.01 Hz, Q16
+    uint32_t _adDCutoffCHz[AXES];
+    uint32_t _adDGain[AXES];          ///< 2 pi dCutoff in Q16 (1/s)
+    int32_t _adVelocity[AXES];        ///< smoothed velocity, user-range units per second
+    uint32_t _adLastUs[AXES];
+
+    // Curve (control points are not kept; only the compiled table)
+    uint16_t* _lut[AXES];             ///< 2^n + 1 entries, nullptr = identity
+    uint8_t _lutLog2[AXES];
+    uint8_t _lutShift[AXES];          ///< 15 - n: input bits below the table index
+};
 
 // =============================================================================
 // HELPER FUNCTIONS
@@ -316,6 +247,7 @@ inline const char* getFilterLevelName(AxisFilterLevel level) {
     switch (level) {
         case AXIS_FILTER_OFF:    return "Off";
         case AXIS_FILTER_EWMA:   return "EWMA";
+        case AXIS_FILTER_ADAPTIVE: return "Adaptive";
         default:                 return "Unknown";
     }
 }
@@ -332,4 +264,4 @@ inline const char* getCurveTypeName(ResponseCurveType type) {
     }
 }
 
-#endif // AXIS_PROCESSING_H 
\ No newline at end of file
+#endif // AXIS_PROCESSING_H
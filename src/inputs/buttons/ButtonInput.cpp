@@ -3,59 +3,111 @@
 #include "../../rp2040/JoystickWrapper.h"
 #include "../../Config.h"
 #include "../shift_register/ShiftRegister165.h"
-#include <vector>
+#include "ButtonKernel.h"
+#include "PinEdgeRing.h"
+#include <atomic>
+#include <hardware/gpio.h>
+#include <hardware/irq.h>
+#include <hardware/timer.h>
 
-// Unified runtime logical button state used for all digital sources
-struct RuntimeLogicalButton {
-    uint8_t joyButtonID = 0;
-    ButtonBehavior behavior = NORMAL;
-    uint8_t reverse = 0;
-    bool lastState = false;
-    uint32_t momentaryStartTime = 0;  // Non-blocking timing
-    bool momentaryActive = false;     // Active pulse flag
-};
+// Kernel sources owned by this module (the matrix registers its own)
+static uint8_t pinSource = ButtonKernel::NO_SOURCE;      // bit n = GPIO n
+static uint8_t shiftRegSource = ButtonKernel::NO_SOURCE; // bit n = reg (n / 8), bit (n % 8)
+static uint16_t pinGroupCount = 0;
+static uint16_t shiftRegGroupCount = 0;
 
-struct PinButtonGroup {
-    uint8_t pin = 0;
-    std::vector<RuntimeLogicalButton> logicalButtons;
-};
+static constexpr uint8_t SHIFTREG_WORDS = (SHIFTREG_COUNT * 8 + 31) / 32;
 
-static std::vector<PinButtonGroup> pinGroups; // dynamic
+// BUTTON_PIN_MODE_IRQ: edges of the direct button pins, queued by the GPIO interrupt
+// (serviced on the scan core, which initializes the inputs) and drained by updateButtons()
+static constexpr uint16_t PIN_EDGE_RING_SIZE = 64;
+static PinEdgeRing<PIN_EDGE_RING_SIZE> pinEdges;
+static uint32_t irqPinMask = 0;        // GPIOs with edge interrupts enabled
+static uint32_t pinEdgeDropsSeen = 0;  // pinEdges.dropped() at the last resync
+static bool pinEdgesPrimed = false;    // kernel holds a full GPIO snapshot to apply edges to
+static uint32_t pinEdgesTouched = 0;   // pins changed by edges in the report being built
 
-struct ShiftRegButtonGroup {
-    uint8_t regIndex = 0;
-    uint8_t bitIndex = 0;
-    std::vector<RuntimeLogicalButton> logicalButtons;
-};
+// Edge-to-kernel latency accounting (written by the scan core, read by serial commands)
+static std::atomic<uint32_t> edgeEventCount{0};
+static std::atomic<uint32_t> edgeLatencyMaxUs{0};
+static std::atomic<uint32_t> edgeLatencyLastUs{0};
+static std::atomic<uint32_t> edgeLatencySumUs{0};
 
-static std::vector<ShiftRegButtonGroup> shiftRegGroups; // dynamic
+static void __not_in_flash_func(onButtonPinEdge)() {
+    const uint64_t now = time_us_64();
+    uint32_t edged = 0;
+    for (uint32_t m = irqPinMask; m; m &= m - 1) {
+        const uint8_t pin = (uint8_t)__builtin_ctz(m);
+        const uint32_t events = gpio_get_irq_event_mask(pin) & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+        if (events) {
+            gpio_acknowledge_irq(pin, events);
+            edged |= 1u << pin;
+        }
+    }
+    // Levels are read after acknowledging, so a later edge raises a new event instead of being lost
+    if (edged) pinEdges.push({edged, gpio_get_all(), now});
+}
 
-// Shared helper for NORMAL / MOMENTARY behaviors (non-blocking)
-static inline void processLogicalButton(uint32_t now, bool pressedPhysical, uint8_t joyButtonID, ButtonBehavior behavior, bool reverse, bool &lastState, uint32_t &pulseStart, bool &pulseActive) {
-    bool effectivePressed = pressedPhysical;
-    if (reverse) effectivePressed = !effectivePressed;
-    uint8_t joyIdx = (joyButtonID > 0) ? (joyButtonID - 1) : 0;
-    switch(behavior) {
-        case NORMAL:
-            MyJoystick.setButton(joyIdx, effectivePressed);
-            break;
-        case MOMENTARY:
-            if(!lastState && effectivePressed && !pulseActive) {
-                MyJoystick.setButton(joyIdx, 1);
-                pulseStart = now;
-                pulseActive = true;
-            }
-            if(pulseActive && (now - pulseStart) >= 50) { // 50 ms pulse
-                MyJoystick.setButton(joyIdx, 0);
-                pulseActive = false;
-            }
-            break;
-        case ENC_A:
-        case ENC_B:
-            // Handled elsewhere
-            break;
+// Raw handler for just these pins; shares IO_IRQ_BANK0 with attachInterrupt() users (ADS1115 ALERT/RDY)
+static void enableButtonPinInterrupts(uint32_t pins) {
+    irqPinMask = pins;
+    gpio_add_raw_irq_handler_masked(pins, onButtonPinEdge);
+    for (uint32_t m = pins; m; m &= m - 1) {
+        gpio_set_irq_enabled((uint8_t)__builtin_ctz(m), GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+static void recordEdgeLatency(uint32_t us) {
+    edgeEventCount.store(edgeEventCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    edgeLatencySumUs.store(edgeLatencySumUs.load(std::memory_order_relaxed) + us, std::memory_order_relaxed);
+    edgeLatencyLastUs.store(us, std::memory_order_relaxed);
+    if (us > edgeLatencyMaxUs.load(std::memory_order_relaxed)) edgeLatencyMaxUs.store(us, std::memory_order_relaxed);
+}
+
+// Applies queued edges in order, each with the GPIO levels of its own interrupt
+static void updatePinEdges(uint32_t nowMs) {
+    if (!pinEdgesPrimed) {
+        // Start from the current levels; edges queued before this read are already in it.
+        // An edge between the discard and the read is applied twice, which is harmless.
+        while (pinEdges.peek()) pinEdges.pop();
+        pinEdgeDropsSeen = pinEdges.dropped();
+        uint32_t pressed = ~gpio_get_all();
+        g_buttonKernel.update(pinSource, &pressed, nowMs);
+        pinEdgesPrimed = true;
+        return;
+    }
+    const uint64_t nowUs = time_us_64();
+    drainPinEdgesForReport(pinEdges, pinEdgesTouched, [&](const PinEdgeEvent& e) {
+        uint32_t pressed = ~e.levels;
+        g_buttonKernel.update(pinSource, &pressed, nowMs);
+        recordEdgeLatency((uint32_t)(nowUs - e.timeUs));
+    });
+    // Events were lost to a full ring: take the current levels directly once it has drained
+    const uint32_t drops = pinEdges.dropped();
+    if (drops != pinEdgeDropsSeen && pinEdges.size() == 0) {
+        pinEdgeDropsSeen = drops;
+        uint32_t pressed = ~gpio_get_all();
+        g_buttonKernel.update(pinSource, &pressed, nowMs);
+    }
+}
+
+PinEdgeStats getPinEdgeStats() {
+    PinEdgeStats st;
+    st.irqMode = (irqPinMask != 0);
+    st.events = edgeEventCount.load(std::memory_order_relaxed);
+    st.dropped = pinEdges.dropped();
+    st.lastLatencyUs = edgeLatencyLastUs.load(std::memory_order_relaxed);
+    st.maxLatencyUs = edgeLatencyMaxUs.load(std::memory_order_relaxed);
+    st.avgLatencyUs = st.events ? edgeLatencySumUs.load(std::memory_order_relaxed) / st.events : 0;
+    return st;
+}
+
+void applyButtonKernelEdits() {
+    uint32_t mask[ButtonKernel::REPORT_WORDS], value[ButtonKernel::REPORT_WORDS];
+    if (g_buttonKernel.takeReportEdits(mask, value)) {
+        MyJoystick.setButtonsMasked(mask, value);
     }
-    lastState = effectivePressed;
 }
 
 // Global shift register components
@@ -67,59 +119,63 @@ void initButtons(const ButtonConfig* configs, uint8_t count) {
     // This function is deprecated - use initButtonsFromLogical instead
     // Keeping for backward compatibility
     
-    pinGroups.clear();
-    pinGroups.reserve(count);
+    g_buttonKernel.clear();
+    shiftRegSource = ButtonKernel::NO_SOURCE;
+    shiftRegGroupCount = 0;
+    pinSource = g_buttonKernel.addSource(32);
+    pinGroupCount = count;
     for (uint8_t i = 0; i < count; i++) {
-        PinButtonGroup grp;
-        grp.pin = configs[i].pin;
-        grp.logicalButtons.resize(1);
-        grp.logicalButtons[0].joyButtonID = configs[i].joyButtonID;
-        grp.logicalButtons[0].behavior = configs[i].behavior;
-        grp.logicalButtons[0].reverse = configs[i].reverse;
-        pinMode(grp.pin, INPUT_PULLUP);
-        bool physicalPressed = (digitalRead(grp.pin) == LOW);
-        if (grp.logicalButtons[0].reverse) physicalPressed = !physicalPressed;
-        grp.logicalButtons[0].lastState = physicalPressed;
-        grp.logicalButtons[0].momentaryStartTime = 0;
-        grp.logicalButtons[0].momentaryActive = false;
-        pinGroups.push_back(grp);
+        pinMode(configs[i].pin, INPUT_PULLUP);
+        g_buttonKernel.addBinding(pinSource, configs[i].pin, configs[i].joyButtonID,
+                                  configs[i].behavior == MOMENTARY, configs[i].reverse);
     }
+    g_buttonKernel.finalize();
 }
 
 void updateButtons() {
-    // Update direct pin buttons
     uint32_t now = millis();
-    for (auto &group : pinGroups) {
-        bool currentPhysicalState = digitalRead(group.pin);
-        bool physicalPressed = (currentPhysicalState == LOW);
-        for (auto &logicalBtn : group.logicalButtons) {
-            processLogicalButton(now, physicalPressed, logicalBtn.joyButtonID, logicalBtn.behavior, logicalBtn.reverse, logicalBtn.lastState, logicalBtn.momentaryStartTime, logicalBtn.momentaryActive);
-        }
+    
+    // Direct pins: queued interrupt edges, or one GPIO snapshot per cycle (active-low)
+    if (irqPinMask) {
+        pinEdgesTouched = 0; // a new report starts
+        updatePinEdges(now);
+    } else if (pinSource != ButtonKernel::NO_SOURCE) {
+        uint32_t pressed = ~gpio_get_all();
+        g_buttonKernel.update(pinSource, &pressed, now);
     }
     
     // Update shift register buttons if present
     updateShiftRegisterButtons();
+    
+    g_buttonKernel.tick(now);
+    applyButtonKernelEdits();
+}
+
+void flushButtonPinEdges() {
+    if (!irqPinMask || !pinEdgesPrimed || !pinEdges.peek()) return;
+    updatePinEdges(millis());
+    applyButtonKernelEdits();
 }
 
 void updateShiftRegisterButtons() {
-    if (!shiftReg || !shiftRegBuffer) return;
-    uint32_t now = millis();
+    if (!shiftReg || !shiftRegBuffer || shiftRegSource == ButtonKernel::NO_SOURCE) return;
     
-    // Update shift register groups
-    for (auto &group : shiftRegGroups) {
-        
-        if (group.regIndex >= SHIFTREG_COUNT || group.bitIndex >= 8) continue;
-        
-        bool physicalPressed = (shiftRegBuffer[group.regIndex] & (1 << group.bitIndex)) == 0; // 74HC165: LOW = pressed
-        
-        // Process all logical buttons for this shift register bit
-        for (auto &logicalBtn : group.logicalButtons) {
-            processLogicalButton(now, physicalPressed, logicalBtn.joyButtonID, logicalBtn.behavior, logicalBtn.reverse, logicalBtn.lastState, logicalBtn.momentaryStartTime, logicalBtn.momentaryActive);
-        }
+    // Pack the chain bytes into words; 74HC165: LOW = pressed
+    uint32_t pressed[SHIFTREG_WORDS] = {};
+    for (uint8_t i = 0; i < SHIFTREG_COUNT; ++i) {
+        pressed[i >> 2] |= (uint32_t)(uint8_t)~shiftRegBuffer[i] << ((i & 3) * 8);
     }
+    g_buttonKernel.update(shiftRegSource, pressed, millis());
 }
 
 void initButtonsFromLogical(const LogicalInput* logicals, uint8_t logicalCount) {
+    // Buttons register their sources first; the matrix appends its own afterwards
+    g_buttonKernel.clear();
+    pinSource = ButtonKernel::NO_SOURCE;
+    shiftRegSource = ButtonKernel::NO_SOURCE;
+    pinGroupCount = 0;
+    shiftRegGroupCount = 0;
+    
     // Count non-encoder buttons
     uint8_t count = 0;
     for (uint8_t i = 0; i < logicalCount; ++i) {
@@ -133,86 +189,38 @@ void initButtonsFromLogical(const LogicalInput* logicals, uint8_t logicalCount)
     }
     
     initShiftRegisterIfNeeded(logicals, logicalCount);
+    g_buttonKernel.finalize();
 }
 
 bool isRegularButton(const LogicalInput& input) {
-    return (input.type == INPUT_PIN && 
-            input.u.pin.behavior != ENC_A && 
-            input.u.pin.behavior != ENC_B);
+    return (input.type == INPUT_PIN && !isEncoderBehavior(input.u.pin.behavior));
 }
 
 void initRegularButtons(const LogicalInput* logicals, uint8_t logicalCount, uint8_t count) {
-    // Reset
-    pinGroups.clear();
     if (count == 0) return;
     
-    // Count unique pins
-    uint8_t uniquePins[64]; // Increased temporary capacity
-    uint8_t uniquePinCount = 0;
-    
+    pinSource = g_buttonKernel.addSource(32);
+    uint32_t configuredPins = 0;
     for (uint8_t i = 0; i < logicalCount; ++i) {
-        if (isRegularButton(logicals[i])) {
-            uint8_t pin = logicals[i].u.pin.pin;
-            bool found = false;
-            for (uint8_t j = 0; j < uniquePinCount; j++) {
-                if (uniquePins[j] == pin) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                uniquePins[uniquePinCount++] = pin;
-            }
+        if (!isRegularButton(logicals[i])) continue;
+        uint8_t pin = logicals[i].u.pin.pin;
+        if (pin >= 32) continue;
+        if (!(configuredPins & (1u << pin))) {
+            pinMode(pin, INPUT_PULLUP); // Initialize pin once
+            configuredPins |= 1u << pin;
+            pinGroupCount++;
         }
+        g_buttonKernel.addBinding(pinSource, pin, logicals[i].u.pin.joyButtonID,
+                                  logicals[i].u.pin.behavior == MOMENTARY, logicals[i].u.pin.reverse);
     }
     
-    // Initialize pin groups
-    pinGroups.reserve(uniquePinCount);
-    for (uint8_t pinIdx = 0; pinIdx < uniquePinCount; pinIdx++) {
-        PinButtonGroup grp;
-        grp.pin = uniquePins[pinIdx];
-        
-        // Initialize pin once
-        pinMode(uniquePins[pinIdx], INPUT_PULLUP);
-        bool physicalPressed = digitalRead(uniquePins[pinIdx]) == LOW;
-        
-        // Count logical buttons for this pin
-        uint8_t logicalCnt = 0;
-        for (uint8_t i = 0; i < logicalCount; ++i) {
-            if (isRegularButton(logicals[i]) && logicals[i].u.pin.pin == uniquePins[pinIdx]) {
-                logicalCnt++;
-            }
-        }
-        grp.logicalButtons.resize(logicalCnt);
-        
-        // Fill logical buttons
-        uint8_t btnIdx = 0;
-        for (uint8_t i = 0; i < logicalCount && btnIdx < logicalCnt; ++i) {
-            if (isRegularButton(logicals[i]) && logicals[i].u.pin.pin == uniquePins[pinIdx]) {
-                grp.logicalButtons[btnIdx].joyButtonID = logicals[i].u.pin.joyButtonID;
-                grp.logicalButtons[btnIdx].behavior = logicals[i].u.pin.behavior;
-                grp.logicalButtons[btnIdx].reverse = logicals[i].u.pin.reverse;
-                
-                // Initialize lastState with effective pressed state
-                bool effectivePressed = physicalPressed;
-                if (grp.logicalButtons[btnIdx].reverse) {
-                    effectivePressed = !effectivePressed;
-                }
-                grp.logicalButtons[btnIdx].lastState = effectivePressed;
-                grp.logicalButtons[btnIdx].momentaryStartTime = 0;
-                grp.logicalButtons[btnIdx].momentaryActive = false;
-                
-                btnIdx++;
-            }
-        }
-        pinGroups.push_back(grp);
+    if (BUTTON_PIN_MODE == BUTTON_PIN_MODE_IRQ && configuredPins && !irqPinMask) {
+        enableButtonPinInterrupts(configuredPins);
     }
+    pinEdgesPrimed = false;
 }
 
 void initShiftRegisterIfNeeded(const LogicalInput* logicals, uint8_t logicalCount) {
-    // Reset
-    shiftRegGroups.clear();
-    
     // Check if any shift register inputs are present
     bool hasShiftReg = false;
     for (uint8_t i = 0; i < logicalCount; ++i) {
@@ -237,86 +245,33 @@ void initShiftRegisterIfNeeded(const LogicalInput* logicals, uint8_t logicalCoun
     
     if (plPin >= 0 && clkPin >= 0 && qhPin >= 0) {
         if (!shiftReg) { // single instance
-            shiftReg = new ShiftRegister165(plPin, clkPin, qhPin, SHIFTREG_COUNT);
+            shiftReg = createShiftRegister165(plPin, clkPin, qhPin, SHIFTREG_COUNT,
+                                              SHIFTREG_BACKEND, SHIFTREG_SPI_BAUD);
             shiftReg->begin();
         }
         for (uint8_t i = 0; i < SHIFTREG_COUNT; i++) shiftRegRawBuffer[i] = 0xFF;
     }
     
-    // Count unique shift register positions (regIndex, bitIndex pairs)
-    struct ShiftRegPosition {
-        uint8_t regIndex;
-        uint8_t bitIndex;
-    };
-    ShiftRegPosition uniquePositions[128]; // temp storage
-    uint8_t uniquePositionCount = 0;
-    
+    // Bind every non-encoder shift register bit; encoders read shiftRegBuffer directly
+    shiftRegSource = g_buttonKernel.addSource(SHIFTREG_COUNT * 8);
+    uint8_t seen[SHIFTREG_COUNT] = {};
     for (uint8_t i = 0; i < logicalCount; ++i) {
-        if (logicals[i].type == INPUT_SHIFTREG && 
-            logicals[i].u.shiftreg.behavior != ENC_A && 
-            logicals[i].u.shiftreg.behavior != ENC_B) {
+        if (logicals[i].type == INPUT_SHIFTREG && !isEncoderBehavior(logicals[i].u.shiftreg.behavior)) {
             
             uint8_t reg = logicals[i].u.shiftreg.regIndex;
             uint8_t bit = logicals[i].u.shiftreg.bitIndex;
-            
-            bool found = false;
-            for (uint8_t j = 0; j < uniquePositionCount; j++) {
-                if (uniquePositions[j].regIndex == reg && uniquePositions[j].bitIndex == bit) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                uniquePositions[uniquePositionCount].regIndex = reg;
-                uniquePositions[uniquePositionCount].bitIndex = bit;
-                uniquePositionCount++;
-            }
-        }
-    }
-    
-    if (uniquePositionCount == 0) return;
-    
-    // Initialize shift register groups
-    shiftRegGroups.reserve(uniquePositionCount);
-    for (uint8_t posIdx = 0; posIdx < uniquePositionCount; posIdx++) {
-        ShiftRegButtonGroup grp;
-        grp.regIndex = uniquePositions[posIdx].regIndex;
-        grp.bitIndex = uniquePositions[posIdx].bitIndex;
-        
-        // Count logical buttons for this position
-        uint8_t logicalCnt = 0;
-        for (uint8_t i = 0; i < logicalCount; ++i) {
-            if (logicals[i].type == INPUT_SHIFTREG && 
-                logicals[i].u.shiftreg.behavior != ENC_A && 
-                logicals[i].u.shiftreg.behavior != ENC_B &&
-                logicals[i].u.shiftreg.regIndex == grp.regIndex &&
-                logicals[i].u.shiftreg.bitIndex == grp.bitIndex) {
-                logicalCnt++;
-            }
-        }
-        grp.logicalButtons.resize(logicalCnt);
-        
-        // Fill logical buttons
-        uint8_t btnIdx = 0;
-        for (uint8_t i = 0; i < logicalCount && btnIdx < logicalCnt; ++i) {
-            if (logicals[i].type == INPUT_SHIFTREG && 
-                logicals[i].u.shiftreg.behavior != ENC_A && 
-                logicals[i].u.shiftreg.behavior != ENC_B &&
-                logicals[i].u.shiftreg.regIndex == grp.regIndex &&
-                logicals[i].u.shiftreg.bitIndex == grp.bitIndex) {
-                grp.logicalButtons[btnIdx].joyButtonID = logicals[i].u.shiftreg.joyButtonID;
-                grp.logicalButtons[btnIdx].behavior = logicals[i].u.shiftreg.behavior;
-                grp.logicalButtons[btnIdx].reverse = logicals[i].u.shiftreg.reverse;
-                grp.logicalButtons[btnIdx].lastState = false; // Initialize to not pressed
-                grp.logicalButtons[btnIdx].momentaryStartTime = 0;
-                grp.logicalButtons[btnIdx].momentaryActive = false;
-                btnIdx++;
+            if (reg >= SHIFTREG_COUNT || bit >= 8) continue;
+            if (!(seen[reg] & (1 << bit))) {
+                seen[reg] |= (1 << bit);
+                shiftRegGroupCount++;
             }
+            g_buttonKernel.addBinding(shiftRegSource, reg * 8 + bit, logicals[i].u.shiftreg.joyButtonID,
+                                      logicals[i].u.shiftreg.behavior == MOMENTARY,
+                                      logicals[i].u.shiftreg.reverse);
         }
-        shiftRegGroups.push_back(grp);
     }
 }
 
 // Debug helpers
-uint16_t getButtonPinGroupCount() { return static_cast<uint16_t>(pinGroups.size()); }
-uint16_t getShiftRegGroupCount() { return static_cast<uint16_t>(shiftRegGroups.size()); }
+uint16_t getButtonPinGroupCount() { return pinGroupCount; }
+uint16_t getShiftRegGroupCount() { return shiftRegGroupCount; }
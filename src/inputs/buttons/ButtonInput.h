@@ -3,6 +3,22 @@
 #include <Arduino.h>
 #include "../../Config.h"
 
+// Direct-pin acquisition (BUTTON_PIN_MODE in ConfigDigital.h)
+enum ButtonPinMode : uint8_t {
+    BUTTON_PIN_MODE_POLL = 0,  // one gpio_get_all() snapshot per scan cycle
+    BUTTON_PIN_MODE_IRQ  = 1   // GPIO edge interrupts with time_us_64() timestamps
+};
+
+// Edge capture counters for BUTTON_PIN_MODE_IRQ (PIN_EDGE_STATS serial command)
+struct PinEdgeStats {
+    bool irqMode;
+    uint32_t events;         // edges applied to the button kernel
+    uint32_t dropped;        // edges lost to a full ring (followed by a resync)
+    uint32_t lastLatencyUs;  // interrupt timestamp -> applied, microseconds
+    uint32_t avgLatencyUs;
+    uint32_t maxLatencyUs;
+};
+
 /**
  * @brief Configuration for a single button input
  */
@@ -32,12 +48,23 @@ void initButtonsFromLogical(const LogicalInput* logicals, uint8_t logicalCount);
  */
 void updateButtons();
 
+/**
+ * @brief BUTTON_PIN_MODE_IRQ: applies pin edges that arrived since updateButtons()
+ * Called right before the report is published, so an edge reaches it within one
+ * hand-off instead of waiting for the next scan cycle. No-op in poll mode.
+ */
+void flushButtonPinEdges();
+
 // Helper functions for button initialization
 void updateShiftRegisterButtons();
+// Applies pending logical button edits from g_buttonKernel to the joystick report
+void applyButtonKernelEdits();
 bool isRegularButton(const LogicalInput& input);
 void initRegularButtons(const LogicalInput* logicals, uint8_t logicalCount, uint8_t count);
 void initShiftRegisterIfNeeded(const LogicalInput* logicals, uint8_t logicalCount); 
 
+PinEdgeStats getPinEdgeStats();
+
 // Optional: allocation summary for debug
 uint16_t getButtonPinGroupCount();
 uint16_t getShiftRegGroupCount();
\ No newline at end of file
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "ButtonKernel.h"
+#include <string.h>
+
+ButtonKernel g_buttonKernel;
+
+void ButtonKernel::clear() {
+    _sources.clear();
+    _prev.clear();
+    _boundMask.clear();
+    _bindStart.clear();
+    _bindings.clear();
+    _pending.clear();
+    _pulses.clear();
+    memset(_editMask, 0, sizeof(_editMask));
+    memset(_editValue, 0, sizeof(_editValue));
+    _hasEdits = false;
+}
+
+uint8_t ButtonKernel::addSource(uint16_t bitCount) {
+    if (_sources.size() >= NO_SOURCE || bitCount == 0) return NO_SOURCE;
+    Source s;
+    s.wordBase = (uint16_t)_prev.size();
+    s.wordCount = (uint16_t)((bitCount + 31) / 32);
+    s.primed = false;
+    _sources.push_back(s);
+    _prev.resize(_prev.size() + s.wordCount, 0);
+    _boundMask.resize(_boundMask.size() + s.wordCount, 0);
+    return (uint8_t)(_sources.size() - 1);
+}
+
+void ButtonKernel::addBinding(uint8_t source, uint16_t bit, uint8_t joyButtonID, bool momentary, bool reverse) {
+    if (source >= _sources.size()) return;
+    const Source& s = _sources[source];
+    if (bit >= s.wordCount * 32) return;
+    uint8_t joyIdx = (joyButtonID > 0) ? (joyButtonID - 1) : 0;
+    if (joyIdx >= REPORT_WORDS * 32) return;
+
+    PendingBinding p;
+    p.globalBit = (uint16_t)(s.wordBase * 32 + bit);
+    p.binding.reportBit = joyIdx;
+    p.binding.flags = (reverse ? BIND_REVERSE : 0) | (momentary ? BIND_MOMENTARY : 0);
+    _pending.push_back(p);
+}
+
+void ButtonKernel::finalize() {
+    const uint16_t totalBits = (uint16_t)(_prev.size() * 32);
+    _bindStart.assign(totalBits + 1, 0);
+    _bindings.resize(_pending.size());
+    _pulses.clear();
+    for (auto& m : _boundMask) m = 0;
+
+    // Counting sort by global bit keeps bindings of one source bit contiguous and in
+    // configuration order. Only edges write the report, so a report bit shared by several
+    // inputs follows the most recent edge among them (within one update, the later entry);
+    // an input that holds steady does not re-assert it.
+    for (const auto& p : _pending) _bindStart[p.globalBit + 1]++;
+    for (uint16_t i = 0; i < totalBits; ++i) _bindStart[i + 1] += _bindStart[i];
+    std::vector<uint16_t> fill(_bindStart.begin(), _bindStart.end() - 1);
+    uint16_t momentaryCount = 0;
+    for (const auto& p : _pending) {
+        _bindings[fill[p.globalBit]++] = p.binding;
+        _boundMask[p.globalBit >> 5] |= 1u << (p.globalBit & 31);
+        if (p.binding.flags & BIND_MOMENTARY) momentaryCount++;
+    }
+    _pulses.reserve(momentaryCount); // keeps update() allocation-free
+    for (auto& s : _sources) s.primed = false;
+}
+
+void ButtonKernel::update(uint8_t source, const uint32_t* pressed, uint32_t nowMs) {
+    if (source >= _sources.size()) return;
+    Source& s = _sources[source];
+    const bool primed = s.primed;
+
+    for (uint16_t w = 0; w < s.wordCount; ++w) {
+        const uint16_t word = s.wordBase + w;
+        const uint32_t cur = pressed[w];
+        uint32_t changed = primed ? ((cur ^ _prev[word]) & _boundMask[word]) : _boundMask[word];
+        _prev[word] = cur;
+
+        while (changed) {
+            const uint8_t b = (uint8_t)__builtin_ctz(changed);
+            changed &= changed - 1;
+            const bool physical = (cur >> b) & 1u;
+            const uint16_t g = (uint16_t)(word * 32 + b);
+
+            for (uint16_t i = _bindStart[g]; i < _bindStart[g + 1]; ++i) {
+                Binding& bind = _bindings[i];
+                const bool effective = physical ^ ((bind.flags & BIND_REVERSE) != 0);
+                if (!(bind.flags & BIND_MOMENTARY)) {
+                    setEdit(bind.reportBit, effective);
+                } else if (effective && primed && !(bind.flags & BIND_PULSING)) {
+                    setEdit(bind.reportBit, true);
+                    bind.flags |= BIND_PULSING;
+                    _pulses.push_back({i, nowMs});
+                }
+            }
+        }
+    }
+    s.primed = true;
+}
+
+void ButtonKernel::tick(uint32_t nowMs) {
+    for (size_t i = 0; i < _pulses.size();) {
+        if ((nowMs - _pulses[i].startMs) >= MOMENTARY_PULSE_MS) {
+            Binding& bind = _bindings[_pulses[i].binding];
+            setEdit(bind.reportBit, false);
+            bind.flags &= (uint8_t)~BIND_PULSING;
+            _pulses[i] = _pulses.back();
+            _pulses.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool ButtonKernel::takeReportEdits(uint32_t* mask, uint32_t* value) {
+    if (!_hasEdits) return false;
+    memcpy(mask, _editMask, sizeof(_editMask));
+    memcpy(value, _editValue, sizeof(_editValue));
+    memset(_editMask, 0, sizeof(_editMask));
+    memset(_editValue, 0, sizeof(_editValue));
+    _hasEdits = false;
+    return true;
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Change-driven logical button kernel shared by all digital sources.
+//
+// Each raw source (direct GPIO word, shift-register bytes, matrix bitmap) is a bitset with
+// 1 = physically pressed. update() XORs it against the previous snapshot and visits only
+// the changed bits with count-trailing-zeros, so per-cycle cost scales with the number of
+// edges, not with the number of configured inputs. Bindings are stored flat per source bit;
+// reverse is an XOR bit and NORMAL bindings are a precomputed source-bit -> report-bit
+// permutation accumulated into 128-bit set/clear masks for one bulk report update.
+class ButtonKernel {
+public:
+    static constexpr uint8_t REPORT_WORDS = 4;         // 128 report buttons
+    static constexpr uint32_t MOMENTARY_PULSE_MS = 50;
+    static constexpr uint8_t NO_SOURCE = 0xFF;
+
+    // Drops all sources, bindings and pending pulses
+    void clear();
+
+    // Registers a raw source of bitCount bits and returns its handle
+    uint8_t addSource(uint16_t bitCount);
+
+    // Binds a source bit to a joystick button (1-based joyButtonID as in LogicalInput).
+    // Bindings take effect at the next finalize().
+    void addBinding(uint8_t source, uint16_t bit, uint8_t joyButtonID, bool momentary, bool reverse);
+
+    // (Re)builds the flat binding tables; safe to call again after adding more sources.
+    void finalize();
+
+    // Feeds the current pressed bitset of a source (ceil(bitCount / 32) words).
+    // The first update of a source evaluates every bound bit; MOMENTARY pulses only
+    // fire on edges seen after that, so inputs held at boot do not pulse.
+    void update(uint8_t source, const uint32_t* pressed, uint32_t nowMs);
+
+    // Ends MOMENTARY pulses older than MOMENTARY_PULSE_MS
+    void tick(uint32_t nowMs);
+
+    // Copies the accumulated report edits (REPORT_WORDS each) and clears them.
+    // Returns false when nothing changed since the last call.
+    bool takeReportEdits(uint32_t* mask, uint32_t* value);
+
+    uint16_t getBindingCount() const { return (uint16_t)_bindings.size(); }
+
+private:
+    enum : uint8_t {
+        BIND_REVERSE   = 0x01,
+        BIND_MOMENTARY = 0x02,
+        BIND_PULSING   = 0x04
+    };
+
+    struct Source {
+        uint16_t wordBase;   // first word in _prev/_boundMask
+        uint16_t wordCount;
+        bool primed;         // false until the first update
+    };
+    struct Binding {
+        uint8_t reportBit;   // 0-127
+        uint8_t flags;
+    };
+    struct PendingBinding {
+        uint16_t globalBit;  // wordBase * 32 + bit
+        Binding binding;
+    };
+    struct Pulse {
+        uint16_t binding;
+        uint32_t startMs;
+    };
+
+    inline void setEdit(uint8_t reportBit, bool pressed) {
+        const uint32_t m = 1u << (reportBit & 31);
+        _editMask[reportBit >> 5] |= m;
+        if (pressed) _editValue[reportBit >> 5] |= m;
+        else _editValue[reportBit >> 5] &= ~m;
+        _hasEdits = true;
+    }
+
+    std::vector<Source> _sources;
+    std::vector<uint32_t> _prev;        // last pressed snapshot, all sources
+    std::vector<uint32_t> _boundMask;   // bits with at least one binding
+    std::vector<uint16_t> _bindStart;   // [globalBit] -> first binding, size totalBits + 1
+    std::vector<Binding> _bindings;
+    std::vector<PendingBinding> _pending;
+    std::vector<Pulse> _pulses;         // active MOMENTARY pulses only
+    uint32_t _editMask[REPORT_WORDS] = {};
+    uint32_t _editValue[REPORT_WORDS] = {};
+    bool _hasEdits = false;
+};
+
+extern ButtonKernel g_buttonKernel;
@@ -1,16 +1,30 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "ButtonMatrix.h"
+#include "MatrixPioScanner.h"
+#include <hardware/gpio.h>
+#include <hardware/timer.h>
 
-ButtonMatrix::ButtonMatrix(char* keymap, byte* rowPins, byte* colPins, uint8_t numRows, uint8_t numCols)
-        : keymap(keymap), rowPins(rowPins), colPins(colPins), numRows(numRows), numCols(numCols),
-            currentStates(nullptr), lastStates(nullptr), lastChangeTime(nullptr), totalKeys(numRows * numCols),
-            debounceTime(20), key(nullptr), keyCount(totalKeys) {
+// SIO backend for the scan engine; settleUs is the pull-up recovery of the rows after
+// switching the driven column
+struct SioMatrixGpio {
+    uint32_t settleUs;
+    void setDirMasked(uint32_t mask, uint32_t outputs) { gpio_set_dir_masked(mask, outputs); }
+    uint32_t readAll() { return gpio_get_all(); }
+    void settle() { busy_wait_us_32(settleUs); }
+};
+
+ButtonMatrix::ButtonMatrix(byte* rowPins, byte* colPins, uint8_t numRows, uint8_t numCols,
+                           MatrixBackend backend, uint32_t settleUs)
+        : rowPins(rowPins), colPins(colPins), numRows(numRows), numCols(numCols),
+            pressedBits(nullptr), changedBits(nullptr), rawBits(nullptr), lastChangeTime(nullptr),
+            totalKeys(numRows * numCols), wordCount((totalKeys + 31) / 32), debounceTime(20),
+            settleUs(settleUs), pioScanner(nullptr) {
 
         // Allocate dynamic storage sized to totalKeys
-        currentStates = new bool[totalKeys]();
-        lastStates = new bool[totalKeys]();
+        pressedBits = new uint32_t[wordCount]();
+        changedBits = new uint32_t[wordCount]();
+        rawBits = new uint32_t[wordCount]();
         lastChangeTime = new unsigned long[totalKeys]();
-        key = new MatrixKey[totalKeys]();
 
     // Configure pins
     for (uint8_t i = 0; i < numRows; i++) {
@@ -19,93 +33,58 @@ ButtonMatrix::ButtonMatrix(char* keymap, byte* rowPins, byte* colPins, uint8_t n
     for (uint8_t i = 0; i < numCols; i++) {
         pinMode(colPins[i], INPUT_PULLUP);
     }
+    matrixScanLayoutInit(layout, rowPins, colPins, numRows, numCols);
+    // Columns keep a LOW output latch; scanning only flips their direction
+    gpio_clr_mask(layout.colMask);
+
+    if (backend == MATRIX_BACKEND_PIO) {
+        pioScanner = new MatrixPioScanner();
+        if (!pioScanner->begin(layout, settleUs)) {
+            // No free state machine / DMA channel: keep working on the SIO path
+            delete pioScanner;
+            pioScanner = nullptr;
+        }
+    }
     
     // Initialize last change times
     unsigned long currentTime = millis();
         for (uint16_t i = 0; i < totalKeys; i++) {
         lastChangeTime[i] = currentTime;
-                key[i].kchar = 0;
-                key[i].kstate = MATRIX_IDLE;
-                key[i].stateChanged = false;
     }
 }
 
 ButtonMatrix::~ButtonMatrix() {
-        delete[] currentStates;
-        delete[] lastStates;
+        delete pioScanner;
+        delete[] pressedBits;
+        delete[] changedBits;
+        delete[] rawBits;
         delete[] lastChangeTime;
-        delete[] key;
 }
 
 void ButtonMatrix::scanMatrix() {
     unsigned long currentTime = millis();
-    // Clear all state change flags
-    for (uint16_t i = 0; i < totalKeys; i++) {
-        key[i].stateChanged = false;
+    if (pioScanner) {
+        pioScanner->read(rawBits, wordCount); // latest DMA'd sample of every column
+    } else {
+        SioMatrixGpio gpio{settleUs};
+        matrixScanRaw(layout, gpio, rawBits, wordCount);
     }
     
-    // Scan each column
-    for (uint8_t col = 0; col < numCols; col++) {
-        // Set current column as output LOW
-        pinMode(colPins[col], OUTPUT);
-        digitalWrite(colPins[col], LOW);
-        
-        // Set all other columns as INPUT_PULLUP (high impedance)
-        for (uint8_t otherCol = 0; otherCol < numCols; otherCol++) {
-            if (otherCol != col) {
-                pinMode(colPins[otherCol], INPUT_PULLUP);
-            }
-        }
-        
-        // Small delay for pin states to stabilize
-        delayMicroseconds(10);
-        
-        // Read all row pins
-        for (uint8_t row = 0; row < numRows; row++) {
-            uint16_t keyIndex = row * numCols + col;
-            bool pinState = digitalRead(rowPins[row]);
-            bool pressed = (pinState == LOW); // Button pressed when pin is pulled LOW
-            
-            // Check if state changed and debounce time has passed
-            if (pressed != lastStates[keyIndex] && (currentTime - lastChangeTime[keyIndex]) >= debounceTime) {
-                currentStates[keyIndex] = pressed;
+    // Debounce only keys whose raw state differs from the debounced state
+    for (uint16_t w = 0; w < wordCount; w++) {
+        uint32_t diff = rawBits[w] ^ pressedBits[w];
+        uint32_t changed = 0;
+        while (diff) {
+            uint8_t b = (uint8_t)__builtin_ctz(diff);
+            diff &= diff - 1;
+            uint16_t keyIndex = (w << 5) | b;
+            if ((currentTime - lastChangeTime[keyIndex]) >= debounceTime) {
+                changed |= 1u << b;
                 lastChangeTime[keyIndex] = currentTime;
-                
-                // Update key structure (compatible with Keypad library)
-                key[keyIndex].kchar = keymap[keyIndex];
-                key[keyIndex].stateChanged = true;
-                
-                if (pressed) {
-                    if (lastStates[keyIndex] == false) {
-                        key[keyIndex].kstate = MATRIX_PRESSED;
-                    } else {
-                        key[keyIndex].kstate = MATRIX_HELD;
-                    }
-                } else {
-                    key[keyIndex].kstate = MATRIX_RELEASED;
-                }
-                
-                lastStates[keyIndex] = pressed;
-            } else {
-                // No state change, but update current state for consistency
-                currentStates[keyIndex] = pressed;
-                
-                // Update held state if button is still pressed
-                if (pressed && lastStates[keyIndex]) {
-                    key[keyIndex].kchar = keymap[keyIndex];
-                    key[keyIndex].kstate = MATRIX_HELD;
-                    // Don't set stateChanged for held state
-                }
             }
         }
-    }
-    
-    // Restore all pins to INPUT_PULLUP state
-    for (uint8_t row = 0; row < numRows; row++) {
-        pinMode(rowPins[row], INPUT_PULLUP);
-    }
-    for (uint8_t col = 0; col < numCols; col++) {
-        pinMode(colPins[col], INPUT_PULLUP);
+        pressedBits[w] ^= changed;
+        changedBits[w] = changed;
     }
 }
 
@@ -113,24 +92,14 @@ bool ButtonMatrix::getKeys() {
     scanMatrix();
     
     // Check if any key state changed
-    for (uint16_t i = 0; i < totalKeys; i++) {
-        if (key[i].stateChanged) {
+    for (uint16_t w = 0; w < wordCount; w++) {
+        if (changedBits[w]) {
             return true;
         }
     }
     return false;
 }
 
-bool ButtonMatrix::isPressed(char keyChar) {
-    // Find the key index for the given character
-    for (uint16_t i = 0; i < totalKeys; i++) {
-        if (keymap[i] == keyChar) {
-            return currentStates[i];
-        }
-    }
-    return false;
-}
-
 void ButtonMatrix::setDebounceTime(uint8_t debounce) {
     debounceTime = debounce;
 }
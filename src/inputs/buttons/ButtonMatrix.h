@@ -1,51 +1,52 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 #include <Arduino.h>
+#include "MatrixScan.h"
+
+class MatrixPioScanner;
+
+// Matrix scan backend (see MATRIX_BACKEND in ConfigDigital.h)
+enum MatrixBackend : uint8_t {
+    MATRIX_BACKEND_SIO = 0,  // CPU drives each column and busy-waits the settle time
+    MATRIX_BACKEND_PIO = 1   // PIO walks the columns continuously, DMA streams samples to RAM
+};
 
 // Button matrix scanner - replacement for external Keypad library
 // Provides simple matrix button scanning with state change detection
 //
 // This implementation uses dynamic allocation sized to the configured
 // matrix (numRows * numCols) to minimize memory usage.
-
-enum MatrixKeyState : uint8_t {
-    MATRIX_IDLE = 0,
-    MATRIX_PRESSED = 1,
-    MATRIX_HELD = 2,
-    MATRIX_RELEASED = 3
-};
-
-struct MatrixKey {
-    char kchar;           // Character representing this key
-    MatrixKeyState kstate; // Current state
-    bool stateChanged;    // True if state changed since last scan
-};
+//
+// Key state is index-based: key (row, col) is bit (row * numCols + col) of packed
+// 32-bit word bitmaps, so lookups are O(1) and a full pass is linear in matrix size.
 
 class ButtonMatrix {
 private:
-    char* keymap;         // Flat array of key characters
     byte* rowPins;        // Array of row pins
     byte* colPins;        // Array of column pins
     uint8_t numRows;      // Number of rows
     uint8_t numCols;      // Number of columns
 
     // Dynamic storage sized to totalKeys = numRows * numCols
-    bool* currentStates;   // Current button states
-    bool* lastStates;      // Previous button states
+    uint32_t* pressedBits;  // Debounced state, 1 = pressed
+    uint32_t* changedBits;  // Keys whose debounced state changed in the last scan
+    uint32_t* rawBits;      // Undebounced state from the last scan
     unsigned long* lastChangeTime; // Last change time for each key
     uint16_t totalKeys;    // Cached total keys
+    uint16_t wordCount;    // Words per bitmap
 
     uint8_t debounceTime;  // Debounce delay in milliseconds
+    MatrixScanLayout layout; // Row/column GPIO masks precomputed at construction
+    uint32_t settleUs;       // Column settle time
+    MatrixPioScanner* pioScanner; // MATRIX_BACKEND_PIO when resources were available, else nullptr
     
     void scanMatrix();    // Internal matrix scanning function
     
 public:
-    // Array of key states (compatible with Keypad library). Length is keyCount.
-    MatrixKey* key;
-    uint16_t keyCount;
-    
-    // Constructor
-    ButtonMatrix(char* keymap, byte* rowPins, byte* colPins, uint8_t numRows, uint8_t numCols);
+    // Constructor. MATRIX_BACKEND_PIO falls back to SIO when no PIO state machine or DMA
+    // channel is free.
+    ButtonMatrix(byte* rowPins, byte* colPins, uint8_t numRows, uint8_t numCols,
+                 MatrixBackend backend = MATRIX_BACKEND_SIO, uint32_t settleUs = 10);
     
     // Destructor
     ~ButtonMatrix();
@@ -54,13 +55,21 @@ public:
     // Returns true if any key state changed
     bool getKeys();
     
-    // Check if a specific key is currently pressed
-    bool isPressed(char keyChar);
+    // Debounced state of key index (row * numCols + col)
+    inline bool isPressed(uint16_t index) const {
+        return (pressedBits[index >> 5] >> (index & 31)) & 1u;
+    }
     
-    // Set debounce time (default is 10ms)
+    // Set debounce time (default is 20ms)
     void setDebounceTime(uint8_t debounce);
     
-    // Accessors for dynamic key array
-    inline uint16_t getKeyCount() const { return keyCount; }
-    inline const MatrixKey* getKeyArray() const { return key; }
+    // Packed bitmaps, getWordCount() words each; bit i = key index i
+    inline const uint32_t* getPressedBits() const { return pressedBits; }
+    inline const uint32_t* getChangedBits() const { return changedBits; }
+    inline const uint32_t* getRawBits() const { return rawBits; }
+    inline uint16_t getWordCount() const { return wordCount; }
+    inline uint16_t getKeyCount() const { return totalKeys; }
+
+    // True when the PIO backend is scanning
+    inline bool isPioScanned() const { return pioScanner != nullptr; }
 };
@@ -3,24 +3,25 @@
 #include "../../Config.h"
 #include "../../rp2040/JoystickWrapper.h"
 #include "ButtonMatrix.h"
+#include "ButtonInput.h"
+#include "ButtonKernel.h"
 #include <new>
-#include "LogicalButton.h"
 
 // Dynamic matrix config and storage
 static uint8_t ROWS = 0;
 static uint8_t COLS = 0;
-static uint16_t PREV_TOTAL = 0;
 static byte* rowPins = nullptr;
 static byte* colPins = nullptr;
-static char* keymap = nullptr;
 // ButtonMatrix instance
 static ButtonMatrix* buttonMatrix = nullptr;
 
-// Per-position logical button storage
-static RuntimeLogicalButton** matrixLogicalButtons = nullptr; // [ROWS*COLS][variable]
-static uint8_t* matrixLogicalCounts = nullptr; // counts per position
+// Logical buttons live in g_buttonKernel; bit (r * COLS + c) of this source is key (r, c)
+static uint8_t matrixSource = ButtonKernel::NO_SOURCE;
 
-bool g_encoderMatrixPinStates[20] = {1};
+// Publishes the debounced pressed bitmap (key index == r * COLS + c) to the kernel
+static void publishMatrixState(uint32_t now) {
+    g_buttonKernel.update(matrixSource, buttonMatrix->getPressedBits(), now);
+}
 
 static bool pinEqualsName(uint8_t pin, const char* pinName) {
     char buf[8];
@@ -43,22 +44,12 @@ void initMatrixFromLogical(const LogicalInput* logicals, uint8_t logicalCount) {
     // Free previous allocations if reinitialized
     delete[] rowPins; rowPins = nullptr;
     delete[] colPins; colPins = nullptr;
-    delete[] keymap; keymap = nullptr;
-    if (matrixLogicalButtons) {
-        for (uint16_t i = 0; i < PREV_TOTAL; ++i) delete[] matrixLogicalButtons[i];
-        delete[] matrixLogicalButtons;
-        matrixLogicalButtons = nullptr;
-    }
-    delete[] matrixLogicalCounts; matrixLogicalCounts = nullptr;
+    matrixSource = ButtonKernel::NO_SOURCE;
 
     if (ROWS == 0 || COLS == 0) return;
 
     rowPins = new byte[ROWS]();
     colPins = new byte[COLS]();
-    keymap = new char[total]();
-    matrixLogicalCounts = new uint8_t[total]();
-    matrixLogicalButtons = new RuntimeLogicalButton*[total]();
-    PREV_TOTAL = total;
 
     // Fill row/col pins excluding encoder pins
     uint8_t rowIdx = 0, colIdx = 0;
@@ -67,7 +58,7 @@ void initMatrixFromLogical(const LogicalInput* logicals, uint8_t logicalCount) {
         bool isEncoderPin = false;
         for (uint8_t j = 0; j < logicalCount; ++j) {
             if (logicals[j].type == INPUT_PIN &&
-                (logicals[j].u.pin.behavior == ENC_A || logicals[j].u.pin.behavior == ENC_B) &&
+                isEncoderBehavior(logicals[j].u.pin.behavior) &&
                 pinEqualsName(logicals[j].u.pin.pin, pinName)) { isEncoderPin = true; break; }
         }
         if (!isEncoderPin) {
@@ -77,101 +68,38 @@ void initMatrixFromLogical(const LogicalInput* logicals, uint8_t logicalCount) {
         }
     }
 
-    for (uint8_t r = 0; r < ROWS; ++r) {
-        for (uint8_t c = 0; c < COLS; ++c) {
-            keymap[r * COLS + c] = 'A' + r * COLS + c;
-        }
-    }
-
-    // Fill logical buttons (per position dynamic arrays sized to count)
-    // First pass: count per position
+    // Register logical buttons with the shared kernel (encoder phases are handled elsewhere)
+    matrixSource = g_buttonKernel.addSource(total);
     for (uint8_t i = 0; i < logicalCount; ++i) {
         if (logicals[i].type == INPUT_MATRIX) {
             uint8_t r = logicals[i].u.matrix.row;
             uint8_t c = logicals[i].u.matrix.col;
-            if (r < ROWS && c < COLS) {
-                uint16_t idx = r * COLS + c;
-                matrixLogicalCounts[idx]++;
-            }
-        }
-    }
-    // Allocate per position arrays
-    for (uint16_t idx = 0; idx < total; ++idx) {
-        uint8_t cnt = matrixLogicalCounts[idx];
-        matrixLogicalButtons[idx] = (cnt > 0) ? new RuntimeLogicalButton[cnt]() : nullptr;
-        matrixLogicalCounts[idx] = 0; // reuse as write index in next pass
-    }
-    // Second pass: populate
-    for (uint8_t i = 0; i < logicalCount; ++i) {
-        if (logicals[i].type == INPUT_MATRIX) {
-            uint8_t r = logicals[i].u.matrix.row;
-            uint8_t c = logicals[i].u.matrix.col;
-            if (r < ROWS && c < COLS) {
-                uint16_t idx = r * COLS + c;
-                uint8_t w = matrixLogicalCounts[idx]++;
-                RuntimeLogicalButton &dest = matrixLogicalButtons[idx][w];
-                dest.joyButtonID = logicals[i].u.matrix.joyButtonID;
-                dest.behavior = logicals[i].u.matrix.behavior;
-                dest.reverse = logicals[i].u.matrix.reverse;
-                dest.lastState = false;
-                dest.momentaryStartTime = 0;
-                dest.momentaryActive = false;
+            ButtonBehavior behavior = logicals[i].u.matrix.behavior;
+            if (r < ROWS && c < COLS && !isEncoderBehavior(behavior)) {
+                g_buttonKernel.addBinding(matrixSource, r * COLS + c, logicals[i].u.matrix.joyButtonID,
+                                          behavior == MOMENTARY, logicals[i].u.matrix.reverse);
             }
         }
     }
+    g_buttonKernel.finalize();
 
     if (!buttonMatrix) {
-        buttonMatrix = new ButtonMatrix(keymap, rowPins, colPins, ROWS, COLS);
+        buttonMatrix = new ButtonMatrix(rowPins, colPins, ROWS, COLS, MATRIX_BACKEND, MATRIX_SETTLE_US);
     } else {
-        // Recreate on size change
+        // Recreate on size change (releases the PIO scanner before the new one claims it)
         delete buttonMatrix;
-        buttonMatrix = new ButtonMatrix(keymap, rowPins, colPins, ROWS, COLS);
+        buttonMatrix = new ButtonMatrix(rowPins, colPins, ROWS, COLS, MATRIX_BACKEND, MATRIX_SETTLE_US);
     }
 
     buttonMatrix->getKeys();
-    for (uint8_t r = 0; r < ROWS; ++r) {
-        for (uint8_t c = 0; c < COLS; ++c) {
-            uint16_t idx = r * COLS + c;
-            char keyChar = keymap[idx];
-            bool physicalPressed = buttonMatrix->isPressed(keyChar);
-            for (uint8_t b = 0; b < matrixLogicalCounts[idx]; ++b) {
-                RuntimeLogicalButton &btn = matrixLogicalButtons[idx][b];
-                bool effective = physicalPressed;
-                if (btn.reverse) effective = !effective;
-                btn.lastState = effective;
-                btn.momentaryActive = false;
-            }
-        }
-    }
+    publishMatrixState(millis()); // prime the kernel snapshot; edits flush with the next update
 }
 
 void updateMatrix() {
-    uint32_t now = millis();
+    if (!buttonMatrix) return;
     if (buttonMatrix->getKeys()) {
-    for (uint16_t i = 0; i < buttonMatrix->getKeyCount(); i++) {
-            if (buttonMatrix->key[i].stateChanged) {
-                char keyChar = buttonMatrix->key[i].kchar;
-                MatrixKeyState keyState = buttonMatrix->key[i].kstate;
-                uint16_t idx = 0;
-                for (uint16_t j = 0; j < (uint16_t)ROWS * COLS; ++j) { if (keymap[j] == keyChar) { idx = j; break; } }
-        for (uint8_t b = 0; b < matrixLogicalCounts[idx]; ++b) {
-                    RuntimeLogicalButton &btn = matrixLogicalButtons[idx][b];
-                    if (btn.behavior == ENC_A || btn.behavior == ENC_B) continue;
-                    bool physicalPressed = (keyState == MATRIX_PRESSED || keyState == MATRIX_HELD);
-                    processLogicalButton(now, physicalPressed, btn);
-                }
-            }
-        }
-    }
-
-    for (uint8_t pin = 0; pin < 20; pin++) g_encoderMatrixPinStates[pin] = 1;
-    for (uint8_t r = 0; r < ROWS; r++) {
-        for (uint8_t c = 0; c < COLS; c++) {
-            uint16_t idx = r * COLS + c;
-            char keyChar = keymap[idx];
-            bool isPressed = buttonMatrix->isPressed(keyChar);
-            if (isPressed) g_encoderMatrixPinStates[rowPins[r]] = 0;
-        }
+        publishMatrixState(millis());
+        applyButtonKernelEdits();
     }
 }
 
@@ -182,4 +110,5 @@ uint8_t getMatrixCols() { return COLS; }
 namespace MatrixRawAccess {
     uint8_t* getRowPins() { return rowPins; }
     uint8_t* getColPins() { return colPins; }
+    const uint32_t* getRawKeyBits() { return buttonMatrix ? buttonMatrix->getRawBits() : nullptr; }
 }
\ No newline at end of file
@@ -15,4 +15,6 @@ uint8_t getMatrixCols();
 namespace MatrixRawAccess {
     uint8_t* getRowPins();
     uint8_t* getColPins();
+    // Undebounced key bitmap (bit r * cols + c, 1 = pressed), nullptr before init
+    const uint32_t* getRawKeyBits();
 }
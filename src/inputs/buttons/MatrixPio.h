@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include "MatrixScan.h"
+
+// PIO matrix scan program and its host-side planning (no Arduino dependency, host-testable).
+//
+// The state machine walks the columns forever: each column word pulled from the TX FIFO sets
+// the pin directions of the column span (exactly one column drives its LOW latch), the SM
+// waits a settle count held in Y, then samples the whole GPIO bank with one `in pins, 32`.
+// A TX DMA channel replays the column table from a RAM ring and an RX DMA channel writes
+// every sample into a second ring of the same length, so entry i of the sample ring is
+// always the bank read while column table entry i was driven. The CPU only reads RAM.
+//
+//   .program matrix_scan
+//       pull block          ; settle count, sent once by the CPU
+//       out y, 32
+//   .wrap_target
+//       out pindirs, 32     ; autopull: next column word, only that column drives LOW
+//       mov x, y
+//   settle:
+//       jmp x-- settle      ; Y + 1 cycles
+//       in pins, 32         ; autopush: one GPIO bank sample per column
+//   .wrap
+//
+// Pins are driven one cycle after `out` and `in` sees them through the 2-cycle input
+// synchronizer, so rows get exactly Y cycles to settle and each column takes Y + 4 cycles.
+static constexpr uint16_t MATRIX_PIO_PROGRAM[] = {
+    0x80A0, // 0: pull block
+    0x6040, // 1: out y, 32
+    0x6080, // 2: out pindirs, 32   (wrap target)
+    0xA022, // 3: mov x, y
+    0x0044, // 4: jmp x--, 4
+    0x4000, // 5: in pins, 32       (wrap)
+};
+static constexpr uint8_t MATRIX_PIO_PROGRAM_LENGTH = sizeof(MATRIX_PIO_PROGRAM) / sizeof(MATRIX_PIO_PROGRAM[0]);
+static constexpr uint8_t MATRIX_PIO_WRAP_TARGET = 2;
+static constexpr uint8_t MATRIX_PIO_WRAP = 5;
+static constexpr uint32_t MATRIX_PIO_COLUMN_OVERHEAD_CYCLES = 4; // out + mov + final jmp + in
+
+// Column table and DMA ring geometry for one matrix
+struct MatrixPioPlan {
+    uint8_t outBase = 0;     // lowest column GPIO (OUT pin base)
+    uint8_t outCount = 0;    // column span, lowest to highest column GPIO
+    uint8_t steps = 0;       // ring length in words: numCols rounded up to a power of two
+    uint8_t ringBits = 0;    // DMA ring size, log2(steps * 4 bytes)
+    uint32_t columnWords[MATRIX_SCAN_MAX_LINES] = {}; // pindirs per step, relative to outBase
+};
+
+// Builds the column table. Padding steps (steps > numCols) drive no column; their samples are
+// ignored. Returns false when no column is on the GPIO bank.
+inline bool matrixPioPlan(const MatrixScanLayout& l, MatrixPioPlan& p) {
+    p = MatrixPioPlan();
+    if (!l.numCols || !l.colMask) return false;
+    const uint8_t lo = (uint8_t)__builtin_ctz(l.colMask);
+    const uint8_t hi = (uint8_t)(31 - __builtin_clz(l.colMask));
+    p.outBase = lo;
+    p.outCount = (uint8_t)(hi - lo + 1);
+    p.steps = 1;
+    p.ringBits = 2;
+    while (p.steps < l.numCols) { p.steps <<= 1; p.ringBits++; }
+    for (uint8_t c = 0; c < l.numCols; ++c) p.columnWords[c] = l.colBit[c] >> lo;
+    return true;
+}
+
+// Settle time in SM cycles (the value loaded into Y)
+inline uint32_t matrixPioSettleCycles(uint32_t settleUs, uint32_t sysClkHz) {
+    return (uint32_t)(((uint64_t)settleUs * sysClkHz + 999999u) / 1000000u);
+}
+
+// SM cycles for one pass over every step of the ring
+inline uint32_t matrixPioFrameCycles(const MatrixPioPlan& p, uint32_t settleCycles) {
+    return (uint32_t)p.steps * (settleCycles + MATRIX_PIO_COLUMN_OVERHEAD_CYCLES);
+}
+
+// Converts the sample ring (one GPIO bank word per step) into the row-major raw bitmap
+inline void matrixPioExtract(const MatrixScanLayout& l, const volatile uint32_t* samples,
+                             uint32_t* raw, uint16_t wordCount) {
+    for (uint16_t w = 0; w < wordCount; ++w) raw[w] = 0;
+    for (uint8_t c = 0; c < l.numCols; ++c) matrixScanStoreColumn(l, c, samples[c], raw);
+}
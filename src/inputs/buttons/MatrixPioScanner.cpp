@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "MatrixPioScanner.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+
+static const pio_program_t matrixScanProgram = {
+    MATRIX_PIO_PROGRAM, MATRIX_PIO_PROGRAM_LENGTH, -1
+};
+
+// Each DMA run is restarted from the ring base when it ends (hours apart at any settle time)
+static constexpr uint32_t MATRIX_PIO_DMA_RUN = 0xFFFFFFFFu;
+
+MatrixPioScanner::~MatrixPioScanner() {
+    release();
+}
+
+void MatrixPioScanner::release() {
+    if (_pio && _sm >= 0) pio_sm_set_enabled(_pio, (uint)_sm, false);
+    if (_txChan >= 0) { dma_channel_abort(_txChan); dma_channel_unclaim(_txChan); _txChan = -1; }
+    if (_rxChan >= 0) { dma_channel_abort(_rxChan); dma_channel_unclaim(_rxChan); _rxChan = -1; }
+    if (_pio && _offset >= 0) pio_remove_program(_pio, &matrixScanProgram, (uint)_offset);
+    if (_pio && _sm >= 0) {
+        pio_sm_set_pindirs_with_mask(_pio, (uint)_sm, 0, _layout ? _layout->colMask : 0);
+        pio_sm_unclaim(_pio, (uint)_sm);
+    }
+    // Columns go back to SIO inputs (pull-ups were set by the owner)
+    if (_layout) {
+        for (uint32_t m = _layout->colMask; m; m &= m - 1) gpio_set_function((uint)__builtin_ctz(m), GPIO_FUNC_SIO);
+    }
+    _pio = nullptr;
+    _sm = -1;
+    _offset = -1;
+}
+
+bool MatrixPioScanner::begin(const MatrixScanLayout& layout, uint32_t settleUs) {
+    if (!matrixPioPlan(layout, _plan)) return false;
+    _layout = &layout;
+
+    // First PIO block with a free state machine and room for the program
+    PIO blocks[2] = { pio0, pio1 };
+    for (PIO pio : blocks) {
+        if (!pio_can_add_program(pio, &matrixScanProgram)) continue;
+        const int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) continue;
+        _pio = pio;
+        _sm = sm;
+        _offset = pio_add_program(pio, &matrixScanProgram);
+        break;
+    }
+    if (!_pio) return false;
+    _txChan = dma_claim_unused_channel(false);
+    _rxChan = dma_claim_unused_channel(false);
+    if (_txChan < 0 || _rxChan < 0) { release(); return false; }
+
+    for (uint8_t i = 0; i < _plan.steps; ++i) {
+        _columnRing[i] = _plan.columnWords[i];
+        _sampleRing[i] = 0xFFFFFFFFu; // all released until the first pass lands
+    }
+
+    const uint sm = (uint)_sm;
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, (uint)_offset + MATRIX_PIO_WRAP_TARGET, (uint)_offset + MATRIX_PIO_WRAP);
+    sm_config_set_out_pins(&c, _plan.outBase, _plan.outCount);
+    sm_config_set_in_pins(&c, 0);                  // `in pins, 32` = whole GPIO bank
+    sm_config_set_out_shift(&c, true, true, 32);   // autopull
+    sm_config_set_in_shift(&c, false, true, 32);   // autopush
+    sm_config_set_clkdiv(&c, 1.0f);
+    pio_sm_init(_pio, sm, (uint)_offset, &c);
+
+    // Columns: LOW latch, released (input) until the program selects them
+    pio_sm_set_pins_with_mask(_pio, sm, 0, layout.colMask);
+    pio_sm_set_pindirs_with_mask(_pio, sm, 0, layout.colMask);
+    for (uint32_t m = layout.colMask; m; m &= m - 1) pio_gpio_init(_pio, (uint)__builtin_ctz(m));
+
+    const uint32_t settleCycles = matrixPioSettleCycles(settleUs, clock_get_hz(clk_sys));
+    pio_sm_put(_pio, sm, settleCycles); // consumed by the `pull` / `out y` prologue
+    const uint32_t frameCycles = matrixPioFrameCycles(_plan, settleCycles);
+    _scanRateHz = frameCycles ? clock_get_hz(clk_sys) / frameCycles : 0;
+
+    dma_channel_config tx = dma_channel_get_default_config(_txChan);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_32);
+    channel_config_set_read_increment(&tx, true);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_ring(&tx, false, _plan.ringBits);
+    channel_config_set_dreq(&tx, pio_get_dreq(_pio, sm, true));
+    dma_channel_configure(_txChan, &tx, &_pio->txf[sm], _columnRing, MATRIX_PIO_DMA_RUN, false);
+
+    dma_channel_config rx = dma_channel_get_default_config(_rxChan);
+    channel_config_set_transfer_data_size(&rx, DMA_SIZE_32);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, true);
+    channel_config_set_ring(&rx, true, _plan.ringBits);
+    channel_config_set_dreq(&rx, pio_get_dreq(_pio, sm, false));
+    dma_channel_configure(_rxChan, &rx, _sampleRing, &_pio->rxf[sm], MATRIX_PIO_DMA_RUN, false);
+
+    startDma();
+    pio_sm_set_enabled(_pio, sm, true);
+    return true;
+}
+
+void MatrixPioScanner::startDma() {
+    // Both rings restart at entry 0 so sample i stays paired with column word i
+    dma_channel_set_read_addr(_txChan, _columnRing, false);
+    dma_channel_set_trans_count(_txChan, MATRIX_PIO_DMA_RUN, false);
+    dma_channel_set_write_addr(_rxChan, _sampleRing, false);
+    dma_channel_set_trans_count(_rxChan, MATRIX_PIO_DMA_RUN, false);
+    dma_start_channel_mask((1u << _rxChan) | (1u << _txChan));
+}
+
+void MatrixPioScanner::read(uint32_t* raw, uint16_t wordCount) {
+    if (!_pio) return;
+    // The RX run ends last (every column word yields one sample); the SM waits on autopull
+    if (!dma_channel_is_busy(_rxChan)) startDma();
+    matrixPioExtract(*_layout, _sampleRing, raw, wordCount);
+}
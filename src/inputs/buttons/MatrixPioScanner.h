@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include "MatrixPio.h"
+
+// Continuous matrix scan on a PIO state machine with DMA into RAM (MATRIX_BACKEND_PIO).
+// Column pins are handed to the PIO; rows stay SIO inputs with pull-ups, since any pin can
+// be sampled by `in pins`. Once started the scan runs with no CPU involvement: read() just
+// converts the latest sample of every column, which is at most one frame old.
+//
+// No other PIO output may sit between the first and the last column GPIO: the program
+// writes the direction of that whole span.
+class MatrixPioScanner {
+public:
+    ~MatrixPioScanner();
+
+    // Claims a state machine and two DMA channels and starts scanning. Returns false (and
+    // releases everything) when no PIO or DMA resource is free; the caller keeps using SIO.
+    bool begin(const MatrixScanLayout& layout, uint32_t settleUs);
+
+    // Row-major raw bitmap (1 = pressed) from the sample ring
+    void read(uint32_t* raw, uint16_t wordCount);
+
+    // Full-matrix scans per second at the current system clock
+    uint32_t getScanRateHz() const { return _scanRateHz; }
+
+private:
+    void startDma();
+    void release();
+
+    const MatrixScanLayout* _layout = nullptr;
+    MatrixPioPlan _plan;
+    PIO _pio = nullptr;
+    int _sm = -1;
+    int _offset = -1;
+    int _txChan = -1;
+    int _rxChan = -1;
+    uint32_t _scanRateHz = 0;
+    // DMA rings must be aligned to their size (at most 32 words)
+    alignas(128) uint32_t _columnRing[MATRIX_SCAN_MAX_LINES] = {};
+    alignas(128) volatile uint32_t _sampleRing[MATRIX_SCAN_MAX_LINES] = {};
+};
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Mask-based matrix scan engine (no Arduino dependency, host-benchmarkable).
+//
+// Column output latches are held LOW once at init; driving a column is then just a
+// direction change of the whole column set in one masked write, so idle columns float
+// on their pull-ups without per-pin pinMode calls. All rows are sampled with a single
+// GPIO bank read per column and cells are extracted with shifts.
+
+static constexpr uint8_t MATRIX_SCAN_MAX_LINES = 32; // GPIO bank width
+static constexpr uint8_t MATRIX_SCAN_NO_PIN = 0xFF;
+
+struct MatrixScanLayout {
+    uint8_t numRows = 0;
+    uint8_t numCols = 0;
+    uint32_t rowMask = 0;                        // all row GPIOs
+    uint32_t colMask = 0;                        // all column GPIOs
+    uint8_t rowPin[MATRIX_SCAN_MAX_LINES] = {};  // GPIO number per row
+    uint32_t colBit[MATRIX_SCAN_MAX_LINES] = {}; // GPIO mask per column
+};
+
+// Precomputes the masks; pins >= 32 are ignored (they would never read as pressed).
+inline void matrixScanLayoutInit(MatrixScanLayout& l, const uint8_t* rowPins, const uint8_t* colPins,
+                                 uint8_t numRows, uint8_t numCols) {
+    l.numRows = numRows < MATRIX_SCAN_MAX_LINES ? numRows : MATRIX_SCAN_MAX_LINES;
+    l.numCols = numCols < MATRIX_SCAN_MAX_LINES ? numCols : MATRIX_SCAN_MAX_LINES;
+    l.rowMask = 0;
+    l.colMask = 0;
+    for (uint8_t r = 0; r < l.numRows; ++r) {
+        l.rowPin[r] = (rowPins[r] < 32) ? rowPins[r] : MATRIX_SCAN_NO_PIN;
+        if (rowPins[r] < 32) l.rowMask |= 1u << rowPins[r];
+    }
+    for (uint8_t c = 0; c < l.numCols; ++c) {
+        l.colBit[c] = (colPins[c] < 32) ? (1u << colPins[c]) : 0;
+        l.colMask |= l.colBit[c];
+    }
+}
+
+// ORs the keys of column c that read LOW in the GPIO bank sample into raw (row-major bitmap)
+inline void matrixScanStoreColumn(const MatrixScanLayout& l, uint8_t c, uint32_t sample, uint32_t* raw) {
+    const uint32_t low = ~sample & l.rowMask;
+    if (!low) return; // nothing pressed in this column
+    uint16_t idx = c;
+    for (uint8_t r = 0; r < l.numRows; ++r, idx += l.numCols) {
+        if (l.rowPin[r] < 32 && ((low >> l.rowPin[r]) & 1u)) raw[idx >> 5] |= 1u << (idx & 31);
+    }
+}
+
+// Scans every column into raw (row-major bit r * numCols + c, 1 = pressed).
+// Gpio provides:
+//   void setDirMasked(uint32_t mask, uint32_t outputs); // e.g. gpio_set_dir_masked
+//   uint32_t readAll();                                 // e.g. gpio_get_all
+//   void settle();                                      // column settle delay
+template <typename Gpio>
+inline void matrixScanRaw(const MatrixScanLayout& l, Gpio& gpio, uint32_t* raw, uint16_t wordCount) {
+    for (uint16_t w = 0; w < wordCount; ++w) raw[w] = 0;
+    for (uint8_t c = 0; c < l.numCols; ++c) {
+        gpio.setDirMasked(l.colMask, l.colBit[c]); // only column c drives LOW
+        gpio.settle();
+        matrixScanStoreColumn(l, c, gpio.readAll(), raw);
+    }
+    gpio.setDirMasked(l.colMask, 0); // release all columns
+}
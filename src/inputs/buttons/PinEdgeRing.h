@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Direct-pin edge event captured by the GPIO interrupt (BUTTON_PIN_MODE_IRQ, see ButtonInput.cpp)
+struct PinEdgeEvent {
+    uint32_t pins;    // GPIOs whose edge raised this interrupt
+    uint32_t levels;  // all GPIO levels read in the handler (gpio_get_all, HIGH = released)
+    uint64_t timeUs;  // time_us_64() at handler entry
+};
+
+// Lock-free single-producer (GPIO interrupt) / single-consumer (scan loop) ring of edge events.
+// Indices are free-running 16-bit counters; only loads and stores are used, so it needs no
+// read-modify-write atomics on Cortex-M0+. A full ring drops the new event and counts it; the
+// consumer then resynchronizes from a direct GPIO read.
+template <uint16_t CAPACITY>
+class PinEdgeRing {
+    static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+    static_assert(CAPACITY <= 0x8000, "capacity must fit the 16-bit indices");
+
+public:
+    // Producer (interrupt handler)
+    bool push(const PinEdgeEvent& e) {
+        const uint16_t head = _head.load(std::memory_order_relaxed);
+        if ((uint16_t)(head - _tail.load(std::memory_order_acquire)) >= CAPACITY) {
+            _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            return false;
+        }
+        _events[head & (CAPACITY - 1)] = e;
+        _head.store((uint16_t)(head + 1), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: oldest event or nullptr; pop() releases it
+    const PinEdgeEvent* peek() const {
+        const uint16_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return nullptr;
+        return &_events[tail & (CAPACITY - 1)];
+    }
+    void pop() {
+        _tail.store((uint16_t)(_tail.load(std::memory_order_relaxed) + 1), std::memory_order_release);
+    }
+
+    uint16_t size() const {
+        return (uint16_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed));
+    }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_acquire); }
+
+private:
+    PinEdgeEvent _events[CAPACITY];
+    std::atomic<uint16_t> _head{0};
+    std::atomic<uint16_t> _tail{0};
+    std::atomic<uint32_t> _dropped{0};
+};
+
+// Drains the events that belong in the current report and passes each to
+// apply(const PinEdgeEvent&), oldest first. touched holds the pins already changed in this
+// report (clear it when a new report starts); draining stops before an event that touches one
+// of them again, so a press and its release never collapse into the same report: a tap shorter
+// than the scan cycle is still pressed in one built report. Carrying it from there to the host
+// past core0's newest-snapshot, 1 ms rate-limited send is ReportPressLatch's job.
+// Returns the number of events applied.
+template <uint16_t CAPACITY, typename Apply>
+inline uint16_t drainPinEdgesForReport(PinEdgeRing<CAPACITY>& ring, uint32_t& touched, Apply apply) {
+    uint16_t n = 0;
+    while (const PinEdgeEvent* e = ring.peek()) {
+        if (e->pins & touched) break;
+        touched |= e->pins;
+        apply(*e);
+        ring.pop();
+        n++;
+    }
+    return n;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Encoder acceleration (ENCODER_FLAG_ACCEL; no Arduino dependency, host-testable).
+//
+// The detent rate is taken from the scan-cycle timestamps RotaryEncoder stores on each latch.
+// Up to slowRate detents/s every detent counts once; the multiplier then rises linearly with
+// the rate up to maxFactor at fastRate. Fractions are carried to the next detent, so a factor of
+// 1.5 emits 3 steps per 2 detents. The scaled count feeds both the button pulses and the axis.
+struct EncoderAccelCurve {
+    uint16_t slowRate;   // detents/s at or below which the factor is 1
+    uint16_t fastRate;   // detents/s at or above which the factor is maxFactor
+    uint8_t maxFactor;   // steps per detent when spun fast
+};
+
+struct EncoderAccel {
+    int32_t residueQ8 = 0;  // fractional steps carried over, 1/256 units
+};
+
+// Steps per detent in 1/256 units for a detent interval in microseconds (0 = unknown)
+inline uint32_t encoderAccelFactorQ8(const EncoderAccelCurve& c, uint32_t intervalUs) {
+    if (!intervalUs || c.maxFactor <= 1 || c.fastRate <= c.slowRate) return 256;
+    const uint32_t rate = 1000000u / intervalUs;
+    if (rate <= c.slowRate) return 256;
+    if (rate >= c.fastRate) return (uint32_t)c.maxFactor * 256;
+    return 256 + (uint32_t)(((uint64_t)(c.maxFactor - 1) * 256 * (rate - c.slowRate)) / (c.fastRate - c.slowRate));
+}
+
+// Scales detents latched this cycle; intervalUs is the time per detent. A direction change drops
+// the carried fraction so a reversal always starts at one step per detent.
+inline int32_t encoderAccelApply(EncoderAccel& a, const EncoderAccelCurve& c, int32_t detents, uint32_t intervalUs) {
+    if (!detents) return 0;
+    if (a.residueQ8 && (detents > 0) != (a.residueQ8 > 0)) a.residueQ8 = 0;
+    const int64_t q = (int64_t)detents * encoderAccelFactorQ8(c, intervalUs) + a.residueQ8;
+    const int32_t steps = (int32_t)(q / 256);
+    a.residueQ8 = (int32_t)(q - (int64_t)steps * 256);
+    return steps;
+}
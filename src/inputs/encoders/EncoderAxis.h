@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Encoder position -> HID axis value (ENC_AXIS_A; no Arduino dependency, host-testable).
+//
+// The value is recomputed every scan cycle and written straight into the report, so each detent
+// reaches the host in the next report instead of waiting for a button pulse slot. Only the eight
+// report axes the analog subsystem never drives (axes[8..15], Wheel onwards) are used.
+static constexpr uint8_t ENCODER_AXIS_FIRST = 8;   // report index of HID axis 9
+static constexpr uint8_t ENCODER_AXIS_LAST = 15;   // report index of HID axis 16
+static constexpr int32_t ENCODER_AXIS_MAX = 32767; // report range is symmetric, -32767..32767
+
+enum EncoderAxisMode : uint8_t {
+    ENCODER_AXIS_WRAP = 0,     // absolute position, wraps from one end to the other
+    ENCODER_AXIS_CLAMP = 1,    // absolute position, stops at the ends
+    ENCODER_AXIS_RELATIVE = 2  // turn rate: each detent adds a step, the sum decays back to 0
+};
+
+// Report axis index for a configured HID axis number (9-16), or -1
+inline int8_t encoderAxisIndex(uint8_t axisNumber) {
+    if (axisNumber < ENCODER_AXIS_FIRST + 1 || axisNumber > ENCODER_AXIS_LAST + 1) return -1;
+    return (int8_t)(axisNumber - 1);
+}
+
+struct EncoderAxis {
+    EncoderAxisMode mode = ENCODER_AXIS_WRAP;
+    int32_t step = 0;       // axis units per detent
+    uint32_t decayUs = 0;   // ENCODER_AXIS_RELATIVE: decay time constant
+    int32_t value = 0;
+    int32_t rateQ8 = 0;     // ENCODER_AXIS_RELATIVE: value in 1/256 units, so slow decay is not lost
+    uint32_t lastUs = 0;
+    bool started = false;
+};
+
+inline void encoderAxisInit(EncoderAxis& a, EncoderAxisMode mode, int32_t step, uint32_t decayUs) {
+    a.mode = mode;
+    a.step = step;
+    a.decayUs = decayUs ? decayUs : 1;
+    a.value = 0;
+    a.rateQ8 = 0;
+    a.lastUs = 0;
+    a.started = false;
+}
+
+// Applies the detents since the last call (positive = CW) and returns the axis value for this report
+inline int16_t encoderAxisStep(EncoderAxis& a, int32_t detents, uint32_t nowUs) {
+    if (a.mode == ENCODER_AXIS_RELATIVE) {
+        // First-order decay, v -= v * dt / decayUs, so steady turning at r detents/s settles
+        // at r * step * decayUs. Rounded away from zero so the value always returns to 0.
+        const uint32_t dt = a.started ? (uint32_t)(nowUs - a.lastUs) : 0;
+        int64_t q = a.rateQ8;
+        if (dt >= a.decayUs) q = 0;
+        else if (q) {
+            const int64_t mag = q < 0 ? -q : q;
+            const int64_t dec = (mag * dt + a.decayUs - 1) / a.decayUs;
+            q = (mag <= dec) ? 0 : (q < 0 ? -(mag - dec) : mag - dec);
+        }
+        q += (int64_t)detents * a.step * 256;
+        const int64_t limit = (int64_t)ENCODER_AXIS_MAX * 256;
+        if (q > limit) q = limit;
+        if (q < -limit) q = -limit;
+        a.rateQ8 = (int32_t)q;
+        a.lastUs = nowUs;
+        a.started = true;
+        a.value = (int32_t)(q / 256);
+        return (int16_t)a.value;
+    }
+    const int32_t span = 2 * ENCODER_AXIS_MAX + 1;
+    int64_t v = (int64_t)a.value + (int64_t)detents * a.step;
+    if (a.mode == ENCODER_AXIS_WRAP) {
+        v = (v + ENCODER_AXIS_MAX) % span;
+        if (v < 0) v += span;
+        v -= ENCODER_AXIS_MAX;
+    } else {
+        if (v > ENCODER_AXIS_MAX) v = ENCODER_AXIS_MAX;
+        if (v < -ENCODER_AXIS_MAX) v = -ENCODER_AXIS_MAX;
+    }
+    a.value = (int32_t)v;
+    return (int16_t)v;
+}
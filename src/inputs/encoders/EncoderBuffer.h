@@ -1,10 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 #include <Arduino.h>
-
-// Timing constants for encoder buffer system
-static const uint32_t PRESS_INTERVAL_US = 40000;  // 40ms interval between presses
-static const uint32_t PRESS_DURATION_US = 40000;  // 40ms press duration for USB
+#include "EncoderSchedule.h"
 
 /**
  * @brief Buffer structure for managing encoder timing and USB output
@@ -12,11 +9,19 @@ static const uint32_t PRESS_DURATION_US = 40000;  // 40ms press duration for USB
 struct EncoderBuffer {
     uint8_t cwButtonId;
     uint8_t ccwButtonId;
-    uint8_t pendingCwSteps;
-    uint8_t pendingCcwSteps;
-    uint32_t lastUsbPressTime;  // Timing for USB output
-    bool usbButtonPressed;      // State for USB output
-    uint8_t currentDirection;   // 0 = none, 1 = CW, 2 = CCW
+    EncoderSchedule schedule;   // Pending steps and pulse timing for USB output
+};
+
+/**
+ * @brief Scheduler counters for one encoder (ENCODER_STATS serial command)
+ */
+struct EncoderBufferStats {
+    uint32_t steps;       // Steps accepted into the queue
+    uint32_t overflow;    // Steps that did not fit the queue
+    uint32_t maxBacklog;  // Deepest queue seen
+    uint32_t pressUs;     // Configured press duration
+    uint32_t releaseUs;   // Configured release duration
+    bool burst;           // ENCODER_FLAG_BURST set
 };
 
 /**
@@ -26,11 +31,11 @@ struct EncoderBuffer {
 void initEncoderBuffers(uint8_t capacity = 0);
 
 /**
- * @brief Add steps to buffer for consistent timing
- * @param buttonId The button ID to add steps for
- * @param steps Number of steps to add
+ * @brief Add steps to an encoder's buffer for consistent timing
+ * @param index Buffer index returned by createEncoderBufferEntry
+ * @param delta Detents since the last call (positive = clockwise)
  */
-void addEncoderSteps(uint8_t buttonId, uint8_t steps);
+void addEncoderSteps(uint8_t index, int32_t delta);
 
 /**
  * @brief Process timing buffers for consistent intervals
@@ -41,12 +46,22 @@ void processEncoderBuffers();
  * @brief Set up buffer entry for an encoder pair
  * @param cwButtonId Clockwise button ID
  * @param ccwButtonId Counter-clockwise button ID
+ * @param pressMs Press duration in ms (0 = ENCODER_PRESS_MS)
+ * @param releaseMs Release duration in ms (0 = ENCODER_RELEASE_MS)
+ * @param flags ENCODER_FLAG_* bits
  * @return Index of the created buffer entry, or 255 if failed
  */
-uint8_t createEncoderBufferEntry(uint8_t cwButtonId, uint8_t ccwButtonId);
+uint8_t createEncoderBufferEntry(uint8_t cwButtonId, uint8_t ccwButtonId,
+                                 uint8_t pressMs = 0, uint8_t releaseMs = 0, uint8_t flags = 0);
 
 /**
  * @brief Get the current buffer count
  * @return Number of active encoder buffers
  */
-uint8_t getEncoderBufferCount(); 
\ No newline at end of file
+uint8_t getEncoderBufferCount();
+
+/**
+ * @brief Read scheduler counters of one encoder
+ * @return false if index is out of range
+ */
+bool getEncoderBufferStats(uint8_t index, EncoderBufferStats& out);
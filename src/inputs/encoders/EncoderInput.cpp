@@ -1,117 +1,169 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "EncoderInput.h"
 #include "EncoderBuffer.h"
+#include "EncoderAxis.h"
+#include "EncoderAccel.h"
 #include "../../rp2040/JoystickWrapper.h"
 #include "../../Config.h"
 #include "RotaryEncoder.h"
+#include "QuadraturePioBank.h"
 #include "../shift_register/ShiftRegister165.h"
+#include "../buttons/MatrixInput.h"
+#include <hardware/gpio.h>
 #include <vector>
 
-// External variable for matrix pin states
-extern bool g_encoderMatrixPinStates[20];
 // Add shift register buffer access
 extern uint8_t* shiftRegBuffer;
 extern ShiftRegister165* shiftReg;
 
-// Helper to get pin state for encoder (matrix-aware and shift-register-aware)
-static int encoderReadPin(uint8_t pin) {
-    // For shift register encoders, pin encodes reg and bit: (reg << 4) | bit
-    if (pin >= 100) {  // Use pin >= 100 to indicate shift register
-        // DO NOT read shift register here!
-        uint8_t reg = (pin - 100) >> 4;
-        uint8_t bit = (pin - 100) & 0x0F;
-        if (shiftRegBuffer && reg < SHIFTREG_COUNT && bit < 8) {
-            return ((shiftRegBuffer[reg] >> bit) & 1) ? 0 : 1;  // Invert for 74HC165
-        }
-        return 1;  // Default HIGH
-    }
-    
-    // Check if this pin is configured as a matrix pin or direct pin
-    bool isMatrixPin = false;
-    for (uint8_t i = 0; i < hardwarePinMapCount; ++i) {
-        HardwarePinName pinName = hardwarePinMap[i].name;
-        if (atoi(pinName) == pin) {
-            PinType type = hardwarePinMap[i].type;
-            if (type == BTN_ROW || type == BTN_COL) {
-                isMatrixPin = true;
+// Targets for phases whose source is unavailable: read as idle (level HIGH)
+static const uint8_t kIdleShiftRegByte = 0xFF;
+static const uint32_t kIdleMatrixWord = 0;
+
+// Level of one phase; the GPIO snapshot is shared by both phases of an encoder
+static inline uint8_t readEncoderPhase(const EncoderPhase& p, uint32_t gpio) {
+    uint32_t word = (p.kind == ENCODER_SRC_GPIO) ? gpio
+                  : (p.kind == ENCODER_SRC_SHIFTREG) ? *p.byte
+                  : *p.cellWord;
+    return (uint8_t)(((word & p.mask) != 0) ^ p.invert);
+}
+
+// Both phases as a RotaryEncoder state (bit 0 = A, bit 1 = B)
+static inline int8_t readEncoderState(const EncoderSource& s) {
+    const uint32_t gpio = gpio_get_all();
+    return (int8_t)(readEncoderPhase(s.a, gpio) | (readEncoderPhase(s.b, gpio) << 1));
+}
+
+// Resolves a logical ENC_A/ENC_B entry into a phase descriptor (no string work afterwards)
+static bool resolveEncoderPhase(const LogicalInput& in, ButtonBehavior want, EncoderPhase& out, uint8_t& joyButtonID) {
+    out.kind = ENCODER_SRC_GPIO;
+    out.invert = 0;
+    out.mask = 0;
+    out.byte = &kIdleShiftRegByte;
+    out.cellWord = &kIdleMatrixWord;
+    switch (in.type) {
+        case INPUT_PIN:
+            if (in.u.pin.behavior != want) return false;
+            out.kind = ENCODER_SRC_GPIO;
+            out.mask = (in.u.pin.pin < 32) ? (1u << in.u.pin.pin) : 0;
+            joyButtonID = in.u.pin.joyButtonID;
+            return true;
+        case INPUT_MATRIX: {
+            if (in.u.matrix.behavior != want) return false;
+            out.kind = ENCODER_SRC_MATRIX;
+            out.invert = 1; // raw bitmap stores pressed = 1, the phase reads LOW
+            const uint32_t* raw = MatrixRawAccess::getRawKeyBits();
+            if (raw && in.u.matrix.row < getMatrixRows() && in.u.matrix.col < getMatrixCols()) {
+                uint16_t cell = in.u.matrix.row * getMatrixCols() + in.u.matrix.col;
+                out.cellWord = &raw[cell >> 5];
+                out.mask = 1u << (cell & 31);
             }
-            break;
+            joyButtonID = in.u.matrix.joyButtonID;
+            return true;
         }
+        case INPUT_SHIFTREG:
+            if (in.u.shiftreg.behavior != want) return false;
+            out.kind = ENCODER_SRC_SHIFTREG;
+            out.invert = 1; // 74HC165 inputs are active-low
+            if (shiftRegBuffer && in.u.shiftreg.regIndex < SHIFTREG_COUNT && in.u.shiftreg.bitIndex < 8) {
+                out.byte = &shiftRegBuffer[in.u.shiftreg.regIndex];
+                out.mask = 1u << in.u.shiftreg.bitIndex;
+            }
+            joyButtonID = in.u.shiftreg.joyButtonID;
+            return true;
     }
-    
-    if (isMatrixPin) {
-        // Use matrix state for matrix pins
-        return g_encoderMatrixPinStates[pin];
-    } else {
-        // Use direct read for direct pins
-        return digitalRead(pin);
-    }
+    return false;
 }
 
-
-
 // Unified encoder system with dynamic storage
 static std::vector<RotaryEncoder*> encoders;
+static std::vector<EncoderSource> encoderSources;
 static std::vector<EncoderButtons> encoderBtnMap;
 static std::vector<int> lastPositions;
+static std::vector<int8_t> encoderPioSlot; // QuadraturePioBank slot, -1 = polled
+static std::vector<EncoderAxis> encoderAxes; // used when encoderSources[i].axis >= 0
+static std::vector<EncoderAccel> encoderAccel; // used with ENCODER_FLAG_ACCEL
+static const EncoderAccelCurve kEncoderAccelCurve = {ENCODER_ACCEL_SLOW_RATE, ENCODER_ACCEL_FAST_RATE, ENCODER_ACCEL_MAX};
 static uint8_t encoderTotal = 0;
 
-void initEncoders(const EncoderPins* pins, const EncoderButtons* buttons, uint8_t count) {
+// Hardware decoder slot for a direct-pin encoder with B on GPIO A + 1, or -1
+static int8_t attachPioDecoder(const EncoderSource& s) {
+    if (ENCODER_BACKEND != ENCODER_BACKEND_PIO) return -1;
+    if (s.a.kind != ENCODER_SRC_GPIO || s.b.kind != ENCODER_SRC_GPIO || !s.a.mask || !s.b.mask) return -1;
+    return g_quadraturePio.attach((uint8_t)__builtin_ctz(s.a.mask), (uint8_t)__builtin_ctz(s.b.mask));
+}
+
+void initEncoders(const EncoderSource* sources, const EncoderButtons* buttons, uint8_t count) {
     // Free previous encoder objects
     for (auto* e : encoders) { delete e; }
     encoderTotal = count;
-    encoders.clear(); encoderBtnMap.clear(); lastPositions.clear();
-    encoders.reserve(count); encoderBtnMap.reserve(count); lastPositions.reserve(count);
+    encoders.clear(); encoderSources.clear(); encoderBtnMap.clear(); lastPositions.clear(); encoderPioSlot.clear();
+    encoderAxes.clear(); encoderAccel.clear();
+    encoders.reserve(count); encoderSources.reserve(count); encoderBtnMap.reserve(count); lastPositions.reserve(count);
+    encoderPioSlot.reserve(count); encoderAxes.reserve(count); encoderAccel.assign(count, EncoderAccel());
+    g_quadraturePio.releaseAll();
     initEncoderBuffers(count);
     for (uint8_t i = 0; i < count; i++) {
         RotaryEncoder::LatchMode latchMode;
-        switch (pins[i].latchMode) {
+        switch (sources[i].latchMode) {
             case FOUR3: latchMode = RotaryEncoder::LatchMode::FOUR3; break;
             case FOUR0: latchMode = RotaryEncoder::LatchMode::FOUR0; break;
             case TWO03: latchMode = RotaryEncoder::LatchMode::TWO03; break;
             default: latchMode = RotaryEncoder::LatchMode::FOUR3; break;
         }
-        RotaryEncoder* enc = new RotaryEncoder(pins[i].pinA, pins[i].pinB, latchMode, encoderReadPin);
-        if (pins[i].pinA < 100 && pins[i].pinB < 100) {
-            pinMode(pins[i].pinA, INPUT_PULLUP);
-            pinMode(pins[i].pinB, INPUT_PULLUP);
+        for (const EncoderPhase* p : {&sources[i].a, &sources[i].b}) {
+            if (p->kind == ENCODER_SRC_GPIO && p->mask) pinMode(__builtin_ctz(p->mask), INPUT_PULLUP);
         }
+        // The decoder's count starts at 0 on the state sampled right after it starts
+        const int8_t slot = attachPioDecoder(sources[i]);
+        RotaryEncoder* enc = new RotaryEncoder(latchMode, readEncoderState(sources[i]));
         encoders.push_back(enc);
+        encoderPioSlot.push_back(slot);
+        encoderSources.push_back(sources[i]);
         encoderBtnMap.push_back(buttons[i]);
         lastPositions.push_back(enc->getPosition());
-        createEncoderBufferEntry(buttons[i].cw, buttons[i].ccw);
+        EncoderAxis axis;
+        if (sources[i].axis >= 0) {
+            const EncoderAxisMode mode = (sources[i].flags & ENCODER_FLAG_AXIS_RELATIVE) ? ENCODER_AXIS_RELATIVE
+                                       : (sources[i].flags & ENCODER_FLAG_AXIS_CLAMP) ? ENCODER_AXIS_CLAMP
+                                       : ENCODER_AXIS_WRAP;
+            encoderAxisInit(axis, mode, ENCODER_AXIS_STEP, ENCODER_AXIS_DECAY_MS * 1000u);
+            MyJoystick.setAxis(sources[i].axis, 0);
+        }
+        encoderAxes.push_back(axis);
+        createEncoderBufferEntry(buttons[i].cw, buttons[i].ccw,
+                                 sources[i].pressMs, sources[i].releaseMs, sources[i].flags);
     }
 }
 
-
-
-
-
-
 void updateEncoders() {
+    const uint32_t now = micros();
     // Handle all encoders with RotaryEncoder library
     for (uint8_t i = 0; i < encoderTotal; i++) {
-        // Call tick() multiple times to catch up on missed transitions
-        for (uint8_t t = 0; t < 3; ++t) {
-            encoders[i]->tick();
+        encoders[i]->setCycleTime(now); // latch timestamps for acceleration
+        // Hardware-counted encoders cannot miss transitions; polled ones see one sample per cycle
+        if (encoderPioSlot[i] >= 0) {
+            encoders[i]->tickCount(g_quadraturePio.readCount((uint8_t)encoderPioSlot[i]));
+        } else {
+            encoders[i]->tick(readEncoderState(encoderSources[i]));
         }
         
         int newPos = encoders[i]->getPosition();
         int diff = newPos - lastPositions[i];
+        int32_t steps = diff;
+        if (diff != 0 && (encoderSources[i].flags & ENCODER_FLAG_ACCEL)) {
+            // Several detents latched in one cycle share the interval since the previous latch
+            const uint32_t perDetentUs = encoders[i]->getMicrosBetweenRotations() / (uint32_t)abs(diff);
+            steps = encoderAccelApply(encoderAccel[i], kEncoderAccelCurve, diff, perDetentUs);
+        }
         
-        if (diff != 0) {
-          uint8_t btnCW = encoderBtnMap[i].cw;
-          uint8_t btnCCW = encoderBtnMap[i].ccw;
-
-          // Handle multiple steps for fast rotation
-          uint8_t steps = abs(diff);
-          uint8_t btn = (diff > 0) ? btnCW : btnCCW;
-          
-
-          
-          // Add to timing buffer
-          addEncoderSteps(btn, steps);
-          
+        // Axis encoders are written every cycle (relative mode decays between detents)
+        if (encoderSources[i].axis >= 0) {
+            MyJoystick.setAxis(encoderSources[i].axis, encoderAxisStep(encoderAxes[i], steps, now));
+            lastPositions[i] = newPos;
+        } else if (diff != 0) {
+          // Every detent is queued; the buffer plays them back at the configured timing
+          addEncoderSteps(i, steps);
           lastPositions[i] = newPos;
         }
     }
@@ -121,101 +173,55 @@ void updateEncoders() {
 }
 
 void initEncodersFromLogical(const LogicalInput* logicals, uint8_t logicalCount) {
-    uint8_t encoderCount = 0;
-    for (uint8_t i = 0; i < logicalCount - 1; ++i) {
-        // Check for any encoder pairs (direct pin, matrix, or shift register)
-        if (((logicals[i].type == INPUT_PIN && logicals[i].u.pin.behavior == ENC_A) ||
-             (logicals[i].type == INPUT_MATRIX && logicals[i].u.matrix.behavior == ENC_A) ||
-             (logicals[i].type == INPUT_SHIFTREG && logicals[i].u.shiftreg.behavior == ENC_A)) &&
-            ((logicals[i + 1].type == INPUT_PIN && logicals[i + 1].u.pin.behavior == ENC_B) ||
-             (logicals[i + 1].type == INPUT_MATRIX && logicals[i + 1].u.matrix.behavior == ENC_B) ||
-             (logicals[i + 1].type == INPUT_SHIFTREG && logicals[i + 1].u.shiftreg.behavior == ENC_B))) {
-            encoderCount++;
+    // Encoders are adjacent ENC_A (or ENC_AXIS_A) then ENC_B entries on any digital source.
+    // Matrix phases need the matrix to be initialized first (see InputManager::begin).
+    std::vector<EncoderSource> sourcesLocal;
+    std::vector<EncoderButtons> buttonsLocal;
+    for (uint8_t i = 0; i + 1 < logicalCount; ++i) {
+        EncoderSource src;
+        EncoderButtons btns;
+        const bool toAxis = logicalBehavior(logicals[i]) == ENC_AXIS_A;
+        if (resolveEncoderPhase(logicals[i], toAxis ? ENC_AXIS_A : ENC_A, src.a, btns.cw) &&
+            resolveEncoderPhase(logicals[i + 1], ENC_B, src.b, btns.ccw)) {
+            if (toAxis) {
+                // joyButtonID of the ENC_AXIS_A entry is the HID axis number
+                src.axis = encoderAxisIndex(btns.cw);
+                if (src.axis < 0) continue;
+                btns.cw = btns.ccw = 0;
+            }
+            src.latchMode = logicals[i].encoderLatchMode;
+            src.pressMs = logicals[i].encoderPressMs;
+            src.releaseMs = logicals[i].encoderReleaseMs;
+            src.flags = logicals[i].encoderFlags;
+            sourcesLocal.push_back(src);
+            buttonsLocal.push_back(btns);
         }
     }
-    if (encoderCount > 0) {
-        std::vector<EncoderPins> pinsLocal(encoderCount);
-        std::vector<EncoderButtons> buttonsLocal(encoderCount);
-        uint8_t idx = 0;
-        for (uint8_t i = 0; i < logicalCount - 1 && idx < encoderCount; ++i) {
-            // Check for any encoder pairs
-            if (((logicals[i].type == INPUT_PIN && logicals[i].u.pin.behavior == ENC_A) ||
-                 (logicals[i].type == INPUT_MATRIX && logicals[i].u.matrix.behavior == ENC_A) ||
-                 (logicals[i].type == INPUT_SHIFTREG && logicals[i].u.shiftreg.behavior == ENC_A)) &&
-                ((logicals[i + 1].type == INPUT_PIN && logicals[i + 1].u.pin.behavior == ENC_B) ||
-                 (logicals[i + 1].type == INPUT_MATRIX && logicals[i + 1].u.matrix.behavior == ENC_B) ||
-                 (logicals[i + 1].type == INPUT_SHIFTREG && logicals[i + 1].u.shiftreg.behavior == ENC_B))) {
-                
-                bool isEncA = false, isEncB = false;
-                uint8_t pinA = 0, pinB = 0;
-                uint8_t joyA = 0, joyB = 0;
-                
-                // Get ENC_A info
-                if (logicals[i].type == INPUT_PIN && logicals[i].u.pin.behavior == ENC_A) {
-                    isEncA = true;
-                    pinA = logicals[i].u.pin.pin;
-                    joyA = logicals[i].u.pin.joyButtonID;
-                } else if (logicals[i].type == INPUT_MATRIX && logicals[i].u.matrix.behavior == ENC_A) {
-                    isEncA = true;
-                    // Find the actual pin for this matrix position
-                    uint8_t rowIdx = 0;
-                    for (uint8_t j = 0; j < hardwarePinMapCount; ++j) {
-                        HardwarePinName pinName = hardwarePinMap[j].name;
-                        if (getPinType(pinName) == BTN_ROW) {
-                            if (rowIdx == logicals[i].u.matrix.row) {
-                                pinA = atoi(pinName); // use Arduino pin number
-                                break;
-                            }
-                            rowIdx++;
-                        }
-                    }
-                    joyA = logicals[i].u.matrix.joyButtonID;
-                } else if (logicals[i].type == INPUT_SHIFTREG && logicals[i].u.shiftreg.behavior == ENC_A) {
-                    isEncA = true;
-                    // Encode shift register info in pin number: (reg << 4) | bit
-                    pinA = 100 + (logicals[i].u.shiftreg.regIndex << 4) + logicals[i].u.shiftreg.bitIndex;
-                    joyA = logicals[i].u.shiftreg.joyButtonID;
-                }
-                
-                // Get ENC_B info
-                if (logicals[i + 1].type == INPUT_PIN && logicals[i + 1].u.pin.behavior == ENC_B) {
-                    isEncB = true;
-                    pinB = logicals[i + 1].u.pin.pin;
-                    joyB = logicals[i + 1].u.pin.joyButtonID;
-                } else if (logicals[i + 1].type == INPUT_MATRIX && logicals[i + 1].u.matrix.behavior == ENC_B) {
-                    isEncB = true;
-                    uint8_t rowIdx = 0;
-                    for (uint8_t j = 0; j < hardwarePinMapCount; ++j) {
-                        HardwarePinName pinName = hardwarePinMap[j].name;
-                        if (getPinType(pinName) == BTN_ROW) {
-                            if (rowIdx == logicals[i + 1].u.matrix.row) {
-                                pinB = atoi(pinName); // use Arduino pin number
-                                break;
-                            }
-                            rowIdx++;
-                        }
-                    }
-                    joyB = logicals[i + 1].u.matrix.joyButtonID;
-                } else if (logicals[i + 1].type == INPUT_SHIFTREG && logicals[i + 1].u.shiftreg.behavior == ENC_B) {
-                    isEncB = true;
-                    // Encode shift register info in pin number: (reg << 4) | bit
-                    pinB = 100 + (logicals[i + 1].u.shiftreg.regIndex << 4) + logicals[i + 1].u.shiftreg.bitIndex;
-                    joyB = logicals[i + 1].u.shiftreg.joyButtonID;
-                }
-                
-                if (isEncA && isEncB) {
-                    pinsLocal[idx].pinA = pinA;
-                    pinsLocal[idx].pinB = pinB;
-                    LatchMode latchMode = logicals[i].encoderLatchMode;
-                    pinsLocal[idx].latchMode = latchMode;
-                    buttonsLocal[idx].cw = joyA;
-                    buttonsLocal[idx].ccw = joyB;
-                    idx++;
-                }
-            }
+    if (!sourcesLocal.empty()) {
+        initEncoders(sourcesLocal.data(), buttonsLocal.data(), (uint8_t)sourcesLocal.size());
+    }
+}
+
+uint8_t getEncoderCount() { return encoderTotal; }
+
+uint8_t getEncoderShiftRegPrefix() {
+    uint8_t prefix = 0;
+    for (const EncoderSource& s : encoderSources) {
+        for (const EncoderPhase* p : {&s.a, &s.b}) {
+            if (p->kind != ENCODER_SRC_SHIFTREG || !p->mask || !shiftRegBuffer) continue;
+            const uint8_t bytes = (uint8_t)(p->byte - shiftRegBuffer + 1);
+            if (bytes > prefix) prefix = bytes;
         }
-        initEncoders(pinsLocal.data(), buttonsLocal.data(), encoderCount);
     }
+    return prefix;
 }
 
-uint8_t getEncoderCount() { return encoderTotal; }
\ No newline at end of file
+bool getEncoderDecodeStats(uint8_t index, EncoderDecodeStats& out) {
+    if (index >= encoderTotal) return false;
+    const QuadratureTracker& t = encoders[index]->getTracker();
+    out.valid = t.valid.load(std::memory_order_relaxed);
+    out.recovered = t.recovered.load(std::memory_order_relaxed);
+    out.rejected = t.rejected.load(std::memory_order_relaxed);
+    out.pio = encoderPioSlot[index] >= 0;
+    return true;
+}
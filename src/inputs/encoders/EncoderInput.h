@@ -4,12 +4,47 @@
 #include "../../Config.h"
 
 /**
- * @brief Pin configuration for a rotary encoder
+ * @brief Direct-pin encoder decoding (ENCODER_BACKEND in ConfigDigital.h)
  */
-struct EncoderPins {
-    uint8_t pinA;
-    uint8_t pinB;
+enum EncoderBackend : uint8_t {
+    ENCODER_BACKEND_POLL = 0,  // phases sampled once per scan cycle
+    ENCODER_BACKEND_PIO  = 1   // PIO state machine counts every transition (adjacent GPIOs)
+};
+
+/**
+ * @brief Where an encoder phase is sampled from
+ */
+enum EncoderSourceKind : uint8_t {
+    ENCODER_SRC_GPIO,      // Direct pin: bit of the SIO input register
+    ENCODER_SRC_SHIFTREG,  // Bit of a shiftRegBuffer byte (74HC165, active-low)
+    ENCODER_SRC_MATRIX     // Cell of the raw matrix bitmap (pressed = LOW)
+};
+
+/**
+ * @brief One encoder phase, resolved once at init
+ *
+ * The phase level is ((word & mask) != 0) ^ invert, where word is the GPIO input
+ * register, *byte or *cellWord depending on kind.
+ */
+struct EncoderPhase {
+    EncoderSourceKind kind;
+    uint8_t invert;             // 1 for active-low sources stored as pressed = 1
+    uint32_t mask;              // GPIO mask, bit mask in *byte, or bit in *cellWord
+    const uint8_t* byte;        // ENCODER_SRC_SHIFTREG
+    const uint32_t* cellWord;   // ENCODER_SRC_MATRIX: word holding the cell
+};
+
+/**
+ * @brief Source configuration for a rotary encoder (both phases)
+ */
+struct EncoderSource {
+    EncoderPhase a;
+    EncoderPhase b;
     LatchMode latchMode;
+    uint8_t pressMs = 0;     // USB pulse timing, 0 = ENCODER_PRESS_MS / ENCODER_RELEASE_MS
+    uint8_t releaseMs = 0;
+    uint8_t flags = 0;       // ENCODER_FLAG_* (Config.h)
+    int8_t axis = -1;        // ENC_AXIS_A: report axis index (8-15), -1 = CW/CCW buttons
 };
 
 /**
@@ -21,9 +56,9 @@ struct EncoderButtons {
 };
 
 /**
- * @brief Initialize encoders with pin and button configurations
+ * @brief Initialize encoders with resolved sources and button configurations
  */
-void initEncoders(const EncoderPins* pins, const EncoderButtons* buttons, uint8_t count);
+void initEncoders(const EncoderSource* sources, const EncoderButtons* buttons, uint8_t count);
 
 /**
  * @brief Initialize encoders from logical input configuration
@@ -36,4 +71,25 @@ void initEncodersFromLogical(const LogicalInput* logicals, uint8_t logicalCount)
 void updateEncoders(); 
 
 // Optional: allocation summary for debug
-uint8_t getEncoderCount();
\ No newline at end of file
+uint8_t getEncoderCount();
+
+/**
+ * @brief Shift-register devices up to the last one holding an encoder phase (0 = none)
+ */
+uint8_t getEncoderShiftRegPrefix();
+
+/**
+ * @brief Sampled-state decoder counters of one encoder (ENCODER_STATS serial command)
+ */
+struct EncoderDecodeStats {
+    uint32_t valid;      // Single-state steps
+    uint32_t recovered;  // Two-state jumps counted in the direction of travel
+    uint32_t rejected;   // Two-state jumps dropped with no current direction
+    bool pio;            // Counted by a PIO decoder (no missed states, counters stay 0)
+};
+
+/**
+ * @brief Read decoder counters of one encoder (same index as the encoder buffer)
+ * @return false if index is out of range
+ */
+bool getEncoderDecodeStats(uint8_t index, EncoderDecodeStats& out);
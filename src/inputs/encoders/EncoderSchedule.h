@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Encoder step -> HID button pulse scheduler (no Arduino dependency, host-testable).
+//
+// Each detent becomes one press of the CW or CCW button held for pressUs, followed by at least
+// releaseUs released before the next press of the same button. Steps that arrive faster than
+// that queue up and are played back later; a direction change presses the other button right
+// away. The host reads the report at most once per 1 ms interrupt poll and a report can wait one
+// poll behind the one in flight, so every state is held for at least two polls.
+static constexpr uint8_t ENCODER_MIN_STATE_MS = 2;
+static constexpr uint8_t ENCODER_MAX_STATE_MS = 255;
+static constexpr uint16_t ENCODER_MAX_PENDING = 0xFFFF;
+// ENCODER_FLAG_BURST (Config.h) plays a backlog back at ENCODER_MIN_STATE_MS
+
+enum EncoderDirection : uint8_t {
+    ENCODER_DIR_NONE = 0,
+    ENCODER_DIR_CW   = 1,
+    ENCODER_DIR_CCW  = 2
+};
+
+// Configured milliseconds (0 = fallbackMs) bounded to what the host can observe, in microseconds
+inline uint32_t encoderStateUs(uint8_t ms, uint8_t fallbackMs) {
+    uint32_t v = ms ? ms : fallbackMs;
+    if (v < ENCODER_MIN_STATE_MS) v = ENCODER_MIN_STATE_MS;
+    if (v > ENCODER_MAX_STATE_MS) v = ENCODER_MAX_STATE_MS;
+    return v * 1000u;
+}
+
+struct EncoderSchedule {
+    uint32_t pressUs = ENCODER_MIN_STATE_MS * 1000u;
+    uint32_t releaseUs = ENCODER_MIN_STATE_MS * 1000u;
+    bool burst = false;
+
+    uint16_t pendingCw = 0;
+    uint16_t pendingCcw = 0;
+    uint32_t lastPressUs = 0;
+    uint32_t holdUs = 0;       // press and release times of the pulse in progress
+    uint32_t gapUs = 0;
+    bool started = false;      // a pulse has been emitted since init
+    bool pressed = false;
+    uint8_t direction = ENCODER_DIR_NONE; // last pressed direction, kept after release
+
+    // Written by the scan core only; read by the serial core
+    std::atomic<uint32_t> steps{0};      // steps accepted
+    std::atomic<uint32_t> overflow{0};   // steps beyond ENCODER_MAX_PENDING
+    std::atomic<uint32_t> maxBacklog{0}; // deepest queue seen
+};
+
+inline void encoderScheduleInit(EncoderSchedule& s, uint32_t pressUs, uint32_t releaseUs, bool burst) {
+    s.pressUs = pressUs;
+    s.releaseUs = releaseUs;
+    s.burst = burst;
+    s.pendingCw = s.pendingCcw = 0;
+    s.lastPressUs = s.holdUs = s.gapUs = 0;
+    s.started = s.pressed = false;
+    s.direction = ENCODER_DIR_NONE;
+    s.steps.store(0, std::memory_order_relaxed);
+    s.overflow.store(0, std::memory_order_relaxed);
+    s.maxBacklog.store(0, std::memory_order_relaxed);
+}
+
+// Queues delta detents (positive = CW). Steps that do not fit are counted, not silently lost.
+inline void encoderScheduleAdd(EncoderSchedule& s, int32_t delta) {
+    if (!delta) return;
+    const uint32_t n = (uint32_t)(delta > 0 ? delta : -(int64_t)delta);
+    uint16_t& q = (delta > 0) ? s.pendingCw : s.pendingCcw;
+    const uint32_t room = ENCODER_MAX_PENDING - q;
+    const uint32_t take = (n < room) ? n : room;
+    q = (uint16_t)(q + take);
+    s.steps.store(s.steps.load(std::memory_order_relaxed) + take, std::memory_order_relaxed);
+    if (take < n) {
+        s.overflow.store(s.overflow.load(std::memory_order_relaxed) + (n - take), std::memory_order_relaxed);
+    }
+    const uint32_t backlog = (uint32_t)s.pendingCw + s.pendingCcw;
+    if (backlog > s.maxBacklog.load(std::memory_order_relaxed)) s.maxBacklog.store(backlog, std::memory_order_relaxed);
+}
+
+// Advances the pulse train to nowUs; setButton(EncoderDirection, bool pressed) drives the HID button.
+// Call once per scan cycle.
+template <typename SetButton>
+inline void encoderScheduleStep(EncoderSchedule& s, uint32_t nowUs, SetButton setButton) {
+    if (s.pressed && (uint32_t)(nowUs - s.lastPressUs) >= s.holdUs) {
+        setButton((EncoderDirection)s.direction, false);
+        s.pressed = false; // direction is kept for the reversal check below
+    }
+    if (s.pressed || (!s.pendingCw && !s.pendingCcw)) return;
+
+    // Finish the current direction before switching
+    uint8_t next;
+    if (s.direction == ENCODER_DIR_CW && s.pendingCw) next = ENCODER_DIR_CW;
+    else if (s.direction == ENCODER_DIR_CCW && s.pendingCcw) next = ENCODER_DIR_CCW;
+    else next = s.pendingCw ? ENCODER_DIR_CW : ENCODER_DIR_CCW;
+
+    // A different button can be pressed as soon as the previous one is released
+    if (s.started && next == s.direction && (uint32_t)(nowUs - s.lastPressUs) < s.holdUs + s.gapUs) return;
+
+    uint16_t& q = (next == ENCODER_DIR_CW) ? s.pendingCw : s.pendingCcw;
+    q--;
+    const bool fast = s.burst && q > 0; // more steps of this direction still waiting
+    s.holdUs = fast ? ENCODER_MIN_STATE_MS * 1000u : s.pressUs;
+    s.gapUs = fast ? ENCODER_MIN_STATE_MS * 1000u : s.releaseUs;
+    s.lastPressUs = nowUs;
+    s.started = true;
+    s.pressed = true;
+    s.direction = next;
+    setButton((EncoderDirection)next, true);
+}
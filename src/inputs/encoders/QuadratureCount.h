@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Detent latching for encoders whose transitions are counted elsewhere (PIO decoder).
+// No Arduino dependency, host-testable.
+//
+// RotaryEncoder counts one position per valid phase transition (KNOBDIR) and only updates its
+// external position when the phases reach a latch state, which gives a full detent of
+// hysteresis against contact bounce at rest. With a transition count the phase state at each
+// step is implied by the count: along the clockwise sequence 0 -> 2 -> 3 -> 1 the state
+// advances one Gray index per transition, so latch states sit at a fixed count residue.
+
+// Gray index of a phase state (bit 0 = A, bit 1 = B) along the clockwise sequence
+inline uint8_t quadratureGrayIndex(uint8_t state) {
+    static const uint8_t GRAY[4] = { 0, 3, 1, 2 };
+    return GRAY[state & 3];
+}
+
+struct QuadratureLatch {
+    uint8_t shift;    // log2 transitions per detent: 2 for FOUR0/FOUR3, 1 for TWO03
+    uint8_t residue;  // count modulo (1 << shift) at a latch state
+};
+
+// latchState: phase state of a detent (0 for FOUR0/TWO03, 3 for FOUR3); the count is 0 at initialState
+inline QuadratureLatch quadratureLatchInit(uint8_t latchState, uint8_t shift, uint8_t initialState) {
+    QuadratureLatch l;
+    l.shift = shift;
+    l.residue = (uint8_t)((quadratureGrayIndex(latchState) - quadratureGrayIndex(initialState)) & ((1u << shift) - 1));
+    return l;
+}
+
+// Count moved from `from` to `to`, assumed monotonic in between (the decoder is read far more
+// often than a detent takes to turn). Sets *latched to the last latch count passed or reached,
+// exactly where tick() would have latched; false when none was. Wrap-safe over 32 bits.
+inline bool quadratureLatchCrossed(const QuadratureLatch& l, int32_t from, int32_t to, int32_t* latched) {
+    const int32_t d = (int32_t)((uint32_t)to - (uint32_t)from);
+    const uint32_t mask = (1u << l.shift) - 1;
+    if (d > 0) {
+        const uint32_t back = ((uint32_t)to - l.residue) & mask;
+        if (back >= (uint32_t)d) return false;
+        *latched = (int32_t)((uint32_t)to - back);
+        return true;
+    }
+    if (d < 0) {
+        const uint32_t ahead = ((uint32_t)l.residue - (uint32_t)to) & mask;
+        if (ahead >= (uint32_t)(-(int64_t)d)) return false;
+        *latched = (int32_t)((uint32_t)to + ahead);
+        return true;
+    }
+    return false;
+}
+
+// Sampled-state decoding with missed-state recovery (RotaryEncoder::tick).
+//
+// Between two samples the phases can move one state (a valid step), not at all, or two states
+// when sampling is slower than the knob: 0 -> 3 could be +2 or -2 and KNOBDIR counts it as 0.
+// The tracker resolves such a jump in the last direction of travel while that direction is
+// still current: the previous move happened no longer ago than twice the interval between the
+// two moves before it, i.e. the knob was turning at least about as fast as the samples arrive.
+// A jump out of rest, or before two moves have set a velocity, stays ambiguous and is rejected.
+struct QuadratureTracker {
+    int8_t dir = 0;              // last direction of travel, 0 = unknown
+    uint32_t lastMoveUs = 0;     // time of the last counted move
+    uint32_t moveIntervalUs = 0; // time between the last two moves, 0 = no velocity yet
+    bool moved = false;          // lastMoveUs is valid
+
+    // Written by the scan core only; read by the serial core
+    std::atomic<uint32_t> valid{0};     // single-state steps
+    std::atomic<uint32_t> recovered{0}; // two-state jumps counted in the direction of travel
+    std::atomic<uint32_t> rejected{0};  // two-state jumps with no current direction
+};
+
+inline void quadratureCountEvent(std::atomic<uint32_t>& c) {
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Transitions (-2..2) between two sampled states at nowUs
+inline int8_t quadratureTrack(QuadratureTracker& t, uint8_t from, uint8_t to, uint32_t nowUs) {
+    const uint8_t d = (uint8_t)((quadratureGrayIndex(to) - quadratureGrayIndex(from)) & 3);
+    if (d == 0) return 0;
+    int8_t delta;
+    if (d == 2) {
+        const bool current = t.dir && t.moved && t.moveIntervalUs &&
+                             (uint32_t)(nowUs - t.lastMoveUs) <= 2 * t.moveIntervalUs;
+        if (!current) {
+            quadratureCountEvent(t.rejected);
+            return 0;
+        }
+        delta = (int8_t)(2 * t.dir);
+        quadratureCountEvent(t.recovered);
+    } else {
+        delta = (d == 1) ? 1 : -1;
+        t.dir = delta;
+        quadratureCountEvent(t.valid);
+    }
+    t.moveIntervalUs = t.moved ? (uint32_t)(nowUs - t.lastMoveUs) : 0;
+    t.lastMoveUs = nowUs;
+    t.moved = true;
+    return delta;
+}
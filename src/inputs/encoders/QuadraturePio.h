@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// PIO quadrature decoder program (no Arduino dependency, host-testable).
+//
+// One state machine per encoder, after the jump-table decoder in pico-examples
+// (quadrature_encoder.pio). Each pass samples both phases (A = IN base, B = base + 1),
+// appends them to the previous state and jumps through a 16-entry table indexed by
+// (previous << 2) | current, the same index as RotaryEncoder's KNOBDIR. The signed
+// transition count lives in Y and is pushed (noblock) every pass, so the RX FIFO always
+// holds a recent count and the CPU never has to keep up with the knob. A pass takes 7-10
+// cycles: at 125 MHz the phases are sampled every 80 ns or faster.
+//
+//   .program quadrature
+//   .origin 0
+//       jmp update / jmp decrement / jmp increment   ; 16 entries, one per KNOBDIR value
+//   decrement:
+//       jmp y-- update
+//   .wrap_target
+//   update:
+//       mov isr, y
+//       push noblock
+//       out isr, 2          ; previous state
+//       in pins, 2          ; (previous << 2) | current
+//       mov osr, isr
+//       mov pc, isr
+//   increment:
+//       mov y, ~y           ; y + 1 as ~(~y - 1)
+//       jmp y-- inc_done
+//   inc_done:
+//       mov y, ~y
+//   .wrap
+//
+// The table needs the program at offset 0; it leaves the top 6 instructions free, which the
+// matrix scan program (MatrixPio.h) fits into.
+static constexpr uint8_t QUADRATURE_PIO_UPDATE = 17;
+static constexpr uint8_t QUADRATURE_PIO_DECREMENT = 16;
+static constexpr uint8_t QUADRATURE_PIO_INCREMENT = 23;
+
+#define QUADRATURE_PIO_JMP(addr) (uint16_t)(0x0000 | (addr))
+static constexpr uint16_t QUADRATURE_PIO_PROGRAM[] = {
+    // Jump table, index (previous << 2) | current; matches KNOBDIR
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    QUADRATURE_PIO_JMP(QUADRATURE_PIO_DECREMENT), // 00->00, 00->01
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_INCREMENT), QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    // 00->10, 00->11
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_INCREMENT), QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    // 01->00, 01->01
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    QUADRATURE_PIO_JMP(QUADRATURE_PIO_DECREMENT), // 01->10, 01->11
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_DECREMENT), QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    // 10->00, 10->01
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    QUADRATURE_PIO_JMP(QUADRATURE_PIO_INCREMENT), // 10->10, 10->11
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    QUADRATURE_PIO_JMP(QUADRATURE_PIO_INCREMENT), // 11->00, 11->01
+    QUADRATURE_PIO_JMP(QUADRATURE_PIO_DECREMENT), QUADRATURE_PIO_JMP(QUADRATURE_PIO_UPDATE),    // 11->10, 11->11
+    0x0091, // 16: jmp y--, update
+    0xA0C2, // 17: mov isr, y          (wrap target)
+    0x8000, // 18: push noblock
+    0x60C2, // 19: out isr, 2
+    0x4002, // 20: in pins, 2
+    0xA0E6, // 21: mov osr, isr
+    0xA0A6, // 22: mov pc, isr
+    0xA04A, // 23: mov y, ~y
+    0x0099, // 24: jmp y--, 25
+    0xA04A, // 25: mov y, ~y           (wrap)
+};
+#undef QUADRATURE_PIO_JMP
+static constexpr uint8_t QUADRATURE_PIO_PROGRAM_LENGTH = sizeof(QUADRATURE_PIO_PROGRAM) / sizeof(QUADRATURE_PIO_PROGRAM[0]);
+static constexpr uint8_t QUADRATURE_PIO_WRAP_TARGET = QUADRATURE_PIO_UPDATE;
+static constexpr uint8_t QUADRATURE_PIO_WRAP = 25;
+
+// Executed once before the SM starts so the first pass compares against the real pin state
+// instead of 00: in pins, 2 / mov osr, isr
+static constexpr uint16_t QUADRATURE_PIO_PRIME[] = { 0x4002, 0xA0E6 };
+
+static constexpr uint8_t QUADRATURE_PIO_MAX_PASS_CYCLES = 10; // update path + increment
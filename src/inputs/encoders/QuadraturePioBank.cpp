@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "QuadraturePioBank.h"
+#include "QuadraturePio.h"
+
+QuadraturePioBank g_quadraturePio;
+
+static const pio_program_t quadratureProgram = {
+    QUADRATURE_PIO_PROGRAM, QUADRATURE_PIO_PROGRAM_LENGTH, 0
+};
+
+int8_t QuadraturePioBank::attach(uint8_t pinA, uint8_t pinB) {
+    if (_count >= MAX_ENCODERS || pinA >= 29 || pinB != pinA + 1) return -1;
+
+    PIO blocks[2] = { pio0, pio1 };
+    for (uint8_t b = 0; b < 2; ++b) {
+        PIO pio = blocks[b];
+        if (!_loaded[b] && !pio_can_add_program(pio, &quadratureProgram)) continue;
+        const int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) continue;
+        if (!_loaded[b]) {
+            pio_add_program(pio, &quadratureProgram); // origin 0: the jump table is absolute
+            _loaded[b] = true;
+        }
+
+        pio_sm_config c = pio_get_default_sm_config();
+        sm_config_set_wrap(&c, QUADRATURE_PIO_WRAP_TARGET, QUADRATURE_PIO_WRAP);
+        sm_config_set_in_pins(&c, pinA);
+        sm_config_set_in_shift(&c, false, false, 32);
+        sm_config_set_out_shift(&c, true, false, 32);
+        sm_config_set_clkdiv(&c, 1.0f);
+        pio_sm_init(pio, (uint)sm, QUADRATURE_PIO_UPDATE, &c);
+        for (uint16_t ins : QUADRATURE_PIO_PRIME) pio_sm_exec(pio, (uint)sm, ins);
+        pio_sm_set_enabled(pio, (uint)sm, true);
+
+        _slots[_count] = { pio, (uint8_t)sm };
+        return (int8_t)_count++;
+    }
+    return -1;
+}
+
+void QuadraturePioBank::releaseAll() {
+    for (uint8_t i = 0; i < _count; ++i) {
+        pio_sm_set_enabled(_slots[i].pio, _slots[i].sm, false);
+        pio_sm_unclaim(_slots[i].pio, _slots[i].sm);
+    }
+    _count = 0;
+    PIO blocks[2] = { pio0, pio1 };
+    for (uint8_t b = 0; b < 2; ++b) {
+        if (_loaded[b]) pio_remove_program(blocks[b], &quadratureProgram, 0);
+        _loaded[b] = false;
+    }
+}
+
+int32_t QuadraturePioBank::readCount(uint8_t slot) {
+    if (slot >= _count) return 0;
+    PIO pio = _slots[slot].pio;
+    const uint sm = _slots[slot].sm;
+    // The SM pushes every pass but drops pushes while the FIFO is full, so what is queued can
+    // be stale: discard it and take the next push, at most one pass (~80 ns) away.
+    for (uint level = pio_sm_get_rx_fifo_level(pio, sm); level; --level) (void)pio_sm_get(pio, sm);
+    return (int32_t)pio_sm_get_blocking(pio, sm);
+}
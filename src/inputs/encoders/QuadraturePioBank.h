@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// Hardware quadrature decoders for direct-pin encoders (ENCODER_BACKEND_PIO).
+// One PIO state machine per encoder counts every phase transition as it happens, so steps
+// are never lost to a slow loop; readCount() returns the accumulated signed count.
+// Phase B must be on GPIO A + 1. Pins stay SIO inputs with their pull-ups: the state
+// machine only reads them.
+class QuadraturePioBank {
+public:
+    static constexpr uint8_t MAX_ENCODERS = 8; // 4 state machines on each PIO block
+
+    // Starts a decoder; returns its slot, or -1 when the pins are not adjacent or no state
+    // machine / program space is free (the caller keeps polling that encoder)
+    int8_t attach(uint8_t pinA, uint8_t pinB);
+
+    // Stops every decoder and frees the program space
+    void releaseAll();
+
+    // Signed transition count since attach() (KNOBDIR direction), wraps at 32 bits
+    int32_t readCount(uint8_t slot);
+
+    uint8_t getCount() const { return _count; }
+
+private:
+    struct Slot {
+        PIO pio;
+        uint8_t sm;
+    };
+    Slot _slots[MAX_ENCODERS] = {};
+    uint8_t _count = 0;
+    bool _loaded[2] = { false, false }; // program resident on pio0 / pio1
+};
+
+extern QuadraturePioBank g_quadraturePio;
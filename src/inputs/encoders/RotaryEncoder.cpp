@@ -27,6 +27,9 @@
 // The array holds the values1 for the entries where a position was decremented,
 // a 1 for the entries where the position was incremented
 // and 0 in all the other (no change or not valid) cases.
+// JoyCore: tick(state) decodes through quadratureTrack(), which returns these values for
+// single-state steps and resolves the 0 entries of two-state jumps from the direction of travel.
+// The table stays as the reference for the PIO jump table (QuadraturePio.h).
 
 const int8_t KNOBDIR[] = {
     0, -1, 1, 0,
@@ -35,6 +38,18 @@ const int8_t KNOBDIR[] = {
     0, 1, -1, 0};
 
 
+// JoyCore: latch geometry of a mode for tickCount()
+static QuadratureLatch latchForMode(RotaryEncoder::LatchMode mode, int8_t initialState)
+{
+  switch (mode) {
+  case RotaryEncoder::LatchMode::FOUR3: return quadratureLatchInit(LATCH3, 2, (uint8_t)initialState);
+  case RotaryEncoder::LatchMode::TWO03: return quadratureLatchInit(LATCH0, 1, (uint8_t)initialState);
+  case RotaryEncoder::LatchMode::FOUR0:
+  default: return quadratureLatchInit(LATCH0, 2, (uint8_t)initialState);
+  }
+}
+
+
 // positions: [3] 1 0 2 [3] 1 0 2 [3]
 // [3] is the positions where my rotary switch detends
 // ==> right, count up
@@ -57,11 +72,35 @@ RotaryEncoder::RotaryEncoder(int pin1, int pin2, LatchMode mode, PinReadFn pinRe
   int sig1 = _pinReadFn ? _pinReadFn(_pin1) : digitalRead(_pin1);
   int sig2 = _pinReadFn ? _pinReadFn(_pin2) : digitalRead(_pin2);
   _oldState = sig1 | (sig2 << 1);
+  _latch = latchForMode(mode, _oldState);
+
+  // start with position 0;
+  _position = 0;
+  _positionExt = 0;
+  _positionExtPrev = 0;
+  _cycleTimeUs = 0;
+  _positionExtTime = 0;
+  _positionExtTimePrev = 0;
+} // RotaryEncoder()
+
+
+// JoyCore: pinless variant used with precomputed encoder sources
+RotaryEncoder::RotaryEncoder(LatchMode mode, int8_t initialState)
+{
+  _pin1 = -1;
+  _pin2 = -1;
+  _mode = mode;
+  _pinReadFn = nullptr;
+  _oldState = initialState;
+  _latch = latchForMode(mode, initialState);
 
   // start with position 0;
   _position = 0;
   _positionExt = 0;
   _positionExtPrev = 0;
+  _cycleTimeUs = 0;
+  _positionExtTime = 0;
+  _positionExtTimePrev = 0;
 } // RotaryEncoder()
 
 
@@ -117,34 +156,35 @@ void RotaryEncoder::tick(void)
   // Use the pin read function if provided
   int sig1 = _pinReadFn ? _pinReadFn(_pin1) : digitalRead(_pin1);
   int sig2 = _pinReadFn ? _pinReadFn(_pin2) : digitalRead(_pin2);
-  int8_t thisState = sig1 | (sig2 << 1);
+  tick((int8_t)(sig1 | (sig2 << 1)));
+} // tick()
+
 
+void RotaryEncoder::tick(int8_t thisState)
+{
   if (_oldState != thisState) {
-    _position += KNOBDIR[thisState | (_oldState << 2)];
+    _position += quadratureTrack(_tracker, (uint8_t)_oldState, (uint8_t)thisState, _cycleTimeUs);
     _oldState = thisState;
 
     switch (_mode) {
     case LatchMode::FOUR3:
       if (thisState == LATCH3) {
         // The hardware has 4 steps with a latch on the input state 3
-        _positionExt = _position >> 2;
-        // Skip expensive millis() calls for faster response - timing not needed for button box
+        setLatchedPosition(_position >> 2);
       }
       break;
 
     case LatchMode::FOUR0:
       if (thisState == LATCH0) {
         // The hardware has 4 steps with a latch on the input state 0
-        _positionExt = _position >> 2;
-        // Skip expensive millis() calls for faster response - timing not needed for button box
+        setLatchedPosition(_position >> 2);
       }
       break;
 
     case LatchMode::TWO03:
       if ((thisState == LATCH0) || (thisState == LATCH3)) {
         // The hardware has 2 steps with a latch on the input state 0 and 3
-        _positionExt = _position >> 1;
-        // Skip expensive millis() calls for faster response - timing not needed for button box
+        setLatchedPosition(_position >> 1);
       }
       break;
     } // switch
@@ -152,7 +192,34 @@ void RotaryEncoder::tick(void)
 } // tick()
 
 
+// JoyCore: hardware-counted transitions
+void RotaryEncoder::tickCount(long count)
+{
+  int32_t latched;
+  if (quadratureLatchCrossed(_latch, (int32_t)_position, (int32_t)count, &latched)) {
+    setLatchedPosition(latched >> _latch.shift);
+  }
+  _position = count;
+} // tickCount()
+
+
+// JoyCore: new external position; stamps it with the cycle time when it changed
+void RotaryEncoder::setLatchedPosition(long positionExt)
+{
+  if (positionExt != _positionExt) {
+    _positionExtTimePrev = _positionExtTime;
+    _positionExtTime = _cycleTimeUs;
+  }
+  _positionExt = positionExt;
+}
+
+
 unsigned long RotaryEncoder::getMillisBetweenRotations() const
+{
+  return (_positionExtTime - _positionExtTimePrev) / 1000;
+}
+
+unsigned long RotaryEncoder::getMicrosBetweenRotations() const
 {
   return (_positionExtTime - _positionExtTimePrev);
 }
@@ -160,10 +227,12 @@ unsigned long RotaryEncoder::getMillisBetweenRotations() const
 unsigned long RotaryEncoder::getRPM()
 {
   // calculate max of difference in time between last position changes or last change and now.
+  // JoyCore: times in microseconds, "now" is the cycle time
   unsigned long timeBetweenLastPositions = _positionExtTime - _positionExtTimePrev;
-  unsigned long timeToLastPosition = millis() - _positionExtTime;
+  unsigned long timeToLastPosition = _cycleTimeUs - _positionExtTime;
   unsigned long t = max(timeBetweenLastPositions, timeToLastPosition);
-  return 60000.0 / ((float)(t * 20));
+  if (t == 0) return 0;
+  return 60000000.0 / ((float)t * 20);
 }
 
 // End
\ No newline at end of file
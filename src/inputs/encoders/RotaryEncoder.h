@@ -24,6 +24,7 @@
 #define RotaryEncoder_h
 
 #include "Arduino.h"
+#include "QuadratureCount.h"
 
 class RotaryEncoder
 {
@@ -47,6 +48,9 @@ public:
   // Add an optional pin read function to the constructor
   RotaryEncoder(int pin1, int pin2, LatchMode mode = LatchMode::FOUR0, PinReadFn pinRead = nullptr);
 
+  // JoyCore: pinless constructor; the caller samples both phases and feeds tick(state)
+  RotaryEncoder(LatchMode mode, int8_t initialState);
+
   // retrieve the current position
   long getPosition();
 
@@ -59,9 +63,25 @@ public:
   // call this function every some milliseconds or by using an interrupt for handling state changes of the rotary encoder.
   void tick(void);
 
+  // JoyCore: process an externally sampled phase state (bit 0 = A, bit 1 = B)
+  void tick(int8_t thisState);
+
+  // JoyCore: take a hardware transition count (QuadraturePioBank, 0 at the initial state)
+  // instead of sampled states; latches on the same detents as tick()
+  void tickCount(long count);
+
+  // JoyCore: timestamp (micros) of the current scan cycle, recorded on each latch by tick()/tickCount()
+  void setCycleTime(unsigned long nowUs) { _cycleTimeUs = nowUs; }
+
   // Returns the time in milliseconds between the current observed
   unsigned long getMillisBetweenRotations() const;
 
+  // JoyCore: same in microseconds (cycle-time resolution)
+  unsigned long getMicrosBetweenRotations() const;
+
+  // JoyCore: sampled-state decoder counters (valid steps, recovered jumps, rejected jumps)
+  const QuadratureTracker& getTracker() const { return _tracker; }
+
   // Returns the RPM
   unsigned long getRPM();
 
@@ -79,6 +99,13 @@ private:
   volatile long _positionExt;     // External position
   volatile long _positionExtPrev; // External position (used only for direction checking)
 
+  QuadratureLatch _latch; // JoyCore: latch count residue for tickCount()
+  QuadratureTracker _tracker; // JoyCore: direction/velocity for tick(state)
+
+  // JoyCore: latch timestamps are in microseconds, taken from the cycle time instead of millis()
+  void setLatchedPosition(long positionExt);
+  unsigned long _cycleTimeUs;
+
   unsigned long _positionExtTime;     // The time the last position change was detected.
   unsigned long _positionExtTimePrev; // The time the previous position change was detected.
 };
@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "ShiftRegister165.h"
+#include "ShiftRegister165Spi.h"
+#include "ShiftRegisterFrame.h"
 
 ShiftRegister165::ShiftRegister165(uint8_t plPin, uint8_t clkPin, uint8_t qhPin, uint8_t count)
     : _plPin(plPin), _clkPin(clkPin), _qhPin(qhPin), _count(count) {}
@@ -13,6 +15,11 @@ void ShiftRegister165::begin() {
 }
 
 void ShiftRegister165::read(uint8_t* buffer) {
+    readPrefix(buffer, _count);
+}
+
+void ShiftRegister165::readPrefix(uint8_t* buffer, uint8_t bytes) {
+    if (bytes > _count) bytes = _count;
     // Parallel load: latch inputs - stable timing for reliable operation
     digitalWrite(_plPin, LOW);
     delayMicroseconds(2);  // Stable timing for 74HC165
@@ -20,7 +27,7 @@ void ShiftRegister165::read(uint8_t* buffer) {
     delayMicroseconds(2);  // Ensure latch completes
 
     // Read bits (LSB first for each byte) - stable timing
-    for (uint8_t i = 0; i < _count; ++i) {
+    for (uint8_t i = 0; i < bytes; ++i) {
         uint8_t value = 0;
         for (uint8_t b = 0; b < 8; ++b) {
             value |= (digitalRead(_qhPin) ? 1 : 0) << b;
@@ -32,3 +39,13 @@ void ShiftRegister165::read(uint8_t* buffer) {
         buffer[i] = value;
     }
 }
+
+ShiftRegister165* createShiftRegister165(uint8_t plPin, uint8_t clkPin, uint8_t qhPin,
+                                         uint8_t count, ShiftRegBackend backend, uint32_t spiBaud) {
+    if (backend == SHIFTREG_BACKEND_SPI_DMA) {
+        int8_t block = ShiftRegisterFrame::spiBlockForPins(clkPin, qhPin);
+        if (block >= 0) return new ShiftRegister165Spi(plPin, clkPin, qhPin, count, (uint8_t)block, spiBaud);
+        // Pins not routable to one SPI block: keep working on the bit-banged path
+    }
+    return new ShiftRegister165(plPin, clkPin, qhPin, count);
+}
@@ -2,18 +2,38 @@
 #pragma once
 #include <Arduino.h>
 
+// Chain readout backend, selectable per chain (see SHIFTREG_BACKEND in ConfigDigital.h)
+enum ShiftRegBackend : uint8_t {
+    SHIFTREG_BACKEND_BITBANG = 0,  // GPIO bit-bang, any pins
+    SHIFTREG_BACKEND_SPI_DMA = 1   // Hardware SPI + DMA, CLK/QH must be SPI SCK/RX pins
+};
+
 // User must call ShiftRegister165::begin() in setup()
 class ShiftRegister165 {
 public:
     // plPin: Parallel load (SH/LD), clkPin: Clock, qhPin: Serial data out
     ShiftRegister165(uint8_t plPin, uint8_t clkPin, uint8_t qhPin, uint8_t count);
+    virtual ~ShiftRegister165() = default;
 
-    void begin();
+    virtual void begin();
     // Reads all bits from the shift register chain into buffer (LSB first)
-    void read(uint8_t* buffer);
+    virtual void read(uint8_t* buffer);
+
+    // Re-latches the chain and reads only its first `bytes` devices into buffer[0..bytes-1];
+    // the rest of buffer is left as is. Backends that read the whole chain cheaply may read it all.
+    virtual void readPrefix(uint8_t* buffer, uint8_t bytes);
+
+    // True when a read costs a few microseconds and can run every loop
+    virtual bool isHardwareClocked() const { return false; }
 
     uint8_t getCount() const { return _count; }
 
-private:
+protected:
     uint8_t _plPin, _clkPin, _qhPin, _count;
 };
+
+// Creates the reader for one chain. SPI_DMA falls back to bit-bang when the pins
+// cannot be routed to a single SPI block.
+ShiftRegister165* createShiftRegister165(uint8_t plPin, uint8_t clkPin, uint8_t qhPin,
+                                         uint8_t count, ShiftRegBackend backend,
+                                         uint32_t spiBaud = 8000000);
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "ShiftRegister165Spi.h"
+#include "ShiftRegisterFrame.h"
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <string.h>
+
+// PL low pulse and PL-high-to-first-clock recovery. The 74HC165 needs ~100 ns at 3.3 V;
+// 32 cycles is ~240 ns at 133 MHz and still comfortably short at higher clocks.
+static constexpr uint32_t PL_PULSE_CYCLES = 32;
+
+ShiftRegister165Spi::ShiftRegister165Spi(uint8_t plPin, uint8_t clkPin, uint8_t qhPin, uint8_t count,
+                                         uint8_t spiBlock, uint32_t baud)
+    : ShiftRegister165(plPin, clkPin, qhPin, count),
+      _spi(spiBlock ? spi1 : spi0), _baud(baud) {}
+
+ShiftRegister165Spi::~ShiftRegister165Spi() {
+    if (_rxChan >= 0) { dma_channel_abort(_rxChan); dma_channel_unclaim(_rxChan); }
+    if (_txChan >= 0) { dma_channel_abort(_txChan); dma_channel_unclaim(_txChan); }
+    delete[] _frames;
+}
+
+void ShiftRegister165Spi::begin() {
+    pinMode(_plPin, OUTPUT);
+    digitalWrite(_plPin, HIGH);
+
+    // Mode 2: SCK idles high like the bit-banged clock. QH is sampled on the falling edge,
+    // half a clock after the 74HC165 shifted on the rising edge, so the read does not
+    // depend on the chip's output hold time. The first bit is valid from the PL pulse.
+    spi_init(_spi, _baud);
+    spi_set_format(_spi, 8, SPI_CPOL_1, SPI_CPHA_0, SPI_MSB_FIRST);
+    gpio_set_function(_clkPin, GPIO_FUNC_SPI);
+    gpio_set_function(_qhPin, GPIO_FUNC_SPI);
+
+    _frames = new uint8_t[_count * 2];
+    memset(_frames, 0xFF, _count * 2); // active-low idle
+
+    _rxChan = dma_claim_unused_channel(true);
+    _txChan = dma_claim_unused_channel(true);
+
+    dma_channel_config tx = dma_channel_get_default_config(_txChan);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_8);
+    channel_config_set_read_increment(&tx, false);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, spi_get_dreq(_spi, true));
+    dma_channel_configure(_txChan, &tx, &spi_get_hw(_spi)->dr, &_txDummy, _count, false);
+
+    dma_channel_config rx = dma_channel_get_default_config(_rxChan);
+    channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, true);
+    channel_config_set_dreq(&rx, spi_get_dreq(_spi, false));
+    dma_channel_configure(_rxChan, &rx, _frames, &spi_get_hw(_spi)->dr, _count, false);
+
+    _fillIndex = 0;
+    _inFlight = false;
+}
+
+void ShiftRegister165Spi::startTransfer() {
+    // Latch the parallel inputs; the previous transfer has fully completed, so SCK is idle
+    gpio_put(_plPin, 0);
+    busy_wait_at_least_cycles(PL_PULSE_CYCLES);
+    gpio_put(_plPin, 1);
+    busy_wait_at_least_cycles(PL_PULSE_CYCLES);
+
+    dma_channel_set_write_addr(_rxChan, _frames + _fillIndex * _count, false);
+    dma_channel_set_trans_count(_rxChan, _count, false);
+    dma_channel_set_read_addr(_txChan, &_txDummy, false);
+    dma_channel_set_trans_count(_txChan, _count, false);
+    // Start both together so RX is armed before the first byte lands in the FIFO
+    dma_start_channel_mask((1u << _rxChan) | (1u << _txChan));
+    _inFlight = true;
+}
+
+void ShiftRegister165Spi::read(uint8_t* buffer) {
+    if (!_frames) return;
+    if (!_inFlight) startTransfer(); // first read: capture synchronously
+
+    // A chain of N devices takes N bytes at SPI clock (2 us for 2 devices at 8 MHz),
+    // so the transfer started last call has normally long finished.
+    dma_channel_wait_for_finish_blocking(_rxChan);
+    const uint8_t* done = _frames + _fillIndex * _count;
+
+    _fillIndex ^= 1;
+    startTransfer();
+
+    ShiftRegisterFrame::fromMsbFirst(done, buffer, _count);
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <Arduino.h>
+#include <hardware/spi.h>
+#include "ShiftRegister165.h"
+
+// 74HC165 chain read by the RP2040 SPI block (mode 2, receive-only) with DMA.
+// PL stays a plain GPIO; CLK must be an SCK pin and QH an RX pin of the same SPI block.
+//
+// Reads are pipelined: each read() publishes the frame captured by the previous call
+// and immediately latches + clocks the next one into the other half of a double buffer.
+// DMA never writes the frame being converted, and the caller's buffer is only written
+// inside read(), so consumers always see a complete snapshot.
+class ShiftRegister165Spi : public ShiftRegister165 {
+public:
+    ShiftRegister165Spi(uint8_t plPin, uint8_t clkPin, uint8_t qhPin, uint8_t count,
+                        uint8_t spiBlock, uint32_t baud);
+    ~ShiftRegister165Spi() override;
+
+    void begin() override;
+    void read(uint8_t* buffer) override;
+    // The whole chain costs a few microseconds here; a prefix read is a full read
+    void readPrefix(uint8_t* buffer, uint8_t) override { read(buffer); }
+    bool isHardwareClocked() const override { return true; }
+
+private:
+    void startTransfer();
+
+    spi_inst_t* _spi;
+    uint32_t _baud;
+    int _rxChan = -1;
+    int _txChan = -1;
+    uint8_t* _frames = nullptr;  // 2 * _count bytes, MSB-first as received
+    uint8_t _fillIndex = 0;      // frame currently targeted by DMA
+    bool _inFlight = false;
+    uint8_t _txDummy = 0xFF;     // clocked out on MOSI (unused) to generate SCK
+};
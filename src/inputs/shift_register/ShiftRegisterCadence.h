@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+
+// Read cadence for a bit-banged 74HC165 chain (no Arduino dependency, host-testable).
+//
+// A chain shifts out device 0 first, so the bytes up to the furthest device holding an encoder
+// phase can be re-latched and read on their own. Those prefix reads run at the encoder rate and
+// the whole chain at the slower button rate; a full read also counts as a prefix read. When the
+// prefix is the whole chain, every read is a full read at the encoder rate.
+struct ShiftRegisterCadence {
+    uint8_t count = 0;        // devices in the chain
+    uint8_t prefixBytes = 0;  // devices up to the last encoder phase, 0 = no prefix reads
+    uint32_t fullUs = 0;      // full-chain interval
+    uint32_t prefixUs = 0;    // prefix interval
+    uint32_t lastFullUs = 0;
+    uint32_t lastPrefixUs = 0;
+    bool started = false;
+};
+
+inline void shiftRegisterCadenceInit(ShiftRegisterCadence& c, uint8_t count, uint8_t prefixBytes,
+                                     uint32_t fullUs, uint32_t prefixUs) {
+    c = ShiftRegisterCadence();
+    c.count = count;
+    c.fullUs = fullUs;
+    c.prefixUs = prefixUs;
+    if (!prefixBytes || !prefixUs || prefixUs >= fullUs) return; // no faster reads needed
+    if (prefixBytes >= count) {
+        // Encoders on the last device: the prefix is the whole chain, so full reads run at
+        // the encoder rate
+        c.fullUs = prefixUs;
+    } else {
+        c.prefixBytes = prefixBytes;
+    }
+}
+
+// Devices to read now: count for a full read, prefixBytes for a prefix read, 0 for none
+inline uint8_t shiftRegisterCadenceNext(ShiftRegisterCadence& c, uint32_t nowUs) {
+    if (!c.started || (uint32_t)(nowUs - c.lastFullUs) >= c.fullUs) {
+        c.started = true;
+        c.lastFullUs = c.lastPrefixUs = nowUs;
+        return c.count;
+    }
+    if (c.prefixBytes && (uint32_t)(nowUs - c.lastPrefixUs) >= c.prefixUs) {
+        c.lastPrefixUs = nowUs;
+        return c.prefixBytes;
+    }
+    return 0;
+}
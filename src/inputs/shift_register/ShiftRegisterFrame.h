@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <stdint.h>
+
+// Bit-order helpers shared by the 74HC165 backends (no Arduino dependency, host-testable).
+//
+// Buffer convention (established by the bit-banged reader): byte i holds the i-th device
+// shifted out of QH, and bit b of that byte is the b-th bit seen on QH after the parallel
+// load - i.e. bit 0 = input H, bit 7 = input A. Configs address bits by this layout, so
+// every backend must produce it exactly.
+//
+// The RP2040 SPI block only shifts MSB-first, so a hardware frame has the first QH bit in
+// bit 7. Converting a frame is therefore a per-byte bit reversal.
+
+namespace ShiftRegisterFrame {
+
+// Nibble table keeps the lookup to 16 bytes; Cortex-M0+ has no RBIT instruction.
+static constexpr uint8_t kNibbleReverse[16] = {
+    0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+    0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
+inline uint8_t reverseBits(uint8_t v) {
+    return (uint8_t)((kNibbleReverse[v & 0x0F] << 4) | kNibbleReverse[v >> 4]);
+}
+
+// Converts an MSB-first SPI frame into the shiftRegBuffer layout.
+inline void fromMsbFirst(const uint8_t* frame, uint8_t* buffer, uint8_t count) {
+    for (uint8_t i = 0; i < count; ++i) buffer[i] = reverseBits(frame[i]);
+}
+
+// RP2040 GPIO function select for SPI: the GPIO number modulo 4 picks the signal
+// (0 = RX, 1 = CSn, 2 = SCK, 3 = TX) and bit 3 picks the SPI block. Returns the block
+// index (0/1) when clkPin can drive SCK and qhPin can receive on the same block, else -1.
+inline int8_t spiBlockForPins(uint8_t clkPin, uint8_t qhPin) {
+    if (clkPin > 29 || qhPin > 29) return -1;
+    if ((clkPin & 0x3) != 2 || (qhPin & 0x3) != 0) return -1;
+    const uint8_t clkBlock = (clkPin >> 3) & 0x1;
+    const uint8_t qhBlock = (qhPin >> 3) & 0x1;
+    return (clkBlock == qhBlock) ? (int8_t)clkBlock : -1;
+}
+
+} // namespace ShiftRegisterFrame
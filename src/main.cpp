@@ -13,9 +13,18 @@
  *   and up to 8 axes via the Joystick_ wrapper; unused descriptor fields are simply not updated.
  *
  * Runtime order and timing now centralized by InputManager (shift -> buttons -> matrix -> encoders -> axes -> HID).
+ * The HID report is built as one transaction per scan cycle and sent at most once, when it changed.
+ *
+ * Dual-core split:
+ * - core1 (setup1/loop1) owns all input hardware and runs the scan loop back to back. Each cycle publishes
+ *   the finished report plus raw pin/matrix/shift-register state through a lock-free seqlock double buffer.
+ * - core0 (setup/loop) services TinyUSB, serial commands, storage and RawStateReader, and sends the newest
+ *   published report. Slow serial commands or USB work no longer delay a scan.
+ * Flash writes still pause core1 briefly: the core idles the other core while XIP flash is being erased.
  */
 
 #include <Arduino.h>
+#include <atomic>
 #ifdef USE_TINYUSB
 #include "Adafruit_TinyUSB.h"
 #endif
@@ -32,12 +41,13 @@
 #include "config/core/ConfigManager.h"
 #include "config/core/DeviceIdentifier.h"
 #include "utils/Debug.h"
+#include "utils/LoopProfiler.h"
 #include "comm/SerialCommands.h"
 #include "comm/RawStateReader.h"
 #include "rp2040/hid/HIDMapping.h"
 
 #if CONFIG_FEATURE_STORAGE_ENABLED
-    #include "rp2040/storage/RP2040EEPROMStorage.h"
+    #include "rp2040/storage/RP2040FlashLogStorage.h"
 #endif
 
 // HID configuration protocol removed - using serial communication instead
@@ -54,6 +64,10 @@ Joystick_ MyJoystick(0x03, 0x04, 128, 0, true, true, false, false, false, false,
 extern ShiftRegister165* shiftReg;
 extern uint8_t* shiftRegBuffer;
 
+// Start-up hand-shake: core0 brings up configuration and USB, then core1 initializes the inputs
+static std::atomic<bool> s_configReady(false);
+static std::atomic<bool> s_inputsReady(false);
+
 
 void setup() {
     // Initialize configuration manager (debug output will be lost but USB works)
@@ -78,14 +92,8 @@ void setup() {
     g_configProtocol.initialize();
 #endif
     
-    // Initialize all input subsystems using configuration from ConfigManager
-    const LogicalInput* configInputs = g_configManager.getLogicalInputs();
-    uint8_t configInputCount = g_configManager.getLogicalInputCount();
-    
-    g_inputManager.begin(configInputs, configInputCount);
-
-    // Initialize axis system
-    setupUserAxes(MyJoystick);
+    // Input subsystems are initialized by core1 (setup1) so their interrupts are serviced there
+    s_configReady.store(true, std::memory_order_release);
     
     // Initialize HID mapping system
     HIDMappingManager::initialize();
@@ -97,7 +105,14 @@ void setup() {
     
     // Delay for USB enumeration BEFORE enabling Serial
     delay(500);
+    while (!s_inputsReady.load(std::memory_order_acquire)) {
+        delay(1);
+    }
     
+#if CONFIG_FEATURE_PERF_STATS_ENABLED
+    LoopProfiler::begin();
+#endif
+
     // Initialize serial for debugging after USB is established
     Serial.begin(115200);
     Serial.println("JoyCore Configuration System Ready");
@@ -120,10 +135,54 @@ void setup() {
 }
 
 void loop() {
-    if (Serial.available()) {
-        String line = Serial.readStringUntil('\n');
-        processSerialLine(line);
+    PERF_BEGIN(tLoop);
+    PERF_BEGIN(tSerial);
+    pollSerialCommands();
+    PERF_END(PERF_SERIAL, tSerial);
+    // Newest scan from core1; committing every loop also retries rate-limited sends
+    // and picks up self-test button overrides. Presses core1 latched stay in its reports
+    // until one carrying them is sent, so a tap between two 1 ms sends is not skipped.
+    PERF_BEGIN(tSend);
+    g_inputManager.pollSnapshot();
+    if (g_inputManager.snapshotNumber() != 0) {
+        MyJoystick.commitReport(g_inputManager.snapshot().report);
+        if (!MyJoystick.reportPending()) g_inputManager.acknowledgeSnapshot();
     }
-    g_inputManager.update(MyJoystick);
+    PERF_END(PERF_HID_SEND, tSend);
+    PERF_BEGIN(tRaw);
     RawStateReader::updateRawMonitoring();
+    PERF_END(PERF_RAW_MONITOR, tRaw);
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    // Queued saves, one flash erase or program per iteration; core1 is parked only for that long
+    PERF_BEGIN(tStorage);
+    g_configManager.serviceStorageJob();
+    PERF_END(PERF_STORAGE, tStorage);
+#endif
+    PERF_END(PERF_LOOP, tLoop);
+}
+
+void setup1() {
+    while (!s_configReady.load(std::memory_order_acquire)) {
+        tight_loop_contents();
+    }
+    
+    // Initialize all input subsystems using configuration from ConfigManager
+    const LogicalInput* configInputs = g_configManager.getLogicalInputs();
+    uint8_t configInputCount = g_configManager.getLogicalInputCount();
+    
+    g_inputManager.begin(configInputs, configInputCount);
+
+    // Initialize axis system
+    setupUserAxes(MyJoystick);
+
+#if CONFIG_FEATURE_PERF_STATS_ENABLED
+    LoopProfiler::beginCore();
+#endif
+    s_inputsReady.store(true, std::memory_order_release);
+}
+
+void loop1() {
+    PERF_BEGIN(tScan);
+    g_inputManager.update(MyJoystick);
+    PERF_END(PERF_SCAN, tScan);
 }
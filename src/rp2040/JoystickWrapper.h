@@ -56,6 +56,11 @@ public:
         _gamepad->setButton(button, value != 0);
     }
     
+    // Bulk button update (4 words = buttons 0-127), used by the logical button kernel
+    void setButtonsMasked(const uint32_t* mask, const uint32_t* value) {
+        _gamepad->setButtonsMasked(mask, value);
+    }
+    
     void pressButton(uint8_t button) {
         setButton(button, 1);
     }
@@ -100,6 +105,32 @@ public:
         _gamepad->sendReport();
     }
     
+    // Per-cycle report transaction (see TinyUSBGamepad::beginReport/commitReport)
+    void beginReport() {
+        _gamepad->beginReport();
+    }
+    
+    bool commitReport() {
+        return _gamepad->commitReport();
+    }
+
+    // Dual-core hand-off (see TinyUSBGamepad::endReport/commitReport(scanned))
+    void endReport() {
+        _gamepad->endReport();
+    }
+
+    const joycore_gamepad_report_t& getReport() const {
+        return _gamepad->getReport();
+    }
+
+    bool commitReport(const joycore_gamepad_report_t& scanned) {
+        return _gamepad->commitReport(scanned);
+    }
+
+    bool reportPending() const {
+        return _gamepad->reportPending();
+    }
+    
     // Auto-send control for MOMENTARY button handling
     void setAutoSend(bool autoSend) {
         _gamepad->setAutoSend(autoSend);
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// HID Report structure for high-capacity gamepad
+// 128 buttons (16 bytes) + 16 axes (32 bytes) + frame counter (2 bytes) = 50 bytes total
+// Hat switches temporarily removed due to phantom input issues
+typedef struct __attribute__((packed)) {
+    uint8_t buttons[16];      // 128 buttons, 1 bit each (16 bytes)
+    int16_t axes[16];         // 16 axes, 16-bit signed values (32 bytes)
+    uint16_t frameCounter;    // Frame counter for report tracking (2 bytes)
+    // uint8_t hats;          // Hat switches temporarily disabled
+    // uint8_t hats2;         // Hat switches temporarily disabled
+} joycore_gamepad_report_t;
+
+static_assert(sizeof(joycore_gamepad_report_t) == 50, "joycore_gamepad_report_t must be 50 bytes");
+
+// Input payload (buttons + axes) compared as 32-bit words; the frame counter is excluded
+// because it only changes as a side effect of sending.
+static constexpr uint8_t GAMEPAD_REPORT_PAYLOAD_BYTES = 48;
+static constexpr uint8_t GAMEPAD_REPORT_PAYLOAD_WORDS = GAMEPAD_REPORT_PAYLOAD_BYTES / 4;
+
+// Returns a bitmask of changed payload words between two reports.
+// Bits 0-3 cover the button field, bits 4-11 the axes (two axes per word).
+// The packed struct has no alignment guarantee, so words are loaded through memcpy
+// (which the compiler lowers to plain word loads on Cortex-M0+ when aligned).
+inline uint16_t gamepadReportDiffMask(const joycore_gamepad_report_t& a, const joycore_gamepad_report_t& b) {
+    const uint8_t* pa = reinterpret_cast<const uint8_t*>(&a);
+    const uint8_t* pb = reinterpret_cast<const uint8_t*>(&b);
+    uint16_t mask = 0;
+    for (uint8_t w = 0; w < GAMEPAD_REPORT_PAYLOAD_WORDS; w++) {
+        uint32_t wa, wb;
+        memcpy(&wa, pa + w * 4, sizeof(wa));
+        memcpy(&wb, pb + w * 4, sizeof(wb));
+        if (wa != wb) mask |= (uint16_t)(1u << w);
+    }
+    return mask;
+}
+
+// Number of 32-bit words covering the 128-bit button field
+static constexpr uint8_t GAMEPAD_BUTTON_WORDS = 4;
+
+// Writes the masked bits of value into the button field: buttons = (buttons & ~mask) | (value & mask).
+// Word w bit k is button 32*w + k (RP2040 and hosts are little-endian, matching the byte layout).
+inline void gamepadReportApplyButtons(joycore_gamepad_report_t& r, const uint32_t* mask, const uint32_t* value) {
+    for (uint8_t w = 0; w < GAMEPAD_BUTTON_WORDS; w++) {
+        if (!mask[w]) continue;
+        uint32_t bits;
+        memcpy(&bits, r.buttons + w * 4, sizeof(bits));
+        bits = (bits & ~mask[w]) | (value[w] & mask[w]);
+        memcpy(r.buttons + w * 4, &bits, sizeof(bits));
+    }
+}
@@ -4,6 +4,7 @@
 #include "../../config/core/ConfigManager.h"
 #include "../../utils/Debug.h"
 #include "../../Config.h"
+#include "../../inputs/encoders/EncoderAxis.h"
 #include <string.h>
 
 // Static member definitions
@@ -34,6 +35,12 @@ uint16_t calculateMappingCRC16(const uint8_t* mapping, uint8_t length) {
     return crc;
 }
 
+// Both entries of an ENC_AXIS_A/ENC_B pair report on an axis, not on buttons
+static bool isEncoderAxisInput(const LogicalInput* inputs, uint8_t i) {
+    if (logicalBehavior(inputs[i]) == ENC_AXIS_A) return true;
+    return i > 0 && logicalBehavior(inputs[i]) == ENC_B && logicalBehavior(inputs[i - 1]) == ENC_AXIS_A;
+}
+
 // Check if mapping is sequential
 bool isMappingSequential(const uint8_t* mapping, uint8_t length) {
     for (uint8_t i = 0; i < length; i++) {
@@ -68,6 +75,7 @@ void HIDMappingManager::buildMappingInfo() {
     // Count actual buttons (exclude encoders and other non-button inputs)
     uint8_t buttonCount = 0;
     for (uint8_t i = 0; i < inputCount; i++) {
+        if (isEncoderAxisInput(inputs, i)) continue;
         if (inputs[i].type == INPUT_PIN || 
             inputs[i].type == INPUT_MATRIX || 
             inputs[i].type == INPUT_SHIFTREG) {
@@ -86,6 +94,14 @@ void HIDMappingManager::buildMappingInfo() {
     }
     _mappingInfo.axis_count = axisCount;
     
+    // Encoders reporting on an axis (ENC_AXIS_A + ENC_B, axis number in the ENC_AXIS_A entry)
+    for (uint8_t i = 0; i + 1 < inputCount; i++) {
+        if (logicalBehavior(inputs[i]) == ENC_AXIS_A && logicalBehavior(inputs[i + 1]) == ENC_B) {
+            int8_t axis = encoderAxisIndex(logicalJoyButtonID(inputs[i]));
+            if (axis >= 0) _mappingInfo.encoder_axis_mask |= (uint16_t)(1u << axis);
+        }
+    }
+    
     // Set fixed offsets based on HID report structure
     _mappingInfo.button_byte_offset = 0;  // Buttons start at byte 0
     _mappingInfo.button_bit_order = HID_MAPPING_BIT_ORDER_LSB;  // LSB first per byte
@@ -109,6 +125,7 @@ void HIDMappingManager::buildButtonMapping() {
     
     uint8_t buttonIndex = 0;
     for (uint8_t i = 0; i < inputCount && buttonIndex < 128; i++) {
+        if (isEncoderAxisInput(inputs, i)) continue;
         uint8_t joyButtonID = 0;
         switch (inputs[i].type) {
             case INPUT_PIN:
@@ -169,15 +186,16 @@ uint16_t HIDMappingManager::handleGetSelfTest(uint8_t* buffer, uint16_t reqlen)
             
             // Clear previous button
             if (_selfTestState.current_button > 0) {
-                _gamepadForTest->releaseButton(_selfTestState.current_button - 1);
+                _gamepadForTest->overrideButton(_selfTestState.current_button - 1, false);
             }
             
             // Set next button
             if (_selfTestState.current_button < _mappingInfo.button_count) {
-                _gamepadForTest->pressButton(_selfTestState.current_button);
+                _gamepadForTest->overrideButton(_selfTestState.current_button, true);
                 _selfTestState.current_button++;
             } else {
-                // Test complete
+                // Test complete: hand the buttons back to the input scan
+                _gamepadForTest->clearButtonOverrides();
                 _selfTestState.status = SELFTEST_STATUS_COMPLETE;
                 _selfTestState.command = SELFTEST_CMD_STOP;
             }
@@ -198,9 +216,9 @@ void HIDMappingManager::handleSetSelfTest(const uint8_t* buffer, uint16_t bufsiz
     
     switch (newState.command) {
         case SELFTEST_CMD_START_WALK:
-            // Clear all buttons first
+            // Clear all buttons first (overrides the scanned state until the test stops)
             for (uint8_t i = 0; i < 128; i++) {
-                _gamepadForTest->releaseButton(i);
+                _gamepadForTest->overrideButton(i, false);
             }
             
             _selfTestState.command = SELFTEST_CMD_START_WALK;
@@ -212,10 +230,8 @@ void HIDMappingManager::handleSetSelfTest(const uint8_t* buffer, uint16_t bufsiz
             break;
             
         case SELFTEST_CMD_STOP:
-            // Clear all buttons
-            for (uint8_t i = 0; i < 128; i++) {
-                _gamepadForTest->releaseButton(i);
-            }
+            // Hand the buttons back to the input scan
+            _gamepadForTest->clearButtonOverrides();
             
             _selfTestState.command = SELFTEST_CMD_STOP;
             _selfTestState.status = SELFTEST_STATUS_IDLE;
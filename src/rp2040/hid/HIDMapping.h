@@ -18,7 +18,8 @@ typedef struct __attribute__((packed)) {
     uint8_t button_bit_order;       // 0 = LSB-first-per-byte, 1 = MSB-first
     uint16_t mapping_crc;           // CRC16 of button mapping (0x0000 = sequential)
     uint8_t frame_counter_offset;   // Byte offset of frame counter in input report
-    uint8_t reserved[7];            // Reserved for future use
+    uint16_t encoder_axis_mask;     // Report axes driven by encoders (bit n = axes[n], ENC_AXIS_A)
+    uint8_t reserved[5];            // Reserved for future use
 } HIDMappingInfo;
 
 // Self-test control structure
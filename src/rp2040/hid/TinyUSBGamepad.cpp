@@ -123,10 +123,13 @@ TinyUSBGamepad MyGamepad;
 uint16_t (*TinyUSBGamepad::_get_feature_callback)(uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen) = nullptr;
 void (*TinyUSBGamepad::_set_feature_callback)(uint8_t report_id, hid_report_type_t report_type, const uint8_t* buffer, uint16_t bufsize) = nullptr;
 
-TinyUSBGamepad::TinyUSBGamepad() : _auto_send(true), _last_send_time(0), _state_changed(false), _hat_switches_disabled(true) {
+TinyUSBGamepad::TinyUSBGamepad() : _auto_send(true), _last_send_time(0), _state_changed(false), _in_transaction(false), _hat_switches_disabled(true) {
     // Initialize report structures
     memset(&_report, 0, sizeof(_report));
+    memset(&_tx_report, 0, sizeof(_tx_report));
     memset(&_prev_report, 0, sizeof(_prev_report));
+    memset(_override_mask, 0, sizeof(_override_mask));
+    memset(_override_value, 0, sizeof(_override_value));
     
     // Hat switches removed from report structure - no initialization needed
 }
@@ -196,6 +199,7 @@ void TinyUSBGamepad::setButton(uint8_t button, bool pressed) {
         _report.buttons[byte_idx] &= ~(1 << bit_idx);
     }
     
+    if (_in_transaction) return; // diffed once in commitReport()
     _updateStateChanged();
     _sendIfChanged();
 }
@@ -210,6 +214,14 @@ void TinyUSBGamepad::releaseButton(uint8_t button) {
 
 void TinyUSBGamepad::releaseAllButtons() {
     memset(_report.buttons, 0, sizeof(_report.buttons));
+    if (_in_transaction) return;
+    _updateStateChanged();
+    _sendIfChanged();
+}
+
+void TinyUSBGamepad::setButtonsMasked(const uint32_t* mask, const uint32_t* value) {
+    gamepadReportApplyButtons(_report, mask, value);
+    if (_in_transaction) return;
     _updateStateChanged();
     _sendIfChanged();
 }
@@ -222,6 +234,7 @@ void TinyUSBGamepad::setAxis(uint8_t axis, int16_t value) {
     if (value > 32767) value = 32767;
     
     _report.axes[axis] = value;
+    if (_in_transaction) return;
     _updateStateChanged();
     _sendIfChanged();
 }
@@ -244,19 +257,48 @@ bool TinyUSBGamepad::sendReport() {
     }
     
     // Increment frame counter before sending
-    _report.frameCounter++;
+    _tx_report.frameCounter++;
     
-    bool success = _usb_hid.sendReport(1, &_report, sizeof(_report));
+    bool success = _usb_hid.sendReport(1, &_tx_report, sizeof(_tx_report));
     
     if (success) {
         _last_send_time = micros();
-        memcpy(&_prev_report, &_report, sizeof(_report));
+        memcpy(&_prev_report, &_tx_report, sizeof(_tx_report));
         _state_changed = false;
     }
     
     return success;
 }
 
+bool TinyUSBGamepad::commitReport() {
+    _in_transaction = false;
+    return commitReport(_report);
+}
+
+bool TinyUSBGamepad::commitReport(const joycore_gamepad_report_t& scanned) {
+    _compose(scanned);
+    _state_changed = (gamepadReportDiffMask(_tx_report, _prev_report) != 0);
+    if (!_state_changed) {
+        return false;
+    }
+    // A failed or rate-limited send leaves _prev_report untouched, so the
+    // difference is picked up again on the next commit.
+    return sendReport();
+}
+
+void TinyUSBGamepad::overrideButton(uint8_t button, bool pressed) {
+    if (button >= 128) return;
+    const uint32_t bit = 1u << (button & 31);
+    _override_mask[button >> 5] |= bit;
+    if (pressed) _override_value[button >> 5] |= bit;
+    else _override_value[button >> 5] &= ~bit;
+}
+
+void TinyUSBGamepad::clearButtonOverrides() {
+    memset(_override_mask, 0, sizeof(_override_mask));
+    memset(_override_value, 0, sizeof(_override_value));
+}
+
 bool TinyUSBGamepad::isReady() const {
     return const_cast<Adafruit_USBD_HID&>(_usb_hid).ready();
 }
@@ -269,8 +311,15 @@ void TinyUSBGamepad::reset() {
     _updateStateChanged();
 }
 
+// Payload (buttons + axes) of source with the override bits applied; the frame counter is kept
+void TinyUSBGamepad::_compose(const joycore_gamepad_report_t& source) {
+    memcpy(&_tx_report, &source, GAMEPAD_REPORT_PAYLOAD_BYTES);
+    gamepadReportApplyButtons(_tx_report, _override_mask, _override_value);
+}
+
 void TinyUSBGamepad::_updateStateChanged() {
-    _state_changed = (memcmp(&_report, &_prev_report, sizeof(_report)) != 0);
+    _compose(_report);
+    _state_changed = (gamepadReportDiffMask(_tx_report, _prev_report) != 0);
 }
 
 bool TinyUSBGamepad::_canSend() const {
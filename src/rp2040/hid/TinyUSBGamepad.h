@@ -3,17 +3,7 @@
 
 #include <Arduino.h>
 #include "Adafruit_TinyUSB.h"
-
-// HID Report structure for high-capacity gamepad
-// 128 buttons (16 bytes) + 16 axes (32 bytes) + frame counter (2 bytes) = 50 bytes total
-// Hat switches temporarily removed due to phantom input issues
-typedef struct __attribute__((packed)) {
-    uint8_t buttons[16];      // 128 buttons, 1 bit each (16 bytes)
-    int16_t axes[16];         // 16 axes, 16-bit signed values (32 bytes)
-    uint16_t frameCounter;    // Frame counter for report tracking (2 bytes)
-    // uint8_t hats;          // Hat switches temporarily disabled
-    // uint8_t hats2;         // Hat switches temporarily disabled
-} joycore_gamepad_report_t;
+#include "GamepadReport.h"
 
 // Hat switch direction values (4-bit values)
 #define HAT_DIR_N   0   // North
@@ -29,8 +19,13 @@ typedef struct __attribute__((packed)) {
 class TinyUSBGamepad {
 private:
     Adafruit_USBD_HID _usb_hid;
-    joycore_gamepad_report_t _report;
-    joycore_gamepad_report_t _prev_report;
+    joycore_gamepad_report_t _report;       // report being built by the input scan (setters write here)
+    joycore_gamepad_report_t _tx_report;    // report as composed for USB (scan payload + button overrides)
+    joycore_gamepad_report_t _prev_report;  // last report sent
+    
+    // Buttons forced by the HID self-test, applied on top of the scanned report when composing
+    uint32_t _override_mask[GAMEPAD_BUTTON_WORDS];
+    uint32_t _override_value[GAMEPAD_BUTTON_WORDS];
     bool _auto_send;
     uint32_t _last_send_time;
     static constexpr uint32_t MIN_SEND_INTERVAL_US = 1000; // 1ms = 1000Hz max
@@ -38,6 +33,9 @@ private:
     // State change detection
     bool _state_changed;
     
+    // Report transaction: while open, setters only edit _report (no compare, no send)
+    bool _in_transaction;
+    
     // Temporary disable hat switches due to phantom inputs
     bool _hat_switches_disabled;
     
@@ -58,6 +56,8 @@ public:
     void pressButton(uint8_t button);
     void releaseButton(uint8_t button);
     void releaseAllButtons();
+    // Bulk update: mask/value are GAMEPAD_BUTTON_WORDS words covering buttons 0-127
+    void setButtonsMasked(const uint32_t* mask, const uint32_t* value);
     
     // Axis methods (0-15), values -32767 to 32767
     void setAxis(uint8_t axis, int16_t value);
@@ -76,6 +76,27 @@ public:
     // Report management
     bool sendReport();
     void sendState() { sendReport(); }
+    
+    // Report transaction for one scan cycle: beginReport() defers all diffing and sending,
+    // commitReport() compares the finished report against the last sent one and sends at most once.
+    // Returns true if a report was sent.
+    void beginReport() { _in_transaction = true; }
+    bool commitReport();
+    bool inReportTransaction() const { return _in_transaction; }
+    
+    // Dual-core split: the scan core closes its transaction with endReport() and publishes
+    // getReport(); core0 sends the published copy with commitReport(scanned). Nothing is sent
+    // from the scan core.
+    void endReport() { _in_transaction = false; }
+    const joycore_gamepad_report_t& getReport() const { return _report; }
+    bool commitReport(const joycore_gamepad_report_t& scanned);
+    // True while the last committed report differs from the one sent (rate limit, USB busy)
+    bool reportPending() const { return _state_changed; }
+    
+    // Force a button in the sent report regardless of the scanned state (HID self-test).
+    // Takes effect on the next commit; clearButtonOverrides() returns to the scanned state.
+    void overrideButton(uint8_t button, bool pressed);
+    void clearButtonOverrides();
     bool isReady() const;
     
     // Auto-send control
@@ -100,6 +121,7 @@ public:
     static void handleFeatureReportSet(uint8_t report_id, hid_report_type_t report_type, const uint8_t* buffer, uint16_t bufsize);
     
 private:
+    void _compose(const joycore_gamepad_report_t& source);
     void _updateStateChanged();
     bool _canSend() const;
     void _sendIfChanged();
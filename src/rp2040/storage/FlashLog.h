@@ -0,0 +1,450 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Log-structured record store on a ring of flash sectors (no Arduino dependency, host-testable).
+//
+// A write appends one record and never rewrites anything in place. The record is a header
+// (sequence number, 4-char key, key version, size, CRC-32) followed by the payload, padded to
+// whole pages and programmed in one operation. The newest valid version of a key is the file.
+// The version before it is kept as well; it serves as the config backup.
+//
+// Records never span a sector. When one does not fit the rest of the head sector, the head moves
+// to the next erased sector. One erased sector is always held in reserve. When the reserve would
+// be used up, the oldest sector (the tail) is collected: its live records are copied to the head
+// and it is erased. Erases walk around the ring, so wear is spread evenly over all sectors.
+//
+// Power loss: a record whose program was cut short fails its CRC and is ignored on mount. A key
+// therefore reads as either its old or its new version. A relocated copy keeps the key version of
+// the original and gets a newer sequence number. The original and the copy are interchangeable
+// until the tail erase completes.
+static constexpr uint32_t FLASH_LOG_PAGE = 256;     // program granularity
+static constexpr uint32_t FLASH_LOG_SECTOR = 4096;  // erase granularity
+static constexpr uint8_t FLASH_LOG_MIN_SECTORS = 3; // head, reserve, one more to collect
+static constexpr uint8_t FLASH_LOG_MAX_SECTORS = 32;
+static constexpr uint8_t FLASH_LOG_MAX_KEYS = 8;
+static constexpr uint32_t FLASH_LOG_MAGIC = 0x474C434Au; // "JCLG"
+static constexpr uint8_t FLASH_LOG_TOMBSTONE = 0x01;    // record marks the key removed
+
+struct FlashLogHeader {
+    uint32_t magic;
+    uint32_t seq;      // write order; every record written gets the next one, relocations too
+    uint32_t gen;      // version of the key; kept when the record is relocated
+    char key[4];
+    uint16_t size;     // payload bytes
+    uint8_t flags;     // FLASH_LOG_TOMBSTONE
+    uint8_t reserved;
+    uint32_t crc;      // CRC-32 of the header fields above and the payload
+};
+static_assert(sizeof(FlashLogHeader) == 24, "FlashLogHeader layout is stored in flash");
+static constexpr uint32_t FLASH_LOG_MAX_PAYLOAD = FLASH_LOG_SECTOR - sizeof(FlashLogHeader);
+
+// Fills page `page` (FLASH_LOG_PAGE bytes) of the record being programmed
+typedef void (*FlashLogFill)(const void* ctx, uint32_t page, uint8_t* out);
+
+// Flash region holding the ring; offsets are relative to its first sector
+class FlashLogMedium {
+public:
+    virtual ~FlashLogMedium() = default;
+    // Memory-mapped view of the region
+    virtual const uint8_t* map(uint32_t offset) const = 0;
+    // Erases the sector at a sector-aligned offset
+    virtual bool erase(uint32_t offset) = 0;
+    // Programs `pages` consecutive pages from a page-aligned offset as one operation
+    virtual bool program(uint32_t offset, uint32_t pages, FlashLogFill fill, const void* ctx) = 0;
+};
+
+struct FlashLogStats {
+    uint32_t appends;    // records written for callers (writes and removes)
+    uint32_t relocated;  // live records copied out of a collected tail
+    uint32_t erases;     // sector erases
+    uint32_t programs;   // program operations
+    uint32_t pages;      // pages programmed
+};
+
+// Outcome of one incremental step (FlashLog::appendStep)
+enum class FlashLogProgress : uint8_t {
+    BUSY,    // one flash operation done, call again
+    DONE,
+    FAILED
+};
+
+inline uint32_t flashLogCrc32(uint32_t crc, const uint8_t* p, size_t n) {
+    crc = ~crc;
+    while (n--) {
+        crc ^= *p++;
+        for (uint8_t k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+inline uint32_t flashLogRecordCrc(const FlashLogHeader& h, const uint8_t* payload) {
+    const uint32_t c = flashLogCrc32(0, (const uint8_t*)&h, offsetof(FlashLogHeader, crc));
+    return flashLogCrc32(c, payload, h.size);
+}
+
+// Pages a record of `size` payload bytes occupies
+inline uint32_t flashLogRecordPages(uint32_t size) {
+    return (uint32_t)(sizeof(FlashLogHeader) + size + FLASH_LOG_PAGE - 1) / FLASH_LOG_PAGE;
+}
+
+class FlashLog {
+public:
+    FlashLog(FlashLogMedium& medium, uint8_t sectors)
+        : m_medium(medium),
+          m_sectors(sectors < FLASH_LOG_MIN_SECTORS ? FLASH_LOG_MIN_SECTORS
+                    : sectors > FLASH_LOG_MAX_SECTORS ? FLASH_LOG_MAX_SECTORS : sectors) {
+        reset();
+    }
+
+    // Scans the ring and rebuilds the index. Returns false if the region holds data but no valid
+    // record (never formatted, or another layout): the caller formats it.
+    bool mount() {
+        reset();
+        bool any = false, blankAll = true;
+        uint32_t maxSeq = 0, headEnd = 0;
+        uint8_t head = 0;
+        for (uint8_t s = 0; s < m_sectors; s++) {
+            if (sectorBlank(s)) { m_erased |= 1u << s; continue; }
+            blankAll = false;
+            for (uint32_t p = 0; p < FLASH_LOG_SECTOR;) {
+                const uint32_t off = s * FLASH_LOG_SECTOR + p;
+                FlashLogHeader h;
+                if (!recordAt(off, h)) { p += FLASH_LOG_PAGE; continue; }
+                p += flashLogRecordPages(h.size) * FLASH_LOG_PAGE;
+                index(h, off);
+                if (!any || h.seq > maxSeq) { maxSeq = h.seq; head = s; headEnd = p; }
+                any = true;
+            }
+        }
+        if (!any) return blankAll;
+
+        // Removed keys have no backup version
+        for (uint8_t i = 0; i < m_keyCount; i++) {
+            if (isTombstone(m_index[i].off[0])) m_index[i].count = 1;
+        }
+        // Append after the last record, past any pages a cut-short program left behind
+        uint32_t used = FLASH_LOG_SECTOR;
+        while (used > headEnd && pageBlank(head * FLASH_LOG_SECTOR + used - FLASH_LOG_PAGE)) used -= FLASH_LOG_PAGE;
+        m_head = head;
+        m_headUsed = used;
+        m_nextSeq = maxSeq + 1;
+        return true;
+    }
+
+    // Erases every sector of the ring
+    bool format() {
+        reset();
+        bool ok = true;
+        for (uint8_t s = 0; s < m_sectors; s++) ok &= eraseSector(s);
+        return ok;
+    }
+
+    // Payload of the newest (version 0) or previous (version 1) record of key, in mapped flash.
+    // nullptr if the key has no such version or was removed.
+    const uint8_t* find(const char* key, uint8_t version, uint16_t* size) const {
+        const Entry* e = entry(key);
+        if (!e || version >= e->count || isTombstone(e->off[0])) return nullptr;
+        FlashLogHeader h;
+        memcpy(&h, m_medium.map(e->off[version]), sizeof(h));
+        if (h.flags & FLASH_LOG_TOMBSTONE) return nullptr;
+        if (size) *size = h.size;
+        return m_medium.map(e->off[version] + sizeof(FlashLogHeader));
+    }
+
+    // Appends a new version of key. The previous version stays readable until the next append.
+    bool append(const char* key, const uint8_t* data, uint16_t size) {
+        return finish(key, data, size, 0);
+    }
+
+    // Same as append(), one flash operation per call: relocating one live record, erasing the
+    // collected tail, or finally programming the record. Call with the same arguments until it
+    // returns DONE or FAILED. Reads see a consistent index between calls.
+    FlashLogProgress appendStep(const char* key, const uint8_t* data, uint16_t size) {
+        return step(key, data, size, 0);
+    }
+
+    // Appends a removal marker; the key and its versions read as absent afterwards
+    bool remove(const char* key) {
+        const Entry* e = entry(key);
+        if (!e || isTombstone(e->off[0])) return false;
+        return finish(key, nullptr, 0, FLASH_LOG_TOMBSTONE);
+    }
+
+    // Keys that currently hold a file
+    uint8_t keys(char out[][4], uint8_t max) const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < m_keyCount && n < max; i++) {
+            if (!isTombstone(m_index[i].off[0])) memcpy(out[n++], m_index[i].key, 4);
+        }
+        return n;
+    }
+
+    // Payload bytes of the newest version of every key
+    uint32_t liveBytes() const {
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < m_keyCount; i++) {
+            FlashLogHeader h;
+            memcpy(&h, m_medium.map(m_index[i].off[0]), sizeof(h));
+            if (!(h.flags & FLASH_LOG_TOMBSTONE)) total += h.size;
+        }
+        return total;
+    }
+
+    // Payload bytes that fit with two versions of each and the reserve sector left over
+    uint32_t capacity() const { return (uint32_t)(m_sectors - 2) * FLASH_LOG_SECTOR / 2; }
+
+    uint8_t sectors() const { return m_sectors; }
+    uint8_t headSector() const { return m_head; }
+    uint32_t headUsed() const { return m_headUsed; }
+    uint8_t erasedSectors() const { return popcount(m_erased & ~(1u << m_head)); }
+    const FlashLogStats& stats() const { return m_stats; }
+
+private:
+    struct Entry {
+        char key[4];
+        uint8_t count;    // versions held (1..2)
+        uint32_t gen[2];  // newest first
+        uint32_t seq[2];
+        uint32_t off[2];
+    };
+
+    struct FillContext {
+        const FlashLogHeader* header;
+        const uint8_t* payload;
+    };
+
+    FlashLogMedium& m_medium;
+    const uint8_t m_sectors;
+    Entry m_index[FLASH_LOG_MAX_KEYS];
+    uint8_t m_keyCount;
+    uint8_t m_head;         // sector being appended to
+    uint32_t m_headUsed;    // bytes of it already programmed (or left unusable)
+    uint32_t m_erased;      // bit per sector known to be blank
+    uint32_t m_nextSeq;
+    FlashLogStats m_stats;
+    int8_t m_collectTail;   // sector being collected, -1 = none
+    uint32_t m_collectPos;  // next byte of it to look at
+    uint8_t m_collectRounds; // collections started for the pending record
+
+    void reset() {
+        memset(m_index, 0, sizeof(m_index));
+        memset(&m_stats, 0, sizeof(m_stats));
+        m_keyCount = 0;
+        m_head = 0;
+        m_headUsed = 0;
+        m_erased = 0;
+        m_nextSeq = 1;
+        m_collectTail = -1;
+        m_collectPos = 0;
+        m_collectRounds = 0;
+    }
+
+    static uint8_t popcount(uint32_t v) {
+        uint8_t n = 0;
+        for (; v; v &= v - 1) n++;
+        return n;
+    }
+
+    bool pageBlank(uint32_t off) const {
+        const uint8_t* p = m_medium.map(off);
+        for (uint32_t i = 0; i < FLASH_LOG_PAGE; i++) if (p[i] != 0xFF) return false;
+        return true;
+    }
+
+    bool sectorBlank(uint8_t s) const {
+        for (uint32_t p = 0; p < FLASH_LOG_SECTOR; p += FLASH_LOG_PAGE) {
+            if (!pageBlank(s * FLASH_LOG_SECTOR + p)) return false;
+        }
+        return true;
+    }
+
+    // Valid record at off: magic, size within the sector, CRC
+    bool recordAt(uint32_t off, FlashLogHeader& h) const {
+        memcpy(&h, m_medium.map(off), sizeof(h));
+        if (h.magic != FLASH_LOG_MAGIC || h.size > FLASH_LOG_MAX_PAYLOAD) return false;
+        if ((off % FLASH_LOG_SECTOR) + flashLogRecordPages(h.size) * FLASH_LOG_PAGE > FLASH_LOG_SECTOR) return false;
+        return flashLogRecordCrc(h, m_medium.map(off + sizeof(FlashLogHeader))) == h.crc;
+    }
+
+    bool isTombstone(uint32_t off) const {
+        FlashLogHeader h;
+        memcpy(&h, m_medium.map(off), sizeof(h));
+        return (h.flags & FLASH_LOG_TOMBSTONE) != 0;
+    }
+
+    const Entry* entry(const char* key) const {
+        for (uint8_t i = 0; i < m_keyCount; i++) if (memcmp(m_index[i].key, key, 4) == 0) return &m_index[i];
+        return nullptr;
+    }
+    Entry* entry(const char* key) { return const_cast<Entry*>(static_cast<const FlashLog*>(this)->entry(key)); }
+
+    void dropEntry(Entry* e) {
+        *e = m_index[--m_keyCount];
+    }
+
+    // Adds a record to the index; of two copies of one version the newer write wins
+    void index(const FlashLogHeader& h, uint32_t off) {
+        Entry* e = entry(h.key);
+        if (!e) {
+            if (m_keyCount >= FLASH_LOG_MAX_KEYS) return;
+            e = &m_index[m_keyCount++];
+            memcpy(e->key, h.key, 4);
+            e->count = 0;
+        }
+        for (uint8_t v = 0; v < e->count; v++) {
+            if (e->gen[v] != h.gen) continue;
+            if (h.seq > e->seq[v]) { e->seq[v] = h.seq; e->off[v] = off; }
+            return;
+        }
+        uint8_t v;
+        if (e->count == 0 || h.gen > e->gen[0]) {
+            e->gen[1] = e->gen[0]; e->seq[1] = e->seq[0]; e->off[1] = e->off[0];
+            if (e->count < 2) e->count++;
+            v = 0;
+        } else if (e->count == 1 || h.gen > e->gen[1]) {
+            e->count = 2;
+            v = 1;
+        } else {
+            return; // older than both versions kept
+        }
+        e->gen[v] = h.gen; e->seq[v] = h.seq; e->off[v] = off;
+    }
+
+    static void fillPage(const void* ctx, uint32_t page, uint8_t* out) {
+        const FillContext* c = (const FillContext*)ctx;
+        const uint32_t size = c->header->size;
+        for (uint32_t i = 0; i < FLASH_LOG_PAGE; i++) {
+            const uint32_t b = page * FLASH_LOG_PAGE + i;
+            out[i] = (b < sizeof(FlashLogHeader)) ? ((const uint8_t*)c->header)[b]
+                   : (b - sizeof(FlashLogHeader) < size) ? c->payload[b - sizeof(FlashLogHeader)]
+                   : 0xFF;
+        }
+    }
+
+    bool eraseSector(uint8_t s) {
+        const bool ok = m_medium.erase(s * FLASH_LOG_SECTOR);
+        m_stats.erases++;
+        if (!ok || !sectorBlank(s)) return false;
+        m_erased |= 1u << s;
+        if (s == m_head) m_headUsed = 0;
+        return true;
+    }
+
+    // Programs one record at the head (stamping seq and CRC); returns its offset or UINT32_MAX.
+    // Moves to the next sector only if that one is blank; space is ensured by the caller.
+    uint32_t writeRecord(FlashLogHeader& h, const uint8_t* payload) {
+        const uint32_t pages = flashLogRecordPages(h.size);
+        if (m_headUsed + pages * FLASH_LOG_PAGE > FLASH_LOG_SECTOR) {
+            const uint8_t next = (uint8_t)((m_head + 1) % m_sectors);
+            if (!(m_erased & (1u << next))) return UINT32_MAX;
+            m_head = next;
+            m_headUsed = 0;
+        }
+        h.magic = FLASH_LOG_MAGIC;
+        h.seq = m_nextSeq++;
+        h.crc = flashLogRecordCrc(h, payload);
+
+        const uint32_t off = m_head * FLASH_LOG_SECTOR + m_headUsed;
+        m_erased &= ~(1u << m_head);
+        m_headUsed += pages * FLASH_LOG_PAGE; // consumed even if the program fails
+        const FillContext ctx = { &h, payload };
+        const bool ok = m_medium.program(off, pages, fillPage, &ctx);
+        m_stats.programs++;
+        m_stats.pages += pages;
+        FlashLogHeader check;
+        if (!ok || !recordAt(off, check) || check.seq != h.seq) return UINT32_MAX;
+        return off;
+    }
+
+    // Oldest sector holding data: the first one after the head that is not blank
+    int8_t tailSector() const {
+        for (uint8_t i = 1; i < m_sectors; i++) {
+            const uint8_t s = (uint8_t)((m_head + i) % m_sectors);
+            if (!(m_erased & (1u << s))) return (int8_t)s;
+        }
+        return -1;
+    }
+
+    // Relocates the next live record of the tail to the head, or erases the tail once none is
+    // left. One flash operation per call.
+    bool collectStep() {
+        if (m_collectTail < 0) {
+            m_collectTail = tailSector();
+            m_collectPos = 0;
+            m_collectRounds++;
+            if (m_collectTail < 0) return false;
+        }
+        while (m_collectPos < FLASH_LOG_SECTOR) {
+            const uint32_t off = (uint32_t)m_collectTail * FLASH_LOG_SECTOR + m_collectPos;
+            FlashLogHeader h;
+            if (!recordAt(off, h)) { m_collectPos += FLASH_LOG_PAGE; continue; }
+            m_collectPos += flashLogRecordPages(h.size) * FLASH_LOG_PAGE;
+
+            Entry* e = entry(h.key);
+            if (!e) continue;
+            const int8_t v = (e->off[0] == off) ? 0 : (e->count > 1 && e->off[1] == off) ? 1 : -1;
+            if (v < 0) continue; // superseded
+            if (isTombstone(e->off[0])) {
+                // Everything older than a removal marker is in this sector or already gone
+                if (v == 0) dropEntry(e);
+                continue;
+            }
+            const uint32_t moved = writeRecord(h, m_medium.map(off + sizeof(FlashLogHeader)));
+            if (moved == UINT32_MAX) return false;
+            e->off[v] = moved;
+            e->seq[v] = h.seq;
+            m_stats.relocated++;
+            return true;
+        }
+        const uint8_t t = (uint8_t)m_collectTail;
+        m_collectTail = -1;
+        return eraseSector(t);
+    }
+
+    // Room for `pages` at the head with one erased sector still in reserve
+    bool spaceReady(uint32_t pages) const {
+        if (m_headUsed + pages * FLASH_LOG_PAGE <= FLASH_LOG_SECTOR) return true;
+        const uint8_t next = (uint8_t)((m_head + 1) % m_sectors);
+        return (m_erased & (1u << next)) && erasedSectors() >= 2;
+    }
+
+    FlashLogProgress step(const char* key, const uint8_t* data, uint16_t size, uint8_t flags) {
+        if (size > FLASH_LOG_MAX_PAYLOAD || (size && !data)) return FlashLogProgress::FAILED;
+        if (!entry(key) && m_keyCount >= FLASH_LOG_MAX_KEYS) return FlashLogProgress::FAILED;
+        if (m_collectTail >= 0 || !spaceReady(flashLogRecordPages(size))) {
+            // Every sector collected once more without making room: the ring is full
+            const bool full = m_collectTail < 0 && m_collectRounds > m_sectors;
+            if (full || !collectStep()) {
+                m_collectTail = -1;
+                m_collectRounds = 0;
+                return FlashLogProgress::FAILED;
+            }
+            return FlashLogProgress::BUSY;
+        }
+        m_collectRounds = 0;
+
+        const Entry* e = entry(key); // collection may have dropped a removed key
+        FlashLogHeader h;
+        memset(&h, 0, sizeof(h));
+        h.gen = e ? e->gen[0] + 1 : 1;
+        memcpy(h.key, key, 4);
+        h.size = size;
+        h.flags = flags;
+        const uint8_t empty = 0xFF;
+        const uint32_t off = writeRecord(h, size ? data : &empty);
+        if (off == UINT32_MAX) return FlashLogProgress::FAILED;
+        m_stats.appends++;
+        index(h, off);
+        if (flags & FLASH_LOG_TOMBSTONE) entry(key)->count = 1;
+        return FlashLogProgress::DONE;
+    }
+
+    bool finish(const char* key, const uint8_t* data, uint16_t size, uint8_t flags) {
+        FlashLogProgress p;
+        while ((p = step(key, data, size, flags)) == FlashLogProgress::BUSY) {}
+        return p == FlashLogProgress::DONE;
+    }
+};
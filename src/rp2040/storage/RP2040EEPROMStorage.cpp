@@ -388,6 +388,20 @@ void RP2040EEPROMStorage::filenameToKey(const char* filename, char* key) {
     }
 }
 
+void RP2040EEPROMStorage::keyToFilename(const char* key, char* filename, size_t size) {
+    // Convert the 3-character key back to filename
+    if (memcmp(key, "CFG", 3) == 0) {
+        snprintf(filename, size, "%s", CONFIG_STORAGE_FILENAME);
+    } else if (memcmp(key, "BAK", 3) == 0) {
+        snprintf(filename, size, "%s", CONFIG_STORAGE_BACKUP_FILENAME);
+    } else if (memcmp(key, "VER", 3) == 0) {
+        snprintf(filename, size, "%s", CONFIG_STORAGE_FIRMWARE_VERSION);
+    } else {
+        // Generic filename (use the key as the name)
+        snprintf(filename, size, "/%.4s", key);
+    }
+}
+
 uint8_t RP2040EEPROMStorage::listFiles(char fileNames[][32], uint8_t maxFiles) {
     if (!m_initialized || !fileNames || maxFiles == 0) {
         return 0;
@@ -402,28 +416,8 @@ uint8_t RP2040EEPROMStorage::listFiles(char fileNames[][32], uint8_t maxFiles) {
     // Iterate through file table and build list of actual filenames
     for (uint8_t i = 0; i < MAX_FILES && count < maxFiles; i++) {
         if (m_fileTable[i].name[0] != 0 && m_fileTable[i].name[0] != 0xFF) {
-            // Convert the 3-character key back to filename
-            if (memcmp(m_fileTable[i].name, "CFG", 3) == 0) {
-                strncpy(fileNames[count], CONFIG_STORAGE_FILENAME, 31);
-                fileNames[count][31] = '\0';
-                count++;
-            } else if (memcmp(m_fileTable[i].name, "BAK", 3) == 0) {
-                strncpy(fileNames[count], CONFIG_STORAGE_BACKUP_FILENAME, 31);
-                fileNames[count][31] = '\0';
-                count++;
-            } else if (memcmp(m_fileTable[i].name, "VER", 3) == 0) {
-                strncpy(fileNames[count], CONFIG_STORAGE_FIRMWARE_VERSION, 31);
-                fileNames[count][31] = '\0';
-                count++;
-            } else {
-                // Generic filename (use the key as the name)
-                snprintf(fileNames[count], 32, "/%c%c%c%c",
-                         m_fileTable[i].name[0],
-                         m_fileTable[i].name[1],
-                         m_fileTable[i].name[2],
-                         m_fileTable[i].name[3]);
-                count++;
-            }
+            keyToFilename(m_fileTable[i].name, fileNames[count], 32);
+            count++;
         }
     }
     
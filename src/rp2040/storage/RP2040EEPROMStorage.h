@@ -37,6 +37,10 @@ public:
     // Debug method to dump file table
     void debugDumpFileTable();
     
+    // Convert long filenames to 4-char keys and back (shared with RP2040FlashLogStorage)
+    static void filenameToKey(const char* filename, char* key);
+    static void keyToFilename(const char* key, char* filename, size_t size);
+    
 private:
     // EEPROM Memory Layout
     static constexpr uint16_t EEPROM_SIZE = 4096;  // 4KB EEPROM
@@ -80,7 +84,4 @@ private:
     FileEntry m_fileTable[MAX_FILES];
     uint8_t m_fileCount;
     bool m_tableLoaded;
-    
-    // Convert long filenames to 4-char keys
-    void filenameToKey(const char* filename, char* key);
 };
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "RP2040FlashLogStorage.h"
+#include "RP2040EEPROMStorage.h"
+#include "../../config/core/ConfigMode.h"
+#include <string.h>
+#include <Arduino.h>
+#include <hardware/flash.h>
+#include <hardware/regs/addressmap.h>
+
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    #include <EEPROM.h>
+#endif
+
+// Filesystem area from the arduino-pico linker script
+extern uint8_t _FS_start;
+extern uint8_t _FS_end;
+
+static const char kConfigKey[4] = {'C', 'F', 'G', 0};
+
+bool RP2040FlashMedium::begin(uint32_t size) {
+    const uintptr_t start = (uintptr_t)&_FS_start;
+    const uintptr_t end = (uintptr_t)&_FS_end;
+    if (end < start || end - start < size || (start - XIP_BASE) % FLASH_LOG_SECTOR) {
+        return false;
+    }
+    m_base = &_FS_start;
+    m_flashOffset = (uint32_t)(start - XIP_BASE);
+    m_size = size;
+    return true;
+}
+
+// Flash is not readable while it is erased or programmed: core1 runs from flash, so it is parked
+// for the operation, the same way EEPROM.commit() does it
+bool RP2040FlashMedium::erase(uint32_t offset) {
+    if (!m_base || offset % FLASH_LOG_SECTOR || offset + FLASH_LOG_SECTOR > m_size) {
+        return false;
+    }
+    noInterrupts();
+    rp2040.idleOtherCore();
+    flash_range_erase(m_flashOffset + offset, FLASH_LOG_SECTOR);
+    rp2040.resumeOtherCore();
+    interrupts();
+    return true;
+}
+
+bool RP2040FlashMedium::program(uint32_t offset, uint32_t pages, FlashLogFill fill, const void* ctx) {
+    if (!m_base || offset % FLASH_LOG_PAGE || offset + pages * FLASH_LOG_PAGE > m_size) {
+        return false;
+    }
+    // Pages are staged in RAM one at a time; XIP is back on between pages, so the source may be
+    // mapped flash (a record being relocated)
+    uint8_t page[FLASH_LOG_PAGE];
+    noInterrupts();
+    rp2040.idleOtherCore();
+    for (uint32_t p = 0; p < pages; p++) {
+        fill(ctx, p, page);
+        flash_range_program(m_flashOffset + offset + p * FLASH_LOG_PAGE, page, FLASH_LOG_PAGE);
+    }
+    rp2040.resumeOtherCore();
+    interrupts();
+    return true;
+}
+
+RP2040FlashLogStorage::RP2040FlashLogStorage()
+    : StorageInterface(), m_log(m_medium, CONFIG_STORAGE_LOG_SECTORS) {
+}
+
+RP2040FlashLogStorage::~RP2040FlashLogStorage() {
+}
+
+StorageResult RP2040FlashLogStorage::initialize() {
+    if (m_initialized) {
+        return StorageResult::SUCCESS;
+    }
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    if (!m_medium.begin((uint32_t)CONFIG_STORAGE_LOG_SECTORS * FLASH_LOG_SECTOR)) {
+        return StorageResult::ERROR_INSUFFICIENT_SPACE;
+    }
+    if (!m_log.mount()) {
+        // Not a log yet (first boot with this backend): start from an empty ring
+        if (!m_log.format()) {
+            return StorageResult::ERROR_WRITE_FAILED;
+        }
+    }
+    m_initialized = true;
+
+    char key[1][4];
+    if (m_log.keys(key, 1) == 0) {
+        importEEPROM();
+    }
+    return StorageResult::SUCCESS;
+#else
+    return StorageResult::ERROR_NOT_INITIALIZED;
+#endif
+}
+
+void RP2040FlashLogStorage::importEEPROM() {
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    RP2040EEPROMStorage legacy;
+    if (legacy.initialize() != StorageResult::SUCCESS) {
+        return;
+    }
+    // The backup holds the config before the last save, so it goes in first as the older version
+    static const char* const kFiles[][2] = {
+        {CONFIG_STORAGE_BACKUP_FILENAME, CONFIG_STORAGE_FILENAME},
+        {CONFIG_STORAGE_FILENAME, CONFIG_STORAGE_FILENAME},
+        {CONFIG_STORAGE_FIRMWARE_VERSION, CONFIG_STORAGE_FIRMWARE_VERSION},
+    };
+    uint8_t buffer[2048];
+    for (const auto& f : kFiles) {
+        size_t bytesRead = 0;
+        if (legacy.read(f[0], buffer, sizeof(buffer), &bytesRead) == StorageResult::SUCCESS && bytesRead > 0) {
+            write(f[1], buffer, bytesRead);
+        }
+    }
+    EEPROM.end(); // free the 4 KB RAM copy
+#endif
+}
+
+bool RP2040FlashLogStorage::isBackupFile(const char* filename) {
+    return strcmp(filename, CONFIG_STORAGE_BACKUP_FILENAME) == 0;
+}
+
+const uint8_t* RP2040FlashLogStorage::findFile(const char* filename, uint16_t* size) const {
+    if (isBackupFile(filename)) {
+        return m_log.find(kConfigKey, 1, size);
+    }
+    char key[4];
+    RP2040EEPROMStorage::filenameToKey(filename, key);
+    return m_log.find(key, 0, size);
+}
+
+const uint8_t* RP2040FlashLogStorage::mapFile(const char* filename, size_t* size) const {
+    if (!m_initialized || !filename) {
+        return nullptr;
+    }
+    uint16_t fileSize = 0;
+    const uint8_t* data = findFile(filename, &fileSize);
+    if (data && size) {
+        *size = fileSize;
+    }
+    return data;
+}
+
+StorageResult RP2040FlashLogStorage::read(const char* filename, uint8_t* buffer, size_t bufferSize, size_t* bytesRead) {
+    if (!m_initialized) {
+        return StorageResult::ERROR_NOT_INITIALIZED;
+    }
+    if (!filename || !buffer || bufferSize == 0) {
+        return StorageResult::ERROR_INVALID_PARAMETER;
+    }
+
+    uint16_t size = 0;
+    const uint8_t* data = findFile(filename, &size);
+    if (!data) {
+        return StorageResult::ERROR_FILE_NOT_FOUND;
+    }
+    size_t readSize = (bufferSize < size) ? bufferSize : size;
+    memcpy(buffer, data, readSize);
+    if (bytesRead) {
+        *bytesRead = readSize;
+    }
+    return StorageResult::SUCCESS;
+}
+
+StorageResult RP2040FlashLogStorage::write(const char* filename, const uint8_t* data, size_t dataSize) {
+    StorageResult result;
+    while (!writeStep(filename, data, dataSize, &result)) {
+    }
+    return result;
+}
+
+bool RP2040FlashLogStorage::writeStep(const char* filename, const uint8_t* data, size_t dataSize, StorageResult* result) {
+    if (!m_initialized) {
+        *result = StorageResult::ERROR_NOT_INITIALIZED;
+        return true;
+    }
+    if (!filename || !data || dataSize == 0 || isBackupFile(filename)) {
+        *result = StorageResult::ERROR_INVALID_PARAMETER;
+        return true;
+    }
+    if (dataSize > FLASH_LOG_MAX_PAYLOAD) {
+        *result = StorageResult::ERROR_INSUFFICIENT_SPACE;
+        return true;
+    }
+
+    char key[4];
+    RP2040EEPROMStorage::filenameToKey(filename, key);
+
+    // Saving unchanged content costs no flash operation (and keeps the backup)
+    uint16_t size = 0;
+    const uint8_t* current = m_log.find(key, 0, &size);
+    if (current && size == dataSize && memcmp(current, data, dataSize) == 0) {
+        *result = StorageResult::SUCCESS;
+        return true;
+    }
+
+    switch (m_log.appendStep(key, data, (uint16_t)dataSize)) {
+        case FlashLogProgress::BUSY:
+            return false;
+        case FlashLogProgress::DONE:
+            *result = StorageResult::SUCCESS;
+            return true;
+        default:
+            *result = StorageResult::ERROR_WRITE_FAILED;
+            return true;
+    }
+}
+
+bool RP2040FlashLogStorage::exists(const char* filename) {
+    if (!m_initialized || !filename) {
+        return false;
+    }
+    return findFile(filename, nullptr) != nullptr;
+}
+
+StorageResult RP2040FlashLogStorage::remove(const char* filename) {
+    if (!m_initialized) {
+        return StorageResult::ERROR_NOT_INITIALIZED;
+    }
+    if (!filename || isBackupFile(filename)) {
+        return StorageResult::ERROR_INVALID_PARAMETER;
+    }
+    if (!exists(filename)) {
+        return StorageResult::ERROR_FILE_NOT_FOUND;
+    }
+
+    char key[4];
+    RP2040EEPROMStorage::filenameToKey(filename, key);
+    return m_log.remove(key) ? StorageResult::SUCCESS : StorageResult::ERROR_WRITE_FAILED;
+}
+
+size_t RP2040FlashLogStorage::getAvailableSpace() const {
+    if (!m_initialized) {
+        return 0;
+    }
+    size_t used = getUsedSpace();
+    return (m_log.capacity() > used) ? (m_log.capacity() - used) : 0;
+}
+
+size_t RP2040FlashLogStorage::getUsedSpace() const {
+    if (!m_initialized) {
+        return 0;
+    }
+    return m_log.liveBytes();
+}
+
+StorageResult RP2040FlashLogStorage::format() {
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    if (!m_medium.isReady()) {
+        return StorageResult::ERROR_NOT_INITIALIZED;
+    }
+    // Clear the EEPROM files too, or the empty log would import them again at the next boot
+    RP2040EEPROMStorage legacy;
+    if (legacy.initialize() == StorageResult::SUCCESS) {
+        legacy.format();
+        EEPROM.end();
+    }
+    return m_log.format() ? StorageResult::SUCCESS : StorageResult::ERROR_WRITE_FAILED;
+#else
+    return StorageResult::ERROR_NOT_INITIALIZED;
+#endif
+}
+
+StorageResult RP2040FlashLogStorage::maintenance() {
+    // Sectors are collected on demand when a write needs room; records are CRC-checked on mount
+    return m_initialized ? StorageResult::SUCCESS : StorageResult::ERROR_NOT_INITIALIZED;
+}
+
+uint8_t RP2040FlashLogStorage::listFiles(char fileNames[][32], uint8_t maxFiles) {
+    if (!m_initialized || !fileNames || maxFiles == 0) {
+        return 0;
+    }
+
+    char keys[FLASH_LOG_MAX_KEYS][4];
+    uint8_t keyCount = m_log.keys(keys, FLASH_LOG_MAX_KEYS);
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < keyCount && count < maxFiles; i++) {
+        RP2040EEPROMStorage::keyToFilename(keys[i], fileNames[count++], 32);
+    }
+    if (count < maxFiles && exists(CONFIG_STORAGE_BACKUP_FILENAME)) {
+        strncpy(fileNames[count], CONFIG_STORAGE_BACKUP_FILENAME, 31);
+        fileNames[count][31] = '\0';
+        count++;
+    }
+    return count;
+}
+
+void RP2040FlashLogStorage::debugDumpFileTable() {
+#if CONFIG_FEATURE_STORAGE_ENABLED
+    Serial.println("\n=== CONFIG LOG DEBUG DUMP ===");
+    Serial.print("Initialized: ");
+    Serial.println(m_initialized ? "YES" : "NO");
+    Serial.print("Sectors: ");
+    Serial.print(m_log.sectors());
+    Serial.print(", head: ");
+    Serial.print(m_log.headSector());
+    Serial.print(" (");
+    Serial.print(m_log.headUsed());
+    Serial.print(" bytes used), erased: ");
+    Serial.println(m_log.erasedSectors());
+
+    char fileNames[FLASH_LOG_MAX_KEYS + 1][32];
+    uint8_t fileCount = listFiles(fileNames, FLASH_LOG_MAX_KEYS + 1);
+    Serial.println("\nFiles:");
+    for (uint8_t i = 0; i < fileCount; i++) {
+        uint16_t size = 0;
+        findFile(fileNames[i], &size);
+        Serial.print("  ");
+        Serial.print(fileNames[i]);
+        Serial.print(", Size: ");
+        Serial.println(size);
+    }
+
+    const FlashLogStats& st = m_log.stats();
+    Serial.print("\nSince boot: appends ");
+    Serial.print(st.appends);
+    Serial.print(", relocated ");
+    Serial.print(st.relocated);
+    Serial.print(", erases ");
+    Serial.print(st.erases);
+    Serial.print(", programs ");
+    Serial.print(st.programs);
+    Serial.print(" (");
+    Serial.print(st.pages);
+    Serial.println(" pages)");
+
+    Serial.print("Total used space: ");
+    Serial.print(getUsedSpace());
+    Serial.print(" / ");
+    Serial.print(m_log.capacity());
+    Serial.println(" bytes");
+    Serial.println("=== END CONFIG LOG DEBUG ===\n");
+#endif
+}
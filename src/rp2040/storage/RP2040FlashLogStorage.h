@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../../StorageInterface.h"
+#include "FlashLog.h"
+#include <stdint.h>
+
+// FlashLog region in RP2040 flash: the first sectors of the filesystem area
+// (board_build.filesystem_size), which LittleFS does not use in this firmware
+class RP2040FlashMedium : public FlashLogMedium {
+public:
+    // Locates the region; false if the filesystem area is smaller than size
+    bool begin(uint32_t size);
+    bool isReady() const { return m_base != nullptr; }
+
+    const uint8_t* map(uint32_t offset) const override { return m_base + offset; }
+    bool erase(uint32_t offset) override;
+    bool program(uint32_t offset, uint32_t pages, FlashLogFill fill, const void* ctx) override;
+
+private:
+    const uint8_t* m_base = nullptr;  // XIP address of the region
+    uint32_t m_flashOffset = 0;       // offset of the region from the start of flash
+    uint32_t m_size = 0;
+};
+
+// RP2040 configuration storage as a log of records in flash (FlashLog.h)
+// A save programs one record; sector erases rotate through CONFIG_STORAGE_LOG_SECTORS sectors.
+// The log keeps the previous config version, which reads as CONFIG_STORAGE_BACKUP_FILENAME.
+// Files stored by RP2040EEPROMStorage are imported while the log is empty; format() clears both.
+class RP2040FlashLogStorage : public StorageInterface {
+public:
+    RP2040FlashLogStorage();
+    virtual ~RP2040FlashLogStorage();
+
+    // StorageInterface implementation
+    StorageResult initialize() override;
+    bool isInitialized() const override { return m_initialized; }
+
+    StorageResult read(const char* filename, uint8_t* buffer, size_t bufferSize, size_t* bytesRead = nullptr) override;
+    // Writing the backup file is rejected: it is the previous version of the config file
+    StorageResult write(const char* filename, const uint8_t* data, size_t dataSize) override;
+    // write() split into single flash operations (FlashLog::appendStep), for use between scans.
+    // Call with the same arguments, data kept valid, until it returns true; *result is then set.
+    // data must not point into the log (mapFile): a step may move or erase what it points to.
+    bool writeStep(const char* filename, const uint8_t* data, size_t dataSize, StorageResult* result);
+
+    // Contents of a file read in place from mapped flash (no copy); nullptr if not found.
+    // Valid until the next write, remove or format, which may relocate or erase the record.
+    const uint8_t* mapFile(const char* filename, size_t* size) const;
+
+    bool exists(const char* filename) override;
+    StorageResult remove(const char* filename) override;
+
+    size_t getAvailableSpace() const override;
+    size_t getUsedSpace() const override;
+
+    StorageResult format() override;
+    StorageResult maintenance() override;
+
+    // List files in storage
+    uint8_t listFiles(char fileNames[][32], uint8_t maxFiles) override;
+
+    // Debug method to dump the log state (name kept from RP2040EEPROMStorage)
+    void debugDumpFileTable();
+
+    const FlashLogStats& getLogStats() const { return m_log.stats(); }
+
+private:
+    RP2040FlashMedium m_medium;
+    FlashLog m_log;
+
+    // Payload of a file in mapped flash; the backup file is the previous config version
+    const uint8_t* findFile(const char* filename, uint16_t* size) const;
+    static bool isBackupFile(const char* filename);
+
+    // One-time carry-over of the files stored by the EEPROM backend
+    void importEEPROM();
+};
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "LoopProfiler.h"
+#include <Arduino.h>
+#include <hardware/structs/systick.h>
+#include <hardware/clocks.h>
+#include <hardware/timer.h>
+
+static PerfStageStats s_stats[PERF_STAGE_COUNT];
+static uint32_t s_cyclesPerUs = 125;
+static uint32_t s_resetTimeUs = 0;
+
+static const char* const kStageNames[PERF_STAGE_COUNT] = {
+    "SHIFT_REG", "BUTTONS", "MATRIX", "ENCODERS", "AXES", "HANDOFF", "SCAN", "HID_SEND", "SERIAL", "RAW_MONITOR", "STORAGE", "LOOP"
+};
+
+// SysTick wraps after 2^24 cycles; beyond this many microseconds fall back to the microsecond timer
+static constexpr uint32_t SYSTICK_SAFE_US = 100000;
+
+namespace LoopProfiler {
+
+void beginCore() {
+    // Free-running 24-bit down-counter clocked from clk_sys, no interrupt
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = (1u << 2) | (1u << 0); // CLKSOURCE = processor clock, ENABLE
+}
+
+void begin() {
+    beginCore();
+    s_cyclesPerUs = clock_get_hz(clk_sys) / 1000000;
+    if (s_cyclesPerUs == 0) s_cyclesPerUs = 1;
+    reset();
+}
+
+PerfMark mark() {
+    PerfMark m;
+    m.tick = systick_hw->cvr;
+    m.us = time_us_32();
+    return m;
+}
+
+void record(PerfStage stage, const PerfMark& start) {
+    uint32_t tick = systick_hw->cvr;
+    uint32_t us = time_us_32() - start.us;
+    uint32_t cycles = (us < SYSTICK_SAFE_US) ? ((start.tick - tick) & 0x00FFFFFF) : us * s_cyclesPerUs;
+    s_stats[stage].add(cycles);
+}
+
+void reset() {
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) s_stats[i] = PerfStageStats();
+    s_resetTimeUs = time_us_32();
+}
+
+const PerfStageStats& stats(PerfStage stage) { return s_stats[stage]; }
+
+const char* stageName(PerfStage stage) {
+    return (stage < PERF_STAGE_COUNT) ? kStageNames[stage] : "UNKNOWN";
+}
+
+uint32_t cyclesPerMicrosecond() { return s_cyclesPerUs; }
+
+void printStats() {
+    // All durations in CPU cycles; divide by cpu_mhz for microseconds
+    uint32_t elapsedUs = time_us_32() - s_resetTimeUs;
+    const PerfStageStats& loop = s_stats[PERF_LOOP];
+    uint32_t loopHz = elapsedUs ? (uint32_t)((uint64_t)loop.count * 1000000ULL / elapsedUs) : 0;
+    Serial.print("PERF_STATS:cpu_mhz="); Serial.print(s_cyclesPerUs);
+    Serial.print(",window_ms="); Serial.print(elapsedUs / 1000);
+    Serial.print(",loop_hz="); Serial.println(loopHz);
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        const PerfStageStats& st = s_stats[i];
+        Serial.print("PERF:"); Serial.print(kStageNames[i]);
+        Serial.print(":n="); Serial.print(st.count);
+        Serial.print(",min="); Serial.print(st.count ? st.min : 0);
+        Serial.print(",avg="); Serial.print(st.average());
+        Serial.print(",max="); Serial.print(st.max);
+        Serial.print(",p50="); Serial.print(st.percentile(500));
+        Serial.print(",p99="); Serial.print(st.percentile(990));
+        Serial.print(",p999="); Serial.println(st.percentile(999));
+    }
+    Serial.println("PERF_STATS:END");
+}
+
+} // namespace LoopProfiler
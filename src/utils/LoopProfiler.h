@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include "../config/core/ConfigMode.h"
+
+// Per-stage loop profiler
+// Times each stage of the main loop in CPU cycles (SysTick, 24-bit down-counter at clk_sys) and keeps
+// min/avg/max plus a quarter-octave log histogram from which p50/p99/p99.9 are estimated.
+// Recording a sample costs two timer reads, a count-leading-zeros and a few adds.
+// Each stage is recorded only by the core that runs it (scan stages on core1, the rest on core0);
+// PERF_STATS / PERF_RESET from core0 may overlap one core1 sample, which only blurs that sample.
+
+enum PerfStage : uint8_t {
+    PERF_SHIFT_REG = 0,   // g_shiftRegisterManager.update
+    PERF_BUTTONS,         // updateButtons
+    PERF_MATRIX,          // updateMatrix
+    PERF_ENCODERS,        // updateEncoders
+    PERF_AXES,            // readUserAxes
+    PERF_HANDOFF,         // publish report + raw snapshot to core0 (core1)
+    PERF_SCAN,            // whole loop1() iteration (core1)
+    PERF_HID_SEND,        // report commit / send (core0)
+    PERF_SERIAL,          // serial command handling
+    PERF_RAW_MONITOR,     // RawStateReader::updateRawMonitoring
+    PERF_STORAGE,         // one step of a background storage job (core0)
+    PERF_LOOP,            // whole loop() iteration (core0)
+    PERF_STAGE_COUNT
+};
+
+// Start-of-stage timestamp: cycle counter plus microseconds to disambiguate SysTick wrap (~126 ms at 133 MHz)
+struct PerfMark {
+    uint32_t tick;
+    uint32_t us;
+};
+
+// Accumulated statistics for one stage (hardware independent)
+struct PerfStageStats {
+    // Log histogram with quarter-octave resolution (worst-case bucket width 25% of its value).
+    // Values 0-3 get their own bucket; above that, bucket = ((msb - 1) << 2) | (two bits below the msb).
+    static constexpr uint8_t BUCKETS = 124;
+
+    uint32_t count = 0;
+    uint32_t min = 0xFFFFFFFF;
+    uint32_t max = 0;
+    uint64_t sum = 0;
+    uint32_t hist[BUCKETS] = {0};
+
+    static inline uint8_t bucketFor(uint32_t cycles) {
+        if (cycles < 4) return (uint8_t)cycles;
+        uint8_t shift = (uint8_t)(29 - __builtin_clz(cycles)); // msb - 2
+        return (uint8_t)(((shift + 1) << 2) | ((cycles >> shift) & 3));
+    }
+
+    // Exclusive upper bound of bucket b (saturates at UINT32_MAX)
+    static inline uint32_t bucketUpperBound(uint8_t b) {
+        if (b < 4) return b + 1;
+        uint8_t shift = (uint8_t)((b >> 2) - 1);
+        uint64_t upper = ((uint64_t)(4 | (b & 3)) << shift) + (1ULL << shift);
+        return upper > 0xFFFFFFFFULL ? 0xFFFFFFFF : (uint32_t)upper;
+    }
+
+    inline void add(uint32_t cycles) {
+        count++;
+        sum += cycles;
+        if (cycles < min) min = cycles;
+        if (cycles > max) max = cycles;
+        hist[bucketFor(cycles)]++;
+    }
+
+    // Percentile estimate in cycles; permille = 500 for p50, 990 for p99, 999 for p99.9.
+    // Returns the upper bound of the bucket holding the requested rank, clamped to the observed max.
+    uint32_t percentile(uint16_t permille) const {
+        if (count == 0) return 0;
+        uint64_t rank = ((uint64_t)count * permille + 999) / 1000;
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (uint8_t b = 0; b < BUCKETS; b++) {
+            seen += hist[b];
+            if (seen >= rank) {
+                uint32_t upper = bucketUpperBound(b);
+                return upper > max ? max : upper;
+            }
+        }
+        return max;
+    }
+
+    uint32_t average() const { return count ? (uint32_t)(sum / count) : 0; }
+};
+
+namespace LoopProfiler {
+    // Configure the cycle counter (call once from setup; SysTick is per core, so the scan
+    // core calls beginCore() from setup1 as well)
+    void begin();
+    void beginCore();
+
+    PerfMark mark();
+    void record(PerfStage stage, const PerfMark& start);
+
+    void reset();
+    const PerfStageStats& stats(PerfStage stage);
+    const char* stageName(PerfStage stage);
+    uint32_t cyclesPerMicrosecond();
+
+    // Print all stage statistics over Serial (PERF_STATS command)
+    void printStats();
+}
+
+#if CONFIG_FEATURE_PERF_STATS_ENABLED
+  #define PERF_BEGIN(var)        const PerfMark var = LoopProfiler::mark()
+  #define PERF_END(stage, var)   LoopProfiler::record(stage, var)
+#else
+  #define PERF_BEGIN(var)        do{}while(0)
+  #define PERF_END(stage, var)   do{}while(0)
+#endif
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Lock-free single-writer / single-reader hand-off of the latest value (core1 -> core0).
+//
+// Two slots, each guarded by its own sequence counter (odd while the writer is inside it).
+// publish() alternates slots, so the slot a reader is copying is only touched again after the
+// writer has finished the other one; a reader that still loses the race sees the counter move
+// and retries, so it never returns a torn value. Neither side ever waits for the other.
+//
+// The payload is stored as relaxed 32-bit atomics: on Cortex-M0+ these compile to plain
+// ldr/str (no read-modify-write is used anywhere), and on the host the protocol is free of
+// data races by the C++ memory model, so it can be checked under ThreadSanitizer.
+// ThreadSanitizer does not model standalone fences, so under it each payload word carries the
+// release/acquire ordering itself (equivalent guarantees, one barrier per word).
+#if defined(__SANITIZE_THREAD__)
+  #define SEQLOCK_WORD_ORDERING 1
+#elif defined(__has_feature)
+  #if __has_feature(thread_sanitizer)
+    #define SEQLOCK_WORD_ORDERING 1
+  #endif
+#endif
+#ifndef SEQLOCK_WORD_ORDERING
+  #define SEQLOCK_WORD_ORDERING 0
+#endif
+
+template <typename T>
+class SeqlockDoubleBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot type must be trivially copyable");
+
+public:
+    static constexpr uint32_t WORDS = (uint32_t)((sizeof(T) + 3) / 4);
+    static constexpr uint8_t READ_ATTEMPTS = 4;
+
+    SeqlockDoubleBuffer() {
+        for (Slot& s : _slots) {
+            s.version.store(0, std::memory_order_relaxed);
+            s.number.store(0, std::memory_order_relaxed);
+            for (uint32_t w = 0; w < WORDS; w++) s.words[w].store(0, std::memory_order_relaxed);
+        }
+        _published.store(0, std::memory_order_relaxed);
+    }
+
+    SeqlockDoubleBuffer(const SeqlockDoubleBuffer&) = delete;
+    SeqlockDoubleBuffer& operator=(const SeqlockDoubleBuffer&) = delete;
+
+    // Writer side: stores value as snapshot number published() + 1
+    void publish(const T& value) {
+        uint32_t tmp[WORDS] = {};
+        memcpy(tmp, &value, sizeof(T));
+
+        const uint32_t number = _published.load(std::memory_order_relaxed) + 1;
+        Slot& s = _slots[number & 1];
+        const uint32_t v = s.version.load(std::memory_order_relaxed);
+        s.version.store(v + 1, std::memory_order_relaxed);
+        if (!SEQLOCK_WORD_ORDERING) std::atomic_thread_fence(std::memory_order_release);
+        s.number.store(number, WORD_STORE);
+        for (uint32_t w = 0; w < WORDS; w++) s.words[w].store(tmp[w], WORD_STORE);
+        s.version.store(v + 2, std::memory_order_release);
+        _published.store(number, std::memory_order_release);
+    }
+
+    // Number of the latest snapshot (0 = none yet)
+    uint32_t published() const { return _published.load(std::memory_order_acquire); }
+
+    // Reader side: copies a snapshot newer than *seq into out and updates *seq.
+    // Returns false when nothing newer is available, or (rarely) when the writer lapped
+    // every attempt; the caller keeps its previous copy and tries again next loop.
+    bool readNewer(T& out, uint32_t& seq) const {
+        for (uint8_t attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+            const uint32_t latest = _published.load(std::memory_order_acquire);
+            if ((int32_t)(latest - seq) <= 0) return false;
+            const Slot& s = _slots[latest & 1];
+            const uint32_t v1 = s.version.load(std::memory_order_acquire);
+            if (v1 & 1) continue;
+            const uint32_t number = s.number.load(WORD_LOAD);
+            uint32_t tmp[WORDS];
+            for (uint32_t w = 0; w < WORDS; w++) tmp[w] = s.words[w].load(WORD_LOAD);
+            if (!SEQLOCK_WORD_ORDERING) std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.version.load(std::memory_order_relaxed) != v1) continue;
+            // The slot may already hold a later snapshot than `latest`; never step backwards
+            if ((int32_t)(number - seq) <= 0) return false;
+            memcpy(&out, tmp, sizeof(T));
+            seq = number;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static constexpr std::memory_order WORD_STORE =
+        SEQLOCK_WORD_ORDERING ? std::memory_order_release : std::memory_order_relaxed;
+    static constexpr std::memory_order WORD_LOAD =
+        SEQLOCK_WORD_ORDERING ? std::memory_order_acquire : std::memory_order_relaxed;
+
+    struct Slot {
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> number;
+        std::atomic<uint32_t> words[WORDS];
+    };
+    Slot _slots[2];
+    std::atomic<uint32_t> _published;
+};
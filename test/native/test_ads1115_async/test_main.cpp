@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the non-blocking ADS1115 sequencer (Ads1115Async.h).
+//
+// A register-level ADS1115 model runs single-shot conversions with the datasheet timing
+// (1 / data rate, scaled by the +/-10% internal oscillator), drives ALERT/RDY in
+// conversion-ready mode and records any read of the conversion register that returns a
+// stale or in-progress result. The bus model completes transactions after their 400 kHz
+// wire time (9 clocks per byte incl. ACK), so the sequencer sees realistic latencies.
+// Run with: pio test -e native -f native/test_ads1115_async -v
+#include <unity.h>
+#include <stdio.h>
+#include "inputs/analog/Ads1115Async.h"
+#include "inputs/analog/Ads1115Async.cpp" // src/ is not built for the native env
+
+struct Ads1115Model {
+    double oscScale = 1.0;          // >1: slower internal oscillator
+    bool rdyWired = true;
+    int16_t input[4] = {1111, 2222, 3333, 4444};
+
+    uint16_t config = 0x8583;       // power-on default
+    uint16_t loThresh = 0x8000, hiThresh = 0x7FFF;
+    uint16_t conversion = 0;
+    bool converting = false;
+    uint8_t convChannel = 0;
+    double convEndUs = 0;
+    bool rdyEdge = false;
+    bool fresh = false;             // a result completed since the last read
+    uint32_t staleReads = 0;
+    uint32_t conversions = 0;
+
+    void advance(double nowUs) {
+        if (converting && nowUs >= convEndUs) {
+            converting = false;
+            conversion = (uint16_t)input[convChannel];
+            conversions++;
+            fresh = true;
+            bool readyMode = (hiThresh & 0x8000) && !(loThresh & 0x8000) && (config & 3) != 3;
+            if (readyMode && rdyWired) rdyEdge = true;
+        }
+    }
+    void write(uint8_t reg, uint16_t v, double nowUs) {
+        advance(nowUs);
+        if (reg == ADS1115_REG_CONFIG) {
+            config = v & 0x7FFF;
+            if (v & ADS1115_CFG_OS_START) {
+                static const uint16_t rates[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+                converting = true;
+                convChannel = (uint8_t)(((v >> 12) & 7) - 4);
+                convEndUs = nowUs + oscScale * 1e6 / rates[(v >> 5) & 7];
+            }
+        } else if (reg == ADS1115_REG_LO_THRESH) {
+            loThresh = v;
+        } else if (reg == ADS1115_REG_HI_THRESH) {
+            hiThresh = v;
+        }
+    }
+    uint16_t read(uint8_t reg, double nowUs) {
+        advance(nowUs);
+        if (reg != ADS1115_REG_CONVERSION) return 0;
+        if (converting || !fresh) staleReads++; // in progress, or the previous result again
+        fresh = false;
+        return conversion;
+    }
+};
+
+struct ModelBus : Ads1115Bus {
+    static constexpr double BYTE_US = 9.0 / 0.4; // 9 clocks at 400 kHz
+
+    Ads1115Model* ads;
+    double now = 0;
+    double doneAt = 0;
+    bool pending = false, isRead = false;
+    uint8_t reg = 0;
+    uint16_t value = 0;
+    uint8_t nackNext = 0;
+    uint32_t polls = 0;
+
+    bool startWrite(uint8_t r, uint16_t v) override {
+        if (pending) return false;
+        pending = true; isRead = false; reg = r; value = v;
+        doneAt = now + 4 * BYTE_US;            // address, pointer, MSB, LSB
+        return true;
+    }
+    bool startRead(uint8_t r) override {
+        if (pending) return false;
+        pending = true; isRead = true; reg = r;
+        doneAt = now + 5 * BYTE_US;            // address, pointer, address, MSB, LSB
+        return true;
+    }
+    Status poll(uint16_t& out) override {
+        polls++;
+        if (!pending) return BUS_ERROR;
+        if (now < doneAt) return BUS_BUSY;
+        pending = false;
+        if (nackNext) { nackNext--; return BUS_ERROR; }
+        if (isRead) out = ads->read(reg, doneAt);
+        else ads->write(reg, value, doneAt);
+        return BUS_DONE;
+    }
+    bool takeReady() override {
+        ads->advance(now);
+        bool r = ads->rdyEdge;
+        ads->rdyEdge = false;
+        return r;
+    }
+};
+
+struct Rig {
+    Ads1115Model ads;
+    ModelBus bus;
+    Ads1115Sequencer seq;
+    uint32_t maxPollsPerUpdate = 0;
+
+    Rig(bool useRdy, double oscScale, uint8_t channelMask) {
+        ads.oscScale = oscScale;
+        bus.ads = &ads;
+        seq.begin(&bus, 860, useRdy);
+        for (uint8_t ch = 0; ch < 4; ch++) if (channelMask & (1u << ch)) seq.enableChannel(ch);
+    }
+};
+
+// Calls update() every loopUs for durationUs of simulated time
+static void runTracked(Rig& r, double durationUs, double loopUs = 25.0) {
+    const double end = r.bus.now + durationUs;
+    for (; r.bus.now < end; r.bus.now += loopUs) {
+        r.bus.polls = 0;
+        r.seq.update((uint32_t)r.bus.now);
+        if (r.bus.polls > r.maxPollsPerUpdate) r.maxPollsPerUpdate = r.bus.polls;
+    }
+}
+
+static void assertValues(Rig& r, uint8_t mask) {
+    for (uint8_t ch = 0; ch < 4; ch++) {
+        if (mask & (1u << ch)) {
+            TEST_ASSERT_EQUAL_INT16(r.ads.input[ch], r.seq.getValue(ch));
+        } else {
+            TEST_ASSERT_EQUAL_UINT32(0, r.seq.getSampleCount(ch));
+        }
+    }
+}
+
+static double ratePerChannelHz(Rig& r, uint8_t ch, double durationUs) {
+    return r.seq.getSampleCount(ch) * 1e6 / durationUs;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_data_rate_codes() {
+    TEST_ASSERT_EQUAL_UINT8(7, Ads1115Sequencer::dataRateCode(860));
+    TEST_ASSERT_EQUAL_UINT8(7, Ads1115Sequencer::dataRateCode(1000));
+    TEST_ASSERT_EQUAL_UINT8(5, Ads1115Sequencer::dataRateCode(300));   // rounds down to 250
+    TEST_ASSERT_EQUAL_UINT8(0, Ads1115Sequencer::dataRateCode(1));
+    TEST_ASSERT_EQUAL_UINT32(1163, Ads1115Sequencer::conversionTimeUs(7));
+    TEST_ASSERT_EQUAL_UINT32(125000, Ads1115Sequencer::conversionTimeUs(0));
+}
+
+void test_ready_pin_sequences_all_channels() {
+    Rig r(true, 1.0, 0x0F);
+    const double duration = 1e6;
+    runTracked(r, duration);
+
+    assertValues(r, 0x0F);
+    TEST_ASSERT_EQUAL_UINT32(0, r.ads.staleReads);
+    TEST_ASSERT_EQUAL_UINT32(0, r.seq.getTimeouts());
+    TEST_ASSERT_EQUAL_UINT32(0, r.seq.getBusErrors());
+    // Conversions are only polled, never waited for
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(2, r.maxPollsPerUpdate);
+
+    printf("  RDY, 4 channels: %.0f / %.0f / %.0f / %.0f Hz per channel (was 12.5 Hz)\n",
+           ratePerChannelHz(r, 0, duration), ratePerChannelHz(r, 1, duration),
+           ratePerChannelHz(r, 2, duration), ratePerChannelHz(r, 3, duration));
+    for (uint8_t ch = 0; ch < 4; ch++) TEST_ASSERT_TRUE(ratePerChannelHz(r, ch, duration) > 170.0);
+}
+
+void test_deadline_mode_never_reads_unfinished_conversions() {
+    const double scales[] = {0.9, 1.0, 1.1}; // datasheet oscillator tolerance
+    for (double scale : scales) {
+        Rig r(false, scale, 0x0F);
+        r.ads.rdyWired = false;
+        const double duration = 500e3;
+        runTracked(r, duration);
+
+        assertValues(r, 0x0F);
+        TEST_ASSERT_EQUAL_UINT32(0, r.ads.staleReads);
+        TEST_ASSERT_EQUAL_UINT32(0, r.seq.getBusErrors());
+        printf("  deadline, osc x%.1f: %.0f Hz per channel\n", scale, ratePerChannelHz(r, 0, duration));
+        TEST_ASSERT_TRUE(ratePerChannelHz(r, 0, duration) > 150.0);
+    }
+}
+
+void test_missing_ready_edge_falls_back_to_deadline() {
+    Rig r(true, 1.1, 0x0F);
+    r.ads.rdyWired = false; // configured but not connected
+    runTracked(r, 200e3);
+
+    assertValues(r, 0x0F);
+    TEST_ASSERT_EQUAL_UINT32(0, r.ads.staleReads);
+    TEST_ASSERT_TRUE(r.seq.getTimeouts() > 0);
+}
+
+void test_channel_subset_is_converted_back_to_back() {
+    Rig r(true, 1.0, 0x0A); // channels 1 and 3
+    const double duration = 1e6;
+    runTracked(r, duration);
+
+    assertValues(r, 0x0A);
+    TEST_ASSERT_EQUAL_UINT32(0, r.ads.staleReads);
+    TEST_ASSERT_TRUE(ratePerChannelHz(r, 1, duration) > 340.0);
+    TEST_ASSERT_TRUE(ratePerChannelHz(r, 3, duration) > 340.0);
+}
+
+void test_bus_errors_back_off_and_recover() {
+    Rig r(true, 1.0, 0x0F);
+    r.bus.nackNext = 3; // threshold writes fail first: must be redone before converting
+    runTracked(r, 50e3);
+    TEST_ASSERT_EQUAL_UINT32(3, r.seq.getBusErrors());
+    TEST_ASSERT_EQUAL_UINT16(0x8000, r.ads.hiThresh);
+    TEST_ASSERT_EQUAL_UINT16(0x0000, r.ads.loThresh);
+
+    r.ads.input[2] = 1234;
+    r.bus.nackNext = 1; // a failed read mid-run
+    runTracked(r, 50e3);
+    TEST_ASSERT_EQUAL_UINT32(4, r.seq.getBusErrors());
+    assertValues(r, 0x0F);
+    TEST_ASSERT_EQUAL_UINT32(0, r.ads.staleReads);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_data_rate_codes);
+    RUN_TEST(test_ready_pin_sequences_all_channels);
+    RUN_TEST(test_deadline_mode_never_reads_unfinished_conversions);
+    RUN_TEST(test_missing_ready_edge_falls_back_to_deadline);
+    RUN_TEST(test_channel_subset_is_converted_back_to_back);
+    RUN_TEST(test_bus_errors_back_off_and_recover);
+    return UNITY_END();
+}
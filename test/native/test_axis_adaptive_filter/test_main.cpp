@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests and step-response benchmark for the adaptive (1-Euro) axis filter.
+//
+// The fixed-point filter in AxisPipeline is checked against the same 1-Euro formulas in
+// double precision (4 LSB, 0.2% of the remaining distance during jumps), with irregular
+// sample intervals like ADS1115 channels produce. The benchmark feeds a noisy step and a
+// ramp at 1 kHz through OFF, EWMA and ADAPTIVE; the EWMA alpha is chosen so its jitter at
+// rest matches the adaptive filter's, and the group delay (50% step rise, ramp lag) of
+// each is printed.
+// Run with: pio test -e native -f native/test_axis_adaptive_filter -v
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "inputs/analog/AxisProcessing.h"
+#include "inputs/analog/AxisProcessing.cpp" // src/ is not built for the native env
+
+static constexpr int32_t FULL_SCALE = 32767;
+
+struct Rng {
+    uint32_t state;
+    uint32_t next() { state = state * 1664525u + 1013904223u; return state >> 8; }
+    double uniform() { return (next() + 0.5) / 16777216.0; }
+    double gauss() { return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform()); }
+};
+
+// Identity range and curve: user value v comes back as HID 2v - 32767
+static void setupIdentity(AxisPipeline& p, uint8_t axis, AxisFilterLevel level) {
+    p.setSourceMax(axis, FULL_SCALE);
+    p.setRange(axis, 0, FULL_SCALE);
+    p.setFilterLevel(axis, level);
+    p.reset(axis);
+}
+
+static int32_t runOne(AxisPipeline& p, uint8_t axis, int32_t x, uint32_t nowUs) {
+    int32_t raw[AxisPipeline::AXES] = {};
+    int32_t out[AxisPipeline::AXES] = {};
+    raw[axis] = x;
+    p.process((uint8_t)(1u << axis), raw, out, nowUs);
+    return (out[axis] + FULL_SCALE) / 2;
+}
+
+// 1-Euro in double precision with the pipeline's parameter units
+struct OneEuroReference {
+    double minCutoff, beta, dCutoff, span;
+    double x = 0, v = 0;
+    uint32_t lastUs = 0;
+    bool init = false;
+
+    static double alpha(double fc, double dt) { double r = 6.283185307179586 * fc * dt; return r / (1.0 + r); }
+    double filter(double in, uint32_t nowUs) {
+        if (!init) { x = in; v = 0; lastUs = nowUs; init = true; return x; }
+        double dt = (nowUs - lastUs) * 1e-6;
+        lastUs = nowUs;
+        double ad = alpha(dCutoff, dt);
+        v += ad * ((in - x) / dt - v);
+        double fc = minCutoff + beta * fabs(v) / span;
+        x += alpha(fc, dt) * (in - x);
+        return x;
+    }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_matches_double_precision_with_irregular_intervals() {
+    AxisPipeline p;
+    setupIdentity(p, 0, AXIS_FILTER_ADAPTIVE);
+    OneEuroReference ref{AxisPipeline::ADAPTIVE_DEFAULT_MIN_CUTOFF / 100.0,
+                         AxisPipeline::ADAPTIVE_DEFAULT_BETA / 100.0,
+                         AxisPipeline::ADAPTIVE_DEFAULT_D_CUTOFF / 10.0, (double)FULL_SCALE};
+    Rng rng{42};
+    uint32_t now = 1000;
+    double target = 16384;
+    double worst = 0, worstExcess = -1e9;
+    for (int i = 0; i < 200000; i++) {
+        now += 1100 + rng.next() % 6000; // 1.1..7.1 ms, like a shared ADS1115
+        if (rng.next() % 500 == 0) target = rng.next() % FULL_SCALE;
+        double in = target + 20.0 * rng.gauss();
+        int32_t x = (int32_t)lround(in);
+        x = (x < 0) ? 0 : ((x > FULL_SCALE) ? FULL_SCALE : x);
+        int32_t got = runOne(p, 0, x, now);
+        double want = ref.filter(x, now);
+        double err = fabs(got - want);
+        if (err > worst) worst = err;
+        // 4 LSB, plus 0.2% of the distance still to travel right after a jump
+        double excess = err - (4.0 + 0.002 * fabs(x - want));
+        if (excess > worstExcess) worstExcess = excess;
+    }
+    printf("  fixed point vs double, irregular dt: max error %.2f LSB (jumps included)\n", worst);
+    TEST_ASSERT_TRUE(worstExcess <= 0.0);
+}
+
+// Time (ms) for the output to cross 50% of a step, sampling at the given intervals
+static double stepHalfRiseMs(uint32_t (*interval)(Rng&), uint32_t seed) {
+    AxisPipeline p;
+    setupIdentity(p, 0, AXIS_FILTER_ADAPTIVE);
+    Rng rng{seed};
+    uint32_t now = 0;
+    for (int i = 0; i < 400; i++) { now += interval(rng); runOne(p, 0, 8192, now); }
+    const uint32_t stepAt = now;
+    for (int i = 0; i < 2000; i++) {
+        now += interval(rng);
+        if (runOne(p, 0, 24576, now) >= 16384) return (now - stepAt) / 1000.0;
+    }
+    return 1e9;
+}
+static uint32_t regular5ms(Rng&) { return 5000; }
+static uint32_t jittered5ms(Rng& r) { return 2000 + r.next() % 6001; }
+
+void test_response_time_follows_wall_clock() {
+    double regular = stepHalfRiseMs(regular5ms, 1);
+    double worst = 0;
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        double d = fabs(stepHalfRiseMs(jittered5ms, seed) - regular);
+        if (d > worst) worst = d;
+    }
+    printf("  50%% step rise: %.1f ms at 5 ms intervals, jittered 2..8 ms within %.1f ms\n", regular, worst);
+    TEST_ASSERT_TRUE(worst <= 8.0); // one sample interval
+}
+
+void test_parameters_and_names() {
+    AxisPipeline p;
+    p.setAdaptiveParams(3, 250, 500, 20);
+    TEST_ASSERT_EQUAL_UINT16(250, p.getAdaptiveMinCutoff(3));
+    TEST_ASSERT_EQUAL_UINT16(500, p.getAdaptiveBeta(3));
+    TEST_ASSERT_EQUAL_UINT8(20, p.getAdaptiveDCutoff(3));
+    p.setAdaptiveParams(3, 0, 0, 0); // zero cutoffs fall back to the defaults
+    TEST_ASSERT_EQUAL_UINT16(AxisPipeline::ADAPTIVE_DEFAULT_MIN_CUTOFF, p.getAdaptiveMinCutoff(3));
+    TEST_ASSERT_EQUAL_UINT16(0, p.getAdaptiveBeta(3));
+    TEST_ASSERT_EQUAL_UINT8(AxisPipeline::ADAPTIVE_DEFAULT_D_CUTOFF, p.getAdaptiveDCutoff(3));
+    TEST_ASSERT_EQUAL_STRING("Adaptive", getFilterLevelName(AXIS_FILTER_ADAPTIVE));
+}
+
+// ---------------------------------------------------------------------------
+// Group delay benchmark
+// ---------------------------------------------------------------------------
+
+struct Response {
+    double restJitter;   // output standard deviation at rest, LSB
+    double stepHalfMs;   // 50% rise after a 50% full-scale step
+    double rampLagMs;    // steady-state lag behind a one-sweep-per-second ramp
+};
+
+static Response measure(AxisFilterLevel level, uint32_t alpha, double noise) {
+    const uint32_t dtUs = 1000; // 1 kHz
+    Response r{};
+    AxisPipeline p;
+    setupIdentity(p, 0, level);
+    if (level == AXIS_FILTER_EWMA) p.setEwmaAlpha(0, alpha);
+    Rng rng{7};
+    uint32_t now = 0;
+    auto sample = [&](double x) {
+        now += dtUs;
+        int32_t in = (int32_t)lround(x + noise * rng.gauss());
+        in = (in < 0) ? 0 : ((in > FULL_SCALE) ? FULL_SCALE : in);
+        return runOne(p, 0, in, now);
+    };
+
+    // Rest: settle 2 s, then 4 s of jitter
+    for (int i = 0; i < 2000; i++) sample(8192);
+    double sum = 0, sumSq = 0;
+    const int restSamples = 4000;
+    for (int i = 0; i < restSamples; i++) { double y = sample(8192); sum += y; sumSq += y * y; }
+    double mean = sum / restSamples;
+    r.restJitter = sqrt(sumSq / restSamples - mean * mean);
+
+    // Step to 24576
+    r.stepHalfMs = 1e9;
+    for (int i = 1; i <= 3000; i++) {
+        if (sample(24576) >= 16384 && r.stepHalfMs > 1e8) r.stepHalfMs = i * dtUs / 1000.0;
+    }
+
+    // Ramp down at one full scale per second; measure mean lag over the middle part
+    const double slope = FULL_SCALE / 1000.0; // per 1 ms sample
+    for (int i = 0; i < 300; i++) sample(FULL_SCALE);
+    double lagSum = 0;
+    int lagCount = 0;
+    for (int i = 0; i < 1000; i++) {
+        double x = FULL_SCALE - slope * i;
+        double y = sample(x);
+        if (i >= 400 && i < 900) { lagSum += (y - x) / slope; lagCount++; }
+    }
+    r.rampLagMs = lagSum / lagCount;
+    return r;
+}
+
+void test_benchmark_group_delay_at_matched_noise() {
+    const double noise = 16.0; // LSB rms of full scale 32767 (about 0.05%)
+    Response off = measure(AXIS_FILTER_OFF, 0, noise);
+    Response adaptive = measure(AXIS_FILTER_ADAPTIVE, 0, noise);
+
+    // EWMA alpha giving the closest rest jitter to the adaptive filter
+    uint32_t bestAlpha = 1;
+    double bestGap = 1e9;
+    for (uint32_t alpha = 1; alpha <= 1000; alpha++) {
+        double gap = fabs(measure(AXIS_FILTER_EWMA, alpha, noise).restJitter - adaptive.restJitter);
+        if (gap < bestGap) { bestGap = gap; bestAlpha = alpha; }
+        if (alpha >= 100) alpha += 9;
+    }
+    Response ewma = measure(AXIS_FILTER_EWMA, bestAlpha, noise);
+
+    printf("  1 kHz, noise %.0f LSB rms     jitter(LSB)  step 50%%(ms)  ramp lag(ms)\n", noise);
+    printf("  OFF                          %8.2f  %12.1f  %12.1f\n", off.restJitter, off.stepHalfMs, off.rampLagMs);
+    printf("  EWMA alpha %4u/1000          %8.2f  %12.1f  %12.1f\n", bestAlpha, ewma.restJitter, ewma.stepHalfMs, ewma.rampLagMs);
+    printf("  ADAPTIVE (defaults)          %8.2f  %12.1f  %12.1f\n", adaptive.restJitter, adaptive.stepHalfMs, adaptive.rampLagMs);
+
+    TEST_ASSERT_TRUE(adaptive.restJitter < off.restJitter / 4);
+    TEST_ASSERT_TRUE(adaptive.rampLagMs < ewma.rampLagMs);
+    TEST_ASSERT_TRUE(adaptive.stepHalfMs < ewma.stepHalfMs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_double_precision_with_irregular_intervals);
+    RUN_TEST(test_response_time_follows_wall_clock);
+    RUN_TEST(test_parameters_and_names);
+    RUN_TEST(test_benchmark_group_delay_at_matched_noise);
+    return UNITY_END();
+}
@@ -0,0 +1,519 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests and benchmark for the fixed-point axis pipeline (AxisProcessing.h).
+//
+// The previous per-axis implementation (Arduino map() twice, AxisDeadband, EwmaFilter
+// with /1000, AxisCurve with four divisions) is reproduced below as the reference.
+// Axes with a linear curve (range and deadband only) must match it to +/-1 LSB at the HID
+// output; a custom curve now interpolates a compiled lookup table, so only those axes may
+// differ by the table's interpolation bound at breakpoints. The EWMA intentionally keeps fractional state, so it is checked
+// against the same formula evaluated in double precision; the old filter's lag is reported.
+// Curve compilation (linear and monotone cubic) is checked against double precision.
+// The benchmark prints host cycles (or ns) per axis for both implementations.
+// Run with: pio test -e native -f native/test_axis_pipeline -v
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "inputs/analog/AxisProcessing.h"
+#include "inputs/analog/AxisProcessing.cpp" // src/ is not built for the native env
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Reference: the former per-axis implementation
+// ---------------------------------------------------------------------------
+
+static long legacyMap(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+struct LegacyEwma {
+    int32_t lastOutput = 0;
+    uint32_t alpha = 30;
+    uint32_t alphaScale = 1000;
+    bool initialized = false;
+    int32_t filter(int32_t input) {
+        if (!initialized) { lastOutput = input; initialized = true; return input; }
+        int32_t output = (alpha * input + (alphaScale - alpha) * lastOutput) / alphaScale;
+        lastOutput = output;
+        return output;
+    }
+};
+
+struct LegacyDeadband {
+    static constexpr uint8_t HISTORY_SIZE = 10;
+    int32_t deadbandSize = 0, lastInput = 0, stableValue = 0;
+    uint32_t settleDuration = 150;
+    bool deadbandActive = false, initialized = false, capturedStableValue = false;
+    int32_t movementHistory[HISTORY_SIZE] = {0};
+    uint8_t historyIndex = 0, historySamples = 0;
+    uint32_t lastSampleTime = 0;
+
+    int32_t getAverageMovement() const {
+        if (historySamples == 0) return 0;
+        int32_t sum = 0;
+        for (uint8_t i = 0; i < historySamples; i++) sum += movementHistory[i];
+        return sum / historySamples;
+    }
+    int32_t apply(int32_t input, uint32_t currentTime) {
+        if (deadbandSize <= 0) return input;
+        if (!initialized) {
+            lastInput = input; stableValue = input; lastSampleTime = currentTime;
+            deadbandActive = false; capturedStableValue = false; initialized = true;
+            return input;
+        }
+        if (currentTime - lastSampleTime >= (settleDuration / HISTORY_SIZE)) {
+            int32_t movement = abs(input - lastInput);
+            movementHistory[historyIndex] = movement;
+            historyIndex = (historyIndex + 1) % HISTORY_SIZE;
+            if (historySamples < HISTORY_SIZE) historySamples++;
+            lastSampleTime = currentTime;
+            lastInput = input;
+            if (historySamples >= HISTORY_SIZE) {
+                int32_t avgMovement = getAverageMovement();
+                if (avgMovement <= deadbandSize / 8) {
+                    if (!capturedStableValue) { stableValue = input; capturedStableValue = true; }
+                    deadbandActive = true;
+                } else {
+                    deadbandActive = false; capturedStableValue = false;
+                }
+            }
+        }
+        if (deadbandActive) {
+            if (abs(input - stableValue) > deadbandSize) {
+                deadbandActive = false; capturedStableValue = false; stableValue = input;
+                historySamples = 0; historyIndex = 0;
+                return input;
+            }
+            return stableValue;
+        }
+        return input;
+    }
+};
+
+struct LegacyCurve {
+    int32_t customTable[11] = {0, 3277, 6554, 9830, 13107, 16384, 19661, 22938, 26214, 29491, 32767};
+    uint8_t points = 11;
+    int32_t apply(int32_t input) const {
+        const int32_t* table = customTable;
+        int32_t maxInput = 32767;
+        int32_t idx = (input * (points - 1)) / maxInput;
+        if (idx >= points - 1) return table[points - 1];
+        if (idx < 0) return table[0];
+        int32_t x0 = (idx * maxInput) / (points - 1);
+        int32_t x1 = ((idx + 1) * maxInput) / (points - 1);
+        int32_t y0 = table[idx];
+        int32_t y1 = table[idx + 1];
+        if (x1 == x0) return y0;
+        return y0 + (input - x0) * (y1 - y0) / (x1 - x0);
+    }
+};
+
+struct LegacyAxis {
+    int32_t sourceMax = 1023, minimum = 0, maximum = 32767;
+    bool ewmaEnabled = false;
+    LegacyDeadband deadband;
+    LegacyEwma ewma;
+    LegacyCurve curve;
+    // exactEwma: replace the truncating filter with the same formula in double precision
+    bool exactEwma = false;
+    double exactState = 0;
+    bool exactInit = false;
+
+    int32_t process(int32_t raw, uint32_t nowMs) {
+        int32_t mapped = (int32_t)legacyMap(raw, 0, sourceMax, minimum, maximum);
+        mapped = (mapped < minimum) ? minimum : ((mapped > maximum) ? maximum : mapped);
+        int32_t v = deadband.apply(mapped, nowMs);
+        if (ewmaEnabled) {
+            if (exactEwma) {
+                if (!exactInit) { exactState = v; exactInit = true; }
+                else exactState += (ewma.alpha / 1000.0) * (v - exactState);
+                v = (int32_t)floor(exactState + 0.5);
+            } else {
+                v = ewma.filter(v);
+            }
+        }
+        v = curve.apply(v);
+        return (int32_t)legacyMap(v, minimum, maximum, -32767, 32767);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+
+struct AxisSetup {
+    int32_t sourceMax, minimum, maximum, deadband;
+    bool ewma;
+    uint32_t alpha;
+    uint8_t curvePoints;
+    int32_t curve[11];
+};
+
+static const AxisSetup kSetups[AxisPipeline::AXES] = {
+    {1023, 0, 32767, 0, false, 0, 11, {0, 3277, 6554, 9830, 13107, 16384, 19661, 22938, 26214, 29491, 32767}},
+    {16383, 0, 32767, 250, false, 0, 11, {0, 1000, 2500, 5000, 9000, 16384, 23767, 27767, 30267, 31767, 32767}},
+    {1023, 0, 1023, 0, false, 0, 2, {0, 32767}},                     // linear
+    {16383, 1000, 30000, 2000, false, 0, 5, {0, 12000, 16384, 20767, 32767}},
+    {1023, 0, 32767, 0, false, 0, 3, {32767, 16384, 0}},             // inverted
+    {16383, 0, 32767, 0, false, 0, 2, {0, 32767}},                   // linear
+    {1023, 500, 20000, 100, false, 0, 7, {0, 100, 2000, 16384, 30000, 32000, 32767}},
+    {16383, 0, 32767, 500, false, 0, 2, {0, 32767}},                 // linear
+};
+
+// A straight 0..32767 curve: stored configs have no curve entry for such an axis, so the
+// pipeline runs it without a table (and the old code's interpolation was exact on it)
+static bool isLinear(const AxisSetup& s) {
+    return s.curvePoints == 2 && s.curve[0] == 0 && s.curve[1] == 32767;
+}
+
+static void configure(AxisPipeline& p, LegacyAxis* legacy, const AxisSetup* setups, bool exactEwma) {
+    for (uint8_t a = 0; a < AxisPipeline::AXES; a++) {
+        const AxisSetup& s = setups[a];
+        p.setSourceMax(a, s.sourceMax);
+        p.setRange(a, s.minimum, s.maximum);
+        p.setFilterLevel(a, s.ewma ? AXIS_FILTER_EWMA : AXIS_FILTER_OFF);
+        if (s.ewma) p.setEwmaAlpha(a, s.alpha);
+        p.setDeadbandSize(a, s.deadband);
+        if (isLinear(s)) p.clearCurve(a);
+        else p.setCustomCurve(a, s.curve, s.curvePoints);
+
+        LegacyAxis& l = legacy[a];
+        l = LegacyAxis();
+        l.sourceMax = s.sourceMax; l.minimum = s.minimum; l.maximum = s.maximum;
+        l.deadband.deadbandSize = s.deadband;
+        l.ewmaEnabled = s.ewma; l.ewma.alpha = s.alpha; l.exactEwma = exactEwma;
+        for (uint8_t i = 0; i < s.curvePoints; i++) l.curve.customTable[i] = s.curve[i];
+        l.curve.points = s.curvePoints;
+    }
+}
+
+// Random walk with occasional jumps and rests, like a hand on a stick
+static int32_t nextRaw(int32_t cur, int32_t sourceMax, uint32_t& rng) {
+    rng = rng * 1664525u + 1013904223u;
+    uint32_t r = rng >> 8;
+    int32_t v = cur;
+    switch (r % 16) {
+        case 0: v = (int32_t)((r >> 4) % (uint32_t)(sourceMax + 1)); break;    // jump
+        case 1: case 2: case 3: case 4: case 5: break;                          // rest
+        default: v += (int32_t)((r >> 4) % 41) - 20; break;                     // drift / noise
+    }
+    return (v < 0) ? 0 : ((v > sourceMax) ? sourceMax : v);
+}
+
+static double maxCurveSlope(const AxisSetup& s, double* maxSlopeChange) {
+    double maxSlope = 0, prev = 0;
+    if (maxSlopeChange) *maxSlopeChange = 0;
+    for (uint8_t i = 0; i + 1 < s.curvePoints; i++) {
+        double dx = (double)((i + 1) * 32767 / (s.curvePoints - 1) - i * 32767 / (s.curvePoints - 1));
+        double slope = (double)(s.curve[i + 1] - s.curve[i]) / dx;
+        if (fabs(slope) > maxSlope) maxSlope = fabs(slope);
+        if (i && maxSlopeChange && fabs(slope - prev) > *maxSlopeChange) *maxSlopeChange = fabs(slope - prev);
+        prev = slope;
+    }
+    return maxSlope;
+}
+
+// Allowed |new - old| at the HID output. Linear axes go through the range, deadband and
+// output stages only, which keep the old truncation: 1 LSB. For a custom curve, interpolating
+// the compiled table instead of the control points is off by at most a quarter cell times the
+// slope change at a breakpoint, plus rounding of the entries and truncation on both sides.
+// With exactEwma one filter-stage LSB, carried through the curve, is allowed on top.
+static int32_t hidTolerance(const AxisSetup& s, bool exactEwma) {
+    if (isLinear(s)) return exactEwma ? (int32_t)ceil(65534.0 / abs(s.maximum - s.minimum)) + 1 : 1;
+    double slopeChange = 0;
+    double maxSlope = maxCurveSlope(s, &slopeChange);
+    const double cell = (double)(1 << (AxisPipeline::CURVE_INPUT_BITS - AxisPipeline::CURVE_LUT_LOG2_DEFAULT));
+    double curveLsb = cell * slopeChange / 4.0 + 2.5;
+    if (exactEwma) curveLsb += maxSlope;
+    return (int32_t)ceil(curveLsb * 65534.0 / abs(s.maximum - s.minimum)) + 1;
+}
+
+// Runs random input through both implementations. Returns how far the worst sample
+// exceeds its axis tolerance (0 = all within); maxDiff[0] receives the largest |new - old|
+// on linear axes, maxDiff[1] on axes with a custom curve.
+static int32_t runAgainstReference(const AxisSetup* setups, bool exactEwma, uint32_t steps, int32_t maxDiff[2]) {
+    AxisPipeline p;
+    LegacyAxis legacy[AxisPipeline::AXES];
+    configure(p, legacy, setups, exactEwma);
+    int32_t tolerance[AxisPipeline::AXES];
+    for (uint8_t a = 0; a < AxisPipeline::AXES; a++) tolerance[a] = hidTolerance(setups[a], exactEwma);
+
+    int32_t raw[AxisPipeline::AXES] = {};
+    int32_t out[AxisPipeline::AXES] = {};
+    uint32_t rng = 12345;
+    int32_t worst = 0;
+    maxDiff[0] = maxDiff[1] = 0;
+    uint32_t nowMs = 0;
+    for (uint32_t step = 0; step < steps; step++) {
+        nowMs += 1 + (step % 5);
+        for (uint8_t a = 0; a < AxisPipeline::AXES; a++) raw[a] = nextRaw(raw[a], setups[a].sourceMax, rng);
+        // Axes arrive in varying subsets, as with per-axis sample rates
+        uint8_t mask = (uint8_t)(0xFF & ~(step * 37u));
+        if (!mask) mask = 0xFF;
+        p.process(mask, raw, out, nowMs * 1000u);
+        for (uint8_t a = 0; a < AxisPipeline::AXES; a++) {
+            if (!(mask & (1u << a))) continue;
+            int32_t ref = legacy[a].process(raw[a], nowMs);
+            int32_t diff = abs(out[a] - ref);
+            int32_t& m = maxDiff[isLinear(setups[a]) ? 0 : 1];
+            if (diff > m) m = diff;
+            if (diff - tolerance[a] > worst) worst = diff - tolerance[a];
+        }
+    }
+    return worst;
+}
+
+// Piecewise-linear or Fritsch-Carlson reference in double precision
+static double referenceCurve(const AxisCurvePoint* pts, uint8_t n, bool smooth, double x) {
+    if (x <= pts[0].x) return pts[0].y;
+    if (x >= pts[n - 1].x) return pts[n - 1].y;
+    uint8_t k = 0;
+    while (x > pts[k + 1].x) k++;
+    const double h = pts[k + 1].x - pts[k].x, t = (x - pts[k].x) / h;
+    if (!smooth) return pts[k].y + t * (pts[k + 1].y - pts[k].y);
+    auto slope = [&](uint8_t i) { return ((double)pts[i + 1].y - pts[i].y) / ((double)pts[i + 1].x - pts[i].x); };
+    auto tangent = [&](uint8_t i) {
+        if (i == 0) return slope(0);
+        if (i == n - 1) return slope(n - 2);
+        double d0 = slope(i - 1), d1 = slope(i);
+        if (d0 * d1 <= 0) return 0.0;
+        double h0 = pts[i].x - pts[i - 1].x, h1 = pts[i + 1].x - pts[i].x;
+        double w0 = 2 * h1 + h0, w1 = h1 + 2 * h0;
+        return (w0 + w1) / (w0 / d0 + w1 / d1);
+    };
+    const double t2 = t * t, t3 = t2 * t;
+    return (2 * t3 - 3 * t2 + 1) * pts[k].y + (t3 - 2 * t2 + t) * h * tangent(k) +
+           (3 * t2 - 2 * t3) * pts[k + 1].y + (t3 - t2) * h * tangent(k + 1);
+}
+
+static uint8_t randomCurve(AxisCurvePoint* pts, uint32_t& rng, bool monotone) {
+    rng = rng * 1664525u + 1013904223u;
+    const uint8_t n = (uint8_t)(2 + (rng >> 8) % (AxisPipeline::MAX_CURVE_POINTS - 1));
+    uint16_t y = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        pts[i].x = (uint16_t)((uint32_t)i * 32767 / (n - 1));
+        if (i && i + 1 < n) pts[i].x = (uint16_t)(pts[i].x + (int32_t)((rng >> 8) % 1001) - 500);
+        rng = rng * 1664525u + 1013904223u;
+        if (monotone) y = (uint16_t)(y + ((rng >> 8) % (32767 - y + 1)) / (n - i));
+        else y = (uint16_t)((rng >> 8) % 32768);
+        pts[i].y = y;
+    }
+    return n;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_ratio_is_exact() {
+    uint32_t rng = 1;
+    for (int i = 0; i < 200000; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t num = rng % 65536;
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t den = 1 + rng % 65535;
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t x = rng % 65536;
+        AxisRatio r;
+        r.set(num, den);
+        if ((uint64_t)x * den >= (1ull << 32)) continue;
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)((uint64_t)x * num / den), r.apply(x));
+        TEST_ASSERT_EQUAL_INT32(-(int32_t)((uint64_t)x * num / den), r.applySigned(-(int32_t)x));
+    }
+}
+
+void test_matches_reference_without_filter() {
+    int32_t maxDiff[2] = {};
+    int32_t excess = runAgainstReference(kSetups, false, 200000, maxDiff);
+    printf("  range/deadband: max |new - old| = %d LSB; custom curve (LUT %u entries): %d LSB\n",
+           maxDiff[0], (1u << AxisPipeline::CURVE_LUT_LOG2_DEFAULT) + 1, maxDiff[1]);
+    TEST_ASSERT_EQUAL_INT32(0, excess);
+}
+
+void test_ewma_matches_exact_formula() {
+    AxisSetup setups[AxisPipeline::AXES];
+    const uint32_t alphas[AxisPipeline::AXES] = {1000, 500, 200, 100, 30, 10, 3, 200};
+    for (uint8_t a = 0; a < AxisPipeline::AXES; a++) {
+        setups[a] = kSetups[a];
+        setups[a].ewma = true;
+        setups[a].alpha = alphas[a];
+    }
+    int32_t maxDiff[2] = {};
+    int32_t excess = runAgainstReference(setups, true, 200000, maxDiff);
+    printf("  EWMA vs exact formula: max |new - exact| = %d HID LSB (linear), %d (custom curve)\n",
+           maxDiff[0], maxDiff[1]);
+    TEST_ASSERT_EQUAL_INT32(0, excess);
+
+    // The truncating filter settles short of a step; report how far (informational)
+    LegacyEwma old;
+    old.alpha = 30;
+    old.filter(0);
+    int32_t settled = 0;
+    for (int i = 0; i < 5000; i++) settled = old.filter(32767);
+    AxisPipeline p;
+    p.setSourceMax(0, 16383);
+    p.setRange(0, 0, 32767);
+    p.setFilterLevel(0, AXIS_FILTER_EWMA);
+    int32_t raw[AxisPipeline::AXES] = {0}, out[AxisPipeline::AXES] = {0};
+    p.process(1, raw, out, 0);
+    raw[0] = 16383;
+    for (int i = 0; i < 5000; i++) p.process(1, raw, out, 0);
+    printf("  step to full scale, alpha 0.03: old filter settles at %d/32767, new reaches HID %d\n",
+           settled, out[0]);
+    TEST_ASSERT_EQUAL_INT32(32767, out[0]);
+}
+
+void test_linear_lut_matches_control_points() {
+    uint32_t rng = 7;
+    for (uint8_t lutLog2 = AxisPipeline::CURVE_LUT_LOG2_MIN; lutLog2 <= AxisPipeline::CURVE_LUT_LOG2_MAX; lutLog2++) {
+        static uint16_t lut[(1u << AxisPipeline::CURVE_LUT_LOG2_MAX) + 1];
+        const uint32_t entries = (1u << lutLog2) + 1;
+        for (int c = 0; c < 200; c++) {
+            AxisCurvePoint pts[AxisPipeline::MAX_CURVE_POINTS];
+            uint8_t n = randomCurve(pts, rng, false);
+            TEST_ASSERT_TRUE(AxisPipeline::compileCurve(pts, n, false, lutLog2, lut));
+            for (uint32_t i = 0; i < entries; i++) {
+                double x = (i == entries - 1) ? 32767.0 : (double)(i << (AxisPipeline::CURVE_INPUT_BITS - lutLog2));
+                TEST_ASSERT_LESS_OR_EQUAL(1, (int32_t)fabs(lut[i] - referenceCurve(pts, n, false, x)) );
+            }
+        }
+    }
+}
+
+void test_smooth_curve_is_monotone_without_overshoot() {
+    uint32_t rng = 11;
+    static uint16_t lut[(1u << AxisPipeline::CURVE_LUT_LOG2_MAX) + 1];
+    const uint8_t lutLog2 = AxisPipeline::CURVE_LUT_LOG2_MAX;
+    const uint32_t entries = (1u << lutLog2) + 1;
+    const uint8_t shift = AxisPipeline::CURVE_INPUT_BITS - lutLog2;
+    double worstErr = 0;
+    for (int c = 0; c < 500; c++) {
+        AxisCurvePoint pts[AxisPipeline::MAX_CURVE_POINTS];
+        const bool monotone = (c % 2) == 0;
+        uint8_t n = randomCurve(pts, rng, monotone);
+        TEST_ASSERT_TRUE(AxisPipeline::compileCurve(pts, n, true, lutLog2, lut));
+        uint8_t k = 0;
+        for (uint32_t i = 0; i < entries; i++) {
+            const uint32_t x = (i == entries - 1) ? 32767 : (i << shift);
+            if (monotone && i) TEST_ASSERT_TRUE(lut[i] >= lut[i - 1]);
+            // Every sample stays between the control points around it
+            while (k + 1 < n - 1 && x > pts[k + 1].x) k++;
+            int32_t lo = pts[0].y, hi = pts[0].y;
+            if (x > pts[0].x && x < pts[n - 1].x) {
+                lo = (pts[k].y < pts[k + 1].y) ? pts[k].y : pts[k + 1].y;
+                hi = (pts[k].y < pts[k + 1].y) ? pts[k + 1].y : pts[k].y;
+            } else if (x >= pts[n - 1].x) {
+                lo = hi = pts[n - 1].y;
+            }
+            TEST_ASSERT_TRUE(lut[i] >= lo - 1 && lut[i] <= hi + 1);
+            double err = fabs(lut[i] - referenceCurve(pts, n, true, x));
+            if (err > worstErr) worstErr = err;
+        }
+    }
+    printf("  monotone cubic LUT vs double precision: max error %.2f LSB\n", worstErr);
+    TEST_ASSERT_TRUE(worstErr <= 1.0);
+}
+
+void test_curve_configuration() {
+    AxisPipeline p;
+    TEST_ASSERT_EQUAL_UINT16(0, p.getCurveLutSize(0)); // identity until a curve is set
+
+    const AxisCurvePoint s[] = {{0, 0}, {8192, 2048}, {16384, 16384}, {24576, 30719}, {32767, 32767}};
+    for (uint8_t n = AxisPipeline::CURVE_LUT_LOG2_MIN; n <= AxisPipeline::CURVE_LUT_LOG2_MAX; n++) {
+        TEST_ASSERT_TRUE(p.setCurve(0, s, 5, true, n));
+        TEST_ASSERT_EQUAL_UINT16((1u << n) + 1, p.getCurveLutSize(0));
+    }
+    TEST_ASSERT_TRUE(p.setCurve(1, s, 5, false, 0));
+    TEST_ASSERT_EQUAL_UINT16((1u << AxisPipeline::CURVE_LUT_LOG2_DEFAULT) + 1, p.getCurveLutSize(1));
+
+    TEST_ASSERT_FALSE(p.setCurve(2, s, 5, true, 7));
+    TEST_ASSERT_FALSE(p.setCurve(2, s, 5, true, 13));
+    TEST_ASSERT_FALSE(p.setCurve(2, s, 1, true, 0));
+    const AxisCurvePoint unsorted[] = {{0, 0}, {20000, 100}, {20000, 200}, {32767, 32767}};
+    TEST_ASSERT_FALSE(p.setCurve(2, unsorted, 4, false, 0));
+    TEST_ASSERT_EQUAL_UINT16(0, p.getCurveLutSize(2));
+
+    // Ends of the input range hit the end points exactly
+    p.setSourceMax(0, 16383);
+    p.setRange(0, 0, 32767);
+    p.setFilterLevel(0, AXIS_FILTER_OFF);
+    int32_t raw[AxisPipeline::AXES] = {0}, out[AxisPipeline::AXES] = {0};
+    p.process(1, raw, out, 0);
+    TEST_ASSERT_EQUAL_INT32(-32767, out[0]);
+    raw[0] = 16383;
+    p.process(1, raw, out, 0);
+    TEST_ASSERT_EQUAL_INT32(32767, out[0]);
+
+    p.clearCurve(0);
+    TEST_ASSERT_EQUAL_UINT16(0, p.getCurveLutSize(0));
+}
+
+void test_benchmark_cycles_per_axis() {
+    AxisSetup setups[AxisPipeline::AXES];
+    for (uint8_t a = 0; a < AxisPipeline::AXES; a++) {
+        setups[a] = kSetups[a];
+        setups[a].ewma = true;
+        setups[a].alpha = 200;
+    }
+    AxisPipeline p;
+    LegacyAxis legacy[AxisPipeline::AXES];
+    configure(p, legacy, setups, false);
+
+    const uint32_t rounds = 200000;
+    int32_t raw[AxisPipeline::AXES] = {};
+    int32_t out[AxisPipeline::AXES] = {};
+    uint32_t rng = 99;
+    static int32_t inputs[1024][AxisPipeline::AXES];
+    for (uint32_t i = 0; i < 1024; i++) {
+        for (uint8_t a = 0; a < AxisPipeline::AXES; a++) inputs[i][a] = raw[a] = nextRaw(raw[a], setups[a].sourceMax, rng);
+    }
+    volatile int32_t sink = 0;
+
+    auto timeIt = [&](auto&& body) {
+#if HAVE_TSC
+        uint64_t t0 = __rdtsc();
+        body();
+        return (double)(__rdtsc() - t0) / ((double)rounds * AxisPipeline::AXES);
+#else
+        auto t0 = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() /
+               ((double)rounds * AxisPipeline::AXES);
+#endif
+    };
+
+    double legacyCost = timeIt([&] {
+        for (uint32_t r = 0; r < rounds; r++) {
+            for (uint8_t a = 0; a < AxisPipeline::AXES; a++) sink += legacy[a].process(inputs[r & 1023][a], r);
+        }
+    });
+    double newCost = timeIt([&] {
+        for (uint32_t r = 0; r < rounds; r++) {
+            p.process(0xFF, inputs[r & 1023], out, r * 1000u);
+            sink += out[r & 7];
+        }
+    });
+#if HAVE_TSC
+    const char* unit = "TSC cycles";
+#else
+    const char* unit = "ns";
+#endif
+    printf("  per axis (8 axes, deadband + EWMA + curve): old %.1f, new %.1f %s\n", legacyCost, newCost, unit);
+    (void)sink;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ratio_is_exact);
+    RUN_TEST(test_matches_reference_without_filter);
+    RUN_TEST(test_ewma_matches_exact_formula);
+    RUN_TEST(test_linear_lut_matches_control_points);
+    RUN_TEST(test_smooth_curve_is_monotone_without_overshoot);
+    RUN_TEST(test_curve_configuration);
+    RUN_TEST(test_benchmark_cycles_per_axis);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the change-driven button kernel (ButtonKernel.h) that carries the direct-pin,
+// shift-register and matrix buttons.
+//
+// Covers NORMAL bindings with and without reverse and MOMENTARY pulses: one 50 ms pulse, a
+// re-press during the pulse ignored, and nothing fired by the priming update. Then several
+// bindings on one source bit, two sources on one report bit (the most recent edge decides),
+// and edge iteration across 32-bit word boundaries.
+// Run with: pio test -e native -f native/test_button_kernel -v
+#include <unity.h>
+#include "inputs/buttons/ButtonKernel.h"
+#include "inputs/buttons/ButtonKernel.cpp" // src/ is not built for the native env
+
+void setUp() {}
+void tearDown() {}
+
+struct Edits {
+    bool any;
+    uint32_t mask[ButtonKernel::REPORT_WORDS];
+    uint32_t value[ButtonKernel::REPORT_WORDS];
+
+    // Report edit for a 1-based joystick button: -1 untouched, 0 released, 1 pressed
+    int button(uint8_t joyButtonID) const {
+        const uint8_t b = joyButtonID - 1;
+        if (!any || !(mask[b >> 5] & (1u << (b & 31)))) return -1;
+        return (value[b >> 5] >> (b & 31)) & 1u;
+    }
+};
+
+static Edits take(ButtonKernel& k) {
+    Edits e = {};
+    e.any = k.takeReportEdits(e.mask, e.value);
+    return e;
+}
+
+static void feed(ButtonKernel& k, uint8_t source, uint32_t word, uint32_t nowMs) {
+    k.update(source, &word, nowMs);
+}
+
+void test_normal_and_reverse() {
+    ButtonKernel k;
+    const uint8_t src = k.addSource(8);
+    k.addBinding(src, 0, 1, false, false);
+    k.addBinding(src, 1, 2, false, true);
+    k.finalize();
+
+    // Priming evaluates every bound bit once: reverse reads as pressed while released
+    feed(k, src, 0x0, 0);
+    Edits e = take(k);
+    TEST_ASSERT_EQUAL_INT(0, e.button(1));
+    TEST_ASSERT_EQUAL_INT(1, e.button(2));
+
+    // Nothing changed, nothing to send
+    feed(k, src, 0x0, 1);
+    TEST_ASSERT_FALSE(take(k).any);
+
+    feed(k, src, 0x3, 2);
+    e = take(k);
+    TEST_ASSERT_EQUAL_INT(1, e.button(1));
+    TEST_ASSERT_EQUAL_INT(0, e.button(2));
+
+    feed(k, src, 0x2, 3);
+    e = take(k);
+    TEST_ASSERT_EQUAL_INT(0, e.button(1));
+    TEST_ASSERT_EQUAL_INT(-1, e.button(2));
+
+    // Unbound bits never produce edits
+    feed(k, src, 0xF2, 4);
+    TEST_ASSERT_FALSE(take(k).any);
+}
+
+void test_momentary_pulse() {
+    ButtonKernel k;
+    const uint8_t src = k.addSource(8);
+    k.addBinding(src, 2, 7, true, false);
+    k.finalize();
+
+    // Held at boot: the priming update fires nothing
+    feed(k, src, 0x4, 0);
+    k.tick(0);
+    TEST_ASSERT_FALSE(take(k).any);
+
+    feed(k, src, 0x0, 10);
+    TEST_ASSERT_FALSE(take(k).any); // release of a MOMENTARY input is not reported
+
+    feed(k, src, 0x4, 100);
+    TEST_ASSERT_EQUAL_INT(1, take(k).button(7));
+
+    // Released and pressed again during the pulse: ignored
+    feed(k, src, 0x0, 110);
+    feed(k, src, 0x4, 120);
+    k.tick(149);
+    TEST_ASSERT_FALSE(take(k).any);
+
+    // One pulse of MOMENTARY_PULSE_MS
+    k.tick(100 + ButtonKernel::MOMENTARY_PULSE_MS);
+    TEST_ASSERT_EQUAL_INT(0, take(k).button(7));
+    k.tick(300);
+    TEST_ASSERT_FALSE(take(k).any);
+
+    // A new press after the pulse ended fires again
+    feed(k, src, 0x0, 310);
+    feed(k, src, 0x4, 320);
+    TEST_ASSERT_EQUAL_INT(1, take(k).button(7));
+    k.tick(320 + ButtonKernel::MOMENTARY_PULSE_MS);
+    TEST_ASSERT_EQUAL_INT(0, take(k).button(7));
+}
+
+void test_bindings_on_one_source_bit() {
+    ButtonKernel k;
+    const uint8_t src = k.addSource(8);
+    k.addBinding(src, 3, 1, false, false);
+    k.addBinding(src, 3, 2, false, true);
+    k.addBinding(src, 3, 3, true, false);
+    k.finalize();
+    TEST_ASSERT_EQUAL_UINT16(3, k.getBindingCount());
+
+    feed(k, src, 0x0, 0);
+    take(k);
+    feed(k, src, 0x8, 100);
+    Edits e = take(k);
+    TEST_ASSERT_EQUAL_INT(1, e.button(1));
+    TEST_ASSERT_EQUAL_INT(0, e.button(2));
+    TEST_ASSERT_EQUAL_INT(1, e.button(3));
+
+    feed(k, src, 0x0, 110);
+    e = take(k);
+    TEST_ASSERT_EQUAL_INT(0, e.button(1));
+    TEST_ASSERT_EQUAL_INT(1, e.button(2));
+    TEST_ASSERT_EQUAL_INT(-1, e.button(3)); // still pulsing
+}
+
+void test_two_sources_on_one_report_bit() {
+    ButtonKernel k;
+    const uint8_t a = k.addSource(8);
+    const uint8_t b = k.addSource(8);
+    k.addBinding(a, 0, 5, false, false);
+    k.addBinding(b, 0, 5, false, false);
+    k.finalize();
+    feed(k, a, 0x0, 0);
+    feed(k, b, 0x0, 0);
+    TEST_ASSERT_EQUAL_INT(0, take(k).button(5));
+
+    feed(k, a, 0x1, 10);
+    TEST_ASSERT_EQUAL_INT(1, take(k).button(5));
+    feed(k, b, 0x1, 20);
+    TEST_ASSERT_EQUAL_INT(1, take(k).button(5));
+
+    // The most recent edge decides: releasing A clears the bit although B is still held,
+    // and B holding steady does not set it again
+    feed(k, a, 0x0, 30);
+    feed(k, b, 0x1, 30);
+    TEST_ASSERT_EQUAL_INT(0, take(k).button(5));
+    feed(k, b, 0x1, 40);
+    TEST_ASSERT_FALSE(take(k).any);
+
+    feed(k, b, 0x0, 50);
+    TEST_ASSERT_EQUAL_INT(0, take(k).button(5));
+    feed(k, b, 0x1, 60);
+    TEST_ASSERT_EQUAL_INT(1, take(k).button(5));
+}
+
+void test_edges_across_word_boundaries() {
+    ButtonKernel k;
+    k.addSource(4); // a source before it, so global bits do not start at 0
+    const uint8_t src = k.addSource(96);
+    const uint16_t BITS[] = {0, 31, 32, 63, 64, 95};
+    for (uint8_t i = 0; i < 6; i++) k.addBinding(src, BITS[i], (uint8_t)(BITS[i] + 1), false, false);
+    k.finalize();
+
+    uint32_t words[3] = {0, 0, 0};
+    k.update(src, words, 0);
+    take(k);
+
+    // Press every bound bit plus unbound neighbours
+    words[0] = 0x80000001u | 0x00000100u;
+    words[1] = 0x80000001u | 0x00010000u;
+    words[2] = 0x80000001u;
+    k.update(src, words, 10);
+    Edits e = take(k);
+    for (uint8_t i = 0; i < 6; i++) TEST_ASSERT_EQUAL_INT(1, e.button((uint8_t)(BITS[i] + 1)));
+    uint8_t edited = 0;
+    for (uint8_t w = 0; w < ButtonKernel::REPORT_WORDS; w++) edited += (uint8_t)__builtin_popcount(e.mask[w]);
+    TEST_ASSERT_EQUAL_UINT8(6, edited);
+
+    // Only the bits that changed are visited: release 31 and 64
+    words[0] &= ~0x80000000u;
+    words[2] &= ~0x00000001u;
+    k.update(src, words, 20);
+    e = take(k);
+    TEST_ASSERT_EQUAL_INT(0, e.button(32));
+    TEST_ASSERT_EQUAL_INT(0, e.button(65));
+    TEST_ASSERT_EQUAL_INT(-1, e.button(1));
+    TEST_ASSERT_EQUAL_INT(-1, e.button(33));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_normal_and_reverse);
+    RUN_TEST(test_momentary_pulse);
+    RUN_TEST(test_bindings_on_one_source_bit);
+    RUN_TEST(test_two_sources_on_one_report_bit);
+    RUN_TEST(test_edges_across_word_boundaries);
+    return UNITY_END();
+}
@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for loading config images written by older firmware (ConfigConversion.cpp).
+//
+// Builds config.bin byte by byte in the version 7 layout of released firmware (15-byte axis
+// entries, no curve section, the padding byte before the axes left as whatever the stack held),
+// and in the version 8 (curve section) and version 9 (20-byte axis entries) layouts. Each is
+// stored as the CFG record of a flash log, where the EEPROM import puts it, and loaded with the
+// steps of ConfigManager::loadFromStorage: upgraded into the RAM image buffer and saved back,
+// after which the next boot uses the current image in place. Damaged and unknown images are
+// rejected.
+// Run with: pio test -e native -f native/test_config_upgrade -v
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "rp2040/storage/FlashLog.h"
+#include "config/core/ConfigConversion.cpp" // src/ is not built for the native env
+
+void setUp() {}
+void tearDown() {}
+
+struct RamFlash : FlashLogMedium {
+    std::vector<uint8_t> mem;
+    explicit RamFlash(uint8_t sectors) : mem(sectors * FLASH_LOG_SECTOR, 0xFF) {}
+    const uint8_t* map(uint32_t offset) const override { return &mem[offset]; }
+    bool erase(uint32_t offset) override {
+        memset(&mem[offset], 0xFF, FLASH_LOG_SECTOR);
+        return true;
+    }
+    bool program(uint32_t offset, uint32_t pages, FlashLogFill fill, const void* ctx) override {
+        for (uint32_t p = 0; p < pages; p++) fill(ctx, p, &mem[offset + p * FLASH_LOG_PAGE]);
+        return true;
+    }
+};
+
+// Little-endian writer for images in an older layout
+struct Bytes {
+    std::vector<uint8_t> b;
+    void u8(uint8_t v) { b.push_back(v); }
+    void u16(uint16_t v) { u8((uint8_t)v); u8((uint8_t)(v >> 8)); }
+    void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); }
+    void str(const char* s, size_t n) {
+        for (size_t i = 0; i < n; i++) u8(i < strlen(s) ? (uint8_t)s[i] : 0);
+    }
+};
+
+// The CRC32 every version computes: the header without its checksum field, then the rest
+static uint32_t referenceChecksum(const std::vector<uint8_t>& b) {
+    uint32_t c = 0xFFFFFFFF;
+    for (size_t i = 0; i < b.size(); i++) {
+        if (i >= 8 && i < 12) continue;
+        c ^= b[i];
+        for (int j = 0; j < 8; j++) c = (c >> 1) ^ (0xEDB88320 & (-(c & 1)));
+    }
+    return ~c;
+}
+
+static const char* const PIN_NAMES[3] = {"2", "3", "GP10"};
+
+static uint16_t axisMin(uint8_t i) { return (uint16_t)(100 + i); }
+static uint16_t axisMax(uint8_t i) { return (uint16_t)(4000 + i); }
+
+// config.bin as firmware of version 7, 8 or 9 wrote it: 3 pins, 4 logical inputs, 1 shift
+// register, axes 0 and 1 enabled, and from version 8 a 3-point curve on axis 1
+static std::vector<uint8_t> legacyImage(uint16_t version) {
+    Bytes w;
+    w.u32(CONFIG_MAGIC);
+    w.u16(version);
+    w.u16(0);  // size, patched below
+    w.u32(0);  // checksum, patched below
+    w.u32(0);
+
+    w.u16(0x2E8A);
+    w.u16(0xA02F);
+    w.str("OpenSource", 32);
+    w.str("JoyCore", 32);
+    w.str("", 8);
+
+    w.u8(3);
+    w.u8(4);
+    w.u8(1);
+    w.u8(version >= 8 ? 1 : 0xCD);  // curveCount; uninitialized padding in version 7
+
+    for (uint8_t i = 0; i < 8; i++) {
+        w.u8(i < 2);
+        w.u8((uint8_t)(26 + i));
+        w.u16(axisMin(i));
+        w.u16(axisMax(i));
+        w.u8(1);        // AXIS_FILTER_EWMA
+        w.u16(300);
+        w.u16(i);
+        w.u8(i == 1 ? 3 : 0);
+        if (version == 7) {
+            w.str("", 3);
+        } else {
+            w.u8(10);   // adcRate
+            w.u8(2);    // adcOversample
+            if (version == 8) {
+                w.u8(0xEE); // padding
+            } else {
+                w.u16(150);
+                w.u16(700);
+                w.u8(12);
+                w.u8(0);
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        w.str(PIN_NAMES[i], 8);
+        w.u8(i < 2 ? BTN : SHIFTREG_QH);
+        w.u8(0);
+    }
+
+    // type, behavior, joyButtonID, reverse, encoderLatchMode, 3 reserved, 2 data
+    const uint8_t inputs[4][10] = {
+        {INPUT_PIN, NORMAL, 1, 0, FOUR3, 0, 0, 0, 2, 0},
+        {INPUT_PIN, MOMENTARY, 2, 1, FOUR3, 0, 0, 0, 3, 0},
+        {INPUT_MATRIX, NORMAL, 3, 0, FOUR3, 0, 0, 0, 1, 2},
+        {INPUT_SHIFTREG, ENC_A, 4, 0, FOUR0, 0, 0, 0, 0, 5},
+    };
+    for (const auto& in : inputs) {
+        for (uint8_t v : in) w.u8(v);
+    }
+
+    if (version >= 8) {
+        w.u8(1);
+        w.u8(CURVE_FLAG_SMOOTH);
+        w.u8(3);
+        w.u8(0);
+        const uint16_t points[3][2] = {{0, 0}, {16000, 8000}, {32767, 32767}};
+        for (const auto& p : points) {
+            w.u16(p[0]);
+            w.u16(p[1]);
+        }
+    }
+
+    w.b[6] = (uint8_t)w.b.size();
+    w.b[7] = (uint8_t)(w.b.size() >> 8);
+    const uint32_t crc = referenceChecksum(w.b);
+    memcpy(&w.b[8], &crc, 4);
+    return w.b;
+}
+
+static uint8_t imageBuffer[MAX_STORED_CONFIG_SIZE];
+
+// ConfigManager::loadFromStorage: a current image is used where it is mapped; an older one is
+// upgraded into the image buffer and saved back in the current layout
+static const StoredConfig* load(FlashLog& log, size_t* size) {
+    uint16_t n = 0;
+    const uint8_t* stored = log.find("CFG", 0, &n);
+    if (!stored) return nullptr;
+    const StoredConfig* config = reinterpret_cast<const StoredConfig*>(stored);
+    if (n >= sizeof(ConfigHeader) && config->header.version < CONFIG_VERSION) {
+        size_t upgradedSize = 0;
+        if (!ConfigConversion::upgradeStoredConfig(stored, n, imageBuffer, sizeof(imageBuffer), &upgradedSize)) {
+            return nullptr;
+        }
+        if (!log.append("CFG", imageBuffer, (uint16_t)upgradedSize)) return nullptr;
+        *size = upgradedSize;
+        return reinterpret_cast<const StoredConfig*>(imageBuffer);
+    }
+    if (!ConfigConversion::validateStoredConfig(config, n, false)) return nullptr;
+    *size = n;
+    return config;
+}
+
+// Stores image as the EEPROM import does, then mounts the log as the next boot does
+static void install(RamFlash& flash, const std::vector<uint8_t>& image, FlashLog& booted) {
+    FlashLog log(flash, 4);
+    TEST_ASSERT_TRUE(log.format());
+    TEST_ASSERT_TRUE(log.append("CFG", image.data(), (uint16_t)image.size()));
+    TEST_ASSERT_TRUE(booted.mount());
+}
+
+static void checkUpgraded(const StoredConfig* config, size_t size, uint16_t fromVersion) {
+    TEST_ASSERT_NOT_NULL(config);
+    TEST_ASSERT_EQUAL_UINT16(CONFIG_VERSION, config->header.version);
+    TEST_ASSERT_EQUAL_UINT16(size, config->header.size);
+    TEST_ASSERT_TRUE(ConfigConversion::validateStoredConfig(config, size));
+
+    TEST_ASSERT_EQUAL_HEX16(0x2E8A, config->usbDescriptor.vendorID);
+    TEST_ASSERT_EQUAL_HEX16(0xA02F, config->usbDescriptor.productID);
+    TEST_ASSERT_EQUAL_STRING("OpenSource", config->usbDescriptor.manufacturer);
+    TEST_ASSERT_EQUAL_STRING("JoyCore", config->usbDescriptor.product);
+    TEST_ASSERT_EQUAL_UINT8(3, config->pinMapCount);
+    TEST_ASSERT_EQUAL_UINT8(4, config->logicalInputCount);
+    TEST_ASSERT_EQUAL_UINT8(1, config->shiftRegCount);
+    TEST_ASSERT_EQUAL_UINT8(fromVersion >= 8 ? 1 : 0, config->curveCount);
+
+    for (uint8_t i = 0; i < 8; i++) {
+        const StoredAxisConfig& a = config->axes[i];
+        TEST_ASSERT_EQUAL_UINT8(i < 2, a.enabled);
+        TEST_ASSERT_EQUAL_UINT8(26 + i, a.pin);
+        TEST_ASSERT_EQUAL_UINT16(axisMin(i), a.minValue);
+        TEST_ASSERT_EQUAL_UINT16(axisMax(i), a.maxValue);
+        TEST_ASSERT_EQUAL_UINT8(1, a.filterLevel);
+        TEST_ASSERT_EQUAL_UINT16(300, a.ewmaAlpha);
+        TEST_ASSERT_EQUAL_UINT16(i, a.deadband);
+        TEST_ASSERT_EQUAL_UINT8(i == 1 ? 3 : 0, a.curve);
+        TEST_ASSERT_EQUAL_UINT8(fromVersion >= 8 ? 10 : 0, a.adcRate);
+        TEST_ASSERT_EQUAL_UINT8(fromVersion >= 8 ? 2 : 0, a.adcOversample);
+        // Parameters an older entry lacks read as 0 (firmware default)
+        TEST_ASSERT_EQUAL_UINT16(fromVersion >= 9 ? 150 : 0, a.minCutoff);
+        TEST_ASSERT_EQUAL_UINT16(fromVersion >= 9 ? 700 : 0, a.beta);
+        TEST_ASSERT_EQUAL_UINT8(fromVersion >= 9 ? 12 : 0, a.dCutoff);
+        TEST_ASSERT_EQUAL_UINT8(0, a.reserved[0]);
+    }
+
+    const uint8_t* image = reinterpret_cast<const uint8_t*>(config);
+    TEST_ASSERT_EQUAL_UINT32(0, configImageLogicalInputsOffset(*config) % 4);
+    TEST_ASSERT_EQUAL_UINT32(0, configImageCurvesOffset(*config) % 4);
+    const StoredPinMapEntry* pins = reinterpret_cast<const StoredPinMapEntry*>(image + configImagePinMapOffset(*config));
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_STRING(PIN_NAMES[i], pins[i].name);
+        TEST_ASSERT_EQUAL_UINT8(i < 2 ? BTN : SHIFTREG_QH, pins[i].type);
+    }
+
+    const LogicalInput* inputs = reinterpret_cast<const LogicalInput*>(image + configImageLogicalInputsOffset(*config));
+    TEST_ASSERT_EQUAL_UINT8(INPUT_PIN, inputs[0].type);
+    TEST_ASSERT_EQUAL_UINT8(2, inputs[0].u.pin.pin);
+    TEST_ASSERT_EQUAL_UINT8(1, inputs[0].u.pin.joyButtonID);
+    TEST_ASSERT_EQUAL_UINT8(NORMAL, inputs[0].u.pin.behavior);
+    TEST_ASSERT_EQUAL_UINT8(0, inputs[0].u.pin.reverse);
+    TEST_ASSERT_EQUAL_UINT8(3, inputs[1].u.pin.pin);
+    TEST_ASSERT_EQUAL_UINT8(MOMENTARY, inputs[1].u.pin.behavior);
+    TEST_ASSERT_EQUAL_UINT8(1, inputs[1].u.pin.reverse);
+    TEST_ASSERT_EQUAL_UINT8(INPUT_MATRIX, inputs[2].type);
+    TEST_ASSERT_EQUAL_UINT8(1, inputs[2].u.matrix.row);
+    TEST_ASSERT_EQUAL_UINT8(2, inputs[2].u.matrix.col);
+    TEST_ASSERT_EQUAL_UINT8(3, inputs[2].u.matrix.joyButtonID);
+    TEST_ASSERT_EQUAL_UINT8(INPUT_SHIFTREG, inputs[3].type);
+    TEST_ASSERT_EQUAL_UINT8(0, inputs[3].u.shiftreg.regIndex);
+    TEST_ASSERT_EQUAL_UINT8(5, inputs[3].u.shiftreg.bitIndex);
+    TEST_ASSERT_EQUAL_UINT8(ENC_A, inputs[3].u.shiftreg.behavior);
+    TEST_ASSERT_EQUAL_UINT8(FOUR0, inputs[3].encoderLatchMode);
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, inputs[i].encoderPressMs);
+        TEST_ASSERT_EQUAL_UINT8(0, inputs[i].encoderReleaseMs);
+        TEST_ASSERT_EQUAL_UINT8(0, inputs[i].encoderFlags);
+    }
+
+    if (fromVersion >= 8) {
+        const StoredCurveHeader* curve = reinterpret_cast<const StoredCurveHeader*>(image + configImageCurvesOffset(*config));
+        TEST_ASSERT_EQUAL_UINT8(1, curve->axis);
+        TEST_ASSERT_EQUAL_UINT8(CURVE_FLAG_SMOOTH, curve->flags);
+        TEST_ASSERT_EQUAL_UINT8(3, curve->pointCount);
+        const StoredCurvePoint* points = reinterpret_cast<const StoredCurvePoint*>(curve + 1);
+        TEST_ASSERT_EQUAL_UINT16(16000, points[1].x);
+        TEST_ASSERT_EQUAL_UINT16(8000, points[1].y);
+    }
+}
+
+// Upgrades once; the saved current image is then used in place without another conversion
+static void checkBootsFrom(uint16_t version) {
+    RamFlash flash(4);
+    FlashLog log(flash, 4);
+    install(flash, legacyImage(version), log);
+    size_t size = 0;
+    const StoredConfig* config = load(log, &size);
+    checkUpgraded(config, size, version);
+    TEST_ASSERT_TRUE(config == reinterpret_cast<const StoredConfig*>(imageBuffer));
+    std::vector<uint8_t> upgraded(imageBuffer, imageBuffer + size);
+
+    memset(imageBuffer, 0, sizeof(imageBuffer));
+    FlashLog next(flash, 4);
+    TEST_ASSERT_TRUE(next.mount());
+    size_t nextSize = 0;
+    const StoredConfig* inPlace = load(next, &nextSize);
+    TEST_ASSERT_NOT_NULL(inPlace);
+    TEST_ASSERT_TRUE(inPlace != reinterpret_cast<const StoredConfig*>(imageBuffer));
+    TEST_ASSERT_EQUAL_UINT32(size, nextSize);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(upgraded.data(), inPlace, size);
+}
+
+void test_boots_from_version_7() {
+    checkBootsFrom(7);
+}
+
+void test_boots_from_version_8() {
+    checkBootsFrom(8);
+}
+
+void test_boots_from_version_9() {
+    checkBootsFrom(9);
+}
+
+// A damaged or unknown image fails to load, so the loader falls back to the backup or defaults
+static void checkRejected(const std::vector<uint8_t>& image) {
+    RamFlash flash(4);
+    FlashLog log(flash, 4);
+    install(flash, image, log);
+    size_t size = 0;
+    TEST_ASSERT_NULL(load(log, &size));
+}
+
+void test_rejects_damaged_and_unknown_images() {
+    std::vector<uint8_t> image = legacyImage(7);
+    image[230] ^= 0x01;  // in the pin map
+    checkRejected(image);
+
+    image = legacyImage(7);
+    image.pop_back();  // shorter than header.size
+    checkRejected(image);
+
+    image = legacyImage(8);
+    image[image.size() - 14] = 40;  // curve pointCount past MAX_CURVE_POINTS
+    const uint32_t crc = referenceChecksum(image);
+    memcpy(&image[8], &crc, 4);
+    checkRejected(image);
+
+    image = legacyImage(7);
+    image[4] = 6;  // version before the supported layouts
+    checkRejected(image);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_boots_from_version_7);
+    RUN_TEST(test_boots_from_version_8);
+    RUN_TEST(test_boots_from_version_9);
+    RUN_TEST(test_rejects_damaged_and_unknown_images);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host stress test for the core1 -> core0 scan hand-off (SeqlockDoubleBuffer<ScanSnapshot>).
+//
+// The two RP2040 cores are modelled as std::threads: a scan thread publishes snapshots back to
+// back, every field derived from the snapshot number, while a USB thread takes the newest one,
+// checks it is neither torn nor older than the previous one, and diffs/"sends" it the way
+// TinyUSBGamepad::commitReport does. The USB thread also stalls now and then (flash write, slow
+// serial command) to show the scan thread never waits for it.
+// Run with: pio test -e native -f native/test_core_handoff -v
+// Under ThreadSanitizer: pio test -e native_tsan -v
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "utils/SeqlockDoubleBuffer.h"
+#include "inputs/ScanSnapshot.h"
+
+static uint32_t mix(uint32_t n, uint32_t salt) {
+    uint32_t x = n * 0x9E3779B1u + salt * 0x85EBCA77u;
+    x ^= x >> 15; x *= 0x2C1B3C6Du; x ^= x >> 12;
+    return x;
+}
+
+// Scan thread's output for cycle n; every byte depends on n
+static void fillSnapshot(ScanSnapshot& s, uint32_t n) {
+    s.gpio = mix(n, 1) & 0x3FFFFFFFu;
+    s.scanUs = n;
+    for (uint8_t w = 0; w < SCAN_SNAPSHOT_MATRIX_WORDS; w++) s.matrixRawBits[w] = mix(n, 10 + w);
+    for (uint8_t i = 0; i < 16; i++) s.report.buttons[i] = (uint8_t)mix(n, 30 + i);
+    for (uint8_t a = 0; a < 16; a++) s.report.axes[a] = (int16_t)(mix(n, 50 + a) % 65535 - 32767);
+    s.report.frameCounter = 0;
+    s.matrixRows = 15;
+    s.matrixCols = 15;
+    s.shiftRegCount = (uint8_t)(n % SCAN_SNAPSHOT_SHIFTREG_MAX);
+    s.reserved = 0;
+    for (uint8_t i = 0; i < SCAN_SNAPSHOT_SHIFTREG_MAX; i++) s.shiftRegs[i] = (uint8_t)mix(n, 70 + i);
+}
+
+static bool snapshotIntact(const ScanSnapshot& s) {
+    ScanSnapshot expect;
+    memset(&expect, 0, sizeof(expect));
+    fillSnapshot(expect, s.scanUs);
+    return memcmp(&expect.report, &s.report, sizeof(s.report)) == 0 &&
+           memcmp(expect.matrixRawBits, s.matrixRawBits, sizeof(s.matrixRawBits)) == 0 &&
+           memcmp(expect.shiftRegs, s.shiftRegs, sizeof(s.shiftRegs)) == 0 &&
+           expect.gpio == s.gpio && expect.shiftRegCount == s.shiftRegCount &&
+           expect.matrixRows == s.matrixRows && expect.matrixCols == s.matrixCols;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_single_thread_sequence() {
+    SeqlockDoubleBuffer<ScanSnapshot> handoff;
+    ScanSnapshot in, out;
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+    uint32_t seq = 0;
+    TEST_ASSERT_FALSE(handoff.readNewer(out, seq)); // nothing published yet
+
+    for (uint32_t n = 1; n <= 5; n++) { fillSnapshot(in, n); handoff.publish(in); }
+    TEST_ASSERT_EQUAL_UINT32(5, handoff.published());
+    TEST_ASSERT_TRUE(handoff.readNewer(out, seq)); // only the newest is returned
+    TEST_ASSERT_EQUAL_UINT32(5, seq);
+    TEST_ASSERT_EQUAL_UINT32(5, out.scanUs);
+    TEST_ASSERT_TRUE(snapshotIntact(out));
+    TEST_ASSERT_FALSE(handoff.readNewer(out, seq)); // nothing newer
+    TEST_ASSERT_EQUAL_UINT32(5, out.scanUs);        // previous copy kept
+}
+
+void test_two_threads_no_torn_or_stale_snapshots() {
+    static SeqlockDoubleBuffer<ScanSnapshot> handoff;
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> scans(0);
+    const uint32_t SCANS = 400000;
+
+    // core1: scan loop, publishes every cycle and never waits
+    std::thread core1([&]() {
+        ScanSnapshot s;
+        memset(&s, 0, sizeof(s));
+        for (uint32_t n = 1; n <= SCANS; n++) {
+            fillSnapshot(s, n);
+            handoff.publish(s);
+            scans.store(n, std::memory_order_relaxed);
+            if ((n & 1023) == 0) std::this_thread::yield();
+        }
+        stop.store(true, std::memory_order_release);
+    });
+
+    // core0: USB / serial loop
+    uint32_t seq = 0, taken = 0, torn = 0, backwards = 0, sent = 0, stallsWithProgress = 0, stalls = 0;
+    uint32_t lastNumber = 0;
+    ScanSnapshot latest;
+    memset(&latest, 0, sizeof(latest));
+    joycore_gamepad_report_t prevSent;
+    memset(&prevSent, 0, sizeof(prevSent));
+    for (uint32_t loop = 0; ; loop++) {
+        const bool done = stop.load(std::memory_order_acquire);
+        if (handoff.readNewer(latest, seq)) {
+            taken++;
+            if (!snapshotIntact(latest) || latest.scanUs != seq) torn++;
+            if (latest.scanUs <= lastNumber) backwards++;
+            lastNumber = latest.scanUs;
+            if (gamepadReportDiffMask(latest.report, prevSent)) { prevSent = latest.report; sent++; }
+        }
+        if (done && seq == handoff.published()) break;
+        if (!done && loop % 5000 == 4999) {
+            // Slow serial command / flash write on core0: the scan keeps going meanwhile
+            const uint32_t before = scans.load(std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            stalls++;
+            if (scans.load(std::memory_order_relaxed) != before) stallsWithProgress++;
+        }
+    }
+    core1.join();
+
+    printf("  %u scans published, %u taken by core0, %u reports sent, scan progressed during %u/%u core0 stalls\n",
+           SCANS, taken, sent, stallsWithProgress, stalls);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, backwards);
+    TEST_ASSERT_EQUAL_UINT32(SCANS, seq); // the final scan always reaches core0
+    TEST_ASSERT_TRUE(taken > 0);
+    if (stalls) TEST_ASSERT_TRUE(stallsWithProgress > 0);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_thread_sequence);
+    RUN_TEST(test_two_threads_no_torn_or_stale_snapshots);
+    return UNITY_END();
+}
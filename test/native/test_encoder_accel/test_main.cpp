@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for encoder acceleration (ENCODER_FLAG_ACCEL, EncoderAccel.h).
+//
+// Checks the factor curve, that fractional factors are carried instead of rounded away, that a
+// reversal starts at one step per detent, and measures how many detents it takes to move an
+// altitude bug by 10000 ft (100 ft per step) at different spin rates with the default curve.
+// Run with: pio test -e native -f native/test_encoder_accel -v
+#include <unity.h>
+#include <stdio.h>
+#include "inputs/encoders/EncoderAccel.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const EncoderAccelCurve kCurve = {20, 200, 8}; // ConfigDigital.h defaults
+
+void test_factor_curve() {
+    TEST_ASSERT_EQUAL_UINT32(256, encoderAccelFactorQ8(kCurve, 0));        // no previous latch
+    TEST_ASSERT_EQUAL_UINT32(256, encoderAccelFactorQ8(kCurve, 1000000));  // 1 detent/s
+    TEST_ASSERT_EQUAL_UINT32(256, encoderAccelFactorQ8(kCurve, 50000));    // 20 detents/s
+    TEST_ASSERT_EQUAL_UINT32(8 * 256, encoderAccelFactorQ8(kCurve, 5000)); // 200 detents/s
+    TEST_ASSERT_EQUAL_UINT32(8 * 256, encoderAccelFactorQ8(kCurve, 100));
+    // 110 detents/s is halfway: 1 + 7/2
+    TEST_ASSERT_UINT32_WITHIN(2, 256 * 9 / 2, encoderAccelFactorQ8(kCurve, 1000000 / 110));
+    uint32_t prev = 0;
+    for (uint32_t us = 100000; us >= 1000; us -= 500) {
+        uint32_t f = encoderAccelFactorQ8(kCurve, us);
+        TEST_ASSERT_TRUE(f >= prev);
+        prev = f;
+    }
+    const EncoderAccelCurve off = {20, 200, 1};
+    TEST_ASSERT_EQUAL_UINT32(256, encoderAccelFactorQ8(off, 1000));
+}
+
+void test_fraction_carry_and_reversal() {
+    EncoderAccel a;
+    // 27 detents/s is halfway up a 20-34 detents/s ramp to 2x: factor 1.5, 3 steps per 2 detents
+    const EncoderAccelCurve c = {20, 34, 2};
+    const uint32_t us = 1000000 / 27;
+    int32_t total = 0;
+    for (int i = 0; i < 100; i++) total += encoderAccelApply(a, c, 1, us);
+    TEST_ASSERT_INT32_WITHIN(1, 150, total);
+
+    // Reversal drops the carried fraction and starts at one step per detent
+    EncoderAccel b;
+    encoderAccelApply(b, c, 1, us);
+    TEST_ASSERT_EQUAL_INT32(-1, encoderAccelApply(b, c, -1, 0));
+    TEST_ASSERT_EQUAL_INT32(0, encoderAccelApply(b, c, 0, us));
+
+    // Several detents latched in one cycle
+    EncoderAccel m;
+    TEST_ASSERT_EQUAL_INT32(-24, encoderAccelApply(m, kCurve, -3, 2000));
+}
+
+// Altitude bug from 0 to 10000 ft at 100 ft per step
+void test_altitude_bug_detents() {
+    const uint32_t RATES[] = {10, 60, 120, 250};
+    for (uint32_t rate : RATES) {
+        EncoderAccel a;
+        const uint32_t interval = 1000000 / rate;
+        uint32_t detents = 0;
+        int32_t steps = 0;
+        while (steps < 100) { steps += encoderAccelApply(a, kCurve, 1, detents ? interval : 0); detents++; }
+        printf("  %3u detents/s: %3u detents (%u without acceleration)\n", rate, detents, 100u);
+        if (rate <= kCurve.slowRate) TEST_ASSERT_EQUAL_UINT32(100, detents);
+        else TEST_ASSERT_TRUE(detents < 100);
+        // The first detent has no previous latch and counts once
+        if (rate >= kCurve.fastRate) TEST_ASSERT_TRUE(detents <= 100u / kCurve.maxFactor + 2);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_factor_curve);
+    RUN_TEST(test_fraction_carry_and_reversal);
+    RUN_TEST(test_altitude_bug_detents);
+    return UNITY_END();
+}
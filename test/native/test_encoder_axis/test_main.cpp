@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for encoder-to-axis output (ENC_AXIS_A, EncoderAxis.h).
+//
+// Checks the axis number mapping, wrap and clamp at the report range ends, that relative mode
+// settles in proportion to the turn rate and returns to center, and compares how long a fast
+// spin takes to reach the host as an axis versus as 40/40 ms button pulses.
+// Run with: pio test -e native -f native/test_encoder_axis -v
+#include <unity.h>
+#include <stdio.h>
+#include "inputs/encoders/EncoderAxis.h"
+#include "inputs/encoders/EncoderSchedule.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_axis_numbers() {
+    TEST_ASSERT_EQUAL_INT8(-1, encoderAxisIndex(0));
+    TEST_ASSERT_EQUAL_INT8(-1, encoderAxisIndex(8));  // analog axes stay untouched
+    TEST_ASSERT_EQUAL_INT8(8, encoderAxisIndex(9));
+    TEST_ASSERT_EQUAL_INT8(15, encoderAxisIndex(16));
+    TEST_ASSERT_EQUAL_INT8(-1, encoderAxisIndex(17));
+}
+
+void test_wrap_and_clamp() {
+    EncoderAxis w, c;
+    encoderAxisInit(w, ENCODER_AXIS_WRAP, 512, 0);
+    encoderAxisInit(c, ENCODER_AXIS_CLAMP, 512, 0);
+    TEST_ASSERT_EQUAL_INT16(512, encoderAxisStep(w, 1, 0));
+    TEST_ASSERT_EQUAL_INT16(0, encoderAxisStep(w, -1, 0));
+    // 128 detents of 512 = 65536 = one full span (65535) plus one unit
+    TEST_ASSERT_EQUAL_INT16(1, encoderAxisStep(w, 128, 0));
+    TEST_ASSERT_EQUAL_INT16(0, encoderAxisStep(w, -128, 0));
+    TEST_ASSERT_EQUAL_INT16(32255, encoderAxisStep(w, -65, 0)); // -33280 wraps past -32767
+
+    TEST_ASSERT_EQUAL_INT16(32767, encoderAxisStep(c, 1000, 0));
+    TEST_ASSERT_EQUAL_INT16(32767 - 512, encoderAxisStep(c, -1, 0)); // turning back responds at once
+    TEST_ASSERT_EQUAL_INT16(-32767, encoderAxisStep(c, -1000, 0));
+}
+
+void test_relative_tracks_rate() {
+    const uint32_t SCAN_US = 250, DECAY_US = 250000;
+    const uint32_t RATES[] = {8, 32, 64};
+    for (uint32_t r : RATES) {
+        EncoderAxis a;
+        encoderAxisInit(a, ENCODER_AXIS_RELATIVE, 64, DECAY_US);
+        const uint32_t period = 1000000u / r;
+        int16_t v = 0;
+        int32_t lo = 32767, hi = -32767;
+        for (uint32_t t = 0; t < 3000000; t += SCAN_US) {
+            v = encoderAxisStep(a, (t % period) < SCAN_US ? 1 : 0, t);
+            if (t > 2000000) { if (v < lo) lo = v; if (v > hi) hi = v; }
+        }
+        // Settles around r * step * decay
+        const int32_t expect = (int32_t)(r * 64 * (DECAY_US / 1000)) / 1000;
+        printf("  relative at %u detents/s: %d..%d (r*step*decay = %d)\n", r, (int)lo, (int)hi, (int)expect);
+        TEST_ASSERT_TRUE(lo <= expect && hi >= expect);
+        TEST_ASSERT_TRUE(hi - lo <= 64 + 2);
+
+        // Released knob returns to center
+        uint32_t t = 3000000;
+        for (uint32_t n = 0; n < 40000 && v; n++, t += SCAN_US) v = encoderAxisStep(a, 0, t);
+        TEST_ASSERT_EQUAL_INT16(0, v);
+    }
+}
+
+// 48 detents spun in 200 ms: when the host has seen all of them
+void test_axis_versus_pulses() {
+    const uint32_t SCAN_US = 250, DETENTS = 48, SPIN_US = 200000;
+    EncoderAxis axis;
+    encoderAxisInit(axis, ENCODER_AXIS_CLAMP, 512, 0);
+    static EncoderSchedule pulses;
+    encoderScheduleInit(pulses, 40000, 40000, false);
+
+    uint32_t axisDoneUs = 0, pulseDoneUs = 0, sent = 0, pressed = 0;
+    for (uint32_t t = 0; t < 10000000 && !(axisDoneUs && pulseDoneUs); t += SCAN_US) {
+        const uint32_t due = (uint32_t)(((uint64_t)t * DETENTS) / SPIN_US);
+        const int32_t d = (int32_t)((due > DETENTS ? DETENTS : due) - sent);
+        sent += d;
+        const int16_t v = encoderAxisStep(axis, d, t);
+        if (!axisDoneUs && v == (int16_t)(DETENTS * 512)) axisDoneUs = t;
+        encoderScheduleAdd(pulses, d);
+        encoderScheduleStep(pulses, t, [&](EncoderDirection, bool p) { pressed += p; });
+        if (!pulseDoneUs && pressed == DETENTS) pulseDoneUs = t;
+    }
+    printf("  %u detents in %u ms reach the host after: axis %u ms, 40/40 ms pulses %u ms\n",
+           DETENTS, SPIN_US / 1000, axisDoneUs / 1000, pulseDoneUs / 1000);
+    TEST_ASSERT_TRUE(axisDoneUs <= SPIN_US);
+    TEST_ASSERT_TRUE(pulseDoneUs > 10 * SPIN_US);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_axis_numbers);
+    RUN_TEST(test_wrap_and_clamp);
+    RUN_TEST(test_relative_tracks_rate);
+    RUN_TEST(test_axis_versus_pulses);
+    return UNITY_END();
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the encoder step -> button pulse scheduler (EncoderSchedule.h).
+//
+// Drives the scheduler once per 250 us scan cycle and samples the button state the way the host
+// does, once per 1 ms poll. Checks that every queued detent becomes exactly one pulse the host
+// can see, that timing is clamped to the 2 ms floor, that overflow is counted, and compares how
+// long a fast spin takes to play back with and without burst mode.
+// Run with: pio test -e native -f native/test_encoder_schedule -v
+#include <unity.h>
+#include <stdio.h>
+#include "inputs/encoders/EncoderSchedule.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t SCAN_US = 250;
+static const uint32_t POLL_US = 1000;
+
+// Button levels as seen by the scheduler and by a host polling every POLL_US
+struct HostModel {
+    bool cw = false, ccw = false;
+    bool seenCw = false, seenCcw = false;
+    uint32_t pulsesCw = 0, pulsesCcw = 0;     // pressed edges the host observed
+    uint32_t firmwareCw = 0, firmwareCcw = 0; // presses the scheduler issued
+    bool overlap = false;                     // both buttons observed pressed at once
+
+    void set(EncoderDirection d, bool pressed) {
+        if (d == ENCODER_DIR_CW) { if (pressed && !cw) firmwareCw++; cw = pressed; }
+        else { if (pressed && !ccw) firmwareCcw++; ccw = pressed; }
+    }
+    void poll() {
+        if (cw && !seenCw) pulsesCw++;
+        if (ccw && !seenCcw) pulsesCcw++;
+        if (cw && ccw) overlap = true;
+        seenCw = cw;
+        seenCcw = ccw;
+    }
+};
+
+// Runs until the queue is empty and the last pulse is released; returns elapsed microseconds
+static uint32_t runUntilIdle(EncoderSchedule& s, HostModel& host, uint32_t startUs = 0) {
+    uint32_t elapsed = 0;
+    for (; elapsed < 600000000u; elapsed += SCAN_US) {
+        encoderScheduleStep(s, startUs + elapsed, [&](EncoderDirection d, bool p) { host.set(d, p); });
+        if (elapsed % POLL_US == 0) host.poll();
+        if (!s.pressed && !s.pendingCw && !s.pendingCcw) break;
+    }
+    host.poll();
+    return elapsed;
+}
+
+void test_timing_bounds() {
+    TEST_ASSERT_EQUAL_UINT32(40000, encoderStateUs(0, 40));
+    TEST_ASSERT_EQUAL_UINT32(2000, encoderStateUs(1, 40));
+    TEST_ASSERT_EQUAL_UINT32(2000, encoderStateUs(0, 0));
+    TEST_ASSERT_EQUAL_UINT32(15000, encoderStateUs(15, 40));
+    TEST_ASSERT_EQUAL_UINT32(255000, encoderStateUs(255, 40));
+}
+
+void test_every_step_reaches_the_host() {
+    // Shortest allowed timing: each state still spans two host polls
+    static EncoderSchedule s;
+    encoderScheduleInit(s, encoderStateUs(1, 0), encoderStateUs(1, 0), false);
+    HostModel host;
+    encoderScheduleAdd(s, 300);
+    runUntilIdle(s, host);
+    TEST_ASSERT_EQUAL_UINT32(300, host.firmwareCw);
+    TEST_ASSERT_EQUAL_UINT32(300, host.pulsesCw);
+    TEST_ASSERT_EQUAL_UINT32(300, s.steps.load());
+    TEST_ASSERT_EQUAL_UINT32(0, s.overflow.load());
+    TEST_ASSERT_EQUAL_UINT32(300, s.maxBacklog.load());
+}
+
+void test_direction_change() {
+    static EncoderSchedule s;
+    encoderScheduleInit(s, 10000, 10000, false);
+    HostModel host;
+    encoderScheduleAdd(s, 3);
+    encoderScheduleAdd(s, -2);
+    runUntilIdle(s, host);
+    TEST_ASSERT_EQUAL_UINT32(3, host.pulsesCw);
+    TEST_ASSERT_EQUAL_UINT32(2, host.pulsesCcw);
+    TEST_ASSERT_FALSE(host.overlap);
+    TEST_ASSERT_FALSE(host.cw || host.ccw);
+}
+
+void test_overflow_is_counted() {
+    static EncoderSchedule s;
+    encoderScheduleInit(s, 2000, 2000, false);
+    encoderScheduleAdd(s, 60000);
+    encoderScheduleAdd(s, 10000);
+    encoderScheduleAdd(s, -5);
+    TEST_ASSERT_EQUAL_UINT16(ENCODER_MAX_PENDING, s.pendingCw);
+    TEST_ASSERT_EQUAL_UINT16(5, s.pendingCcw);
+    TEST_ASSERT_EQUAL_UINT32(70000 - ENCODER_MAX_PENDING, s.overflow.load());
+    TEST_ASSERT_EQUAL_UINT32(ENCODER_MAX_PENDING + 5, s.steps.load());
+    TEST_ASSERT_EQUAL_UINT32(ENCODER_MAX_PENDING + 5, s.maxBacklog.load());
+}
+
+// A fast 48-detent spin at the 40/40 ms default: normal playback versus burst
+void test_burst_drains_backlog() {
+    const uint32_t DETENTS = 48;
+    static EncoderSchedule normal, burst;
+    encoderScheduleInit(normal, 40000, 40000, false);
+    encoderScheduleInit(burst, 40000, 40000, true);
+    HostModel hn, hb;
+    encoderScheduleAdd(normal, DETENTS);
+    encoderScheduleAdd(burst, DETENTS);
+    const uint32_t tn = runUntilIdle(normal, hn);
+    const uint32_t tb = runUntilIdle(burst, hb);
+    printf("  %u detents at 40/40 ms: normal %u ms, burst %u ms\n", DETENTS, tn / 1000, tb / 1000);
+    TEST_ASSERT_EQUAL_UINT32(DETENTS, hn.pulsesCw);
+    TEST_ASSERT_EQUAL_UINT32(DETENTS, hb.pulsesCw);
+    TEST_ASSERT_TRUE(tb * 10 < tn);
+
+    // A single step still uses the configured timing in burst mode
+    HostModel h1;
+    encoderScheduleAdd(burst, 1);
+    runUntilIdle(burst, h1, 10000000);
+    TEST_ASSERT_EQUAL_UINT32(40000, burst.holdUs);
+}
+
+void test_timer_wrap() {
+    static EncoderSchedule s;
+    encoderScheduleInit(s, 2000, 2000, false);
+    HostModel host;
+    encoderScheduleAdd(s, -20);
+    runUntilIdle(s, host, 0xFFFFFFFFu - 30000); // micros() wraps halfway through
+    TEST_ASSERT_EQUAL_UINT32(20, host.pulsesCcw);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_timing_bounds);
+    RUN_TEST(test_every_step_reaches_the_host);
+    RUN_TEST(test_direction_change);
+    RUN_TEST(test_overflow_is_counted);
+    RUN_TEST(test_burst_drains_backlog);
+    RUN_TEST(test_timer_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,317 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the log-structured config store (FlashLog.h) on a simulated NOR flash.
+//
+// The simulator counts erases per sector, program operations and pages. It charges typical
+// W25Q16JV timings (0.4 ms per page program, 45 ms per sector erase) to report save latency. It
+// rejects nothing but counts any program that would have to set a cleared bit (NOR flash can
+// only clear bits). It can cut power after any page program or erase, leaving that operation
+// half done.
+// Checks versions and removal across a remount. Compares erases and latency per save with the
+// EEPROM emulation it replaces. Then cuts power at every flash operation of a run that wraps
+// the ring several times, and checks after each remount that nothing is lost or corrupted.
+// Last, runs saves one step at a time and checks that no step does more than one flash operation.
+// Run with: pio test -e native -f native/test_flash_log -v
+#include <unity.h>
+#include <stdio.h>
+#include <vector>
+#include "rp2040/storage/FlashLog.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct SimFlash : FlashLogMedium {
+    static constexpr double PAGE_MS = 0.4;
+    static constexpr double ERASE_MS = 45.0;
+
+    std::vector<uint8_t> mem;
+    std::vector<uint32_t> sectorErases;
+    uint32_t programs = 0, pages = 0, overwrites = 0;
+    double busyMs = 0;
+    long cutAfter = -1;  // page programs and erases left before power is lost, -1 = never
+    bool dead = false;
+
+    explicit SimFlash(uint8_t sectors) : mem(sectors * FLASH_LOG_SECTOR, 0xA5), sectorErases(sectors, 0) {}
+
+    // False once power is gone; the operation that hits the cut is left half done
+    bool powered(bool& half) {
+        half = false;
+        if (dead) return false;
+        if (cutAfter == 0) { dead = true; half = true; return false; }
+        if (cutAfter > 0) cutAfter--;
+        return true;
+    }
+    void reboot() { dead = false; cutAfter = -1; }
+
+    const uint8_t* map(uint32_t offset) const override { return &mem[offset]; }
+
+    bool erase(uint32_t offset) override {
+        bool half;
+        if (!powered(half)) {
+            if (half) memset(&mem[offset], 0xFF, FLASH_LOG_SECTOR / 2);
+            return false;
+        }
+        memset(&mem[offset], 0xFF, FLASH_LOG_SECTOR);
+        sectorErases[offset / FLASH_LOG_SECTOR]++;
+        busyMs += ERASE_MS;
+        return true;
+    }
+
+    bool program(uint32_t offset, uint32_t n, FlashLogFill fill, const void* ctx) override {
+        programs++;
+        uint8_t buf[FLASH_LOG_PAGE];
+        for (uint32_t p = 0; p < n; p++) {
+            fill(ctx, p, buf);
+            bool half;
+            const bool ok = powered(half);
+            const uint32_t bytes = ok ? FLASH_LOG_PAGE : half ? FLASH_LOG_PAGE / 3 : 0;
+            uint8_t* dst = &mem[offset + p * FLASH_LOG_PAGE];
+            for (uint32_t i = 0; i < bytes; i++) {
+                if ((dst[i] & buf[i]) != buf[i]) overwrites++;
+                dst[i] &= buf[i];
+            }
+            if (!ok) return false;
+            pages++;
+            busyMs += PAGE_MS;
+        }
+        return true;
+    }
+};
+
+// Payload of config version v
+static std::vector<uint8_t> configImage(uint32_t v, uint16_t size) {
+    std::vector<uint8_t> d(size);
+    for (uint16_t i = 0; i < size; i++) d[i] = (uint8_t)(v * 37 + i * 11 + (i >> 8));
+    return d;
+}
+
+static bool readsAs(const FlashLog& log, const char* key, uint8_t version, const std::vector<uint8_t>& want) {
+    uint16_t size = 0;
+    const uint8_t* p = log.find(key, version, &size);
+    return p && size == want.size() && memcmp(p, want.data(), size) == 0;
+}
+
+void test_versions_and_remove() {
+    SimFlash flash(4);
+    FlashLog log(flash, 4);
+    TEST_ASSERT_FALSE(log.mount()); // never formatted
+    TEST_ASSERT_TRUE(log.format());
+    TEST_ASSERT_TRUE(log.mount());
+    TEST_ASSERT_NULL(log.find("CFG", 0, nullptr));
+
+    for (uint32_t v = 1; v <= 3; v++) TEST_ASSERT_TRUE(log.append("CFG", configImage(v, 700).data(), 700));
+    TEST_ASSERT_TRUE(log.append("VER", (const uint8_t*)"0.1.0", 5));
+    TEST_ASSERT_TRUE(readsAs(log, "CFG", 0, configImage(3, 700)));
+    TEST_ASSERT_TRUE(readsAs(log, "CFG", 1, configImage(2, 700)));
+    TEST_ASSERT_EQUAL_UINT32(705, log.liveBytes());
+
+    FlashLog again(flash, 4);
+    TEST_ASSERT_TRUE(again.mount());
+    TEST_ASSERT_TRUE(readsAs(again, "CFG", 0, configImage(3, 700)));
+    TEST_ASSERT_TRUE(readsAs(again, "CFG", 1, configImage(2, 700)));
+
+    TEST_ASSERT_TRUE(again.remove("VER"));
+    TEST_ASSERT_FALSE(again.remove("VER"));
+    TEST_ASSERT_NULL(again.find("VER", 0, nullptr));
+    char keys[FLASH_LOG_MAX_KEYS][4];
+    TEST_ASSERT_EQUAL_UINT8(1, again.keys(keys, FLASH_LOG_MAX_KEYS));
+
+    // The removal survives a remount and collection of the sectors around it
+    for (uint32_t v = 4; v <= 20; v++) TEST_ASSERT_TRUE(again.append("CFG", configImage(v, 700).data(), 700));
+    FlashLog third(flash, 4);
+    TEST_ASSERT_TRUE(third.mount());
+    TEST_ASSERT_NULL(third.find("VER", 0, nullptr));
+    TEST_ASSERT_TRUE(readsAs(third, "CFG", 0, configImage(20, 700)));
+    TEST_ASSERT_TRUE(readsAs(third, "CFG", 1, configImage(19, 700)));
+    TEST_ASSERT_TRUE(third.append("VER", (const uint8_t*)"0.2.0", 5));
+    TEST_ASSERT_NULL(third.find("VER", 1, nullptr)); // no backup across a removal
+    TEST_ASSERT_EQUAL_UINT32(0, flash.overwrites);
+}
+
+// arduino-pico EEPROM.commit(): erase the 4 KB sector and program all of it back. A config save
+// through RP2040EEPROMStorage commits twice: once for the backup copy, once for the config.
+static void eepromSave(SimFlash& flash) {
+    static const uint8_t ram[FLASH_LOG_SECTOR] = {0};
+    for (int commit = 0; commit < 2; commit++) {
+        flash.erase(0);
+        flash.program(0, FLASH_LOG_SECTOR / FLASH_LOG_PAGE,
+                      [](const void* ctx, uint32_t page, uint8_t* out) {
+                          memcpy(out, (const uint8_t*)ctx + page * FLASH_LOG_PAGE, FLASH_LOG_PAGE);
+                      }, ram);
+    }
+}
+
+void test_wear_and_latency() {
+    const uint32_t SAVES = 2000;
+    const uint8_t SECTORS = 16;
+    const uint16_t SIZES[] = {600, 2048};
+
+    SimFlash eeprom(1);
+    for (uint32_t i = 0; i < SAVES; i++) eepromSave(eeprom);
+    printf("  EEPROM emulation: %.2f erases/save, all on 1 sector (%u erases), %.1f ms/save\n",
+           (double)eeprom.sectorErases[0] / SAVES, eeprom.sectorErases[0], eeprom.busyMs / SAVES);
+
+    for (uint16_t size : SIZES) {
+        SimFlash flash(SECTORS);
+        FlashLog log(flash, SECTORS);
+        TEST_ASSERT_TRUE(log.format());
+        for (uint8_t s = 0; s < SECTORS; s++) flash.sectorErases[s] = 0;
+        const uint32_t programs0 = flash.programs;
+        log.append("VER", (const uint8_t*)"0.1.0", 5);
+
+        double worstMs = 0;
+        const double busy0 = flash.busyMs;
+        for (uint32_t v = 1; v <= SAVES; v++) {
+            const uint32_t before = log.stats().programs;
+            const double t0 = flash.busyMs;
+            TEST_ASSERT_TRUE(log.append("CFG", configImage(v, size).data(), size));
+            const double ms = flash.busyMs - t0;
+            if (ms > worstMs) worstMs = ms;
+            // Only a save that collects the tail programs more than its own record
+            if (log.stats().programs - before > 1) TEST_ASSERT_TRUE(log.stats().relocated > 0);
+        }
+        TEST_ASSERT_TRUE(readsAs(log, "CFG", 0, configImage(SAVES, size)));
+        TEST_ASSERT_TRUE(readsAs(log, "CFG", 1, configImage(SAVES - 1, size)));
+
+        uint32_t lo = UINT32_MAX, hi = 0, total = 0;
+        for (uint32_t e : flash.sectorErases) { if (e < lo) lo = e; if (e > hi) hi = e; total += e; }
+        printf("  log, %4u-byte config: %.3f erases/save, per sector %u..%u, %.2f programs/save, "
+               "%.1f ms/save avg, %.1f ms worst\n",
+               size, (double)total / SAVES, lo, hi, (double)(flash.programs - programs0) / SAVES,
+               (flash.busyMs - busy0) / SAVES, worstMs);
+        // A sector is erased once per sector-full of records; a 2 KB config fills one by itself
+        const uint32_t perSector = FLASH_LOG_SECTOR / (flashLogRecordPages(size) * FLASH_LOG_PAGE);
+        TEST_ASSERT_TRUE(total <= SAVES / perSector + SECTORS);
+        TEST_ASSERT_TRUE(hi - lo <= 1);                        // erases spread over the ring
+        TEST_ASSERT_TRUE(hi * SECTORS < eeprom.sectorErases[0]); // per-sector wear, ring-size times lower
+        TEST_ASSERT_EQUAL_UINT32(0, flash.overwrites);
+    }
+}
+
+// Cuts power at every flash operation of a run that wraps a 4-sector ring several times
+void test_power_loss_recovery() {
+    const uint8_t SECTORS = 4;
+    const uint16_t SIZE = 1500; // two records per sector, so collection relocates live data
+    const uint32_t SAVES = 24;
+
+    // Flash operations of an uninterrupted run; those before each save's own record collect the tail
+    SimFlash probe(SECTORS);
+    std::vector<bool> inCollection;
+    {
+        FlashLog log(probe, SECTORS);
+        log.format();
+        const uint32_t formatOps = log.stats().erases;
+        auto opCount = [&]() { return log.stats().pages + log.stats().erases - formatOps; };
+        log.append("VER", (const uint8_t*)"0.1.0", 5);
+        inCollection.assign(opCount(), false);
+        for (uint32_t v = 1; v <= SAVES; v++) {
+            const uint32_t before = opCount();
+            log.append("CFG", configImage(v, SIZE).data(), SIZE);
+            const uint32_t own = flashLogRecordPages(SIZE);
+            for (uint32_t op = before; op < opCount(); op++) inCollection.push_back(op + own < opCount());
+        }
+    }
+    const long ops = (long)inCollection.size();
+
+    uint32_t cutsInCollection = 0;
+    for (long cut = 0; cut < ops; cut++) {
+        SimFlash flash(SECTORS);
+        uint32_t committed = 0; // newest version whose append returned
+        {
+            FlashLog log(flash, SECTORS);
+            log.format();
+            flash.cutAfter = cut;
+            bool ok = log.append("VER", (const uint8_t*)"0.1.0", 5);
+            for (uint32_t v = 1; ok && v <= SAVES; v++) {
+                ok = log.append("CFG", configImage(v, SIZE).data(), SIZE);
+                if (ok) committed = v;
+            }
+            if (ok) continue; // cut fell into format()
+        }
+        cutsInCollection += inCollection[cut];
+
+        flash.reboot();
+        FlashLog log(flash, SECTORS);
+        if (!log.mount()) {
+            // Only before the first record: nothing was stored yet
+            TEST_ASSERT_EQUAL_UINT32(0, committed);
+            continue;
+        }
+        // Either the save that was cut or the one before it, and the backup one version older
+        uint16_t size = 0;
+        const uint8_t* cur = log.find("CFG", 0, &size);
+        if (committed == 0 && !cur) continue;
+        TEST_ASSERT_NOT_NULL(cur);
+        const uint32_t v = readsAs(log, "CFG", 0, configImage(committed + 1, SIZE)) ? committed + 1 : committed;
+        TEST_ASSERT_TRUE(readsAs(log, "CFG", 0, configImage(v, SIZE)));
+        if (v > 1) TEST_ASSERT_TRUE(readsAs(log, "CFG", 1, configImage(v - 1, SIZE)));
+        TEST_ASSERT_TRUE(readsAs(log, "VER", 0, std::vector<uint8_t>{'0', '.', '1', '.', '0'}));
+
+        // The log keeps working without programming over used flash
+        for (uint32_t n = v + 1; n <= v + 12; n++) TEST_ASSERT_TRUE(log.append("CFG", configImage(n, SIZE).data(), SIZE));
+        FlashLog after(flash, SECTORS);
+        TEST_ASSERT_TRUE(after.mount());
+        TEST_ASSERT_TRUE(readsAs(after, "CFG", 0, configImage(v + 12, SIZE)));
+        TEST_ASSERT_TRUE(readsAs(after, "CFG", 1, configImage(v + 11, SIZE)));
+        TEST_ASSERT_EQUAL_UINT32(0, flash.overwrites);
+    }
+    printf("  %ld power cuts, %u during tail collection: no loss, no corruption\n", ops, cutsInCollection);
+    TEST_ASSERT_TRUE(cutsInCollection > 0);
+}
+
+// appendStep: one flash operation per call, reads stay valid between calls, and a config file
+// written synchronously in between (the version file at boot) is not disturbed
+void test_incremental_append() {
+    const uint8_t SECTORS = 4;
+    const uint16_t SIZE = 1500;
+    const uint32_t SAVES = 40;
+    SimFlash flash(SECTORS);
+    FlashLog log(flash, SECTORS);
+    TEST_ASSERT_TRUE(log.format());
+    TEST_ASSERT_TRUE(log.append("VER", (const uint8_t*)"0.1.0", 5));
+
+    double worstStepMs = 0, worstSaveMs = 0;
+    uint32_t maxSteps = 0;
+    for (uint32_t v = 1; v <= SAVES; v++) {
+        const std::vector<uint8_t> image = configImage(v, SIZE);
+        const double save0 = flash.busyMs;
+        uint32_t steps = 0;
+        FlashLogProgress p;
+        do {
+            const uint32_t ops0 = log.stats().erases + log.stats().programs;
+            const double t0 = flash.busyMs;
+            p = log.appendStep("CFG", image.data(), SIZE);
+            steps++;
+            TEST_ASSERT_TRUE(log.stats().erases + log.stats().programs - ops0 <= 1);
+            if (flash.busyMs - t0 > worstStepMs) worstStepMs = flash.busyMs - t0;
+            if (p != FlashLogProgress::BUSY) break;
+            // Between steps the previous config still reads back
+            TEST_ASSERT_TRUE(readsAs(log, "CFG", 0, configImage(v - 1, SIZE)) || v == 1);
+            if (v % 7 == 0 && steps == 1) {
+                TEST_ASSERT_TRUE(log.append("VER", (const uint8_t*)"0.1.1", 5));
+            }
+        } while (true);
+        TEST_ASSERT_TRUE(p == FlashLogProgress::DONE);
+        if (steps > maxSteps) maxSteps = steps;
+        if (flash.busyMs - save0 > worstSaveMs) worstSaveMs = flash.busyMs - save0;
+        TEST_ASSERT_TRUE(readsAs(log, "CFG", 0, image));
+    }
+    printf("  stepped save: up to %u steps, longest step %.1f ms (whole save up to %.1f ms)\n",
+           maxSteps, worstStepMs, worstSaveMs);
+    TEST_ASSERT_TRUE(maxSteps > 1);
+    TEST_ASSERT_TRUE(worstStepMs < SimFlash::ERASE_MS + SimFlash::PAGE_MS); // one erase, or one record program
+
+    FlashLog after(flash, SECTORS);
+    TEST_ASSERT_TRUE(after.mount());
+    TEST_ASSERT_TRUE(readsAs(after, "CFG", 0, configImage(SAVES, SIZE)));
+    TEST_ASSERT_TRUE(readsAs(after, "CFG", 1, configImage(SAVES - 1, SIZE)));
+    TEST_ASSERT_EQUAL_UINT32(0, flash.overwrites);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_versions_and_remove);
+    RUN_TEST(test_wear_and_latency);
+    RUN_TEST(test_power_loss_recovery);
+    RUN_TEST(test_incremental_append);
+    return UNITY_END();
+}
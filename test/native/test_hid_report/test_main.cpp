@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host benchmark for the per-cycle HID report transaction.
+//
+// Compares the legacy path (memcmp + possible send after every setButton/setAxis)
+// with beginReport()/commitReport() (one word-wise diff and at most one send per cycle).
+// Run with: pio test -e native -f native/test_hid_report -v
+#include <unity.h>
+#include <stdio.h>
+#include "rp2040/hid/GamepadReport.h"
+
+static constexpr uint32_t MIN_SEND_INTERVAL_US = 1000; // mirrors TinyUSBGamepad
+static constexpr uint32_t CYCLE_US = 230;              // simulated scan cycle
+static constexpr uint8_t BUTTONS = 30;
+static constexpr uint8_t AXES = 8;
+
+struct SimStats {
+    uint32_t byteCompares = 0; // bytes (legacy) or bytes covered by word compares (transaction)
+    uint32_t reports = 0;
+    uint32_t tornReports = 0;  // reports carrying only part of a chord
+};
+
+// Simulated input state for one scan cycle
+struct SimInputs {
+    bool buttons[BUTTONS];
+    int16_t axes[AXES];
+};
+
+static void setButtonBit(joycore_gamepad_report_t& r, uint8_t b, bool pressed) {
+    if (pressed) r.buttons[b / 8] |= (1 << (b % 8));
+    else r.buttons[b / 8] &= ~(1 << (b % 8));
+}
+
+static bool isTorn(const joycore_gamepad_report_t& sent, const uint8_t* chord, uint8_t chordLen) {
+    uint8_t set = 0;
+    for (uint8_t i = 0; i < chordLen; i++) {
+        if (sent.buttons[chord[i] / 8] & (1 << (chord[i] % 8))) set++;
+    }
+    return set != 0 && set != chordLen;
+}
+
+// Legacy behaviour: every setter compares the whole report and may send mid-update
+struct LegacyGamepad {
+    joycore_gamepad_report_t report{}, prev{};
+    uint32_t lastSend = 0;
+    bool everSent = false;
+    SimStats stats;
+    const uint8_t* chord = nullptr;
+    uint8_t chordLen = 0;
+
+    void trySend(uint32_t now) {
+        if (everSent && (now - lastSend) < MIN_SEND_INTERVAL_US) return;
+        report.frameCounter++;
+        if (isTorn(report, chord, chordLen)) stats.tornReports++;
+        prev = report; lastSend = now; everSent = true; stats.reports++;
+    }
+    void changed(uint32_t now) {
+        stats.byteCompares += sizeof(report);
+        if (memcmp(&report, &prev, sizeof(report)) != 0) trySend(now);
+    }
+    void cycle(const SimInputs& in, uint32_t now) {
+        for (uint8_t b = 0; b < BUTTONS; b++) { setButtonBit(report, b, in.buttons[b]); changed(now); }
+        for (uint8_t a = 0; a < AXES; a++) { report.axes[a] = in.axes[a]; changed(now); }
+        trySend(now); // sendState() at the end of InputManager::update
+    }
+};
+
+// Transactional behaviour: setters only write, commit diffs once
+struct TransactionGamepad {
+    joycore_gamepad_report_t report{}, prev{};
+    uint32_t lastSend = 0;
+    bool everSent = false;
+    SimStats stats;
+    const uint8_t* chord = nullptr;
+    uint8_t chordLen = 0;
+
+    void cycle(const SimInputs& in, uint32_t now) {
+        for (uint8_t b = 0; b < BUTTONS; b++) setButtonBit(report, b, in.buttons[b]);
+        for (uint8_t a = 0; a < AXES; a++) report.axes[a] = in.axes[a];
+        stats.byteCompares += GAMEPAD_REPORT_PAYLOAD_BYTES;
+        if (gamepadReportDiffMask(report, prev) == 0) return;
+        if (everSent && (now - lastSend) < MIN_SEND_INTERVAL_US) return;
+        report.frameCounter++;
+        if (isTorn(report, chord, chordLen)) stats.tornReports++;
+        prev = report; lastSend = now; everSent = true; stats.reports++;
+    }
+};
+
+static const uint8_t kChord[] = {3, 4, 17};
+static constexpr uint32_t CYCLES = 4000;
+static constexpr uint32_t CHANGE_EVERY = 101;
+static constexpr uint32_t PHYSICAL_CHANGES = CYCLES / CHANGE_EVERY;
+
+// One physical event every CHANGE_EVERY cycles: chord pressed/released together with an axis move
+template <typename Pad>
+static void runScenario(Pad& pad) {
+    pad.chord = kChord; pad.chordLen = sizeof(kChord);
+    SimInputs in{};
+    // Start from an already-sent idle state so only physical changes produce reports
+    pad.cycle(in, 0);
+    pad.stats = SimStats{};
+    for (uint32_t c = 1; c <= CYCLES; c++) {
+        if (c % CHANGE_EVERY == 0) {
+            bool press = !in.buttons[kChord[0]];
+            for (uint8_t i = 0; i < sizeof(kChord); i++) in.buttons[kChord[i]] = press;
+            in.axes[0] = press ? 12000 : -12000;
+        }
+        pad.cycle(in, c * CYCLE_US + 5000);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_diff_mask_word_layout() {
+    joycore_gamepad_report_t a{}, b{};
+    TEST_ASSERT_EQUAL_UINT16(0, gamepadReportDiffMask(a, b));
+    setButtonBit(b, 0, true);
+    TEST_ASSERT_EQUAL_UINT16(0x0001, gamepadReportDiffMask(a, b));
+    b = a; setButtonBit(b, 127, true);
+    TEST_ASSERT_EQUAL_UINT16(0x0008, gamepadReportDiffMask(a, b));
+    b = a; b.axes[0] = 1;
+    TEST_ASSERT_EQUAL_UINT16(0x0010, gamepadReportDiffMask(a, b));
+    b = a; b.axes[15] = -1;
+    TEST_ASSERT_EQUAL_UINT16(0x0800, gamepadReportDiffMask(a, b));
+    b = a; b.frameCounter = 99; // frame counter is not payload
+    TEST_ASSERT_EQUAL_UINT16(0, gamepadReportDiffMask(a, b));
+}
+
+void test_benchmark_before_after() {
+    LegacyGamepad legacy;
+    TransactionGamepad txn;
+    runScenario(legacy);
+    runScenario(txn);
+
+    printf("HID report benchmark (%u buttons, %u axes, %lu cycles, %lu physical changes)\n",
+           BUTTONS, AXES, (unsigned long)CYCLES, (unsigned long)PHYSICAL_CHANGES);
+    printf("  legacy      : %6.1f bytes compared/cycle, %.2f reports/change, %lu torn reports\n",
+           (double)legacy.stats.byteCompares / CYCLES, (double)legacy.stats.reports / PHYSICAL_CHANGES,
+           (unsigned long)legacy.stats.tornReports);
+    printf("  transaction : %6.1f bytes compared/cycle, %.2f reports/change, %lu torn reports\n",
+           (double)txn.stats.byteCompares / CYCLES, (double)txn.stats.reports / PHYSICAL_CHANGES,
+           (unsigned long)txn.stats.tornReports);
+
+    TEST_ASSERT_EQUAL_UINT32(PHYSICAL_CHANGES, txn.stats.reports);
+    TEST_ASSERT_EQUAL_UINT32(0, txn.stats.tornReports);
+    TEST_ASSERT_LESS_THAN(legacy.stats.byteCompares / 20, txn.stats.byteCompares);
+    TEST_ASSERT_GREATER_THAN(txn.stats.reports, legacy.stats.reports);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_diff_mask_word_layout);
+    RUN_TEST(test_benchmark_before_after);
+    return UNITY_END();
+}
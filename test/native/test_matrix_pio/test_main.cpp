@@ -0,0 +1,409 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the PIO matrix scanner (MatrixPio.h, MATRIX_BACKEND_PIO).
+//
+// MATRIX_PIO_PROGRAM runs on a cycle-level model of one RP2040 PIO state machine (4-deep
+// FIFOs, autopull/autopush, 1-cycle output and 2-cycle input synchronizer latency) wired to
+// two modelled DMA rings and a switch matrix whose rows take a number of cycles to recover
+// HIGH on their pull-ups. The tests check that the sample ring decodes to the pressed keys
+// (padding steps and scattered column pins included), that each column takes exactly
+// settle + 4 cycles, that a too-short settle smears keys into the next column, that a DMA
+// restart keeps samples paired with their columns, and report the full-matrix scan rate.
+// Run with: pio test -e native -f native/test_matrix_pio -v
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "inputs/buttons/MatrixPio.h"
+
+static constexpr uint32_t SYS_CLK_HZ = 125000000u;
+
+// One PIO state machine, enough of the ISA for JMP/IN/OUT/PUSH/PULL/MOV
+struct PioSmModel {
+    const uint16_t* prog = nullptr;
+    uint8_t wrapTarget = 0, wrap = 0;
+    uint8_t outBase = 0, outCount = 32, inBase = 0;
+    uint8_t pc = 0;
+    uint32_t x = 0, y = 0, osr = 0, isr = 0;
+    uint8_t osrShifted = 32, isrShifted = 0; // OSR starts empty
+    uint32_t pindirs = 0;                    // GPIO-wide, 1 = output
+    uint32_t txf[4] = {}, rxf[4] = {};
+    uint8_t txLevel = 0, rxLevel = 0;
+    uint64_t stallCycles = 0;
+
+    bool txPush(uint32_t v) { if (txLevel == 4) return false; txf[txLevel++] = v; return true; }
+    bool rxPop(uint32_t& v) {
+        if (!rxLevel) return false;
+        v = rxf[0];
+        memmove(rxf, rxf + 1, sizeof(uint32_t) * 3);
+        rxLevel--;
+        return true;
+    }
+    uint32_t txPop() { uint32_t v = txf[0]; memmove(txf, txf + 1, sizeof(uint32_t) * 3); txLevel--; return v; }
+
+    static uint32_t bits(uint8_t n) { return n == 0 || n >= 32 ? 0xFFFFFFFFu : (1u << n) - 1; }
+    void advance() { pc = (pc == wrap) ? wrapTarget : (uint8_t)(pc + 1); }
+    void autopull() { if (osrShifted >= 32 && txLevel) { osr = txPop(); osrShifted = 0; } }
+
+    // One clock; pads = GPIO levels after the input synchronizer
+    void step(uint32_t pads) {
+        const uint16_t ins = prog[pc];
+        const uint8_t op = ins >> 13;
+        const uint8_t arg = (ins >> 5) & 7;
+        const uint8_t low5 = ins & 31;
+        const uint8_t n = low5 ? low5 : 32;
+        switch (op) {
+        case 0: { // JMP
+            bool take = true;
+            switch (arg) {
+            case 1: take = x == 0; break;
+            case 2: take = x != 0; x--; break;
+            case 3: take = y == 0; break;
+            case 4: take = y != 0; y--; break;
+            case 5: take = x != y; break;
+            case 7: take = osrShifted < 32; break;
+            default: break;
+            }
+            if (take) pc = low5; else advance();
+            return;
+        }
+        case 2: { // IN (shift left, autopush at 32)
+            if (isrShifted + n >= 32 && rxLevel == 4) { stallCycles++; return; }
+            uint32_t data = 0;
+            if (arg == 0) data = (pads >> inBase) | (inBase ? pads << (32 - inBase) : 0);
+            else if (arg == 1) data = x;
+            else if (arg == 2) data = y;
+            data &= bits(n);
+            isr = (n == 32) ? data : (isr << n) | data;
+            isrShifted = (uint8_t)(isrShifted + n);
+            if (isrShifted >= 32) { rxf[rxLevel++] = isr; isr = 0; isrShifted = 0; }
+            advance();
+            return;
+        }
+        case 3: { // OUT (shift right, autopull at 32)
+            if (osrShifted >= 32) {
+                if (!txLevel) { stallCycles++; return; }
+                autopull();
+            }
+            const uint32_t data = osr & bits(n);
+            osr = (n == 32) ? 0 : osr >> n;
+            osrShifted = (uint8_t)(osrShifted + n);
+            if (arg == 1) x = data;
+            else if (arg == 2) y = data;
+            else if (arg == 4) {
+                const uint32_t span = bits(outCount) << outBase;
+                pindirs = (pindirs & ~span) | ((data << outBase) & span);
+            }
+            advance();
+            autopull(); // refills in the background once the OSR is empty
+            return;
+        }
+        case 4: { // PUSH / PULL (blocking)
+            if (ins & 0x80) {
+                if (!txLevel) { stallCycles++; return; }
+                osr = txPop(); osrShifted = 0;
+            } else {
+                if (rxLevel == 4) { stallCycles++; return; }
+                rxf[rxLevel++] = isr; isr = 0; isrShifted = 0;
+            }
+            advance();
+            return;
+        }
+        case 5: { // MOV
+            const uint8_t src = ins & 7;
+            uint32_t v = src == 0 ? pads : src == 1 ? x : src == 2 ? y : src == 6 ? isr : src == 7 ? osr : 0;
+            if (((ins >> 3) & 3) == 1) v = ~v;
+            if (arg == 1) x = v;
+            else if (arg == 2) y = v;
+            else if (arg == 6) { isr = v; isrShifted = 0; }
+            else if (arg == 7) { osr = v; osrShifted = 0; }
+            advance();
+            return;
+        }
+        default:
+            TEST_FAIL_MESSAGE("instruction not modelled");
+        }
+    }
+};
+
+// Switch matrix without diodes' sneak paths: row r is LOW while a pressed key in that row sits
+// on a driven column, and for recoverCycles after that column is released (pull-up RC).
+struct RcMatrixModel {
+    uint8_t rows = 0, cols = 0;
+    uint8_t rowPin[16] = {}, colPin[16] = {};
+    bool pressed[16][16] = {};
+    uint32_t recoverCycles = 0;
+    bool everPulled[16] = {};
+    uint64_t lastPulled[16] = {}; // last cycle row r was pulled LOW
+    uint64_t cycle = 0;
+
+    uint32_t levels(uint32_t pindirs) {
+        uint32_t v = 0xFFFFFFFFu;
+        for (uint8_t c = 0; c < cols; ++c) {
+            if (!(pindirs & (1u << colPin[c]))) continue;
+            v &= ~(1u << colPin[c]);
+            for (uint8_t r = 0; r < rows; ++r) {
+                if (pressed[r][c]) { lastPulled[r] = cycle; everPulled[r] = true; }
+            }
+        }
+        for (uint8_t r = 0; r < rows; ++r) {
+            if (everPulled[r] && cycle - lastPulled[r] <= recoverCycles) v &= ~(1u << rowPin[r]);
+        }
+        cycle++;
+        return v;
+    }
+};
+
+// SM + both DMA rings + matrix, advanced one system clock at a time
+struct ScanRig {
+    MatrixScanLayout layout;
+    MatrixPioPlan plan;
+    PioSmModel sm;
+    RcMatrixModel matrix;
+    uint32_t samples[MATRIX_SCAN_MAX_LINES];
+    uint32_t txIndex = 0, rxIndex = 0;       // ring positions
+    uint32_t txRemaining = 0, rxRemaining = 0;
+    uint64_t samplesTaken = 0;
+    uint64_t lastSampleCycle = 0, sampleInterval = 0;
+    uint32_t pads[3] = { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu }; // synchronizer stages
+
+    void init(const uint8_t* rowPins, uint8_t rows, const uint8_t* colPins, uint8_t cols,
+              uint32_t settleCycles, uint32_t recoverCycles, uint32_t dmaRun = 0xFFFFFFFFu) {
+        matrix = RcMatrixModel();
+        matrix.rows = rows; matrix.cols = cols; matrix.recoverCycles = recoverCycles;
+        memcpy(matrix.rowPin, rowPins, rows);
+        memcpy(matrix.colPin, colPins, cols);
+        matrixScanLayoutInit(layout, rowPins, colPins, rows, cols);
+        TEST_ASSERT_TRUE(matrixPioPlan(layout, plan));
+        sm = PioSmModel();
+        sm.prog = MATRIX_PIO_PROGRAM;
+        sm.wrapTarget = MATRIX_PIO_WRAP_TARGET;
+        sm.wrap = MATRIX_PIO_WRAP;
+        sm.outBase = plan.outBase;
+        sm.outCount = plan.outCount;
+        sm.inBase = 0;
+        for (uint32_t& s : samples) s = 0xFFFFFFFFu;
+        sm.txPush(settleCycles); // MatrixPioScanner::begin: pio_sm_put before the DMA starts
+        txIndex = rxIndex = 0;
+        txRemaining = rxRemaining = dmaRun;
+        samplesTaken = 0;
+        lastSampleCycle = sampleInterval = 0;
+    }
+
+    // MatrixPioScanner::startDma after the RX run has ended
+    void restartDma(uint32_t dmaRun) {
+        txIndex = rxIndex = 0;
+        txRemaining = rxRemaining = dmaRun;
+    }
+
+    void clock() {
+        // DMA: one transfer per channel per cycle when the DREQ allows it
+        if (txRemaining && sm.txPush(plan.columnWords[txIndex])) { txIndex = (txIndex + 1) & (plan.steps - 1); txRemaining--; }
+        uint32_t v;
+        if (rxRemaining && sm.rxPop(v)) {
+            samples[rxIndex] = v;
+            rxIndex = (rxIndex + 1) & (plan.steps - 1);
+            rxRemaining--;
+            samplesTaken++;
+            sampleInterval = matrix.cycle - lastSampleCycle;
+            lastSampleCycle = matrix.cycle;
+        }
+        // Pads see this cycle's pindirs (set by the previous cycle); `in` sees them 2 cycles late
+        pads[2] = pads[1];
+        pads[1] = pads[0];
+        pads[0] = matrix.levels(sm.pindirs);
+        sm.step(pads[2]);
+    }
+
+    void runSamples(uint64_t n) { const uint64_t target = samplesTaken + n; while (samplesTaken < target) clock(); }
+
+    void decode(uint32_t* raw, uint16_t words) { matrixPioExtract(layout, samples, raw, words); }
+
+    void expected(uint32_t* raw, uint16_t words) const {
+        for (uint16_t w = 0; w < words; ++w) raw[w] = 0;
+        for (uint8_t r = 0; r < matrix.rows; ++r)
+            for (uint8_t c = 0; c < matrix.cols; ++c)
+                if (matrix.pressed[r][c]) { uint16_t i = r * matrix.cols + c; raw[i >> 5] |= 1u << (i & 31); }
+    }
+};
+
+static uint32_t rngState = 0x5EED1234u;
+static uint32_t nextRand() {
+    rngState ^= rngState << 13; rngState ^= rngState >> 17; rngState ^= rngState << 5;
+    return rngState;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_plan_padding_and_span() {
+    MatrixScanLayout l;
+    const uint8_t rows[3] = { 20, 21, 22 };
+    const uint8_t cols[5] = { 9, 3, 5, 4, 12 };
+    matrixScanLayoutInit(l, rows, cols, 3, 5);
+    MatrixPioPlan p;
+    TEST_ASSERT_TRUE(matrixPioPlan(l, p));
+    TEST_ASSERT_EQUAL_UINT8(3, p.outBase);
+    TEST_ASSERT_EQUAL_UINT8(10, p.outCount);  // GPIO 3..12
+    TEST_ASSERT_EQUAL_UINT8(8, p.steps);      // 5 columns -> 8-word rings
+    TEST_ASSERT_EQUAL_UINT8(5, p.ringBits);   // 32 bytes
+    TEST_ASSERT_EQUAL_HEX32(1u << 6, p.columnWords[0]);
+    TEST_ASSERT_EQUAL_HEX32(1u << 0, p.columnWords[1]);
+    TEST_ASSERT_EQUAL_HEX32(1u << 9, p.columnWords[4]);
+    for (uint8_t i = 5; i < 8; ++i) TEST_ASSERT_EQUAL_HEX32(0, p.columnWords[i]); // padding drives nothing
+
+    // One column: a 1-word ring still needs a 4-byte DMA ring
+    matrixScanLayoutInit(l, rows, cols, 3, 1);
+    TEST_ASSERT_TRUE(matrixPioPlan(l, p));
+    TEST_ASSERT_EQUAL_UINT8(1, p.steps);
+    TEST_ASSERT_EQUAL_UINT8(2, p.ringBits);
+    TEST_ASSERT_EQUAL_UINT32(1250, matrixPioSettleCycles(10, SYS_CLK_HZ));
+    TEST_ASSERT_EQUAL_UINT32(2, matrixPioSettleCycles(1, 1500000)); // rounds up
+}
+
+void test_column_period_is_settle_plus_four() {
+    const uint8_t rows[4] = { 8, 9, 10, 11 };
+    const uint8_t cols[4] = { 0, 1, 2, 3 };
+    const uint32_t settles[4] = { 0, 1, 7, 125 };
+    for (uint32_t settle : settles) {
+        ScanRig rig;
+        rig.init(rows, 4, cols, 4, settle, 0);
+        rig.runSamples(40);
+        TEST_ASSERT_EQUAL_UINT32(settle + MATRIX_PIO_COLUMN_OVERHEAD_CYCLES, (uint32_t)rig.sampleInterval);
+        const uint64_t stallsBefore = rig.sm.stallCycles;
+        rig.runSamples(400);
+        TEST_ASSERT_TRUE(rig.sm.stallCycles == stallsBefore); // steady state: no FIFO stalls
+    }
+}
+
+void test_sample_ring_decodes_pressed_keys() {
+    struct Case { uint8_t rows, cols; uint8_t colPins[16]; uint8_t rowPins[16]; };
+    const Case cases[] = {
+        { 4, 4, { 0, 1, 2, 3 }, { 4, 5, 6, 7 } },
+        { 3, 5, { 9, 3, 5, 4, 12 }, { 20, 21, 22 } },                          // scattered, padded
+        { 8, 8, { 0, 1, 2, 3, 4, 5, 6, 7 }, { 8, 9, 10, 11, 12, 13, 14, 15 } },
+        { 13, 15, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 },
+                  { 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29 } },
+    };
+    const uint32_t settle = 40, recover = 30;
+    for (const Case& k : cases) {
+        ScanRig rig;
+        rig.init(k.rowPins, k.rows, k.colPins, k.cols, settle, recover);
+        const uint16_t words = (uint16_t)((k.rows * k.cols + 31) / 32);
+        for (int trial = 0; trial < 20; ++trial) {
+            for (uint8_t r = 0; r < k.rows; ++r)
+                for (uint8_t c = 0; c < k.cols; ++c) rig.matrix.pressed[r][c] = (nextRand() & 7) == 0;
+            rig.runSamples(2 * rig.plan.steps); // one pass may straddle the change
+            uint32_t raw[8] = {}, expect[8] = {};
+            rig.decode(raw, words);
+            rig.expected(expect, words);
+            TEST_ASSERT_EQUAL_UINT32_ARRAY(expect, raw, words);
+        }
+    }
+}
+
+void test_short_settle_smears_into_next_column() {
+    const uint8_t rows[2] = { 8, 9 };
+    const uint8_t cols[4] = { 0, 1, 2, 3 };
+    ScanRig rig;
+    rig.init(rows, 2, cols, 4, 5, 30); // rows need 30 cycles, settle only 5
+    rig.matrix.pressed[0][1] = true;
+    rig.runSamples(16);
+    uint32_t raw[1] = {};
+    rig.decode(raw, 1);
+    TEST_ASSERT_TRUE(raw[0] & (1u << 1));  // the key itself
+    TEST_ASSERT_TRUE(raw[0] & (1u << 2));  // ghost in the next column: settle too short
+
+    rig.init(rows, 2, cols, 4, 30, 30);    // settle covers the recovery
+    rig.matrix.pressed[0][1] = true;
+    rig.runSamples(16);
+    rig.decode(raw, 1);
+    TEST_ASSERT_EQUAL_HEX32(1u << 1, raw[0]);
+}
+
+void test_dma_restart_keeps_columns_paired() {
+    const uint8_t rows[3] = { 10, 11, 12 };
+    const uint8_t cols[5] = { 0, 1, 2, 3, 4 };
+    ScanRig rig;
+    rig.init(rows, 3, cols, 5, 20, 10, 37); // run length not a multiple of the 8-word ring
+    rig.matrix.pressed[2][4] = true;
+    rig.matrix.pressed[0][0] = true;
+    for (int run = 0; run < 5; ++run) {
+        rig.runSamples(37);
+        for (int i = 0; i < 200; ++i) rig.clock(); // SM now waits on autopull
+        TEST_ASSERT_EQUAL_UINT32(0, rig.rxRemaining);
+        rig.restartDma(37);
+    }
+    rig.runSamples(16);
+    uint32_t raw[1] = {}, expect[1] = {};
+    rig.decode(raw, 1);
+    rig.expected(expect, 1);
+    TEST_ASSERT_EQUAL_HEX32(expect[0], raw[0]);
+}
+
+void test_scan_rate_and_latency() {
+    printf("  full-matrix scan rate at %u MHz (columns x settle):\n", SYS_CLK_HZ / 1000000u);
+    const uint8_t colCounts[3] = { 4, 8, 16 };
+    const uint32_t settleUs[3] = { 1, 5, 10 };
+    for (uint8_t cols : colCounts) {
+        printf("   %2u cols:", cols);
+        for (uint32_t us : settleUs) {
+            uint8_t colPins[16], rowPins[8];
+            for (uint8_t c = 0; c < cols; ++c) colPins[c] = c;
+            for (uint8_t r = 0; r < 8; ++r) rowPins[r] = (uint8_t)(16 + r);
+            MatrixScanLayout l;
+            matrixScanLayoutInit(l, rowPins, colPins, 8, cols);
+            MatrixPioPlan p;
+            matrixPioPlan(l, p);
+            const uint32_t hz = SYS_CLK_HZ / matrixPioFrameCycles(p, matrixPioSettleCycles(us, SYS_CLK_HZ));
+            printf("  %2u us %6u Hz", us, hz);
+        }
+        printf("\n");
+    }
+
+    // 8 x 8 at 10 us settle: model frame time matches the formula, and reaches 10 kHz
+    uint8_t colPins[8], rowPins[8];
+    for (uint8_t i = 0; i < 8; ++i) { colPins[i] = i; rowPins[i] = (uint8_t)(8 + i); }
+    const uint32_t settle = matrixPioSettleCycles(10, SYS_CLK_HZ);
+    ScanRig rig;
+    rig.init(rowPins, 8, colPins, 8, settle, settle / 2);
+    rig.runSamples(8);
+    const uint64_t start = rig.lastSampleCycle;
+    rig.runSamples(8 * 10);
+    const uint64_t frame = (rig.lastSampleCycle - start) / 10;
+    TEST_ASSERT_EQUAL_UINT32(matrixPioFrameCycles(rig.plan, settle), (uint32_t)frame);
+    TEST_ASSERT_GREATER_OR_EQUAL(10000u, SYS_CLK_HZ / (uint32_t)frame);
+
+    // Press latency: a key shows up in the sample ring within one frame plus one column
+    uint64_t worst = 0;
+    for (int trial = 0; trial < 30; ++trial) {
+        const uint8_t r = nextRand() % 8, c = nextRand() % 8;
+        const uint32_t skew = nextRand() % (uint32_t)frame;
+        for (uint32_t i = 0; i < skew; ++i) rig.clock();
+        rig.matrix.pressed[r][c] = true;
+        const uint64_t pressedAt = rig.matrix.cycle;
+        const uint16_t idx = r * 8 + c;
+        for (;;) {
+            rig.clock();
+            uint32_t raw[2] = {};
+            rig.decode(raw, 2);
+            if (raw[idx >> 5] & (1u << (idx & 31))) break;
+        }
+        const uint64_t latency = rig.matrix.cycle - pressedAt;
+        if (latency > worst) worst = latency;
+        rig.matrix.pressed[r][c] = false;
+        rig.runSamples(2 * 8);
+    }
+    printf("  8x8 @ 10 us: frame %u cycles (%u Hz), worst press latency %.1f us\n",
+           (unsigned)frame, SYS_CLK_HZ / (unsigned)frame, worst * 1e6 / SYS_CLK_HZ);
+    TEST_ASSERT_LESS_OR_EQUAL(frame + settle + MATRIX_PIO_COLUMN_OVERHEAD_CYCLES + 8, worst);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_plan_padding_and_span);
+    RUN_TEST(test_column_period_is_settle_plus_four);
+    RUN_TEST(test_sample_ring_decodes_pressed_keys);
+    RUN_TEST(test_short_settle_smears_into_next_column);
+    RUN_TEST(test_dma_restart_keeps_columns_paired);
+    RUN_TEST(test_scan_rate_and_latency);
+    return UNITY_END();
+}
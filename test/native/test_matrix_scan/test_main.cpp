@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host benchmark for the mask-based matrix scan engine (MatrixScan.h).
+//
+// A switch-matrix GPIO model checks that matrixScanRaw() matches the legacy per-pin scan
+// (pinMode on every other column, digitalRead per row, full restore) and reports GPIO API
+// calls and host scan time for 4x4, 8x8 and 16x16. Column settle delays are excluded;
+// both engines wait the same settle time per column on hardware.
+// Run with: pio test -e native -f native/test_matrix_scan -v
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "inputs/buttons/MatrixScan.h"
+
+// Wired switch matrix: row r reads LOW when any pressed key in that row sits on a column
+// whose pin is an output (latch LOW). Columns are GPIO 0..cols-1, rows follow.
+struct MatrixModel {
+    uint8_t rows = 0, cols = 0;
+    bool pressed[16][16] = {};
+    uint32_t dirOut = 0;      // 1 = output
+    uint32_t calls = 0;       // GPIO API calls issued by the scanner
+
+    uint8_t colPin(uint8_t c) const { return c; }
+    uint8_t rowPin(uint8_t r) const { return (uint8_t)(cols + r); }
+
+    uint32_t levels() const {
+        uint32_t v = 0xFFFFFFFFu; // pull-ups
+        for (uint8_t c = 0; c < cols; ++c) {
+            if (!(dirOut & (1u << colPin(c)))) continue;
+            v &= ~(1u << colPin(c));
+            for (uint8_t r = 0; r < rows; ++r) if (pressed[r][c]) v &= ~(1u << rowPin(r));
+        }
+        return v;
+    }
+};
+
+// Engine backend over the model
+struct ModelGpio {
+    MatrixModel* m;
+    void setDirMasked(uint32_t mask, uint32_t outputs) { m->calls++; m->dirOut = (m->dirOut & ~mask) | (outputs & mask); }
+    uint32_t readAll() { m->calls++; return m->levels(); }
+    void settle() {}
+};
+
+// Legacy ButtonMatrix::scanMatrix pin sequence over the model
+static void legacyPinModeOutput(MatrixModel& m, uint8_t pin) { m.calls++; m.dirOut |= 1u << pin; }
+static void legacyPinModeInput(MatrixModel& m, uint8_t pin) { m.calls++; m.dirOut &= ~(1u << pin); }
+static void legacyDigitalWriteLow(MatrixModel& m) { m.calls++; }
+static bool legacyDigitalRead(MatrixModel& m, uint8_t pin) { m.calls++; return (m.levels() >> pin) & 1u; }
+
+static void legacyScan(MatrixModel& m, uint32_t* raw, uint16_t words) {
+    for (uint16_t w = 0; w < words; ++w) raw[w] = 0;
+    for (uint8_t col = 0; col < m.cols; col++) {
+        legacyPinModeOutput(m, m.colPin(col));
+        legacyDigitalWriteLow(m);
+        for (uint8_t other = 0; other < m.cols; other++) {
+            if (other != col) legacyPinModeInput(m, m.colPin(other));
+        }
+        for (uint8_t row = 0; row < m.rows; row++) {
+            uint16_t idx = row * m.cols + col;
+            if (!legacyDigitalRead(m, m.rowPin(row))) raw[idx >> 5] |= 1u << (idx & 31);
+        }
+    }
+    for (uint8_t row = 0; row < m.rows; row++) legacyPinModeInput(m, m.rowPin(row));
+    for (uint8_t col = 0; col < m.cols; col++) legacyPinModeInput(m, m.colPin(col));
+}
+
+static uint32_t rngState = 0xC0FFEEu;
+static uint32_t nextRand() {
+    rngState ^= rngState << 13; rngState ^= rngState >> 17; rngState ^= rngState << 5;
+    return rngState;
+}
+
+static void setupModel(MatrixModel& m, MatrixScanLayout& l, uint8_t rows, uint8_t cols) {
+    m = MatrixModel();
+    m.rows = rows; m.cols = cols;
+    uint8_t rowPins[16], colPins[16];
+    for (uint8_t r = 0; r < rows; ++r) rowPins[r] = m.rowPin(r);
+    for (uint8_t c = 0; c < cols; ++c) colPins[c] = m.colPin(c);
+    matrixScanLayoutInit(l, rowPins, colPins, rows, cols);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_engine_matches_legacy_scan() {
+    const uint8_t sizes[][2] = {{4, 4}, {8, 8}, {16, 16}, {3, 7}, {13, 2}};
+    for (const auto& sz : sizes) {
+        MatrixModel m;
+        MatrixScanLayout l;
+        setupModel(m, l, sz[0], sz[1]);
+        const uint16_t words = (uint16_t)((sz[0] * sz[1] + 31) / 32);
+        for (uint16_t iter = 0; iter < 200; ++iter) {
+            for (uint8_t r = 0; r < m.rows; ++r)
+                for (uint8_t c = 0; c < m.cols; ++c) m.pressed[r][c] = (nextRand() % 11) == 0;
+            uint32_t expected[8], actual[8];
+            legacyScan(m, expected, words);
+            ModelGpio gpio{&m};
+            matrixScanRaw(l, gpio, actual, words);
+            TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, actual, words);
+            TEST_ASSERT_EQUAL_HEX32(0, m.dirOut & l.colMask); // columns released afterwards
+        }
+    }
+}
+
+template <typename Fn>
+static double nsPerScan(Fn fn, uint32_t iterations) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+void test_benchmark_scan_sizes() {
+    const uint8_t sizes[] = {4, 8, 16};
+    const uint32_t iterations = 20000;
+    printf("\n  size   legacy_calls  engine_calls  legacy_ns  engine_ns\n");
+    for (uint8_t n : sizes) {
+        MatrixModel m;
+        MatrixScanLayout l;
+        setupModel(m, l, n, n);
+        const uint16_t words = (uint16_t)((n * n + 31) / 32);
+        m.pressed[0][0] = m.pressed[n - 1][n / 2] = true; // a couple of held keys
+        uint32_t raw[8];
+        volatile uint32_t sink = 0;
+
+        m.calls = 0;
+        legacyScan(m, raw, words);
+        uint32_t legacyCalls = m.calls;
+        ModelGpio gpio{&m};
+        m.calls = 0;
+        matrixScanRaw(l, gpio, raw, words);
+        uint32_t engineCalls = m.calls;
+
+        double legacyNs = nsPerScan([&] { legacyScan(m, raw, words); sink += raw[0]; }, iterations);
+        double engineNs = nsPerScan([&] { matrixScanRaw(l, gpio, raw, words); sink += raw[0]; }, iterations);
+        printf("  %2ux%-2u  %12u  %12u  %9.0f  %9.0f\n", n, n, (unsigned)legacyCalls, (unsigned)engineCalls,
+               legacyNs, engineNs);
+
+        // Legacy is cols^2 + rows*cols + ...; the engine issues 2 calls per column + 1
+        TEST_ASSERT_EQUAL_UINT32(2u * n + 1u, engineCalls);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)n * n + (uint32_t)n * n + 2u * n + n, legacyCalls);
+        (void)sink;
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_engine_matches_legacy_scan);
+    RUN_TEST(test_benchmark_scan_sizes);
+    return UNITY_END();
+}
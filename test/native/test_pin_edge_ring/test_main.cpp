@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the direct-pin edge ring (BUTTON_PIN_MODE_IRQ).
+//
+// Checks FIFO order and overflow accounting, the per-report drain rule (a tap shorter than a
+// scan cycle still shows up in one report), and runs the ring with a producer thread standing
+// in for the GPIO interrupt. The simulation at the end compares how many short taps reach a
+// report when pins are polled once per cycle versus replayed from edge events; the last one
+// carries the reports on through the seqlock hand-off and core0's 1 ms send limit, with and
+// without ReportPressLatch, and counts the taps the host is sent.
+// Run with: pio test -e native -f native/test_pin_edge_ring -v
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include "inputs/buttons/PinEdgeRing.h"
+#include "inputs/ReportPressLatch.h"
+#include "inputs/ScanSnapshot.h"
+#include "utils/SeqlockDoubleBuffer.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_fifo_order_and_overflow() {
+    PinEdgeRing<8> ring;
+    TEST_ASSERT_NULL(ring.peek());
+    for (uint32_t i = 0; i < 10; i++) {
+        bool ok = ring.push({1u << (i % 30), i, 1000ull + i});
+        TEST_ASSERT_EQUAL(i < 8, ok);
+    }
+    TEST_ASSERT_EQUAL_UINT16(8, ring.size());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.dropped());
+    for (uint32_t i = 0; i < 8; i++) {
+        const PinEdgeEvent* e = ring.peek();
+        TEST_ASSERT_NOT_NULL(e);
+        TEST_ASSERT_EQUAL_UINT32(i, e->levels);
+        TEST_ASSERT_TRUE(e->timeUs == 1000ull + i);
+        ring.pop();
+    }
+    TEST_ASSERT_NULL(ring.peek());
+    // Indices keep running across the 16-bit wrap
+    for (uint32_t i = 0; i < 70000; i++) {
+        TEST_ASSERT_TRUE(ring.push({1, i, i}));
+        TEST_ASSERT_EQUAL_UINT32(i, ring.peek()->levels);
+        ring.pop();
+    }
+}
+
+void test_drain_keeps_each_edge_in_its_own_report() {
+    PinEdgeRing<16> ring;
+    // Pin 3 pressed and released within one cycle, pin 5 pressed meanwhile (HIGH = released)
+    ring.push({1u << 3, ~(1u << 3), 10});
+    ring.push({1u << 5, ~((1u << 3) | (1u << 5)), 12});
+    ring.push({1u << 3, ~(1u << 5), 15});
+
+    uint32_t lastLevels = 0;
+    uint32_t touched = 0;
+    uint16_t n = drainPinEdgesForReport(ring, touched, [&](const PinEdgeEvent& e) { lastLevels = e.levels; });
+    TEST_ASSERT_EQUAL_UINT16(2, n);                     // stops before pin 3 changes again
+    TEST_ASSERT_FALSE(lastLevels & (1u << 3));          // report 1: pin 3 pressed
+    TEST_ASSERT_FALSE(lastLevels & (1u << 5));          // ... and pin 5 pressed
+    // A second drain for the same report (late flush) adds nothing
+    TEST_ASSERT_EQUAL_UINT16(0, drainPinEdgesForReport(ring, touched, [&](const PinEdgeEvent& e) { lastLevels = e.levels; }));
+
+    touched = 0; // next report
+    n = drainPinEdgesForReport(ring, touched, [&](const PinEdgeEvent& e) { lastLevels = e.levels; });
+    TEST_ASSERT_EQUAL_UINT16(1, n);
+    TEST_ASSERT_TRUE(lastLevels & (1u << 3));           // report 2: pin 3 released
+    TEST_ASSERT_FALSE(lastLevels & (1u << 5));          // pin 5 still pressed
+}
+
+void test_interrupt_thread_producer() {
+    static PinEdgeRing<64> ring;
+    const uint32_t EVENTS = 200000;
+    std::atomic<bool> done(false);
+    std::thread isr([&]() {
+        for (uint32_t i = 1; i <= EVENTS; i++) {
+            while (!ring.push({1u << (i % 30), i, (uint64_t)i * 3})) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    uint32_t expect = 1, bad = 0;
+    for (;;) {
+        const bool finished = done.load(std::memory_order_acquire);
+        while (const PinEdgeEvent* e = ring.peek()) {
+            if (e->levels != expect || e->timeUs != (uint64_t)expect * 3 || e->pins != 1u << (expect % 30)) bad++;
+            expect++;
+            ring.pop();
+        }
+        if (finished && !ring.peek()) break;
+    }
+    isr.join();
+    TEST_ASSERT_EQUAL_UINT32(0, bad);
+    TEST_ASSERT_EQUAL_UINT32(EVENTS + 1, expect);
+}
+
+// Taps of 20-400 us against a 500 us scan cycle: how many show up as pressed in some report
+void test_short_taps_reach_a_report() {
+    const uint32_t CYCLE_US = 500;
+    const uint32_t TAPS = 2000;
+    uint32_t seed = 12345;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+
+    uint32_t seenPoll = 0, seenIrq = 0;
+    for (uint32_t t = 0; t < TAPS; t++) {
+        const uint32_t start = rnd() % CYCLE_US;
+        const uint32_t len = 20 + rnd() % 381;
+        // Poll: the pin is sampled at multiples of CYCLE_US
+        bool hit = false;
+        for (uint32_t s = 0; s <= 2 * CYCLE_US; s += CYCLE_US) {
+            if (s >= start && s < start + len) hit = true;
+        }
+        seenPoll += hit;
+
+        // IRQ: both edges are queued and replayed at the next cycles
+        PinEdgeRing<8> ring;
+        ring.push({1u << 4, ~(1u << 4), start});
+        ring.push({1u << 4, 0xFFFFFFFFu, (uint64_t)start + len});
+        bool pressedInReport = false;
+        for (int report = 0; report < 3; report++) {
+            uint32_t touched = 0, levels = 0xFFFFFFFFu;
+            drainPinEdgesForReport(ring, touched, [&](const PinEdgeEvent& e) { levels = e.levels; });
+            if (!(levels & (1u << 4))) pressedInReport = true;
+        }
+        seenIrq += pressedInReport;
+    }
+    printf("  taps of 20-400 us at a %u us scan cycle reaching a report: poll %u/%u, irq %u/%u\n",
+           CYCLE_US, seenPoll, TAPS, seenIrq, TAPS);
+    TEST_ASSERT_EQUAL_UINT32(TAPS, seenIrq);
+    TEST_ASSERT_TRUE(seenPoll < TAPS);
+}
+
+// Core0's side of the hand-off as in loop(): TinyUSBGamepad::commitReport diffs the newest
+// snapshot against the last report sent and sends at most once per MIN_SEND_INTERVAL_US
+struct SendModel {
+    static constexpr uint32_t MIN_SEND_INTERVAL_US = 1000;
+    joycore_gamepad_report_t sent = {};
+    uint64_t lastSendUs = 0;
+    bool pending = false;
+
+    bool commit(const joycore_gamepad_report_t& r, uint64_t nowUs) {
+        pending = gamepadReportDiffMask(r, sent) != 0;
+        if (!pending || nowUs - lastSendUs < MIN_SEND_INTERVAL_US) return false;
+        sent = r;
+        lastSendUs = nowUs;
+        pending = false;
+        return true;
+    }
+};
+
+// One tap of 20-900 us per 5 ms on pin 4, a 100 us scan cycle on core1 and a core0 loop every
+// 37 us. Returns the taps sent to the host as pressed; *releasedAtEnd is false if the button
+// was left pressed in the last report sent.
+static uint32_t tapsSentToHost(bool latch, uint32_t taps, bool* releasedAtEnd) {
+    const uint32_t PERIOD_US = 5000, SCAN_US = 100, LOOP_US = 37;
+    const uint32_t PIN = 1u << 4;
+    uint32_t seed = 777;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+
+    PinEdgeRing<8> ring;
+    SeqlockDoubleBuffer<ScanSnapshot> handoff;
+    ReportPressLatch pressLatch;
+    ScanSnapshot scan = {}, latest = {};
+    uint32_t latestSeq = 0, acked = 0;
+    uint32_t levels = 0xFFFFFFFFu; // HIGH = released
+    SendModel usb;
+    uint32_t sentTaps = 0;
+    bool tapSent = false;
+    uint64_t pressAt = 0, releaseAt = 0;
+
+    const uint64_t endUs = (uint64_t)taps * PERIOD_US + PERIOD_US;
+    for (uint64_t t = 0; t < endUs; t++) {
+        if (t % PERIOD_US == 0) {
+            if (tapSent) sentTaps++;
+            tapSent = false;
+            if (t / PERIOD_US < taps) {
+                pressAt = t + rnd() % 4000;
+                releaseAt = pressAt + 20 + rnd() % 881;
+            }
+        }
+        // GPIO interrupt
+        if (t == pressAt) ring.push({PIN, ~PIN, t});
+        if (t == releaseAt) ring.push({PIN, 0xFFFFFFFFu, t});
+        // core1: one scan cycle, as InputManager::update
+        if (t % SCAN_US == 0) {
+            uint32_t touched = 0;
+            drainPinEdgesForReport(ring, touched, [&](const PinEdgeEvent& e) { levels = e.levels; });
+            joycore_gamepad_report_t built = {};
+            built.buttons[0] = (levels & PIN) ? 0 : 1;
+            if (latch) pressLatch.apply(built, handoff.published() + 1, acked, scan.report);
+            else scan.report = built;
+            scan.scanUs = (uint32_t)t;
+            handoff.publish(scan);
+        }
+        // core0: loop()
+        if (t % LOOP_US == 0) {
+            handoff.readNewer(latest, latestSeq);
+            if (latestSeq == 0) continue;
+            if (usb.commit(latest.report, t) && (usb.sent.buttons[0] & 1)) tapSent = true;
+            if (!usb.pending) acked = latestSeq;
+        }
+    }
+    *releasedAtEnd = (usb.sent.buttons[0] & 1) == 0;
+    return sentTaps;
+}
+
+void test_short_taps_reach_the_host() {
+    const uint32_t TAPS = 2000;
+    bool releasedPlain = false, releasedLatched = false;
+    const uint32_t plain = tapsSentToHost(false, TAPS, &releasedPlain);
+    const uint32_t latched = tapsSentToHost(true, TAPS, &releasedLatched);
+    printf("  taps of 20-900 us sent to the host (1 ms send limit): newest snapshot %u/%u, "
+           "press latch %u/%u\n", plain, TAPS, latched, TAPS);
+    TEST_ASSERT_EQUAL_UINT32(TAPS, latched);
+    TEST_ASSERT_TRUE(releasedLatched);
+    TEST_ASSERT_TRUE(plain < TAPS);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_order_and_overflow);
+    RUN_TEST(test_drain_keeps_each_edge_in_its_own_report);
+    RUN_TEST(test_interrupt_thread_producer);
+    RUN_TEST(test_short_taps_reach_a_report);
+    RUN_TEST(test_short_taps_reach_the_host);
+    return UNITY_END();
+}
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for the PIO quadrature decoder (QuadraturePio.h) and count latching (QuadratureCount.h).
+//
+// QUADRATURE_PIO_PROGRAM runs on a cycle-level model of one PIO state machine at 125 MHz fed by
+// a simulated encoder (24 detents, 4 transitions per detent, contact bounce on every edge).
+// The CPU side reads the count the way QuadraturePioBank::readCount does (drain the RX FIFO,
+// take the next push) at irregular intervals with long stalls, and latches detents with
+// quadratureLatchCrossed. Checks: the jump table matches RotaryEncoder's KNOBDIR, the count is
+// exact at 1000+ RPM however rarely it is read, latching matches RotaryEncoder::tick() step for
+// step including detent bounce, and a once-per-millisecond poll (the old path) is compared.
+// Run with: pio test -e native -f native/test_quadrature_pio -v
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "inputs/encoders/QuadraturePio.h"
+#include "inputs/encoders/QuadratureCount.h"
+
+static constexpr uint32_t SYS_CLK_HZ = 125000000u;
+static constexpr uint32_t TRANSITIONS_PER_REV = 24 * 4;
+
+// RotaryEncoder.cpp reference (KNOBDIR and the latch rule of tick())
+static const int8_t KNOBDIR[] = { 0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0 };
+
+struct ReferenceEncoder {
+    int8_t oldState;
+    uint8_t latchA, latchB, shift; // latch states (same twice for FOUR modes)
+    long position = 0, positionExt = 0;
+    ReferenceEncoder(int8_t initial, uint8_t la, uint8_t lb, uint8_t sh) : oldState(initial), latchA(la), latchB(lb), shift(sh) {}
+    void tick(int8_t s) {
+        if (s == oldState) return;
+        position += KNOBDIR[s | (oldState << 2)];
+        oldState = s;
+        if (s == latchA || s == latchB) positionExt = position >> shift;
+    }
+};
+
+// Subset of a PIO state machine: JMP, IN, OUT, PUSH, MOV (incl. PC and ~), no autopush/pull
+struct QuadSmModel {
+    uint8_t pc = QUADRATURE_PIO_UPDATE;
+    uint32_t y = 0, osr = 0, isr = 0;
+    uint32_t rxf[4] = {};
+    uint8_t rxLevel = 0;
+    uint64_t pushes = 0;
+
+    void exec(uint16_t ins, uint32_t pins) {
+        const uint8_t op = ins >> 13, arg = (ins >> 5) & 7, low5 = ins & 31;
+        const uint8_t n = low5 ? low5 : 32;
+        const uint32_t m = n >= 32 ? 0xFFFFFFFFu : (1u << n) - 1;
+        bool advance = true;
+        switch (op) {
+        case 0: { // JMP: always / y--
+            bool take = true;
+            if (arg == 4) { take = y != 0; y--; }
+            else TEST_ASSERT_EQUAL(0, arg);
+            if (take) { pc = low5; advance = false; }
+            break;
+        }
+        case 2: isr = (isr << n) | (pins & m); TEST_ASSERT_EQUAL(0, arg); break; // IN pins, shift left
+        case 3: { // OUT isr (shift right)
+            TEST_ASSERT_EQUAL(6, arg);
+            isr = osr & m; osr >>= n;
+            break;
+        }
+        case 4: // PUSH noblock
+            TEST_ASSERT_EQUAL_HEX16(0x8000, ins);
+            if (rxLevel < 4) { rxf[rxLevel++] = isr; pushes++; }
+            isr = 0;
+            break;
+        case 5: { // MOV
+            const uint8_t src = ins & 7, opx = (ins >> 3) & 3;
+            uint32_t v = src == 2 ? y : src == 6 ? isr : 0;
+            if (opx == 1) v = ~v;
+            if (arg == 2) y = v;
+            else if (arg == 6) isr = v;
+            else if (arg == 7) osr = v;
+            else if (arg == 5) { pc = (uint8_t)(v & 31); advance = false; }
+            break;
+        }
+        default:
+            TEST_FAIL_MESSAGE("instruction not modelled");
+        }
+        if (advance) pc = (pc == QUADRATURE_PIO_WRAP) ? QUADRATURE_PIO_WRAP_TARGET : (uint8_t)(pc + 1);
+    }
+    void step(uint32_t pins) { exec(QUADRATURE_PIO_PROGRAM[pc], pins); }
+    bool rxPop(uint32_t& v) {
+        if (!rxLevel) return false;
+        v = rxf[0];
+        memmove(rxf, rxf + 1, sizeof(uint32_t) * 3);
+        rxLevel--;
+        return true;
+    }
+};
+
+// Encoder turning at a fixed speed, each edge followed by a few bounce toggles of that phase
+struct EncoderSignal {
+    uint32_t seed = 0x1234567u;
+    int8_t dir = 1;
+    uint32_t gray = 0;           // Gray index, state = STATES[gray & 3]
+    uint64_t nextEdge = 0;
+    uint64_t period = 0;         // cycles between transitions
+    uint8_t bouncePhase = 0, bounceLeft = 0;
+    uint64_t nextBounce = 0;
+    bool bounceLevel = false;
+    int64_t transitions = 0;
+    static constexpr uint8_t STATES[4] = { 0, 2, 3, 1 };
+
+    uint32_t rnd() { seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5; return seed; }
+    void setRpm(uint32_t rpm, uint64_t now) {
+        period = (uint64_t)SYS_CLK_HZ * 60 / ((uint64_t)rpm * TRANSITIONS_PER_REV);
+        nextEdge = now + period;
+    }
+    uint8_t state() const { return STATES[gray & 3]; }
+    uint32_t pins(uint64_t now) {
+        if (period && now >= nextEdge) {
+            const uint8_t before = state();
+            gray += dir;
+            transitions += dir;
+            const uint8_t changed = before ^ state();
+            nextEdge += period;
+            // Bounce: up to 3 glitches of the changed phase in the first 3% of the step
+            bounceLeft = (uint8_t)(rnd() % 4) * 2;
+            bouncePhase = changed;
+            nextBounce = now + 1 + rnd() % (period / 100 + 1);
+        }
+        uint8_t s = state();
+        if (bounceLeft) {
+            if (now >= nextBounce) { bounceLevel = !bounceLevel; bounceLeft--; nextBounce = now + 1 + rnd() % (period / 100 + 1); }
+            if (bounceLevel) s ^= bouncePhase;
+        } else {
+            bounceLevel = false;
+        }
+        return s;
+    }
+};
+
+// QuadraturePioBank::readCount over the model: drain, then wait for the next push
+static int32_t readCount(QuadSmModel& sm, EncoderSignal& enc, uint64_t& now) {
+    uint32_t v;
+    while (sm.rxPop(v)) {}
+    while (!sm.rxPop(v)) sm.step(enc.pins(now++));
+    return (int32_t)v;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_jump_table_matches_knobdir() {
+    TEST_ASSERT_EQUAL_UINT8(26, QUADRATURE_PIO_PROGRAM_LENGTH);
+    TEST_ASSERT_TRUE(QUADRATURE_PIO_PROGRAM_LENGTH + 6 <= 32); // MatrixPio.h fits alongside
+    for (uint8_t i = 0; i < 16; ++i) {
+        const uint16_t ins = QUADRATURE_PIO_PROGRAM[i];
+        TEST_ASSERT_EQUAL_HEX16(0, ins & 0xFFE0); // unconditional jmp
+        const uint8_t target = ins & 31;
+        const int8_t dir = target == QUADRATURE_PIO_INCREMENT ? 1 : target == QUADRATURE_PIO_DECREMENT ? -1 : 0;
+        if (!dir) TEST_ASSERT_EQUAL_UINT8(QUADRATURE_PIO_UPDATE, target);
+        TEST_ASSERT_EQUAL_INT8(KNOBDIR[i], dir);
+    }
+}
+
+void test_latch_matches_tick_step_by_step() {
+    struct Mode { uint8_t la, lb, shift; };
+    const Mode modes[3] = { { 0, 0, 2 }, { 3, 3, 2 }, { 0, 3, 1 } }; // FOUR0, FOUR3, TWO03
+    const uint8_t STATES[4] = { 0, 2, 3, 1 };
+    uint32_t seed = 99;
+    for (const Mode& md : modes) {
+        for (uint8_t start = 0; start < 4; ++start) {
+            ReferenceEncoder ref(STATES[start], md.la, md.lb, md.shift);
+            const QuadratureLatch latch = quadratureLatchInit(md.la, md.shift, STATES[start]);
+            int32_t count = 0, lastRead = 0;
+            long ext = 0;
+            uint32_t gray = start;
+            int8_t prevD = 1;
+            auto readNow = [&]() {
+                int32_t l;
+                if (quadratureLatchCrossed(latch, lastRead, count, &l)) ext = l >> latch.shift;
+                lastRead = count;
+            };
+            for (int i = 0; i < 20000; ++i) {
+                seed = seed * 1103515245u + 12345u;
+                // Mostly forward with reversals and detent jitter (back and forth by one)
+                const int8_t d = ((seed >> 16) % 10) < 6 ? 1 : -1;
+                // Motion between two reads is monotonic: the decoder is read long before the
+                // knob can turn back across a detent, so fold the count in at each reversal
+                if (d != prevD) readNow();
+                prevD = d;
+                gray += d;
+                count += d;
+                ref.tick(STATES[gray & 3]);
+                if (((seed >> 8) % 3) == 0 || i == 19999) {
+                    readNow();
+                    TEST_ASSERT_EQUAL_INT32(ref.positionExt, ext);
+                }
+            }
+        }
+    }
+    // 32-bit wrap of the hardware counter
+    const QuadratureLatch l = quadratureLatchInit(0, 2, 0);
+    int32_t latched = 0;
+    TEST_ASSERT_TRUE(quadratureLatchCrossed(l, (int32_t)0x7FFFFFFE, (int32_t)0x80000001u, &latched));
+    TEST_ASSERT_EQUAL_HEX32(0x80000000u, (uint32_t)latched);
+}
+
+// Turns `revs` revolutions at rpm while the CPU reads at 0.5-20 ms intervals
+static void runAtRpm(uint32_t rpm, float revs, int64_t& expected, int64_t& counted, int64_t& detents,
+                     int64_t& polledDetents) {
+    QuadSmModel sm;
+    EncoderSignal enc;
+    uint64_t now = 0;
+    sm.osr = enc.state(); // QUADRATURE_PIO_PRIME
+    enc.setRpm(rpm, now);
+    const uint64_t end = (uint64_t)(revs * 60.0f / rpm * SYS_CLK_HZ);
+    const QuadratureLatch latch = quadratureLatchInit(0, 2, enc.state());
+    ReferenceEncoder polled(enc.state(), 0, 0, 2);
+    int32_t last = 0;
+    long ext = 0;
+    uint64_t nextRead = 0, nextPoll = 0;
+    uint32_t seed = rpm;
+    while (now < end) {
+        const uint32_t pins = enc.pins(now);
+        sm.step(pins);
+        if (now >= nextPoll) { polled.tick((int8_t)enc.state()); nextPoll += SYS_CLK_HZ / 1000; } // 1 kHz loop
+        now++;
+        if (now >= nextRead) {
+            const int32_t c = readCount(sm, enc, now);
+            int32_t l;
+            if (quadratureLatchCrossed(latch, last, c, &l)) ext = l >> latch.shift;
+            last = c;
+            seed = seed * 1664525u + 1013904223u;
+            nextRead = now + (uint64_t)SYS_CLK_HZ * (500 + (seed >> 8) % 19500) / 1000000;
+        }
+    }
+    while (enc.transitions % 4) sm.step(enc.pins(now++)); // stop on a detent
+    enc.period = 0;
+    for (int i = 0; i < 100000; ++i) sm.step(enc.pins(now++)); // bounce settles
+    const int32_t c = readCount(sm, enc, now);
+    int32_t l;
+    if (quadratureLatchCrossed(latch, last, c, &l)) ext = l >> latch.shift;
+    polled.tick((int8_t)enc.state());
+    expected = enc.transitions;
+    counted = c;
+    detents = ext;
+    polledDetents = polled.positionExt;
+}
+
+void test_count_exact_at_high_rpm() {
+    const uint32_t rpms[4] = { 300, 1000, 3000, 6000 };
+    for (uint32_t rpm : rpms) {
+        int64_t expected, counted, detents, polled;
+        runAtRpm(rpm, 2.0f, expected, counted, detents, polled);
+        printf("  %4u RPM: %lld transitions, PIO counted %lld (%lld detents), 1 kHz poll %lld detents\n",
+               rpm, (long long)expected, (long long)counted, (long long)detents, (long long)polled);
+        TEST_ASSERT_EQUAL_INT32((int32_t)expected, (int32_t)counted);
+        TEST_ASSERT_EQUAL_INT32((int32_t)(expected / 4), (int32_t)detents);
+        if (rpm >= 1000) TEST_ASSERT_TRUE(polled != expected / 4); // the poll aliases at this speed
+    }
+}
+
+void test_pass_timing() {
+    // Sampling interval bounds the trackable speed: a transition must last >= one pass
+    QuadSmModel sm;
+    uint64_t cycles = 0;
+    uint32_t pins = 0;
+    const uint8_t seq[4] = { 0, 2, 3, 1 };
+    for (int i = 0; i < 400; ++i) {
+        uint64_t start = sm.pushes;
+        while (sm.pushes == start) { sm.step(pins); cycles++; uint32_t v; sm.rxPop(v); }
+        pins = seq[(i + 1) & 3];
+    }
+    TEST_ASSERT_EQUAL_INT32(400 - 1, (int32_t)sm.y); // the first pass saw no change
+    const uint32_t maxRpm = (uint32_t)((uint64_t)SYS_CLK_HZ * 60 / ((uint64_t)QUADRATURE_PIO_MAX_PASS_CYCLES * TRANSITIONS_PER_REV));
+    printf("  pass <= %u cycles: sampling limit %u RPM for a 24-detent encoder\n",
+           QUADRATURE_PIO_MAX_PASS_CYCLES, maxRpm);
+    TEST_ASSERT_TRUE(cycles <= 400ull * QUADRATURE_PIO_MAX_PASS_CYCLES);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_jump_table_matches_knobdir);
+    RUN_TEST(test_latch_matches_tick_step_by_step);
+    RUN_TEST(test_count_exact_at_high_rpm);
+    RUN_TEST(test_pass_timing);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host tests for sampled quadrature decoding with missed-state recovery (quadratureTrack,
+// QuadratureCount.h).
+//
+// Checks that single steps match RotaryEncoder's KNOBDIR table, that a two-state jump is counted
+// in the direction of travel only while that direction is current, and that the counters add up.
+// Then spins a synthetic 24-detent encoder (4 transitions per detent) up to a steady speed,
+// samples it at several polling rates, and reports the highest RPM each decoder tracks without
+// losing a transition: KNOBDIR alone versus quadratureTrack.
+// Run with: pio test -e native -f native/test_quadrature_recovery -v
+#include <unity.h>
+#include <stdio.h>
+#include "inputs/encoders/QuadratureCount.h"
+
+void setUp() {}
+void tearDown() {}
+
+// RotaryEncoder.cpp reference
+static const int8_t KNOBDIR[] = { 0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0 };
+static const uint8_t kGray[4] = { 0, 2, 3, 1 }; // clockwise phase sequence
+
+static const uint32_t TRANSITIONS_PER_REV = 24 * 4;
+
+void test_single_steps_match_knobdir() {
+    for (uint8_t from = 0; from < 4; from++) {
+        for (uint8_t to = 0; to < 4; to++) {
+            QuadratureTracker t;
+            const int8_t d = quadratureTrack(t, from, to, 1000);
+            // Jumps from rest are ambiguous: same 0 as KNOBDIR
+            TEST_ASSERT_EQUAL_INT8(KNOBDIR[to | (from << 2)], d);
+        }
+    }
+}
+
+void test_jump_follows_direction_of_travel() {
+    QuadratureTracker t;
+    // Two clockwise steps 1 ms apart set direction and velocity
+    TEST_ASSERT_EQUAL_INT8(1, quadratureTrack(t, kGray[0], kGray[1], 0));
+    TEST_ASSERT_EQUAL_INT8(1, quadratureTrack(t, kGray[1], kGray[2], 1000));
+    // Next sample 1 ms later skipped a state
+    TEST_ASSERT_EQUAL_INT8(2, quadratureTrack(t, kGray[2], kGray[0], 2000));
+    // Still current within twice the last interval
+    TEST_ASSERT_EQUAL_INT8(2, quadratureTrack(t, kGray[0], kGray[2], 4000));
+    // Knob stopped: a jump 100 ms later is ambiguous (bounce, or a reversal)
+    TEST_ASSERT_EQUAL_INT8(0, quadratureTrack(t, kGray[2], kGray[0], 104000));
+    TEST_ASSERT_EQUAL_UINT32(2, t.valid.load());
+    TEST_ASSERT_EQUAL_UINT32(2, t.recovered.load());
+    TEST_ASSERT_EQUAL_UINT32(1, t.rejected.load());
+
+    // Counter-clockwise travel resolves the same jump the other way
+    QuadratureTracker c;
+    quadratureTrack(c, kGray[0], kGray[3], 0);
+    quadratureTrack(c, kGray[3], kGray[2], 500);
+    TEST_ASSERT_EQUAL_INT8(-2, quadratureTrack(c, kGray[2], kGray[0], 1000));
+
+    // A single step alone gives a direction but no velocity yet
+    QuadratureTracker s;
+    quadratureTrack(s, kGray[0], kGray[1], 0);
+    TEST_ASSERT_EQUAL_INT8(0, quadratureTrack(s, kGray[1], kGray[3], 100));
+    TEST_ASSERT_EQUAL_UINT32(1, s.rejected.load());
+}
+
+void test_timer_wrap() {
+    QuadratureTracker t;
+    quadratureTrack(t, kGray[0], kGray[1], 0xFFFFFFFFu - 1500);
+    quadratureTrack(t, kGray[1], kGray[2], 0xFFFFFFFFu - 500);
+    TEST_ASSERT_EQUAL_INT8(2, quadratureTrack(t, kGray[2], kGray[0], 500));
+}
+
+// Transitions turned by time tUs: ramp from rest to rpm in RAMP_US, then steady
+static const double RAMP_US = 100000.0;
+static double transitionsAt(double rpm, double tUs) {
+    const double perUs = rpm * TRANSITIONS_PER_REV / 60e6;
+    if (tUs <= RAMP_US) return 0.5 * perUs * tUs * tUs / RAMP_US;
+    return perUs * (tUs - RAMP_US / 2);
+}
+
+// Samples one spin at sampleHz; true if the decoder ends with every transition counted
+static bool tracksWithoutLoss(double rpm, uint32_t sampleHz, bool recover, QuadratureTracker* out = nullptr) {
+    QuadratureTracker t;
+    const uint32_t periodUs = 1000000u / sampleHz;
+    const uint32_t SPIN_US = 500000;
+    uint8_t old = kGray[0];
+    int32_t position = 0;
+    long truth = 0;
+    for (uint32_t now = 0; now <= SPIN_US; now += periodUs) {
+        truth = (long)transitionsAt(rpm, now);
+        const uint8_t state = kGray[truth & 3];
+        if (state == old) continue;
+        position += recover ? quadratureTrack(t, old, state, now) : KNOBDIR[state | (old << 2)];
+        old = state;
+    }
+    if (out) {
+        out->valid.store(t.valid.load());
+        out->recovered.store(t.recovered.load());
+        out->rejected.store(t.rejected.load());
+    }
+    return position == truth;
+}
+
+static uint32_t maxLosslessRpm(uint32_t sampleHz, bool recover) {
+    uint32_t best = 0;
+    for (uint32_t rpm = 5; rpm <= 20000; rpm += 5) {
+        if (!tracksWithoutLoss(rpm, sampleHz, recover)) break;
+        best = rpm;
+    }
+    return best;
+}
+
+void test_max_tracked_rpm() {
+    const uint32_t RATES[] = {200, 1000, 2000, 4000};
+    for (uint32_t hz : RATES) {
+        const uint32_t plain = maxLosslessRpm(hz, false);
+        const uint32_t tracked = maxLosslessRpm(hz, true);
+        // One transition per sample is the limit without recovery, two with it
+        const uint32_t limit = hz * 60 / TRANSITIONS_PER_REV;
+        printf("  %4u Hz sampling: KNOBDIR %4u RPM, recovery %4u RPM (one state per sample = %u RPM)\n",
+               hz, plain, tracked, limit);
+        TEST_ASSERT_TRUE(plain <= limit);
+        TEST_ASSERT_TRUE(tracked > plain * 3 / 2);
+        TEST_ASSERT_TRUE(tracked <= 2 * limit);
+    }
+}
+
+void test_counters_add_up() {
+    QuadratureTracker t;
+    // 1.5 states per 1 ms sample: half the samples skip a state
+    const double rpm = 1.5 * 1000 * 60 / TRANSITIONS_PER_REV;
+    TEST_ASSERT_TRUE(tracksWithoutLoss(rpm, 1000, true, &t));
+    TEST_ASSERT_TRUE(t.recovered.load() > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, t.rejected.load());
+    const long truth = (long)transitionsAt(rpm, 500000);
+    TEST_ASSERT_EQUAL_INT32(truth, (int32_t)(t.valid.load() + 2 * t.recovered.load()));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_steps_match_knobdir);
+    RUN_TEST(test_jump_follows_direction_of_travel);
+    RUN_TEST(test_timer_wrap);
+    RUN_TEST(test_max_tracked_rpm);
+    RUN_TEST(test_counters_add_up);
+    return UNITY_END();
+}
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Host validation of the 74HC165 readout backends against a bit-accurate chain model.
+//
+// The bit-banged sequence (ShiftRegister165::read) defines the buffer layout that configs
+// rely on. The SPI backend clocks the same chain in mode 2 with an MSB-first shifter and
+// converts the frame with ShiftRegisterFrame::fromMsbFirst; both must agree bit for bit.
+// The bit-banged chain can also be read as a prefix (ShiftRegister165::readPrefix) on the
+// ShiftRegisterCadence schedule; the last tests check that and what it does for a fast encoder.
+// Run with: pio test -e native -f native/test_shiftreg_model -v
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inputs/shift_register/ShiftRegisterFrame.h"
+#include "inputs/shift_register/ShiftRegisterCadence.h"
+#include "inputs/encoders/QuadratureCount.h"
+
+static constexpr uint8_t MAX_DEVICES = 8;
+
+// Chain of 74HC165s. Device 0 drives the MCU's QH input; device i's SER is fed from
+// device i+1's QH; the last device's SER is tied high (as on JoyCore boards).
+// Per device, register bit 7 is stage H (appears on QH), bit 0 is stage A.
+struct Chain165 {
+    uint8_t count = 0;
+    uint8_t inputs[MAX_DEVICES] = {};  // parallel pins, bit 0 = A ... bit 7 = H
+    uint8_t stages[MAX_DEVICES] = {};
+    bool pl = true;
+    bool clk = true;
+
+    void setPL(bool level) {
+        pl = level;
+        if (!pl) memcpy(stages, inputs, count); // asynchronous parallel load while PL low
+    }
+    void setCLK(bool level) {
+        bool rising = !clk && level;
+        clk = level;
+        if (!rising || !pl) return;           // shifting only with PL high
+        for (uint8_t d = 0; d < count; ++d) {
+            bool ser = (d + 1 < count) ? (stages[d + 1] & 0x80) : true;
+            stages[d] = (uint8_t)((stages[d] << 1) | (ser ? 1 : 0));
+        }
+    }
+    bool qh() const { return (stages[0] & 0x80) != 0; }
+};
+
+// Mirrors ShiftRegister165::readPrefix: sample QH, then LOW->HIGH clock, LSB first.
+static void readBitBang(Chain165& chain, uint8_t* buffer, uint8_t bytes = 0xFF) {
+    if (bytes > chain.count) bytes = chain.count;
+    chain.setPL(false);
+    chain.setPL(true);
+    for (uint8_t i = 0; i < bytes; ++i) {
+        uint8_t value = 0;
+        for (uint8_t b = 0; b < 8; ++b) {
+            value |= (chain.qh() ? 1 : 0) << b;
+            chain.setCLK(false);
+            chain.setCLK(true);
+        }
+        buffer[i] = value;
+    }
+}
+
+// SPI mode 2 master (CPOL=1, CPHA=0, MSB first): SCK idles high, RX is sampled on each
+// falling edge and the 74HC165 shifts on the following rising edge, so every sample is
+// taken half a clock after QH last changed.
+static void readSpiMode2(Chain165& chain, uint8_t* frame) {
+    chain.setPL(false);
+    chain.setPL(true);
+    for (uint8_t i = 0; i < chain.count; ++i) {
+        uint8_t shifter = 0;
+        for (uint8_t b = 0; b < 8; ++b) {
+            chain.setCLK(false);
+            bool sample = chain.qh();
+            chain.setCLK(true);
+            shifter = (uint8_t)((shifter << 1) | (sample ? 1 : 0));
+        }
+        frame[i] = shifter;
+    }
+}
+
+static uint32_t rngState = 0x1234567u;
+static uint8_t nextByte() {
+    rngState ^= rngState << 13; rngState ^= rngState >> 17; rngState ^= rngState << 5;
+    return (uint8_t)rngState;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_reverse_bits_exhaustive() {
+    for (unsigned v = 0; v < 256; ++v) {
+        uint8_t expected = 0;
+        for (uint8_t b = 0; b < 8; ++b) if (v & (1u << b)) expected |= (uint8_t)(0x80 >> b);
+        TEST_ASSERT_EQUAL_UINT8(expected, ShiftRegisterFrame::reverseBits((uint8_t)v));
+    }
+}
+
+void test_bitbang_layout_matches_convention() {
+    // Buffer bit b of device i = b-th bit out of QH = input (7 - b) of device i
+    Chain165 chain;
+    chain.count = 2;
+    chain.inputs[0] = 0x80; // input H of device 0
+    chain.inputs[1] = 0x01; // input A of device 1
+    uint8_t buffer[MAX_DEVICES];
+    readBitBang(chain, buffer);
+    TEST_ASSERT_EQUAL_HEX8(0x01, buffer[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, buffer[1]);
+}
+
+void test_spi_matches_bitbang_random_chains() {
+    for (uint16_t iter = 0; iter < 2000; ++iter) {
+        Chain165 a, b;
+        a.count = b.count = (uint8_t)(1 + iter % MAX_DEVICES);
+        for (uint8_t d = 0; d < a.count; ++d) a.inputs[d] = b.inputs[d] = nextByte();
+
+        uint8_t expected[MAX_DEVICES], frame[MAX_DEVICES], converted[MAX_DEVICES];
+        readBitBang(a, expected);
+        readSpiMode2(b, frame);
+        ShiftRegisterFrame::fromMsbFirst(frame, converted, b.count);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, converted, a.count);
+    }
+}
+
+void test_spi_back_to_back_frames_relatch() {
+    // The pipelined reader latches a new snapshot before every frame
+    Chain165 chain;
+    chain.count = 3;
+    uint8_t frame[MAX_DEVICES], converted[MAX_DEVICES], expected[MAX_DEVICES];
+    for (uint8_t n = 0; n < 16; ++n) {
+        for (uint8_t d = 0; d < chain.count; ++d) chain.inputs[d] = nextByte();
+        Chain165 ref = chain;
+        readBitBang(ref, expected);
+        readSpiMode2(chain, frame);
+        ShiftRegisterFrame::fromMsbFirst(frame, converted, chain.count);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, converted, chain.count);
+    }
+}
+
+void test_spi_pin_routing() {
+    TEST_ASSERT_EQUAL_INT8(0, ShiftRegisterFrame::spiBlockForPins(18, 16));
+    TEST_ASSERT_EQUAL_INT8(0, ShiftRegisterFrame::spiBlockForPins(2, 4));
+    TEST_ASSERT_EQUAL_INT8(1, ShiftRegisterFrame::spiBlockForPins(10, 12));
+    TEST_ASSERT_EQUAL_INT8(1, ShiftRegisterFrame::spiBlockForPins(26, 28));
+    // Shipped config (CLK 20, QH 18) has the roles swapped -> bit-bang fallback
+    TEST_ASSERT_EQUAL_INT8(-1, ShiftRegisterFrame::spiBlockForPins(20, 18));
+    // SCK and RX on different blocks
+    TEST_ASSERT_EQUAL_INT8(-1, ShiftRegisterFrame::spiBlockForPins(18, 12));
+    TEST_ASSERT_EQUAL_INT8(-1, ShiftRegisterFrame::spiBlockForPins(30, 16));
+}
+
+void test_prefix_read_matches_full_read() {
+    for (uint16_t iter = 0; iter < 500; ++iter) {
+        Chain165 chain;
+        chain.count = (uint8_t)(2 + iter % (MAX_DEVICES - 1));
+        for (uint8_t d = 0; d < chain.count; ++d) chain.inputs[d] = nextByte();
+        const uint8_t bytes = (uint8_t)(1 + iter % (chain.count - 1));
+        uint8_t full[MAX_DEVICES], prefix[MAX_DEVICES];
+        memset(prefix, 0xA5, sizeof(prefix));
+        readBitBang(chain, prefix, bytes); // partial read leaves the chain mid-shift
+        readBitBang(chain, full);          // the next latch starts over
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(full, prefix, bytes);
+        for (uint8_t d = bytes; d < MAX_DEVICES; ++d) TEST_ASSERT_EQUAL_HEX8(0xA5, prefix[d]);
+    }
+}
+
+void test_cadence() {
+    ShiftRegisterCadence c;
+    shiftRegisterCadenceInit(c, 4, 1, 5000, 500);
+    uint32_t full = 0, prefix = 0;
+    for (uint32_t t = 0xFFFFF000u; t != 0xFFFFF000u + 20000; t += 50) { // crosses the 32-bit wrap
+        uint8_t n = shiftRegisterCadenceNext(c, t);
+        if (n == 4) full++;
+        else if (n == 1) prefix++;
+        else TEST_ASSERT_EQUAL_UINT8(0, n);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, full);
+    TEST_ASSERT_EQUAL_UINT32(36, prefix);
+
+    // Encoders on the last device (the shipped 2-device config): the whole chain at the
+    // encoder rate
+    shiftRegisterCadenceInit(c, 2, 2, 5000, 500);
+    TEST_ASSERT_EQUAL_UINT8(0, c.prefixBytes);
+    full = 0;
+    for (uint32_t t = 0; t < 20000; t += 50) {
+        uint8_t n = shiftRegisterCadenceNext(c, t);
+        if (n == 2) full++;
+        else TEST_ASSERT_EQUAL_UINT8(0, n);
+    }
+    TEST_ASSERT_EQUAL_UINT32(40, full);
+
+    // A prefix rate no faster than full reads: full reads only, at the full rate
+    shiftRegisterCadenceInit(c, 2, 1, 5000, 5000);
+    TEST_ASSERT_EQUAL_UINT32(5000, c.fullUs);
+    TEST_ASSERT_EQUAL_UINT8(0, c.prefixBytes);
+    shiftRegisterCadenceInit(c, 2, 1, 0, 500); // hardware-clocked chain: full read every loop
+    TEST_ASSERT_EQUAL_UINT8(0, c.prefixBytes);
+    TEST_ASSERT_EQUAL_UINT8(2, shiftRegisterCadenceNext(c, 0));
+    TEST_ASSERT_EQUAL_UINT8(2, shiftRegisterCadenceNext(c, 0));
+}
+
+// Encoder on device 0 (A = input H, B = input G, buffer bits 0/1) of a 4-device chain, turned at
+// a steady rate for one second while the scan loop runs every 50 us. Counts the detents decoded
+// from the samples; a sample that jumps two quadrature states loses that step.
+static uint32_t decodedDetents(uint32_t detentsPerSec, uint8_t prefixBytes, uint32_t prefixUs) {
+    Chain165 chain;
+    chain.count = 4;
+    ShiftRegisterCadence c;
+    shiftRegisterCadenceInit(c, chain.count, prefixBytes, 5000, prefixUs);
+    static const uint8_t kGray[4] = {0, 2, 3, 1}; // quadratureGrayIndex 0, 1, 2, 3: counts up
+    uint8_t buffer[MAX_DEVICES] = {};
+    int32_t transitions = 0;
+    uint8_t lastIndex = 0;
+    const uint32_t DURATION_US = 1000000;
+    for (uint32_t t = 0; t <= DURATION_US; t += 50) {
+        const uint32_t step = (uint32_t)(((uint64_t)t * detentsPerSec * 4) / 1000000u);
+        const uint8_t state = kGray[step & 3];
+        chain.inputs[0] = (uint8_t)(((state & 1) ? 0x80 : 0) | ((state & 2) ? 0x40 : 0));
+        const uint8_t n = shiftRegisterCadenceNext(c, t);
+        if (!n) continue;
+        readBitBang(chain, buffer, n);
+        const uint8_t idx = quadratureGrayIndex(buffer[0] & 0x3);
+        const uint8_t d = (uint8_t)((idx - lastIndex) & 3);
+        if (d == 1) transitions++;
+        else if (d == 3) transitions--;
+        lastIndex = idx;
+    }
+    return (uint32_t)(transitions / 4);
+}
+
+void test_prefix_reads_keep_fast_detents() {
+    const uint32_t RATES[] = {20, 50, 100, 200};
+    for (uint32_t rate : RATES) {
+        const uint32_t full = decodedDetents(rate, 0, 0);
+        const uint32_t fast = decodedDetents(rate, 1, 500);
+        const uint32_t whole = decodedDetents(rate, 4, 500); // prefix = whole chain
+        printf("  %3u detents/s on a 4-device chain: full reads every 5 ms %3u, prefix at 2 kHz %3u,"
+               " whole chain at 2 kHz %3u\n", rate, full, fast, whole);
+        TEST_ASSERT_UINT32_WITHIN(1, rate, fast);
+        TEST_ASSERT_UINT32_WITHIN(1, rate, whole);
+        if (rate >= 100) TEST_ASSERT_TRUE(full < rate);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reverse_bits_exhaustive);
+    RUN_TEST(test_bitbang_layout_matches_convention);
+    RUN_TEST(test_spi_matches_bitbang_random_chains);
+    RUN_TEST(test_spi_back_to_back_frames_relatch);
+    RUN_TEST(test_spi_pin_routing);
+    RUN_TEST(test_prefix_read_matches_full_read);
+    RUN_TEST(test_cadence);
+    RUN_TEST(test_prefix_reads_keep_fast_detents);
+    return UNITY_END();
+}
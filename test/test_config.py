@@ -311,7 +311,7 @@ def parse_config_data(config_data):
                 joy_button_id = config_data[offset + 2]
                 reverse = config_data[offset + 3]
                 encoder_latch_mode = config_data[offset + 4]
-                # Skip reserved bytes
+                # Bytes 5-7: encoder press ms, release ms, flags (0 = firmware default)
                 
                 print(f"  Input {i+1}:")
                 print(f"    Type: {parse_input_type(input_type)}")
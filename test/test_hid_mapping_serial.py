@@ -116,7 +116,7 @@ class JoyCoreSerial:
         if not response.startswith("HID_MAPPING_INFO:"):
             return None
         
-        # Parse response: HID_MAPPING_INFO:ver=1,rid=1,btn=32,axis=8,btn_offset=0,bit_order=0,crc=0x0000,fc_offset=48
+        # Parse response: HID_MAPPING_INFO:ver=1,rid=1,btn=32,axis=8,btn_offset=0,bit_order=0,crc=0x0000,fc_offset=48,enc_axes=0x0
         data = response.split(":", 1)[1]
         info = {}
         
@@ -125,7 +125,7 @@ class JoyCoreSerial:
                 key, value = pair.split("=", 1)
                 if key in ["ver", "rid", "btn", "axis", "btn_offset", "bit_order", "fc_offset"]:
                     info[key] = int(value)
-                elif key == "crc":
+                elif key in ["crc", "enc_axes"]:
                     info[key] = int(value, 16)
         
         # Add derived fields
@@ -206,6 +206,7 @@ def print_mapping_info(info: Dict):
     print(f"Button Bit Order:     {bit_order_str}")
     
     print(f"Frame Counter Offset: {info.get('fc_offset', 'Unknown')}")
+    print(f"Encoder Axis Mask:    0x{info.get('enc_axes', 0):04X}")
     
     crc = info.get('crc', -1)
     if crc >= 0:
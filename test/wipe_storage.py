@@ -8,9 +8,9 @@ Purpose:
   generates fresh defaults (only when config is absent).
 
 Mechanism:
-  Uses the existing serial command 'FORMAT_STORAGE' which formats the EEPROM
-  file table. This is preferable to issuing individual deletions because it
-  guarantees a clean table and frees all space.
+  Uses the existing serial command 'FORMAT_STORAGE' which erases the config
+  log in flash (and the files of the older EEPROM layout). This is preferable
+  to issuing individual deletions because it leaves no old versions behind.
 
 Workflow:
   1. Detect the serial port (heuristic similar to test scripts).